@@ -33,6 +33,12 @@
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <optional>
+
+#include <nlohmann/json.hpp>
 
 #include "NHLBICompression.h"
 #include "GadgetronTimer.h"
@@ -73,6 +79,17 @@ struct NoiseStatistics
     float noise_dwell_time_us;
 };
 
+// The compression tolerance is given as a fraction of sigma; scales it to the noise level at the readout's dwell time.
+float scaled_compression_tolerance(float compression_tolerance, const NoiseStatistics& stat, const ISMRMRD::AcquisitionHeader& head)
+{
+    float local_tolerance = compression_tolerance;
+    float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
+    if (stat.status && sigma > 0 && stat.noise_dwell_time_us && head.sample_time_us) {
+        local_tolerance = local_tolerance*stat.sigma_min*head.sample_time_us*std::sqrt(stat.noise_dwell_time_us/head.sample_time_us);
+    }
+    return local_tolerance;
+}
+
 #if defined GADGETRON_COMPRESSION_ZFP
 size_t compress_zfp_tolerance(float* in, size_t samples, size_t coils, double tolerance, char* buffer, size_t buf_size)
 {
@@ -278,6 +295,9 @@ public:
 
 class GadgetronClientResponseReader : public GadgetronClientMessageReader
 {
+public:
+    explicit GadgetronClientResponseReader(std::ostream& out = std::cout) : out_(out) {}
+
     void read(tcp::socket *stream) override {
 
         uint64_t correlation_id = 0;
@@ -290,15 +310,18 @@ class GadgetronClientResponseReader : public GadgetronClientMessageReader
 
         boost::asio::read(*stream, boost::asio::buffer(response.data(),response_length));
 
-        std::cout << response.data() << std::endl;
+        out_ << response.data() << std::endl;
     }
+
+private:
+    std::ostream& out_;
 };
 
 class GadgetronClientTextReader : public GadgetronClientMessageReader
 {
   
 public:
-  GadgetronClientTextReader()
+  explicit GadgetronClientTextReader(std::ostream& out = std::cout) : out_(out)
   {
     
   }
@@ -333,9 +356,12 @@ public:
     }
 
     std::string s(buf);
-    std::cout << s;
+    out_ << s;
     delete[] buf;
   }  
+
+protected:
+  std::ostream& out_;
 };
 
 
@@ -1372,11 +1398,7 @@ public:
         if (data_elements) {
             std::vector<float> input_data((float*)&acq.getDataPtr()[0], (float*)&acq.getDataPtr()[0] + acq.getHead().active_channels* acq.getHead().number_of_samples*2);
 
-            float local_tolerance = compression_tolerance;
-            float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
-            if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
-                local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
-            }
+            float local_tolerance = scaled_compression_tolerance(compression_tolerance, stat, acq.getHead());
 
             std::unique_ptr<CompressedFloatBuffer> comp_buffer(CompressedFloatBuffer::createCompressedBuffer());
             comp_buffer->compress(input_data, local_tolerance);
@@ -1475,11 +1497,7 @@ public:
             header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
         }
 
-        float local_tolerance = compression_tolerance;
-        float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
-        if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
-            local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
-        }
+        float local_tolerance = scaled_compression_tolerance(compression_tolerance, stat, acq.getHead());
 
         if (data_elements) {
             size_t comp_buffer_size = 4*sizeof(float)*data_elements;
@@ -1536,6 +1554,15 @@ public:
         }
     }
 
+    void send_encoded_message(const std::vector<char>& message)
+    {
+        if (!socket_) {
+            throw GadgetronClientException("Invalid socket.");
+        }
+
+        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(message));
+    }
+
     void register_reader(unsigned short slot, std::shared_ptr<GadgetronClientMessageReader> r) {
         readers_[slot] = r;
     }
@@ -1698,6 +1725,619 @@ void send_ismrmrd_acq(GadgetronClientConnector& con, ISMRMRD::Acquisition& acq_t
     }
 }
 
+/*
+ * Load replay
+ *
+ * Streams recorded datasets to the server over several connections at once, paced as the scanner acquired them (or at
+ * a fixed rate), to see how the server holds up under the load of a busy site. Messages are read from the file and
+ * encoded ahead of sending on a thread of their own, so the HDF5 reads do not hold up the pace. Images are counted as
+ * they come back rather than written out.
+ */
+
+using LoadClock = std::chrono::steady_clock;
+
+struct LoadOptions
+{
+    std::string host_name;
+    std::string port;
+    std::vector<std::string> datasets;
+    std::string hdf5_in_group;
+    std::string config_file;
+    std::string config_xml_local;
+    unsigned int streams;
+    unsigned int loops;
+    unsigned int timeout_ms;
+    unsigned int stagger_ms;
+    double acquisition_rate;            // Acquisitions per second on each stream; 0 sends as fast as possible
+    bool scanner_timing;                // Follow the acquisition time stamps instead
+    double time_stamp_resolution_ms;
+    unsigned int compression_precision;
+    float compression_tolerance;
+    NoiseStatistics noise_stats;
+};
+
+struct EncodedMessage
+{
+    std::vector<char> bytes;
+    uint32_t time_stamp;
+    bool acquisition;
+    size_t uncompressed_bytes;          // Size of the samples before and after compression
+    size_t compressed_bytes;
+};
+
+template<class T> void append(std::vector<char>& bytes, const T* data, size_t elements)
+{
+    const char* begin = reinterpret_cast<const char*>(data);
+    bytes.insert(bytes.end(), begin, begin + sizeof(T)*elements);
+}
+
+EncodedMessage encode_acquisition(const ISMRMRD::Acquisition& acq, unsigned int compression_precision, float compression_tolerance, const NoiseStatistics& stat)
+{
+    EncodedMessage message;
+    message.time_stamp = acq.getHead().acquisition_time_stamp;
+    message.acquisition = true;
+
+    bool compressed = compression_precision > 0 || compression_tolerance > 0.0;
+
+    GadgetMessageIdentifier id;
+    id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
+
+    ISMRMRD::AcquisitionHeader h = acq.getHead();
+    if (compressed) {
+        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
+    }
+
+    unsigned long trajectory_elements = h.trajectory_dimensions*h.number_of_samples;
+    unsigned long data_elements = h.active_channels*h.number_of_samples;
+
+    append(message.bytes, &id, 1);
+    append(message.bytes, &h, 1);
+    if (trajectory_elements) {
+        append(message.bytes, acq.getTrajPtr(), trajectory_elements);
+    }
+
+    message.uncompressed_bytes = data_elements*2*sizeof(float);
+    message.compressed_bytes = message.uncompressed_bytes;
+
+    if (data_elements && compressed) {
+        const float* samples = reinterpret_cast<const float*>(acq.getDataPtr());
+        std::vector<float> input_data(samples, samples + data_elements*2);
+
+        std::unique_ptr<CompressedFloatBuffer> comp_buffer(CompressedFloatBuffer::createCompressedBuffer());
+        if (compression_precision > 0) {
+            comp_buffer->compress(input_data, -1.0, compression_precision);
+        } else {
+            comp_buffer->compress(input_data, scaled_compression_tolerance(compression_tolerance, stat, h));
+        }
+        std::vector<uint8_t> serialized_buffer = comp_buffer->serialize();
+
+        uint32_t bs = (uint32_t)serialized_buffer.size();
+        append(message.bytes, &bs, 1);
+        append(message.bytes, serialized_buffer.data(), serialized_buffer.size());
+        message.compressed_bytes = serialized_buffer.size();
+    }
+    else if (data_elements) {
+        append(message.bytes, acq.getDataPtr(), data_elements);
+    }
+
+    return message;
+}
+
+EncodedMessage encode_waveform(ISMRMRD::Waveform& wav)
+{
+    EncodedMessage message;
+    message.time_stamp = wav.head.time_stamp;
+    message.acquisition = false;
+    message.uncompressed_bytes = 0;
+    message.compressed_bytes = 0;
+
+    GadgetMessageIdentifier id;
+    id.id = GADGET_MESSAGE_ISMRMRD_WAVEFORM;
+
+    append(message.bytes, &id, 1);
+    append(message.bytes, reinterpret_cast<const char*>(&wav.head), sizeof(ISMRMRD::ISMRMRD_WaveformHeader));
+
+    unsigned long data_elements = wav.head.channels*wav.head.number_of_samples;
+    if (data_elements) {
+        append(message.bytes, wav.begin_data(), data_elements);
+    }
+
+    return message;
+}
+
+// Hands encoded messages from the reading thread to the sending one; the reader waits once it is far enough ahead.
+class EncodedMessageQueue
+{
+public:
+    explicit EncodedMessageQueue(size_t capacity) : capacity_(capacity), closed_(false) {}
+
+    void push(EncodedMessage message)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&]() { return queue_.size() < capacity_ || closed_; });
+        if (closed_) {
+            return;
+        }
+        queue_.push_back(std::move(message));
+        not_empty_.notify_one();
+    }
+
+    // Returns false once the queue is closed and drained.
+    bool pop(EncodedMessage& message)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&]() { return !queue_.empty() || closed_; });
+        if (queue_.empty()) {
+            return false;
+        }
+        message = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    bool closed_;
+    std::deque<EncodedMessage> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+// Reads the dataset in the order the scanner produced it: waveforms go ahead of the acquisitions that follow them.
+void prefetch_dataset(ISMRMRD::Dataset& dataset, EncodedMessageQueue& queue, const LoadOptions& options)
+{
+    uint32_t acquisitions = 0;
+    uint32_t waveforms = 0;
+    {
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        acquisitions = dataset.getNumberOfAcquisitions();
+        waveforms = dataset.getNumberOfWaveforms();
+    }
+
+    ISMRMRD::Acquisition acq_tmp;
+    ISMRMRD::Waveform wav_tmp;
+
+    uint32_t i(0), j(0); // i : index over the acquisition; j : index over the waveform
+
+    auto read_acquisition = [&]() {
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        dataset.readAcquisition(i, acq_tmp);
+    };
+
+    auto read_waveform = [&]() {
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        dataset.readWaveform(j, wav_tmp);
+    };
+
+    if (i < acquisitions) read_acquisition();
+    if (j < waveforms) read_waveform();
+
+    while (i < acquisitions || j < waveforms)
+    {
+        if (j < waveforms && (i == acquisitions || wav_tmp.head.time_stamp < acq_tmp.getHead().acquisition_time_stamp))
+        {
+            queue.push(encode_waveform(wav_tmp));
+            if (++j < waveforms) read_waveform();
+        }
+        else
+        {
+            queue.push(encode_acquisition(acq_tmp, options.compression_precision, options.compression_tolerance, options.noise_stats));
+            if (++i < acquisitions) read_acquisition();
+        }
+    }
+}
+
+// When the images of a replay came back.
+class ReplayTimeline
+{
+public:
+    ReplayTimeline() : images_(0) {}
+
+    void image_received()
+    {
+        LoadClock::time_point now = LoadClock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!images_++) {
+            first_image_ = now;
+        }
+        last_image_ = now;
+    }
+
+    size_t images()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return images_;
+    }
+
+    LoadClock::time_point first_image()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return first_image_;
+    }
+
+    LoadClock::time_point last_image()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_image_;
+    }
+
+private:
+    std::mutex mutex_;
+    size_t images_;
+    LoadClock::time_point first_image_;
+    LoadClock::time_point last_image_;
+};
+
+class GadgetronClientLoadImageReader : public GadgetronClientMessageReader
+{
+public:
+    explicit GadgetronClientLoadImageReader(ReplayTimeline& timeline) : timeline_(timeline) {}
+
+    virtual void read(tcp::socket* stream)
+    {
+        ISMRMRD::ImageHeader h;
+        boost::asio::read(*stream, boost::asio::buffer(&h, sizeof(ISMRMRD::ImageHeader)));
+
+        typedef unsigned long long size_t_type;
+        size_t_type meta_attrib_length;
+        boost::asio::read(*stream, boost::asio::buffer(&meta_attrib_length, sizeof(size_t_type)));
+
+        size_t element_size = ISMRMRD::ismrmrd_sizeof_data_type(h.data_type);
+        if (!element_size) {
+            throw GadgetronClientException("Received image of unknown data type.");
+        }
+
+        size_t data_bytes = element_size*h.matrix_size[0]*h.matrix_size[1]*h.matrix_size[2]*h.channels;
+        buffer_.resize(meta_attrib_length + data_bytes);
+        boost::asio::read(*stream, boost::asio::buffer(buffer_));
+
+        timeline_.image_received();
+    }
+
+private:
+    ReplayTimeline& timeline_;
+    std::vector<char> buffer_;
+};
+
+class GadgetronClientLoadBlobReader : public GadgetronClientMessageReader
+{
+public:
+    explicit GadgetronClientLoadBlobReader(ReplayTimeline& timeline) : timeline_(timeline) {}
+
+    virtual void read(tcp::socket* socket)
+    {
+        uint32_t nbytes;
+        boost::asio::read(*socket, boost::asio::buffer(&nbytes, sizeof(uint32_t)));
+        skip(socket, nbytes);
+
+        unsigned long long fileNameLen;
+        boost::asio::read(*socket, boost::asio::buffer(&fileNameLen, sizeof(unsigned long long)));
+        skip(socket, fileNameLen);
+
+        unsigned long long meta_attrib_length;
+        boost::asio::read(*socket, boost::asio::buffer(&meta_attrib_length, sizeof(unsigned long long)));
+        skip(socket, meta_attrib_length);
+
+        timeline_.image_received();
+    }
+
+private:
+    void skip(tcp::socket* socket, size_t bytes)
+    {
+        buffer_.resize(bytes);
+        boost::asio::read(*socket, boost::asio::buffer(buffer_));
+    }
+
+    ReplayTimeline& timeline_;
+    std::vector<char> buffer_;
+};
+
+struct ReplayResult
+{
+    unsigned int stream;
+    std::string dataset;
+    bool succeeded;
+    std::string error;
+    double start_s;                     // Since the load test began
+    double duration_s;                  // Connect to close
+    double send_s;                      // First acquisition to last
+    double max_send_lag_s;              // How far sending fell behind the pace
+    size_t acquisitions;
+    size_t images;
+    double bytes_sent;
+    double uncompressed_bytes;
+    double compressed_bytes;
+    std::optional<double> time_to_first_image_s;   // From the first acquisition sent
+    std::optional<double> time_to_last_image_s;    // From the last acquisition sent, i.e. the end of the scan
+};
+
+double seconds_between(LoadClock::time_point from, LoadClock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+ReplayResult replay_dataset(unsigned int stream, const std::string& filename, const LoadOptions& options, LoadClock::time_point load_start)
+{
+    ReplayResult result;
+    result.stream = stream;
+    result.dataset = filename;
+    result.succeeded = false;
+    result.start_s = seconds_between(load_start, LoadClock::now());
+    result.duration_s = 0;
+    result.send_s = 0;
+    result.max_send_lag_s = 0;
+    result.acquisitions = 0;
+    result.images = 0;
+    result.bytes_sent = 0;
+    result.uncompressed_bytes = 0;
+    result.compressed_bytes = 0;
+
+    const size_t prefetch_depth = 1024;
+    EncodedMessageQueue queue(prefetch_depth);
+    std::thread prefetcher;
+    std::exception_ptr prefetch_error;
+
+    // Outlives the prefetcher, which is joined before the dataset is closed
+    std::shared_ptr<ISMRMRD::Dataset> dataset;
+
+    try
+    {
+        std::string xml_config;
+        {
+            std::lock_guard<std::mutex> scoped_lock(mtx);
+            dataset = std::make_shared<ISMRMRD::Dataset>(filename.c_str(), options.hdf5_in_group.c_str(), false);
+            dataset->readHeader(xml_config);
+        }
+
+        prefetcher = std::thread([&]() {
+            try {
+                prefetch_dataset(*dataset, queue, options);
+            } catch (...) {
+                prefetch_error = std::current_exception();
+            }
+            queue.close();
+        });
+
+        ReplayTimeline timeline;
+        GadgetronClientConnector con;
+        con.set_timeout(options.timeout_ms);
+        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientLoadImageReader(timeline)));
+        con.register_reader(GADGET_MESSAGE_DICOM_WITHNAME, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientLoadBlobReader(timeline)));
+        // Standard output is kept for the report
+        con.register_reader(GADGET_MESSAGE_TEXT, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientTextReader(std::cerr)));
+        con.register_reader(7, std::shared_ptr<GadgetronClientResponseReader>(new GadgetronClientResponseReader(std::cerr)));
+
+        LoadClock::time_point connected = LoadClock::now();
+        con.connect(options.host_name, options.port);
+
+        if (!options.config_xml_local.empty()) {
+            con.send_gadgetron_configuration_script(options.config_xml_local);
+        } else {
+            con.send_gadgetron_configuration_file(options.config_file);
+        }
+        con.send_gadgetron_parameters(xml_config);
+
+        LoadClock::time_point first_sent, last_sent;
+        uint32_t first_time_stamp = 0;
+        std::chrono::duration<double> tick(options.time_stamp_resolution_ms/1000.0);
+
+        EncodedMessage message;
+        while (queue.pop(message))
+        {
+            // The pace is set from the first acquisition; waveforms only wait their turn when the scanner's timing is
+            // followed.
+            LoadClock::time_point now = LoadClock::now();
+            if (first_sent == LoadClock::time_point()) {
+                if (message.acquisition) {
+                    first_sent = now;
+                    first_time_stamp = message.time_stamp;
+                }
+            }
+            else if (message.acquisition || options.scanner_timing) {
+                LoadClock::time_point due = now;
+                if (options.scanner_timing) {
+                    double ticks = message.time_stamp > first_time_stamp ? double(message.time_stamp - first_time_stamp) : 0.0;
+                    due = first_sent + std::chrono::duration_cast<LoadClock::duration>(tick*ticks);
+                } else if (options.acquisition_rate > 0) {
+                    due = first_sent + std::chrono::duration_cast<LoadClock::duration>(std::chrono::duration<double>(result.acquisitions/options.acquisition_rate));
+                }
+
+                if (due > now) {
+                    std::this_thread::sleep_until(due);
+                } else {
+                    result.max_send_lag_s = std::max(result.max_send_lag_s, seconds_between(due, now));
+                }
+            }
+
+            con.send_encoded_message(message.bytes);
+
+            if (message.acquisition) {
+                result.acquisitions++;
+                result.uncompressed_bytes += message.uncompressed_bytes;
+                result.compressed_bytes += message.compressed_bytes;
+                last_sent = LoadClock::now();
+            }
+        }
+
+        if (prefetch_error) {
+            std::rethrow_exception(prefetch_error);
+        }
+
+        con.send_gadgetron_close();
+        con.wait();
+
+        LoadClock::time_point finished = LoadClock::now();
+        result.duration_s = seconds_between(connected, finished);
+        result.bytes_sent = con.get_bytes_transmitted();
+        result.images = timeline.images();
+
+        if (result.acquisitions) {
+            result.send_s = seconds_between(first_sent, last_sent);
+            if (result.images) {
+                result.time_to_first_image_s = seconds_between(first_sent, timeline.first_image());
+                result.time_to_last_image_s = seconds_between(last_sent, timeline.last_image());
+            }
+        }
+
+        result.succeeded = true;
+    }
+    catch (std::exception& ex)
+    {
+        result.error = ex.what();
+    }
+
+    queue.close();
+    if (prefetcher.joinable()) {
+        prefetcher.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        dataset.reset();
+    }
+
+    return result;
+}
+
+// Nearest rank percentile of sorted values.
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+    size_t rank = size_t(std::ceil(fraction*sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+nlohmann::json summarize(std::vector<double> values)
+{
+    if (values.empty()) {
+        return nullptr;
+    }
+
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (auto v : values) sum += v;
+
+    return {
+        { "count", values.size() },
+        { "min", values.front() },
+        { "mean", sum/values.size() },
+        { "p50", percentile(values, 0.50) },
+        { "p95", percentile(values, 0.95) },
+        { "p99", percentile(values, 0.99) },
+        { "max", values.back() }
+    };
+}
+
+nlohmann::json run_load_test(const LoadOptions& options)
+{
+    std::vector<std::vector<ReplayResult>> stream_results(options.streams);
+    std::vector<std::thread> streams;
+
+    LoadClock::time_point load_start = LoadClock::now();
+    for (unsigned int s = 0; s < options.streams; s++)
+    {
+        streams.emplace_back([&, s]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(s*options.stagger_ms));
+            const std::string& filename = options.datasets[s % options.datasets.size()];
+            for (unsigned int l = 0; l < options.loops; l++) {
+                stream_results[s].push_back(replay_dataset(s, filename, options, load_start));
+            }
+        });
+    }
+
+    for (auto& t : streams) {
+        t.join();
+    }
+    double wall_time_s = seconds_between(load_start, LoadClock::now());
+
+    std::vector<double> ttfi, ttli, durations, lags;
+    size_t succeeded = 0, failed = 0, acquisitions = 0, images = 0;
+    double bytes_sent = 0, uncompressed_bytes = 0, compressed_bytes = 0;
+
+    nlohmann::json replays = nlohmann::json::array();
+    for (auto& results : stream_results)
+    {
+        for (auto& r : results)
+        {
+            nlohmann::json replay = {
+                { "stream", r.stream },
+                { "dataset", r.dataset },
+                { "succeeded", r.succeeded },
+                { "start_s", r.start_s }
+            };
+
+            if (!r.succeeded) {
+                replay["error"] = r.error;
+                replays.push_back(replay);
+                failed++;
+                continue;
+            }
+
+            succeeded++;
+            acquisitions += r.acquisitions;
+            images += r.images;
+            bytes_sent += r.bytes_sent;
+            uncompressed_bytes += r.uncompressed_bytes;
+            compressed_bytes += r.compressed_bytes;
+            durations.push_back(r.duration_s);
+            lags.push_back(r.max_send_lag_s);
+
+            replay["duration_s"] = r.duration_s;
+            replay["send_s"] = r.send_s;
+            replay["max_send_lag_s"] = r.max_send_lag_s;
+            replay["acquisitions"] = r.acquisitions;
+            replay["images"] = r.images;
+            replay["bytes_sent"] = r.bytes_sent;
+            if (r.time_to_first_image_s) {
+                ttfi.push_back(*r.time_to_first_image_s);
+                ttli.push_back(*r.time_to_last_image_s);
+                replay["time_to_first_image_s"] = *r.time_to_first_image_s;
+                replay["time_to_last_image_s"] = *r.time_to_last_image_s;
+            }
+            replays.push_back(replay);
+        }
+    }
+
+    nlohmann::json report = {
+        { "streams", options.streams },
+        { "loops", options.loops },
+        { "datasets", options.datasets },
+        { "pacing", options.scanner_timing ? "scanner" : options.acquisition_rate > 0 ? "rate" : "unpaced" },
+        { "succeeded_replays", succeeded },
+        { "failed_replays", failed },
+        { "wall_time_s", wall_time_s },
+        { "acquisitions_sent", acquisitions },
+        { "images_received", images },
+        { "bytes_sent", bytes_sent },
+        { "throughput", {
+            { "mb_per_s", bytes_sent/(1024*1024)/wall_time_s },
+            { "acquisitions_per_s", acquisitions/wall_time_s },
+            { "images_per_s", images/wall_time_s },
+            { "replays_per_hour", succeeded*3600.0/wall_time_s }
+        } },
+        { "time_to_first_image_s", summarize(ttfi) },
+        { "time_to_last_image_s", summarize(ttli) },
+        { "replay_duration_s", summarize(durations) },
+        { "max_send_lag_s", summarize(lags) },
+        { "replays", replays }
+    };
+
+    if (compressed_bytes > 0 && (options.compression_precision > 0 || options.compression_tolerance > 0.0)) {
+        report["compression_ratio"] = uncompressed_bytes/compressed_bytes;
+    }
+
+    return report;
+}
+
 int main(int argc, char **argv)
 {
 
@@ -1718,6 +2358,12 @@ int main(int argc, char **argv)
     float compression_tolerance = 0.0;
     bool use_zfp_compression = false;
     bool verbose = false;
+    unsigned int load_streams = 0;
+    std::vector<std::string> replay_files;
+    double acquisition_rate = 0;
+    double time_stamp_resolution_ms = 2.5;
+    unsigned int stagger_ms = 0;
+    std::string report_file;
     Gadgetron::GadgetronTimer timer(false);
 
     po::options_description desc("Allowed options");
@@ -1735,16 +2381,29 @@ int main(int argc, char **argv)
         ("out-group,G", po::value<std::string>(&hdf5_out_group)->default_value(get_date_time_string()), "Output group name")  
         ("config,c", po::value<std::string>(&config_file)->default_value("default.xml"), "Configuration file (remote)")
         ("config-local,C", po::value<std::string>(&config_file_local), "Configuration file (local)")
-        ("loops,l", po::value<unsigned int>(&loops)->default_value(1), "Loops")
+        ("loops,l", po::value<unsigned int>(&loops)->default_value(1), "Loops (replays on each stream in load mode)")
         ("timeout,t", po::value<unsigned int>(&timeout_ms)->default_value(10000), "Timeout [ms]")
         ("outformat,F", po::value<std::string>(&out_fileformat)->default_value("h5"), "Out format, h5 for hdf5 and hdr for analyze image")
         ("precision,P", po::value<unsigned int>(&compression_precision)->default_value(0), "Compression precision (bits)")
         ("tolerance,T", po::value<float>(&compression_tolerance)->default_value(0.0), "Compression tolerance (fraction of sigma, if no noise stats, assume sigma 1)")
 #if defined GADGETRON_COMPRESSION_ZFP
-        ("ZFP,Z", po::value<bool>(&use_zfp_compression)->default_value(false), "Use ZFP library for compression");
+        ("ZFP,Z", po::value<bool>(&use_zfp_compression)->default_value(false), "Use ZFP library for compression")
 #endif //GADGETRON_COMPRESSION_ZFP
         ;
 
+    po::options_description load_desc("Load replay (enabled by --streams)");
+
+    load_desc.add_options()
+        ("streams,n", po::value<unsigned int>(&load_streams)->default_value(0), "Number of concurrent connections replaying data")
+        ("replay-files", po::value<std::vector<std::string>>(&replay_files)->multitoken(), "Further datasets to replay; the streams take the input file and these in turn")
+        ("rate", po::value<double>(&acquisition_rate)->default_value(0), "Acquisitions per second on each stream; 0 sends as fast as possible")
+        ("scanner-timing", "Send at the pace of the acquisition time stamps")
+        ("time-stamp-resolution", po::value<double>(&time_stamp_resolution_ms)->default_value(2.5), "Duration of a time stamp tick [ms]")
+        ("stagger", po::value<unsigned int>(&stagger_ms)->default_value(0), "Delay between the start of each stream [ms]")
+        ("report", po::value<std::string>(&report_file), "Write the load report (JSON) to this file rather than to standard output");
+
+    desc.add(load_desc);
+
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -1785,6 +2444,16 @@ int main(int argc, char **argv)
        return -1;
     }
 
+    if (load_streams > 0 && use_zfp_compression) {
+        std::cout << "ZFP compression is not available in load mode" << std::endl;
+        return -1;
+    }
+
+    if (load_streams > 0 && (vm.count("query") || vm.count("info"))) {
+        std::cout << "Load mode replays data; it cannot be combined with a query" << std::endl;
+        return -1;
+    }
+
     //Let's check if the files exist:
     std::string hdf5_xml_varname = std::string(hdf5_in_group) + std::string("/xml");
     std::string hdf5_data_varname = std::string(hdf5_in_group) + std::string("/data");
@@ -1802,16 +2471,19 @@ int main(int argc, char **argv)
       ismrmrd_dataset->readHeader(xml_config);
     }
 
+    // In load mode, standard output is kept for the JSON report
+    std::ostream& info = load_streams > 0 ? std::cerr : std::cout;
+
     if (!vm.count("query") && !vm.count("info")) {
-      std::cout << "Gadgetron ISMRMRD client" << std::endl;
-      std::cout << "  -- host            :      " << host_name << std::endl;
-      std::cout << "  -- port            :      " << port << std::endl;
-      std::cout << "  -- hdf5 file  in   :      " << in_filename << std::endl;
-      std::cout << "  -- hdf5 group in   :      " << hdf5_in_group << std::endl;
-      std::cout << "  -- conf            :      " << config_file << std::endl;
-      std::cout << "  -- loop            :      " << loops << std::endl;
-      std::cout << "  -- hdf5 file out   :      " << out_filename << std::endl;
-      std::cout << "  -- hdf5 group out  :      " << hdf5_out_group << std::endl;
+      info << "Gadgetron ISMRMRD client" << std::endl;
+      info << "  -- host            :      " << host_name << std::endl;
+      info << "  -- port            :      " << port << std::endl;
+      info << "  -- hdf5 file  in   :      " << in_filename << std::endl;
+      info << "  -- hdf5 group in   :      " << hdf5_in_group << std::endl;
+      info << "  -- conf            :      " << config_file << std::endl;
+      info << "  -- loop            :      " << loops << std::endl;
+      info << "  -- hdf5 file out   :      " << out_filename << std::endl;
+      info << "  -- hdf5 group out  :      " << hdf5_out_group << std::endl;
     }
 
 
@@ -1824,9 +2496,9 @@ int main(int argc, char **argv)
         std::string noise_id;
         if (h.measurementInformation.is_present() &&
             (h.measurementInformation().measurementDependency.size() > 0)) {
-            std::cout << "This measurement has dependent measurements" << std::endl;
+            info << "This measurement has dependent measurements" << std::endl;
             for (auto d: h.measurementInformation().measurementDependency) {
-                std::cout << "  " << d.dependencyType << " : " << d.measurementID << std::endl;
+                info << "  " << d.dependencyType << " : " << d.measurementID << std::endl;
                 if (d.dependencyType == "Noise") {
                     noise_id = d.measurementID;
                 }
@@ -1834,19 +2506,55 @@ int main(int argc, char **argv)
         }
         
         if (!noise_id.empty()) {
-            std::cout << "Querying the Gadgetron instance for the dependent measurement: " << noise_id << std::endl;
+            info << "Querying the Gadgetron instance for the dependent measurement: " << noise_id << std::endl;
             noise_stats = get_noise_statistics(std::string("GadgetronNoiseCovarianceMatrix_") + noise_id, host_name, port, timeout_ms);
             if (!noise_stats.status) {
-                std::cout << "WARNING: Dependent noise measurement not found on Gadgetron server. Was the noise data processed?" << std::endl;
+                info << "WARNING: Dependent noise measurement not found on Gadgetron server. Was the noise data processed?" << std::endl;
                 if (compression_tolerance > 0.0) {
-                    std::cout << "  !!!!!! COMPRESSION TOLERANCE LEVEL SPECIFIED, BUT IT IS NOT POSSIBLE TO DETERMINE SIGMA. ASSIMUMING SIGMA == 1 !!!!!!" << std::endl;
+                    info << "  !!!!!! COMPRESSION TOLERANCE LEVEL SPECIFIED, BUT IT IS NOT POSSIBLE TO DETERMINE SIGMA. ASSIMUMING SIGMA == 1 !!!!!!" << std::endl;
                 }
             } else {
-                std::cout << "Noise level: Min sigma = " << noise_stats.sigma_min << ", Mean sigma = " << noise_stats.sigma_mean << ", Max sigma = " << noise_stats.sigma_max << std::endl; 
+                info << "Noise level: Min sigma = " << noise_stats.sigma_min << ", Mean sigma = " << noise_stats.sigma_mean << ", Max sigma = " << noise_stats.sigma_max << std::endl; 
             }
         }
     }
 
+    if (load_streams > 0)
+    {
+        LoadOptions options;
+        options.host_name = host_name;
+        options.port = port;
+        options.datasets.push_back(in_filename);
+        options.datasets.insert(options.datasets.end(), replay_files.begin(), replay_files.end());
+        options.hdf5_in_group = hdf5_in_group;
+        options.config_file = config_file;
+        options.config_xml_local = config_xml_local;
+        options.streams = load_streams;
+        options.loops = loops;
+        options.timeout_ms = timeout_ms;
+        options.stagger_ms = stagger_ms;
+        options.acquisition_rate = acquisition_rate;
+        options.scanner_timing = vm.count("scanner-timing") > 0;
+        options.time_stamp_resolution_ms = time_stamp_resolution_ms;
+        options.compression_precision = compression_precision;
+        options.compression_tolerance = compression_tolerance;
+        options.noise_stats = noise_stats; // Taken from the input file, and applied to all datasets
+
+        ismrmrd_dataset.reset();
+
+        info << "Replaying " << options.datasets.size() << " dataset(s) on " << load_streams << " stream(s), " << loops << " time(s) each" << std::endl;
+        nlohmann::json report = run_load_test(options);
+
+        if (vm.count("report")) {
+            std::ofstream out(report_file);
+            out << report.dump(4) << std::endl;
+        } else {
+            std::cout << report.dump(4) << std::endl;
+        }
+
+        return report["failed_replays"].get<size_t>() ? -1 : 0;
+    }
+
     GadgetronClientConnector con;
     con.set_timeout(timeout_ms);
 
@@ -0,0 +1,61 @@
+#include "Admission.h"
+
+#include "log.h"
+
+using boost::asio::ip::tcp;
+
+namespace Gadgetron::Server {
+
+    Admission::Admission(
+            boost::asio::io_context &executor,
+            size_t max_connections,
+            std::chrono::seconds queue_timeout,
+            Handler handler
+    ) : executor(executor), max_connections(max_connections), queue_timeout(queue_timeout),
+        handler(std::move(handler)), timer(executor) {}
+
+    void Admission::submit(std::unique_ptr<tcp::socket> socket) {
+        if (!max_connections || active < max_connections) return start(std::move(socket));
+
+        GINFO_STREAM("Maximum number of connections (" << max_connections << ") reached; queueing connection. " <<
+                     "Queued connections: " << queue.size() + 1);
+        queue.push_back(Pending{std::move(socket), std::chrono::steady_clock::now() + queue_timeout});
+        schedule_expiry();
+    }
+
+    void Admission::start(std::unique_ptr<tcp::socket> socket) {
+        handler(std::move(socket), [this]() { boost::asio::post(executor, [this]() { finished(); }); });
+        active++;
+    }
+
+    void Admission::finished() {
+        active--;
+        expire();
+        if (!queue.empty()) {
+            auto socket = std::move(queue.front().socket);
+            queue.pop_front();
+            start(std::move(socket));
+        }
+    }
+
+    void Admission::expire() {
+        auto now = std::chrono::steady_clock::now();
+        while (!queue.empty() && queue.front().deadline <= now) {
+            boost::system::error_code ec;
+            GWARN_STREAM("Connection from " << queue.front().socket->remote_endpoint(ec).address() <<
+                         " was not admitted within " << queue_timeout.count() << " seconds; closing it.");
+            queue.front().socket->close(ec);
+            queue.pop_front();
+        }
+    }
+
+    void Admission::schedule_expiry() {
+        if (queue.empty()) return;
+        timer.expires_at(queue.front().deadline);
+        timer.async_wait([this](const boost::system::error_code &ec) {
+            if (ec) return;
+            expire();
+            schedule_expiry();
+        });
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace Gadgetron::Server {
+
+    /**
+     * Admission control for incoming connections. At most 'max_connections' connections are handled at once (0 means
+     * no limit); further connections are queued, and closed if they are not admitted within 'queue_timeout'.
+     *
+     * All state is owned by the io_context thread; connections report back that they are done by calling the
+     * callback they are handed, which posts to the io_context.
+     */
+    class Admission {
+    public:
+        using Handler = std::function<void(std::unique_ptr<boost::asio::ip::tcp::socket>, std::function<void()>)>;
+
+        Admission(
+                boost::asio::io_context &executor,
+                size_t max_connections,
+                std::chrono::seconds queue_timeout,
+                Handler handler
+        );
+
+        void submit(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
+
+    private:
+        struct Pending {
+            std::unique_ptr<boost::asio::ip::tcp::socket> socket;
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+        void start(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
+        void finished();
+        void expire();
+        void schedule_expiry();
+
+        boost::asio::io_context &executor;
+        const size_t max_connections;
+        const std::chrono::seconds queue_timeout;
+        const Handler handler;
+
+        size_t active = 0;
+        std::deque<Pending> queue;
+        boost::asio::steady_timer timer;
+    };
+}
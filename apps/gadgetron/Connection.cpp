@@ -5,6 +5,7 @@
 #include "Context.h"
 
 #include "connection/Core.h"
+#include "connection/core/ThreadCache.h"
 #if !(_WIN32)
 #include <cstdlib>
 #include <unistd.h>
@@ -21,9 +22,15 @@ namespace Gadgetron::Server::Connection {
             const Gadgetron::Core::StreamContext::Paths& paths,
             const Gadgetron::Core::StreamContext::Args& args,
             const std::string& storage_address,
-            std::unique_ptr<std::iostream> stream
+            std::unique_ptr<std::iostream> stream,
+            std::function<void()> on_close
     ) {
-        auto thread = std::thread(handle_connection, std::move(stream), paths, args, storage_address);
+        auto thread = ThreadCache::instance().run(
+                [=, stream = std::move(stream)]() mutable {
+                    struct Closer { std::function<void()> &on_close; ~Closer() { on_close(); } } closer{on_close};
+                    handle_connection(std::move(stream), paths, args, storage_address);
+                }
+        );
         thread.detach();
     }
 
@@ -33,15 +40,18 @@ namespace Gadgetron::Server::Connection {
             const Gadgetron::Core::StreamContext::Paths& paths,
             const Gadgetron::Core::StreamContext::Args& args,
             const Gadgetron::Core::StreamContext::StorageAddress& storage_address,
-            std::unique_ptr<std::iostream> stream
+            std::unique_ptr<std::iostream> stream,
+            std::function<void()> on_close
     ) {
         auto pid = fork();
         if (pid == 0) {
             handle_connection(std::move(stream), paths, args, storage_address);
             std::quick_exit(0);
         }
-        auto listen_for_close = [](auto pid) {int status; waitpid(pid,&status,0);};
-        std::thread t(listen_for_close,pid);
+        if (pid < 0) throw std::runtime_error("Failed to fork connection process.");
+
+        auto listen_for_close = [](auto pid, auto on_close) {int status; waitpid(pid,&status,0); on_close();};
+        std::thread t(listen_for_close,pid,std::move(on_close));
         t.detach();
     }
 
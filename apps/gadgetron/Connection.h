@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <iostream>
 
@@ -10,6 +11,7 @@ namespace Gadgetron::Server::Connection {
             const Gadgetron::Core::StreamContext::Paths &paths,
             const Gadgetron::Core::StreamContext::Args &args,
             const std::string& storage,
-            std::unique_ptr<std::iostream> stream
+            std::unique_ptr<std::iostream> stream,
+            std::function<void()> on_close = []() {}
     );
 }
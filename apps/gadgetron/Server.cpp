@@ -3,16 +3,59 @@
 
 #include <Context.h>
 
+#include <chrono>
+#include <functional>
+
 #include "log.h"
 
 #include "Server.h"
+#include "Admission.h"
 #include "Connection.h"
+#include "connection/ConfigConnection.h"
+#include "connection/PipelineCache.h"
 #include "connection/SocketStreamBuf.h"
 #include "system_info.h"
 
 using namespace boost::filesystem;
 using namespace Gadgetron::Server;
 
+namespace {
+
+    using boost::asio::ip::tcp;
+
+    void accept(tcp::acceptor &acceptor, Admission &admission) {
+        acceptor.async_accept([&](const boost::system::error_code &ec, tcp::socket socket) {
+            if (ec) {
+                GERROR_STREAM("Failed to accept connection: " << ec.message());
+            } else {
+                boost::system::error_code endpoint_ec;
+                GINFO_STREAM("Accepted connection from: " << socket.remote_endpoint(endpoint_ec).address());
+                try {
+                    admission.submit(std::make_unique<tcp::socket>(std::move(socket)));
+                }
+                catch (const std::exception &e) {
+                    GERROR_STREAM("Failed to start handling connection: " << e.what());
+                }
+            }
+            accept(acceptor, admission);
+        });
+    }
+
+    void preload_configs(const boost::program_options::variables_map &args, const Gadgetron::Core::Context::Paths &paths) {
+        if (!args.count("preload_config")) return;
+
+        for (auto &name : args["preload_config"].as<std::vector<std::string>>()) {
+            auto filename = Gadgetron::Server::Connection::ConfigConnection::config_path(paths, name);
+            try {
+                Gadgetron::Server::Connection::PipelineCache::instance().preload(filename);
+                GINFO_STREAM("Preloaded config: " << filename);
+            }
+            catch (const std::exception &e) {
+                GERROR_STREAM("Failed to preload config " << filename << ": " << e.what());
+            }
+        }
+    }
+}
 
 Server::Server(
         const boost::program_options::variables_map &args,
@@ -25,18 +68,33 @@ Server::Server(
     GINFO_STREAM("Gadgetron home directory: " << paths.gadgetron_home);
     GINFO_STREAM("Gadgetron working directory: " << paths.working_folder);
 
+    preload_configs(args, paths);
+
     boost::asio::io_context executor;
     boost::asio::ip::tcp::endpoint local(Info::tcp_protocol(), args["port"].as<unsigned short>());
     boost::asio::ip::tcp::acceptor acceptor(executor, local);
 
     acceptor.set_option(boost::asio::socket_base::reuse_address(true));
 
-    while(true) {
-        auto socket = std::make_unique<boost::asio::ip::tcp::socket>(executor);
-        acceptor.accept(*socket);
+    auto socket_buffer_size = args["socket_buffer_size"].as<size_t>();
 
-        GINFO_STREAM("Accepted connection from: " << socket->remote_endpoint().address());
+    Admission admission(
+            executor,
+            args["max_connections"].as<unsigned int>(),
+            std::chrono::seconds(args["connection_queue_timeout"].as<unsigned int>()),
+            [&](std::unique_ptr<tcp::socket> socket, std::function<void()> on_close) {
+                Connection::handle(
+                        paths,
+                        args,
+                        storage_address,
+                        Gadgetron::Connection::stream_from_socket(std::move(socket), socket_buffer_size),
+                        std::move(on_close)
+                );
+            }
+    );
 
-        Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(std::move(socket)));
-    }
+    accept(acceptor, admission);
+    executor.run();
+
+    throw std::runtime_error("Server stopped accepting connections.");
 }
@@ -10,6 +10,11 @@ namespace Gadgetron::Server {
     public:
         Server(const boost::program_options::variables_map &args, std::string storage_address);
 
+        /**
+         * Accepts connections asynchronously. At most 'max_connections' connections are handled at once (0 means no
+         * limit); further connections are queued, and closed if they are not admitted within
+         * 'connection_queue_timeout' seconds.
+         */
         [[noreturn]] void serve();
 
     private:
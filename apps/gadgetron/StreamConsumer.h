@@ -68,7 +68,7 @@ public:
             args_["dir"].as<boost::filesystem::path>().string()};
 
         ISMRMRD::IsmrmrdHeader hdr = consume_ismrmrd_header(input_stream, output_stream);
-        auto storage_spaces = setup_storage_spaces(storage_address_, hdr);
+        auto storage_spaces = setup_storage_spaces(storage_address_, hdr, args_);
 
         auto context = StreamContext(hdr, paths, args_, storage_address_, storage_spaces);
         auto loader = Connection::Loader(context);
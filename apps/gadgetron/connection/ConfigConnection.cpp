@@ -8,6 +8,7 @@
 
 #include "Handlers.h"
 #include "HeaderConnection.h"
+#include "PipelineCache.h"
 #include "config/Config.h"
 
 #include "io/primitives.h"
@@ -20,23 +21,6 @@ using namespace Gadgetron::Core::IO;
 using namespace Gadgetron::Server::Connection;
 using namespace Gadgetron::Server::Connection::Handlers;
 
-#ifdef USE_GTBABYLON
-#include <GTBabylon.h>
-
-    static std::unique_ptr<std::istream> open_and_verify_config(const std::string& filename)
-    {
-        auto filestream = std::ifstream(filename);
-        auto config_string = std::string(std::istreambuf_iterator<char>(filestream),{});
-        auto decoded =  GTBabylon::decode_message(config_string);
-        return std::make_unique<std::stringstream>(decoded);
-    }
-#else
-    static std::unique_ptr<std::istream> open_and_verify_config(const std::string& filename)
-    {
-        return std::make_unique<std::ifstream>(filename);
-    }
-#endif
-
 namespace {
 
     using Header = Gadgetron::Core::StreamContext::Header;
@@ -56,7 +40,7 @@ namespace {
             callback(parse_config(config_stream));
         }
 
-    private:
+    protected:
         std::function<void(Config)> callback;
     };
 
@@ -68,19 +52,11 @@ namespace {
         ) : ConfigHandler(callback), paths(paths) {}
 
         void handle(std::istream &stream, Gadgetron::Core::OutputChannel&) override {
-            auto recon_name = read_filename_from_stream(stream);
-
-            // Look up if there is an environment variable with that name
-            if (getenv(recon_name.c_str())) {
-                recon_name = std::string(getenv(recon_name.c_str()));
-            }
-
-            boost::filesystem::path filename = paths.gadgetron_home / GADGETRON_CONFIG_PATH / recon_name;
+            auto filename = ConfigConnection::config_path(paths, read_filename_from_stream(stream));
 
             GDEBUG_STREAM("Reading config file: " << filename);
 
-            auto config_stream = open_and_verify_config(filename.string());
-            handle_callback(*config_stream);
+            callback(PipelineCache::instance().config(filename));
         }
 
     private:
@@ -119,6 +95,7 @@ namespace {
         handlers[CONFIG]   = std::make_unique<ConfigStringHandler>(config_callback);
         handlers[HEADER]   = std::make_unique<ErrorProducingHandler>("Received ISMRMRD header before config file.");
         handlers[QUERY]    = std::make_unique<QueryHandler>();
+        handlers[COMPRESSION] = std::make_unique<CompressionHandler>();
         handlers[CLOSE]    = std::make_unique<CloseHandler>(close);
 
         return handlers;
@@ -128,6 +105,16 @@ namespace {
 
 namespace Gadgetron::Server::Connection::ConfigConnection {
 
+    boost::filesystem::path config_path(const Core::StreamContext::Paths &paths, std::string name) {
+
+        // Look up if there is an environment variable with that name
+        if (getenv(name.c_str())) {
+            name = std::string(getenv(name.c_str()));
+        }
+
+        return paths.gadgetron_home / GADGETRON_CONFIG_PATH / name;
+    }
+
     void process(
             std::iostream &stream,
             const Core::StreamContext::Paths &paths,
@@ -144,14 +131,14 @@ namespace Gadgetron::Server::Connection::ConfigConnection {
 
         auto channel = make_channel<MessageChannel>();
 
-        std::thread input_thread = start_input_thread(
+        auto input_thread = start_input_thread(
                 stream,
                 std::move(channel.output),
                 [&](auto close) { return prepare_handlers(close, context); },
                 error_handler
         );
 
-        std::thread output_thread = start_output_thread(
+        auto output_thread = start_output_thread(
                 stream,
                 std::move(channel.input),
                 default_writers,
@@ -4,6 +4,10 @@
 #include "Context.h"
 
 namespace Gadgetron::Server::Connection::ConfigConnection {
+
+    /// The file a config name refers to; an environment variable by that name overrides it.
+    boost::filesystem::path config_path(const Core::StreamContext::Paths &paths, std::string name);
+
     void process(
         std::iostream &stream,
         const Core::StreamContext::Paths &paths,
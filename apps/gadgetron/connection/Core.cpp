@@ -2,7 +2,11 @@
 #include "Core.h"
 
 #include "ConfigConnection.h"
+#include "SocketStreamBuf.h"
 #include "Writers.h"
+#include "initialization.h"
+
+#include "io/compressed_stream.h"
 
 namespace {
 
@@ -57,23 +61,46 @@ namespace Gadgetron::Server::Connection {
     ) {
 
         stream->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+
+        // Traffic passes through uncompressed, unless the peer asks for compression when it connects.
+        Gadgetron::Core::IO::CompressibleStream connection(*stream);
+        connection.exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+
         ErrorSender sender;
 
         ErrorHandler error_handler(sender, "Connection Main Thread");
 
         error_handler.handle([&]() {
-            ConfigConnection::process(*stream, paths, args, storage_address, error_handler);
+            ConfigConnection::process(connection, paths, args, storage_address, error_handler);
         });
 
         try {
-            sender.send_error_to_client(*stream);
-            send_close(*stream);
+            sender.send_error_to_client(connection);
+            send_close(connection);
+            connection.flush();
         }
         catch (std::runtime_error &e) {
             GERROR_STREAM("Finalizing connection to client failed with the following error: " << e.what());
         }
         catch (...) {}
 
+        auto compression = connection.buffer().statistics();
+        if (compression.bytes_compressed || compression.bytes_decompressed) {
+            GINFO_STREAM("Connection compression: received " << compression.bytes_received << " bytes for "
+                         << compression.bytes_decompressed << " (ratio " << compression.decompression_ratio()
+                         << ", decompressed at " << compression.decompression_rate() / (1024 * 1024)
+                         << " MiB/s), sent " << compression.bytes_sent << " bytes for "
+                         << compression.bytes_compressed << " (ratio " << compression.compression_ratio()
+                         << ", compressed at " << compression.compression_rate() / (1024 * 1024) << " MiB/s)");
+        }
+
+        if (auto statistics = Gadgetron::Connection::socket_statistics(*stream)) {
+            GINFO_STREAM("Connection throughput: received " << statistics->bytes_read << " bytes ("
+                         << statistics->read_rate() / (1024 * 1024) << " MiB/s), sent " << statistics->bytes_written
+                         << " bytes (" << statistics->write_rate() / (1024 * 1024) << " MiB/s) in "
+                         << statistics->elapsed.count() << " s");
+        }
+
         GINFO_STREAM("Connection state: [FINISHED]");
     }
 
@@ -82,6 +109,7 @@ namespace Gadgetron::Server::Connection {
 
         writers.emplace_back(std::make_unique<Writers::TextWriter>());
         writers.emplace_back(std::make_unique<Writers::ResponseWriter>());
+        writers.emplace_back(std::make_unique<Writers::CompressionWriter>());
         // TODO: writers.emplace_back(std::make_unique<Writers::ErrorWriter>());
 
         return std::move(writers);
@@ -3,6 +3,7 @@
 #include <thread>
 #include <memory>
 #include <functional>
+#include <tuple>
 
 
 #include "io/primitives.h"
@@ -10,6 +11,8 @@
 #include "Channel.h"
 #include "Context.h"
 
+#include "connection/core/ThreadCache.h"
+
 namespace Gadgetron::Server::Connection {
 
     class ErrorReporter {
@@ -67,14 +70,11 @@ namespace Gadgetron::Server::Connection {
 #endif
 
         template<class F, class... ARGS>
-        std::thread run(F fn, ARGS &&... args) {
-            return std::thread(
-                    []( auto handler, auto fn, auto &&... iargs) {
-                        handler.handle(fn, std::forward<ARGS>(iargs)...);
-                    },
-                    *this,
-                    std::forward<F>(fn),
-                    std::forward<ARGS>(args)...
+        CachedThread run(F fn, ARGS &&... args) {
+            return ThreadCache::instance().run(
+                    [handler = *this, fn = std::move(fn), iargs = std::make_tuple(std::forward<ARGS>(args)...)]() mutable {
+                        std::apply([&](auto &... a) { handler.handle(fn, std::move(a)...); }, iargs);
+                    }
             );
         }
 
@@ -113,6 +113,7 @@ namespace Gadgetron::Server::Connection {
 
             if (writer != writers.end()) {
                 (*writer)->write(stream, std::move(message));
+                stream.flush();
             }
         }
     }
@@ -120,7 +121,7 @@ namespace Gadgetron::Server::Connection {
     std::vector<std::unique_ptr<Core::Writer>> default_writers();
 
     template<class F>
-    std::thread start_input_thread(
+    CachedThread start_input_thread(
             std::iostream &stream,
             Core::OutputChannel channel,
             F handler_factory,
@@ -133,7 +134,7 @@ namespace Gadgetron::Server::Connection {
     }
 
     template<class F>
-    std::thread start_output_thread(
+    CachedThread start_output_thread(
             std::iostream &stream,
             Core::GenericInputChannel channel,
             F writer_factory,
@@ -4,8 +4,10 @@
 
 #include "system_info.h"
 
+#include "io/compressed_stream.h"
 #include "io/primitives.h"
 #include "Response.h"
+#include "Writers.h"
 
 namespace {
 
@@ -54,6 +56,9 @@ namespace {
         answers["gadgetron::cuda::runtime"]      = Info::CUDA::cuda_runtime_version;
         answers["gadgetron::cuda::memory"]       = cuda_memory;
         answers["gadgetron::cuda::capabilities"] = cuda_capabilities;
+        answers["gadgetron::compression"]        = []() {
+            return boost::algorithm::join(Gadgetron::Core::IO::supported_codecs(), ",");
+        };
     }
 }
 
@@ -83,6 +88,20 @@ namespace Gadgetron::Server::Connection::Handlers {
     }
 
 
+    void CompressionHandler::handle(std::istream &stream, Gadgetron::Core::OutputChannel &channel) {
+        auto codec = read_string_from_stream<uint32_t>(stream);
+        auto level = read<int32_t>(stream);
+
+        auto buffer = dynamic_cast<CompressedStreamBuf *>(stream.rdbuf());
+        if (!buffer) throw std::runtime_error("Compression is not available on this connection.");
+
+        GINFO_STREAM("Compressing connection traffic with " << codec << " at level " << level);
+        buffer->decompress_input(codec);
+
+        // The output side belongs to the output thread; it switches once it has written what was queued before.
+        channel.push(Writers::CompressOutput{codec, level});
+    }
+
     ErrorProducingHandler::ErrorProducingHandler(std::string message)
     : message(std::move(message)) {}
 
@@ -25,6 +25,18 @@ namespace Gadgetron::Server::Connection::Handlers {
         std::map<std::string, std::function<std::string()>> answers;
     };
 
+    /**
+     * Switches the connection to compressed traffic in both directions, with the codec the peer asked for.
+     *
+     * Peers look up the codecs available with the 'gadgetron::compression' query first, and send nothing more until
+     * they have sent this message; everything after it is compressed. Output already queued when the message arrives
+     * is sent uncompressed, as the output thread only switches once it reaches the message.
+     */
+    class CompressionHandler : public Handler {
+    public:
+        void handle(std::istream &stream, Gadgetron::Core::OutputChannel &channel) override;
+    };
+
     class ErrorProducingHandler : public Handler {
     public:
         explicit ErrorProducingHandler(std::string message);
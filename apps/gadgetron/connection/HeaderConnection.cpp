@@ -91,14 +91,14 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
 
         auto channel = make_channel<MessageChannel>();
 
-        std::thread input_thread = start_input_thread(
+        auto input_thread = start_input_thread(
                 stream,
                 std::move(channel.output),
                 [&](auto close) { return prepare_handlers(close, context); },
                 error_handler
         );
 
-        std::thread output_thread = start_output_thread(
+        auto output_thread = start_output_thread(
                 stream,
                 std::move(channel.input),
                 default_writers,
@@ -114,7 +114,7 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
             paths,
             args,
             storage_address,
-            setup_storage_spaces(storage_address, header)
+            setup_storage_spaces(storage_address, header, args)
         };
 
         auto process = context.header ? StreamConnection::process : VoidConnection::process;
@@ -6,32 +6,14 @@
 
 namespace {
     using namespace Gadgetron::Core;
-
-    using reader_factory = std::unique_ptr<Reader>();
-    using writer_factory = std::unique_ptr<Writer>();
 }
 
 namespace Gadgetron::Server::Connection {
 
-    Loader::Loader(const StreamContext &context) : context(context) {}
-
-    boost::dll::shared_library Loader::load_library(const std::string &shared_library_name) {
-        try
-        {
-            auto lib = boost::dll::shared_library(
-                    shared_library_name,
-                    boost::dll::load_mode::append_decorations |
-                    boost::dll::load_mode::rtld_global |
-                    boost::dll::load_mode::search_system_folders
-            );
-            libraries.push_back(lib);
-            return lib;
-        }
-        catch( const std::exception & ex )
-        {
-            std::cerr << ex.what() << std::endl;
-            throw;
-        }
+    Loader::Loader(const StreamContext &context) : context(context), connection_tracer(Tracer::create(context)) {}
+
+    std::shared_ptr<Tracer> Loader::tracer() const {
+        return connection_tracer;
     }
 
     std::unique_ptr<Reader> Loader::load(const Config::Reader &conf) {
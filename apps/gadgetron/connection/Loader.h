@@ -3,7 +3,9 @@
 #include <map>
 #include <memory>
 
+#include "PipelineCache.h"
 #include "config/Config.h"
+#include "core/Tracing.h"
 #include "nodes/Stream.h"
 
 #include "Context.h"
@@ -36,13 +38,19 @@ namespace Gadgetron::Server::Connection {
                 const GadgetProperties &
         );
 
+        using reader_factory = std::unique_ptr<Reader>();
+        using writer_factory = std::unique_ptr<Writer>();
+
+        /// Libraries are loaded, and factories looked up, once per server process; see PipelineCache.
         template<class FACTORY>
         FACTORY& load_factory(const std::string &prefix, const std::string &classname, const std::string &dll) {
             GINFO_STREAM("loading " << prefix << " - " << classname << " from the dll " << dll);
-            auto library = load_library(dll);
-            return library.get_alias<FACTORY>(prefix + classname);
+            return PipelineCache::instance().factory<FACTORY>(prefix, classname, dll);
         }
 
+        /// The tracer of the connection, or nullptr if tracing is disabled.
+        std::shared_ptr<Tracer> tracer() const;
+
         std::map<uint16_t, std::unique_ptr<Reader>> load_readers(const std::vector<Config::Reader> &);
         std::vector<std::unique_ptr<Writer>> load_writers(const std::vector<Config::Writer> &);
 
@@ -92,11 +100,8 @@ namespace Gadgetron::Server::Connection {
         }
 
     private:
-        boost::dll::shared_library load_library(const std::string &shared_library_name);
-
         const Core::StreamContext context;
-
-        std::vector<boost::dll::shared_library> libraries = std::vector<boost::dll::shared_library>();
+        const std::shared_ptr<Tracer> connection_tracer;
     };
 }
 
@@ -0,0 +1,173 @@
+#include "PipelineCache.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "Loader.h"
+
+#include "Node.h"
+#include "distributed/Distributor.h"
+#include "parallel/Branch.h"
+#include "parallel/Merge.h"
+#include "log.h"
+
+#ifdef USE_GTBABYLON
+#include <GTBabylon.h>
+
+    static std::unique_ptr<std::istream> open_and_verify_config(const std::string& filename)
+    {
+        auto filestream = std::ifstream(filename);
+        auto config_string = std::string(std::istreambuf_iterator<char>(filestream),{});
+        auto decoded =  GTBabylon::decode_message(config_string);
+        return std::make_unique<std::stringstream>(decoded);
+    }
+#else
+    static std::unique_ptr<std::istream> open_and_verify_config(const std::string& filename)
+    {
+        return std::make_unique<std::ifstream>(filename);
+    }
+#endif
+
+namespace {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Server::Connection;
+
+    void resolve(PipelineCache &cache, const Config::Stream &conf);
+    void resolve(PipelineCache &cache, const Config::PureStream &conf);
+
+    void resolve(PipelineCache &cache, const Config::Reader &conf) {
+        cache.factory<Loader::reader_factory>("reader_factory_export_", conf.classname, conf.dll);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Writer &conf) {
+        cache.factory<Loader::writer_factory>("writer_factory_export_", conf.classname, conf.dll);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Gadget &conf) {
+        cache.factory<Loader::generic_factory<Node>>("gadget_factory_export_", conf.classname, conf.dll);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Branch &conf) {
+        cache.factory<Loader::generic_factory<Core::Parallel::Branch>>("branch_factory_export_", conf.classname, conf.dll);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Merge &conf) {
+        cache.factory<Loader::generic_factory<Core::Parallel::Merge>>("merge_factory_export_", conf.classname, conf.dll);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Distributor &conf) {
+        cache.factory<Loader::generic_factory<Core::Distributed::Distributor>>(
+                "distributor_factory_export_", conf.classname, conf.dll);
+    }
+
+    template<class CONFIG>
+    void resolve(PipelineCache &cache, const std::vector<CONFIG> &confs) {
+        for (auto &conf : confs) resolve(cache, conf);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Parallel &conf) {
+        resolve(cache, conf.branch);
+        resolve(cache, conf.merge);
+        resolve(cache, conf.streams);
+    }
+
+    // The module behind an external node is started for each connection; only its readers and writers are loaded.
+    void resolve(PipelineCache &cache, const Config::External &conf) {
+        resolve(cache, conf.readers);
+        resolve(cache, conf.writers);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Distributed &conf) {
+        resolve(cache, conf.readers);
+        resolve(cache, conf.writers);
+        resolve(cache, conf.distributor);
+        resolve(cache, conf.stream);
+    }
+
+    void resolve(PipelineCache &cache, const Config::ParallelProcess &conf) {
+        resolve(cache, conf.stream);
+    }
+
+    void resolve(PipelineCache &cache, const Config::PureDistributed &conf) {
+        resolve(cache, conf.readers);
+        resolve(cache, conf.writers);
+        resolve(cache, conf.stream);
+    }
+
+    void resolve(PipelineCache &cache, const Config::PureStream &conf) {
+        resolve(cache, conf.gadgets);
+    }
+
+    void resolve(PipelineCache &cache, const Config::Stream &conf) {
+        for (auto &node : conf.nodes) {
+            Core::visit([&](auto &n) { resolve(cache, n); }, node);
+        }
+    }
+}
+
+namespace Gadgetron::Server::Connection {
+
+    Config PipelineCache::config(const boost::filesystem::path &filename) {
+        boost::system::error_code modified_ec, size_ec;
+        auto modified = boost::filesystem::last_write_time(filename, modified_ec);
+        auto size = boost::filesystem::file_size(filename, size_ec);
+        auto cacheable = !modified_ec && !size_ec;
+
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto cached = configs.find(filename.string());
+        if (cacheable && cached != configs.end() && cached->second.modified == modified && cached->second.size == size) {
+            GDEBUG_STREAM("Using cached config: " << filename);
+            return cached->second.config;
+        }
+
+        auto config_stream = open_and_verify_config(filename.string());
+        auto config = parse_config(*config_stream);
+
+        if (cacheable) configs.insert_or_assign(filename.string(), CachedConfig{modified, size, config});
+        return config;
+    }
+
+    void PipelineCache::preload(const boost::filesystem::path &filename) {
+        auto conf = config(filename);
+
+        resolve(*this, conf.readers);
+        resolve(*this, conf.writers);
+        resolve(*this, conf.stream);
+    }
+
+    size_t PipelineCache::cached_configs() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return configs.size();
+    }
+
+    size_t PipelineCache::loaded_libraries() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return libraries.size();
+    }
+
+    boost::dll::shared_library &PipelineCache::library(const std::string &dll) {
+        auto loaded = libraries.find(dll);
+        if (loaded != libraries.end()) return loaded->second;
+
+        try {
+            auto library = boost::dll::shared_library(
+                    dll,
+                    boost::dll::load_mode::append_decorations |
+                    boost::dll::load_mode::rtld_global |
+                    boost::dll::load_mode::search_system_folders
+            );
+            return libraries.emplace(dll, std::move(library)).first->second;
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            throw;
+        }
+    }
+
+    PipelineCache &PipelineCache::instance() {
+        static PipelineCache cache;
+        return cache;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <any>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <boost/dll.hpp>
+#include <boost/filesystem.hpp>
+
+#include "config/Config.h"
+
+namespace Gadgetron::Server::Connection {
+
+    /**
+     * Keeps what connections with the same configuration have in common, so it is not redone for every scan: the
+     * parsed configuration, keyed by the file it was read from, and the libraries the readers, writers and gadgets
+     * come from, with their factories already looked up. Libraries stay loaded for the lifetime of the server.
+     *
+     * The gadgets themselves are built from the ISMRMRD header of each scan, so they cannot be built ahead of time.
+     *
+     * Connections are handled in processes forked from the server, which start out with the cache as it was when they
+     * were forked. Configurations named by the preload_config argument are loaded into the cache when the server
+     * starts, so every connection using them finds them there.
+     */
+    class PipelineCache {
+    public:
+        PipelineCache() = default;
+        PipelineCache(const PipelineCache &) = delete;
+        PipelineCache &operator=(const PipelineCache &) = delete;
+
+        /// The configuration in the file. The file is parsed again if it has changed since it was last read.
+        Config config(const boost::filesystem::path &filename);
+
+        /// Looks up a factory exported by a library, loading the library the first time it is used.
+        template<class FACTORY>
+        FACTORY &factory(const std::string &prefix, const std::string &classname, const std::string &dll) {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto &symbol = factories[dll + ":" + prefix + classname];
+            if (!symbol.has_value()) symbol = &library(dll).get_alias<FACTORY>(prefix + classname);
+            return *std::any_cast<FACTORY *>(symbol);
+        }
+
+        /// Reads the configuration, and loads every library and factory it uses.
+        void preload(const boost::filesystem::path &filename);
+
+        size_t cached_configs();
+        size_t loaded_libraries();
+
+        static PipelineCache &instance();
+
+    private:
+        boost::dll::shared_library &library(const std::string &dll);
+
+        struct CachedConfig {
+            std::time_t modified;
+            std::uintmax_t size;
+            Config config;
+        };
+
+        std::mutex mutex;
+        std::map<std::string, CachedConfig> configs;
+        std::map<std::string, boost::dll::shared_library> libraries;
+        std::map<std::string, std::any> factories;
+    };
+}
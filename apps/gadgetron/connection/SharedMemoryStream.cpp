@@ -0,0 +1,405 @@
+#include "SharedMemoryStream.h"
+
+#if _WIN32
+
+#include <stdexcept>
+
+// POSIX shared memory and futexes are not available; external modules keep using TCP.
+namespace Gadgetron::Connection {
+
+    std::shared_ptr<SharedMemorySegment> SharedMemorySegment::create(size_t) {
+        throw std::runtime_error("Shared memory transport is not supported on this platform");
+    }
+
+    std::shared_ptr<SharedMemorySegment> SharedMemorySegment::attach(const std::string &) {
+        throw std::runtime_error("Shared memory transport is not supported on this platform");
+    }
+
+    SharedMemorySegment::~SharedMemorySegment() = default;
+
+    size_t SharedMemorySegment::ring_size() const { return 0; }
+
+    bool SharedMemorySegment::peer_attached() const { return false; }
+
+    void SharedMemorySegment::unlink() {}
+
+    std::unique_ptr<std::iostream> stream_from_shared_memory(
+        std::shared_ptr<SharedMemorySegment>,
+        std::unique_ptr<boost::asio::ip::tcp::socket>) {
+        throw std::runtime_error("Shared memory transport is not supported on this platform");
+    }
+}
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <boost/asio.hpp>
+
+namespace Gadgetron::Connection {
+
+    namespace {
+        constexpr uint64_t segment_magic = 0x314d454d48535447ULL; // "GTSHMEM1"
+        constexpr uint32_t segment_version = 1;
+        constexpr size_t ring_data_offset = 4096;
+
+        // Spins before sleeping on the futex, and how long to sleep before checking that the peer is still there.
+        constexpr int spin_count = 64;
+        constexpr auto wait_timeout = std::chrono::milliseconds(50);
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                      "Shared memory rings need lock free atomics");
+
+        struct alignas(64) RingControl {
+            alignas(64) std::atomic<uint64_t> written;
+            alignas(64) std::atomic<uint64_t> read;
+            alignas(64) std::atomic<uint32_t> data_signal;
+            std::atomic<uint32_t> reader_waiting;
+            alignas(64) std::atomic<uint32_t> space_signal;
+            std::atomic<uint32_t> writer_waiting;
+            alignas(64) std::atomic<uint32_t> closed;
+        };
+
+        void wait_for_signal(std::atomic<uint32_t> &signal, uint32_t seen) {
+#ifdef __linux__
+            timespec timeout{0, std::chrono::duration_cast<std::chrono::nanoseconds>(wait_timeout).count()};
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&signal), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+            if (signal.load() == seen) std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+        }
+
+        void signal(std::atomic<uint32_t> &signal, std::atomic<uint32_t> &waiting) {
+            signal.fetch_add(1);
+#ifdef __linux__
+            if (waiting.load()) syscall(SYS_futex, reinterpret_cast<uint32_t *>(&signal), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+        }
+
+        std::string unique_segment_name() {
+            static std::atomic<uint64_t> counter{0};
+            std::random_device random;
+            return "/gadgetron-" + std::to_string(::getpid()) + "-" + std::to_string(counter++) + "-" +
+                   std::to_string(random());
+        }
+
+        std::system_error system_error(const std::string &what) {
+            return std::system_error(errno, std::generic_category(), what);
+        }
+    }
+
+    struct SharedMemorySegment::Header {
+        uint64_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> peer_attached;
+        uint64_t ring_size;
+        RingControl rings[2];
+    };
+
+    static_assert(offsetof(SharedMemorySegment::Header, rings) == 64, "Shared memory header layout changed");
+    static_assert(sizeof(RingControl) == 320, "Shared memory ring control layout changed");
+    static_assert(sizeof(SharedMemorySegment::Header) <= ring_data_offset, "Shared memory header too large");
+
+    std::shared_ptr<SharedMemorySegment> SharedMemorySegment::create(size_t ring_size) {
+        if (ring_size == 0 || ring_size > (size_t(1) << 30))
+            throw std::invalid_argument("Shared memory ring size must be between 1 byte and 1 GiB");
+
+        auto name = unique_segment_name();
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) throw system_error("Failed to create shared memory segment " + name);
+
+        size_t size = ring_data_offset + 2 * ring_size;
+        if (::ftruncate(fd, off_t(size)) != 0) {
+            auto error = system_error("Failed to size shared memory segment " + name);
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw error;
+        }
+
+        void *memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            auto error = system_error("Failed to map shared memory segment " + name);
+            ::shm_unlink(name.c_str());
+            throw error;
+        }
+
+        // The segment starts out zeroed, which is the initial state of the rings.
+        auto header = new (memory) Header{};
+        header->magic = segment_magic;
+        header->version = segment_version;
+        header->ring_size = ring_size;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        return std::shared_ptr<SharedMemorySegment>(new SharedMemorySegment(name, memory, size, true));
+    }
+
+    std::shared_ptr<SharedMemorySegment> SharedMemorySegment::attach(const std::string &name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) throw system_error("Failed to open shared memory segment " + name);
+
+        struct stat status{};
+        if (::fstat(fd, &status) != 0 || size_t(status.st_size) < ring_data_offset) {
+            ::close(fd);
+            throw std::runtime_error("Shared memory segment " + name + " is not a Gadgetron segment");
+        }
+
+        size_t size = status.st_size;
+        void *memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) throw system_error("Failed to map shared memory segment " + name);
+
+        auto segment = std::shared_ptr<SharedMemorySegment>(new SharedMemorySegment(name, memory, size, false));
+        auto &header = segment->header();
+        if (header.magic != segment_magic || header.version != segment_version ||
+            ring_data_offset + 2 * header.ring_size != size)
+            throw std::runtime_error("Shared memory segment " + name + " is not a Gadgetron segment of version " +
+                                     std::to_string(segment_version));
+
+        header.peer_attached.store(1);
+        return segment;
+    }
+
+    SharedMemorySegment::SharedMemorySegment(std::string name, void *memory, size_t size, bool owner)
+        : name_(std::move(name)), memory(memory), size(size), owner(owner), linked(owner) {}
+
+    SharedMemorySegment::~SharedMemorySegment() {
+        unlink();
+        ::munmap(memory, size);
+    }
+
+    size_t SharedMemorySegment::ring_size() const {
+        return header().ring_size;
+    }
+
+    bool SharedMemorySegment::peer_attached() const {
+        return header().peer_attached.load() != 0;
+    }
+
+    void SharedMemorySegment::unlink() {
+        if (!linked) return;
+        ::shm_unlink(name_.c_str());
+        linked = false;
+    }
+
+    SharedMemorySegment::Header &SharedMemorySegment::header() const {
+        return *static_cast<Header *>(memory);
+    }
+
+    char *SharedMemorySegment::ring_data(size_t ring) const {
+        return static_cast<char *>(memory) + ring_data_offset + ring * header().ring_size;
+    }
+
+    namespace {
+
+        /**
+         * Stream buffer on top of a pair of shared memory rings.
+         *
+         * Writes are copied straight into the outbound ring and published immediately, as callers do not flush the
+         * stream. The get area points into the inbound ring itself; consumed bytes are handed back to the writer
+         * whenever the get area is refilled.
+         */
+        class SharedMemoryStreamBuf : public std::streambuf {
+        public:
+            SharedMemoryStreamBuf(std::shared_ptr<SharedMemorySegment> segment,
+                                  std::unique_ptr<boost::asio::ip::tcp::socket> socket);
+            ~SharedMemoryStreamBuf() override;
+
+        protected:
+            std::streamsize xsputn(const char_type *data, std::streamsize length) override;
+            std::streamsize xsgetn(char_type *data, std::streamsize length) override;
+
+            int underflow() override;
+            int overflow(int ch = traits_type::eof()) override;
+
+        private:
+            std::shared_ptr<SharedMemorySegment> segment;
+            std::unique_ptr<boost::asio::ip::tcp::socket> socket;
+
+            const size_t ring_size;
+            RingControl &outbound;
+            RingControl &inbound;
+            char *const outbound_data;
+            char *const inbound_data;
+
+            void release_get_area();
+            size_t wait_for_data();
+            size_t wait_for_space();
+            bool peer_alive();
+        };
+
+        SharedMemoryStreamBuf::SharedMemoryStreamBuf(std::shared_ptr<SharedMemorySegment> segment,
+                                                     std::unique_ptr<boost::asio::ip::tcp::socket> socket)
+            : segment(segment), socket(std::move(socket)), ring_size(segment->ring_size()),
+              outbound(segment->header().rings[segment->is_owner() ? 0 : 1]),
+              inbound(segment->header().rings[segment->is_owner() ? 1 : 0]),
+              outbound_data(segment->ring_data(segment->is_owner() ? 0 : 1)),
+              inbound_data(segment->ring_data(segment->is_owner() ? 1 : 0)) {
+            if (this->socket) this->socket->non_blocking(true);
+            this->setg(nullptr, nullptr, nullptr);
+        }
+
+        SharedMemoryStreamBuf::~SharedMemoryStreamBuf() {
+            release_get_area();
+            for (auto ring : { &outbound, &inbound }) {
+                ring->closed.store(1);
+                signal(ring->data_signal, ring->reader_waiting);
+                signal(ring->space_signal, ring->writer_waiting);
+            }
+        }
+
+        bool SharedMemoryStreamBuf::peer_alive() {
+            if (!socket) return true;
+            char byte;
+            boost::system::error_code ec;
+            socket->receive(boost::asio::buffer(&byte, 1), boost::asio::socket_base::message_peek, ec);
+            return ec == boost::asio::error::would_block || ec == boost::asio::error::try_again || !ec;
+        }
+
+        void SharedMemoryStreamBuf::release_get_area() {
+            auto consumed = std::distance(this->eback(), this->gptr());
+            if (consumed > 0) {
+                inbound.read.store(inbound.read.load(std::memory_order_relaxed) + consumed);
+                signal(inbound.space_signal, inbound.writer_waiting);
+            }
+            this->setg(nullptr, nullptr, nullptr);
+        }
+
+        size_t SharedMemoryStreamBuf::wait_for_data() {
+            for (int spins = 0;; spins++) {
+                auto available = inbound.written.load() - inbound.read.load(std::memory_order_relaxed);
+                if (available > 0) return available;
+                if (inbound.closed.load()) return 0;
+
+                if (spins < spin_count) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                inbound.reader_waiting.store(1);
+                auto seen = inbound.data_signal.load();
+                if (inbound.written.load() == inbound.read.load(std::memory_order_relaxed) && !inbound.closed.load()) {
+                    wait_for_signal(inbound.data_signal, seen);
+                    if (inbound.data_signal.load() == seen && !peer_alive()) {
+                        inbound.reader_waiting.store(0);
+                        return inbound.written.load() - inbound.read.load(std::memory_order_relaxed);
+                    }
+                }
+                inbound.reader_waiting.store(0);
+            }
+        }
+
+        size_t SharedMemoryStreamBuf::wait_for_space() {
+            for (int spins = 0;; spins++) {
+                if (outbound.closed.load()) throw std::runtime_error("Shared memory stream closed by peer");
+
+                auto used = outbound.written.load(std::memory_order_relaxed) - outbound.read.load();
+                if (used < ring_size) return ring_size - used;
+
+                if (spins < spin_count) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                outbound.writer_waiting.store(1);
+                auto seen = outbound.space_signal.load();
+                if (outbound.written.load(std::memory_order_relaxed) - outbound.read.load() == ring_size) {
+                    wait_for_signal(outbound.space_signal, seen);
+                    if (outbound.space_signal.load() == seen && !peer_alive()) {
+                        outbound.writer_waiting.store(0);
+                        throw std::runtime_error("Shared memory peer went away");
+                    }
+                }
+                outbound.writer_waiting.store(0);
+            }
+        }
+
+        int SharedMemoryStreamBuf::underflow() {
+            release_get_area();
+
+            auto available = wait_for_data();
+            if (available == 0) return traits_type::eof();
+
+            auto offset = inbound.read.load(std::memory_order_relaxed) % ring_size;
+            auto chunk = std::min(available, ring_size - offset);
+            this->setg(inbound_data + offset, inbound_data + offset, inbound_data + offset + chunk);
+            return traits_type::to_int_type(*this->gptr());
+        }
+
+        int SharedMemoryStreamBuf::overflow(int ch) {
+            if (ch != traits_type::eof()) {
+                char c = traits_type::to_char_type(ch);
+                xsputn(&c, 1);
+            }
+            return 0;
+        }
+
+        std::streamsize SharedMemoryStreamBuf::xsputn(const char *data, std::streamsize length) {
+            std::streamsize sent = 0;
+            while (sent < length) {
+                auto space = wait_for_space();
+                auto written = outbound.written.load(std::memory_order_relaxed);
+                auto offset = written % ring_size;
+
+                auto chunk = std::min<size_t>({ space, size_t(length - sent), ring_size - offset });
+                std::memcpy(outbound_data + offset, data + sent, chunk);
+
+                outbound.written.store(written + chunk);
+                signal(outbound.data_signal, outbound.reader_waiting);
+                sent += chunk;
+            }
+            return length;
+        }
+
+        std::streamsize SharedMemoryStreamBuf::xsgetn(char *data, std::streamsize length) {
+            std::streamsize received = 0;
+            while (received < length) {
+                if (this->gptr() == this->egptr() && this->underflow() == traits_type::eof()) break;
+
+                auto chunk = std::min<std::streamsize>(length - received, std::distance(this->gptr(), this->egptr()));
+                std::memcpy(data + received, this->gptr(), chunk);
+                this->setg(this->eback(), this->gptr() + chunk, this->egptr());
+                received += chunk;
+            }
+            return received;
+        }
+
+        class SharedMemoryStream : public std::iostream {
+        public:
+            SharedMemoryStream(std::shared_ptr<SharedMemorySegment> segment,
+                               std::unique_ptr<boost::asio::ip::tcp::socket> socket)
+                : std::iostream(nullptr), buffer(std::move(segment), std::move(socket)) {
+                this->rdbuf(&buffer);
+            }
+
+        private:
+            SharedMemoryStreamBuf buffer;
+        };
+    }
+
+    std::unique_ptr<std::iostream> stream_from_shared_memory(
+        std::shared_ptr<SharedMemorySegment> segment,
+        std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
+        return std::make_unique<SharedMemoryStream>(std::move(segment), std::move(socket));
+    }
+}
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+#include <boost/asio/ip/tcp.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace Gadgetron::Connection {
+
+    /**
+     * Shared memory segment carrying a stream between two processes on the same host.
+     *
+     * The segment holds a header followed by two byte rings, one per direction. Each ring has a single writer and a
+     * single reader, which exchange monotonic byte counts through the header; data is copied straight from the
+     * writer's memory into the ring and from the ring into the reader's memory, without passing through the kernel.
+     *
+     * Only available on POSIX systems; elsewhere, creating or attaching to a segment throws.
+     *
+     * This only replaces the transport. Messages are serialized into the ring and deserialized out of it as they
+     * would be over a socket, so array payloads are still copied once on each side, as over TCP loopback; the ring
+     * saves the system calls and the socket buffers, not the copies. Handing arrays over by reference would need
+     * hoNDArrays allocated in the segment and a different protocol. None of the Python, Julia or MATLAB modules
+     * attach to the segment yet, so they keep using TCP.
+     *
+     * The owner creates the segment and passes its name to the peer, which attaches before connecting. Header layout
+     * (native byte order, all offsets in bytes):
+     *
+     *      0   uint64  magic, "GTSHMEM1"
+     *      8   uint32  layout version, 1
+     *     12   uint32  set to 1 by the peer once attached
+     *     16   uint64  size of each ring
+     *     64   ring control, owner to peer
+     *    384   ring control, peer to owner
+     *   4096   ring data, owner to peer, followed by ring data, peer to owner
+     *
+     * Ring control, each field on its own 64 byte line: uint64 bytes written; uint64 bytes read; uint32 futex word
+     * bumped after each write, uint32 reader waiting; uint32 futex word bumped after each read, uint32 writer waiting;
+     * uint32 closed.
+     */
+    class SharedMemorySegment {
+    public:
+        /// Creates a new segment with rings of the given size. The segment is unlinked when the owner releases it.
+        static std::shared_ptr<SharedMemorySegment> create(size_t ring_size);
+
+        /// Attaches to a segment created by another process, and marks it as attached.
+        static std::shared_ptr<SharedMemorySegment> attach(const std::string &name);
+
+        ~SharedMemorySegment();
+
+        const std::string &name() const { return name_; }
+        size_t ring_size() const;
+        bool is_owner() const { return owner; }
+
+        /// True once a peer has attached to the segment.
+        bool peer_attached() const;
+
+        /// Removes the name of the segment, so no further peers can attach. Mappings stay valid.
+        void unlink();
+
+        struct Header;
+        Header &header() const;
+        char *ring_data(size_t ring) const;
+
+    private:
+        SharedMemorySegment(std::string name, void *memory, size_t size, bool owner);
+
+        const std::string name_;
+        void *const memory;
+        const size_t size;
+        const bool owner;
+        bool linked;
+    };
+
+    /**
+     * Stream over a shared memory segment; the owner writes to the first ring and reads from the second, the peer the
+     * other way around.
+     *
+     * The socket, if given, is a connection to the peer process. Nothing is sent over it; it only tells when the peer
+     * has gone away, so reads and writes do not wait forever on a process that has died.
+     */
+    std::unique_ptr<std::iostream> stream_from_shared_memory(
+        std::shared_ptr<SharedMemorySegment> segment,
+        std::unique_ptr<boost::asio::ip::tcp::socket> socket = nullptr);
+}
@@ -4,6 +4,11 @@
 
 #include "SocketStreamBuf.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <thread>
 
 #include "Types.h"
@@ -11,6 +16,7 @@
 #include <boost/asio.hpp>
 namespace {
     using boost::asio::ip::tcp;
+    using Gadgetron::Connection::SocketStatistics;
 
     std::unique_ptr<tcp::socket> connect_socket(
         const std::string& host, const std::string& service, boost::asio::io_service& context) {
@@ -40,12 +46,22 @@ namespace {
         throw std::runtime_error("Failed to connect to service " + service + " on host " + host + ": " + ec.message());
     }
 
+    /**
+     * Stream buffer on top of a socket.
+     *
+     * Small reads go through the input buffer. Large reads bypass it: data is read with scatter reads straight into
+     * the destination (typically hoNDArray memory), with any surplus landing in the input buffer. Writes are sent
+     * straight from the source, together with any pending output, in a single gather write.
+     */
     class SocketStreamBuf : public std::streambuf {
     public:
-        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 1024);
+        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size);
+
+        SocketStatistics statistics() const;
 
     protected:
         std::streamsize xsputn(const char_type* data, std::streamsize length) override;
+        std::streamsize xsgetn(char_type* data, std::streamsize length) override;
 
         int sync() override;
         int underflow() override;
@@ -56,24 +72,37 @@ namespace {
         std::vector<char> input_buffer;
         std::vector<char> output_buffer;
 
-        /* Other members */
+        std::atomic<size_t> bytes_read{0}, bytes_written{0};
+        const std::chrono::steady_clock::time_point created = std::chrono::steady_clock::now();
+
+        void flush_output();
     };
 
+    void SocketStreamBuf::flush_output() {
+        if (this->pptr() != this->pbase()) {
+            auto pending = std::distance(this->pbase(), this->pptr());
+            boost::asio::write(*socket, boost::asio::buffer(this->pbase(), pending));
+            bytes_written += pending;
+            this->setp(this->pbase(), this->epptr());
+        }
+    }
+
     int SocketStreamBuf::sync() {
-        return this->overflow() != traits_type::eof() ? 0 : -1;
+        flush_output();
+        return 0;
     }
+
     int SocketStreamBuf::underflow() {
 
         auto elements_read = socket->read_some(boost::asio::buffer(this->eback(), input_buffer.size()));
+        bytes_read += elements_read;
 
         this->setg(this->eback(), this->eback(), this->eback() + elements_read);
         return traits_type::to_int_type(*this->gptr());
     }
+
     int SocketStreamBuf::overflow(int ch) {
-        if (this->pptr() != this->pbase()) {
-            boost::asio::write(*socket, boost::asio::buffer(this->pbase(), std::distance(this->pbase(), this->pptr())));
-            this->setp(this->pbase(), this->epptr());
-        }
+        flush_output();
         if (ch != traits_type::eof()) {
             this->sputc(ch);
         }
@@ -82,31 +111,84 @@ namespace {
     }
 
     std::streamsize SocketStreamBuf::xsputn(const char* data, std::streamsize length) {
-        this->overflow();
-        return boost::asio::write(*socket, boost::asio::buffer(data, length));
+        // Writes are sent immediately, as callers do not flush the stream; pending output goes out in the same call.
+        std::array<boost::asio::const_buffer, 2> buffers{
+            boost::asio::buffer(this->pbase(), std::distance(this->pbase(), this->pptr())),
+            boost::asio::buffer(data, length)
+        };
+        auto written = boost::asio::write(*socket, buffers);
+        bytes_written += written;
+        this->setp(this->pbase(), this->epptr());
+        return length;
     }
+
+    std::streamsize SocketStreamBuf::xsgetn(char* data, std::streamsize length) {
+        std::streamsize buffered = std::min<std::streamsize>(length, std::distance(this->gptr(), this->egptr()));
+        std::memcpy(data, this->gptr(), buffered);
+        this->gbump(int(buffered));
+
+        auto received = buffered;
+        if (received == length) return length;
+
+        if (length - received < std::streamsize(input_buffer.size())) {
+            // Small remainder; refilling the buffer is cheaper than a dedicated read.
+            while (received < length) {
+                if (this->underflow() == traits_type::eof()) return received;
+                auto chunk = std::min<std::streamsize>(length - received, std::distance(this->gptr(), this->egptr()));
+                std::memcpy(data + received, this->gptr(), chunk);
+                this->gbump(int(chunk));
+                received += chunk;
+            }
+            return received;
+        }
+
+        while (received < length) {
+            std::array<boost::asio::mutable_buffer, 2> buffers{
+                boost::asio::buffer(data + received, length - received),
+                boost::asio::buffer(input_buffer)
+            };
+            auto elements_read = std::streamsize(socket->read_some(buffers));
+            bytes_read += elements_read;
+
+            auto surplus = std::max<std::streamsize>(0, received + elements_read - length);
+            received = std::min(length, received + elements_read);
+            this->setg(input_buffer.data(), input_buffer.data(), input_buffer.data() + surplus);
+        }
+        return received;
+    }
+
     SocketStreamBuf::SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size)
         : socket(std::move(socket)), input_buffer(buffer_size), output_buffer(buffer_size) {
         this->setg(input_buffer.data(), input_buffer.data() + buffer_size, input_buffer.data() + buffer_size);
         this->setp(output_buffer.data(), output_buffer.data() + buffer_size);
     }
 
+    SocketStatistics SocketStreamBuf::statistics() const {
+        return SocketStatistics{
+            bytes_read.load(),
+            bytes_written.load(),
+            std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - created)
+        };
+    }
+
     using namespace Gadgetron::Connection;
     class SocketStream : public std::iostream {
     public:
-        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket)
-            : std::iostream(new SocketStreamBuf(std::move(socket))) {
+        SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size)
+            : std::iostream(new SocketStreamBuf(std::move(socket), buffer_size)) {
             buffer = std::unique_ptr<SocketStreamBuf>(static_cast<SocketStreamBuf*>(this->rdbuf()));
         }
 
-        SocketStream(const std::string& host, const std::string& service,
+        SocketStream(const std::string& host, const std::string& service, size_t buffer_size,
             std::shared_ptr<boost::asio::io_service> io_service = std::make_shared<boost::asio::io_service>())
-            : SocketStream(connect_socket(host, service, *io_service)) {
+            : SocketStream(connect_socket(host, service, *io_service), buffer_size) {
             this->io_service = io_service;
         }
 
         ~SocketStream() override = default;
 
+        SocketStatistics statistics() const { return buffer->statistics(); }
+
     private:
         std::shared_ptr<boost::asio::io_service> io_service;
         std::unique_ptr<SocketStreamBuf> buffer;
@@ -115,11 +197,17 @@ namespace {
 
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::stream_from_socket(
-    std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
-    return std::make_unique<SocketStream>(std::move(socket));
+    std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size) {
+    return std::make_unique<SocketStream>(std::move(socket), buffer_size);
 }
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::remote_stream(
-    const std::string& host, const std::string& service) {
-    return std::make_unique<SocketStream>(host, service);
+    const std::string& host, const std::string& service, size_t buffer_size) {
+    return std::make_unique<SocketStream>(host, service, buffer_size);
+}
+
+Gadgetron::Core::optional<Gadgetron::Connection::SocketStatistics> Gadgetron::Connection::socket_statistics(
+    const std::iostream& stream) {
+    if (auto socket_stream = dynamic_cast<const SocketStream*>(&stream)) return socket_stream->statistics();
+    return Core::none;
 }
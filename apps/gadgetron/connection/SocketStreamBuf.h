@@ -1,10 +1,28 @@
-
 #pragma once
 #include <boost/asio/ip/tcp.hpp>
+#include <chrono>
 #include <iostream>
 
+#include "Types.h"
+
 namespace Gadgetron::Connection {
 
-    std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
-    std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service);
-}
\ No newline at end of file
+    constexpr size_t default_socket_buffer_size = 1u << 16;
+
+    struct SocketStatistics {
+        size_t bytes_read;
+        size_t bytes_written;
+        std::chrono::duration<double> elapsed;
+
+        double read_rate() const { return elapsed.count() > 0 ? bytes_read / elapsed.count() : 0.0; }
+        double write_rate() const { return elapsed.count() > 0 ? bytes_written / elapsed.count() : 0.0; }
+    };
+
+    std::unique_ptr<std::iostream> stream_from_socket(
+        std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = default_socket_buffer_size);
+    std::unique_ptr<std::iostream> remote_stream(
+        const std::string& host, const std::string& service, size_t buffer_size = default_socket_buffer_size);
+
+    /// Bytes transferred over the socket behind the stream, and the time since it was opened. None if the stream is not a socket stream.
+    Core::optional<SocketStatistics> socket_statistics(const std::iostream& stream);
+}
@@ -83,14 +83,14 @@ namespace Gadgetron::Server::Connection::StreamConnection {
         auto readers = loader.load_readers(config);
         auto writers = loader.load_writers(config);
 
-        std::thread input_thread = start_input_thread(
+        auto input_thread = start_input_thread(
                 stream,
                 std::move(ichannel.output),
                 [&](auto close) { return prepare_handlers(close, readers); },
                 error_handler
         );
 
-        std::thread output_thread = start_output_thread(
+        auto output_thread = start_output_thread(
                 stream,
                 std::move(ochannel.input),
                 [&]() { return prepare_writers(writers); },
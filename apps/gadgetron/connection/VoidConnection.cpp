@@ -45,7 +45,7 @@ namespace Gadgetron::Server::Connection::VoidConnection {
         auto node = loader.load(config.stream);
         auto writers = loader.load_writers(config);
 
-        std::thread output_thread = start_output_thread(
+        auto output_thread = start_output_thread(
                 stream,
                 std::move(ochannel.input),
                 [&writers]() { return prepare_writers(writers); },
@@ -2,6 +2,8 @@
 
 #include "Writers.h"
 
+#include "io/compressed_stream.h"
+
 namespace Gadgetron::Server::Connection::Writers {
 
     void ResponseWriter::serialize(
@@ -31,4 +33,14 @@ namespace Gadgetron::Server::Connection::Writers {
         stream.write(reinterpret_cast<char *>(&length), sizeof(length));
         stream.write(message.data(), length);
     }
+
+    void CompressionWriter::serialize(
+            std::ostream &stream,
+            const CompressOutput& compression
+    ) {
+        auto buffer = dynamic_cast<Core::IO::CompressedStreamBuf *>(stream.rdbuf());
+        if (!buffer) throw std::runtime_error("Compression is not available on this connection.");
+
+        buffer->compress_output(compression.codec, compression.level);
+    }
 }
@@ -14,4 +14,15 @@ namespace Gadgetron::Server::Connection::Writers {
     public:
         void serialize(std::ostream &, const std::string&) override;
     };
+
+    /// Compresses everything the output thread writes after this message, which itself writes nothing.
+    struct CompressOutput {
+        std::string codec;
+        int level;
+    };
+
+    class CompressionWriter : public Core::TypedWriter<CompressOutput> {
+    public:
+        void serialize(std::ostream &, const CompressOutput&) override;
+    };
 }
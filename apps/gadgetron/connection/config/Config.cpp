@@ -161,6 +161,8 @@ namespace {
         static pugi::xml_node add_node(const Config::Stream &stream, pugi::xml_node &node) {
             auto stream_node = node.append_child("stream");
             stream_node.append_attribute("key").set_value(stream.key.c_str());
+            if (stream.channel_capacity)
+                stream_node.append_attribute("channel_capacity").set_value((long long unsigned int)stream.channel_capacity);
             for (auto n : stream.nodes) {
                 visit([&stream_node](auto &typed_node) { add_node(typed_node, stream_node); }, n);
             }
@@ -170,6 +172,12 @@ namespace {
         static pugi::xml_node add_node(const Config::ParallelProcess& parallelProcess, pugi::xml_node & node){
             auto parallel_node = node.append_child("parallelprocess");
             parallel_node.append_attribute("workers").set_value((long long unsigned int)parallelProcess.workers);
+            if (parallelProcess.window)
+                parallel_node.append_attribute("window").set_value((long long unsigned int)parallelProcess.window);
+            if (!parallelProcess.ordered)
+                parallel_node.append_attribute("ordered").set_value(false);
+            if (parallelProcess.adaptive)
+                parallel_node.append_attribute("adaptive").set_value(true);
             add_node(parallelProcess.stream, parallel_node);
             return parallel_node;
         }
@@ -523,7 +531,8 @@ namespace {
             for (auto &node : stream_node.children()) {
                 nodes.push_back(node_parsers.at(node.name())(node));
             }
-            return Config::Stream{stream_node.attribute("key").value(), nodes};
+            size_t channel_capacity = stream_node.attribute("channel_capacity").as_ullong(0);
+            return Config::Stream{stream_node.attribute("key").value(), nodes, channel_capacity};
         }
 
         Config::PureStream parse_purestream(const pugi::xml_node &purestream_node){
@@ -536,7 +545,13 @@ namespace {
         Config::ParallelProcess parse_parallelprocess(const pugi::xml_node& parallelprocess_node)
         {
             size_t workers = std::stoul(parallelprocess_node.attribute("workers").value());
-            return Config::ParallelProcess{workers,parse_purestream(parallelprocess_node.child("purestream"))};
+            return Config::ParallelProcess{
+                workers,
+                parse_purestream(parallelprocess_node.child("purestream")),
+                parallelprocess_node.attribute("window").as_ullong(0),
+                parallelprocess_node.attribute("ordered").as_bool(true),
+                parallelprocess_node.attribute("adaptive").as_bool(false)
+            };
         }
 
         Config::PureDistributed parse_puredistributed(const pugi::xml_node& puredistributedprocess_node){
@@ -35,6 +35,8 @@ namespace Gadgetron::Server::Connection {
         struct Stream {
             std::string key;
             std::vector<Node> nodes;
+            /// Capacity of the channels between the nodes of the stream. Zero means unbounded.
+            size_t channel_capacity = 0;
         };
 
         struct PureStream{
@@ -88,8 +90,15 @@ namespace Gadgetron::Server::Connection {
         };
 
         struct ParallelProcess {
+            /// Maximum number of messages processed concurrently. Zero means the size of the shared thread pool.
             size_t workers = 0;
             PureStream stream;
+            /// Maximum number of messages received but not yet sent on. Zero means four per worker.
+            size_t window = 0;
+            /// Send results in the order the messages arrived. Otherwise results are sent as soon as they are ready.
+            bool ordered = true;
+            /// Scale the number of concurrent workers, up to workers, to the measured processing time and input rate.
+            bool adaptive = false;
         };
 
         struct Distributor : Gadget { using Gadget::Gadget;};
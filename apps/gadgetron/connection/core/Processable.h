@@ -20,7 +20,7 @@ namespace Gadgetron::Server::Connection {
 
         virtual const std::string& name() = 0;
 
-        static std::thread process_async(
+        static CachedThread process_async(
             std::shared_ptr<Processable> processable,
             Core::GenericInputChannel input,
             Core::OutputChannel output,
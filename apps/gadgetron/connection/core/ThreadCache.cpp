@@ -0,0 +1,196 @@
+#include "ThreadCache.h"
+
+#include <algorithm>
+#include <thread>
+
+#if !(_WIN32)
+#include <pthread.h>
+#endif
+
+namespace Gadgetron::Server::Connection {
+
+    struct CachedThread::Completion {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+
+        void finish() {
+            std::lock_guard<std::mutex> guard(mutex);
+            done = true;
+            cv.notify_all();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return done; });
+        }
+    };
+
+    CachedThread::CachedThread(std::shared_ptr<Completion> completion) : completion(std::move(completion)) {}
+
+    CachedThread &CachedThread::operator=(CachedThread &&other) noexcept {
+        if (this != &other) {
+            if (joinable()) join();
+            completion = std::move(other.completion);
+        }
+        return *this;
+    }
+
+    CachedThread::~CachedThread() {
+        if (joinable()) join();
+    }
+
+    void CachedThread::join() {
+        if (!completion) throw std::logic_error("Cannot join a CachedThread which is not running a job.");
+        completion->wait();
+        completion = nullptr;
+    }
+
+    void CachedThread::detach() {
+        completion = nullptr;
+    }
+
+    bool CachedThread::joinable() const {
+        return bool(completion);
+    }
+
+    struct ThreadCache::Worker {
+        std::mutex mutex;
+        std::condition_variable cv;
+        Core::ThreadPool::Task job;
+        std::shared_ptr<CachedThread::Completion> completion;
+        bool retired = false;
+    };
+
+    struct ThreadCache::State {
+        const size_t max_idle_threads;
+        const std::chrono::milliseconds idle_timeout;
+
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Worker>> idle;
+        bool shutting_down = false;
+
+        State(size_t max_idle_threads, std::chrono::milliseconds idle_timeout)
+            : max_idle_threads(max_idle_threads), idle_timeout(idle_timeout) {}
+
+        // Returns false if the worker should exit rather than wait for another job.
+        bool park(const std::shared_ptr<Worker> &worker) {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (shutting_down || idle.size() >= max_idle_threads) return false;
+                idle.push_back(worker);
+            }
+
+            std::unique_lock<std::mutex> lock(worker->mutex);
+            auto has_work = [&]() { return bool(worker->job) || worker->retired; };
+            if (!worker->cv.wait_for(lock, idle_timeout, has_work)) {
+                lock.unlock();
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    auto it = std::find(idle.begin(), idle.end(), worker);
+                    if (it != idle.end()) {
+                        idle.erase(it);
+                        return false;
+                    }
+                }
+                // A job was handed to us while we were timing out.
+                lock.lock();
+                worker->cv.wait(lock, has_work);
+            }
+            return bool(worker->job);
+        }
+
+        static void work(std::shared_ptr<State> state, std::shared_ptr<Worker> worker) {
+            do {
+                Core::ThreadPool::Task job;
+                std::shared_ptr<CachedThread::Completion> completion;
+                {
+                    std::lock_guard<std::mutex> guard(worker->mutex);
+                    job = std::move(worker->job);
+                    completion = std::move(worker->completion);
+                }
+                job();
+                job = Core::ThreadPool::Task();
+                completion->finish();
+            } while (state->park(worker));
+        }
+    };
+
+    ThreadCache::ThreadCache(size_t max_idle_threads, std::chrono::milliseconds idle_timeout)
+        : state(std::make_shared<State>(max_idle_threads, idle_timeout)) {}
+
+    ThreadCache::~ThreadCache() {
+        std::lock_guard<std::mutex> guard(state->mutex);
+        state->shutting_down = true;
+        for (auto &worker : state->idle) {
+            std::lock_guard<std::mutex> worker_guard(worker->mutex);
+            worker->retired = true;
+            worker->cv.notify_one();
+        }
+        state->idle.clear();
+    }
+
+    CachedThread ThreadCache::run(Core::ThreadPool::Task job) {
+        auto completion = std::make_shared<CachedThread::Completion>();
+
+        std::shared_ptr<Worker> worker;
+        {
+            std::lock_guard<std::mutex> guard(state->mutex);
+            if (!state->idle.empty()) {
+                worker = std::move(state->idle.back());
+                state->idle.pop_back();
+            }
+        }
+
+        if (worker) {
+            std::lock_guard<std::mutex> guard(worker->mutex);
+            worker->job = std::move(job);
+            worker->completion = completion;
+            worker->cv.notify_one();
+        } else {
+            worker = std::make_shared<Worker>();
+            worker->job = std::move(job);
+            worker->completion = completion;
+            std::thread(State::work, state, std::move(worker)).detach();
+        }
+
+        return CachedThread(std::move(completion));
+    }
+
+    size_t ThreadCache::idle_threads() {
+        std::lock_guard<std::mutex> guard(state->mutex);
+        return state->idle.size();
+    }
+
+    // Holds the state mutex across the fork, so the child never inherits it half way through a change.
+    void ThreadCache::prepare_fork() {
+        state->mutex.lock();
+    }
+
+    void ThreadCache::resume_after_fork() {
+        state->mutex.unlock();
+    }
+
+    void ThreadCache::reset_after_fork() {
+        // Parked threads do not survive a fork, so the child drops them and starts out with an empty cache.
+        auto inherited = std::move(state);
+        inherited->shutting_down = true;
+        inherited->idle.clear();
+        inherited->mutex.unlock();
+        state = std::make_shared<State>(inherited->max_idle_threads, inherited->idle_timeout);
+    }
+
+    ThreadCache &ThreadCache::instance() {
+        static std::once_flag once;
+        static ThreadCache *cache = nullptr;
+        std::call_once(once, []() {
+            cache = new ThreadCache();
+#if !(_WIN32)
+            pthread_atfork([]() { cache->prepare_fork(); },
+                           []() { cache->resume_after_fork(); },
+                           []() { cache->reset_after_fork(); });
+#endif
+        });
+        return *cache;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace Gadgetron::Server::Connection {
+
+    /**
+     * Handle to a job running on a cached thread. Behaves like a std::thread that can only be joined.
+     */
+    class CachedThread {
+    public:
+        CachedThread() = default;
+        CachedThread(CachedThread &&) noexcept = default;
+        CachedThread &operator=(CachedThread &&other) noexcept;
+        ~CachedThread();
+
+        void join();
+        void detach();
+        bool joinable() const;
+
+    private:
+        friend class ThreadCache;
+        struct Completion;
+        explicit CachedThread(std::shared_ptr<Completion> completion);
+        std::shared_ptr<Completion> completion;
+    };
+
+    /**
+     * Keeps finished threads parked for a while, so they can be reused for the next job.
+     *
+     * Nodes, and the input and output of every connection, each block a thread for their entire lifetime, so they
+     * cannot share a fixed size pool. Reusing threads takes thread creation and teardown out of connection setup,
+     * which matters when many short scans arrive back to back.
+     */
+    class ThreadCache {
+    public:
+        explicit ThreadCache(size_t max_idle_threads = 256,
+                             std::chrono::milliseconds idle_timeout = std::chrono::seconds(60));
+        ~ThreadCache();
+
+        ThreadCache(const ThreadCache &) = delete;
+        ThreadCache &operator=(const ThreadCache &) = delete;
+
+        /// Runs the job on an idle thread if one is available, or on a new thread otherwise.
+        CachedThread run(Core::ThreadPool::Task job);
+
+        size_t idle_threads();
+
+        static ThreadCache &instance();
+
+    private:
+        struct Worker;
+        struct State;
+        std::shared_ptr<State> state;
+
+        void prepare_fork();
+        void resume_after_fork();
+        void reset_after_fork();
+    };
+}
@@ -0,0 +1,279 @@
+#include "Tracing.h"
+
+#include <ctime>
+#include <fstream>
+#include <map>
+
+#include <nlohmann/json.hpp>
+
+#include "log.h"
+
+namespace {
+    using namespace Gadgetron::Server::Connection;
+    using json = nlohmann::json;
+
+    double seconds(Tracer::Clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    double microseconds(Tracer::Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    std::string timestamp() {
+        auto now = std::time(nullptr);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y%m%d-%H%M%S", std::localtime(&now));
+        return buffer;
+    }
+
+    // Counters accumulated over every traced connection handled by this process.
+    struct Cumulative {
+        std::mutex mutex;
+        size_t connections = 0;
+        std::map<std::string, Tracer::NodeStatistics> nodes;
+    };
+
+    Cumulative &cumulative() {
+        static Cumulative counters;
+        return counters;
+    }
+
+    std::atomic<size_t> connection_counter{ 0 };
+}
+
+namespace Gadgetron::Server::Connection {
+
+    struct Tracer::Event {
+        enum class Type { slice, flow_start, flow_end, counter };
+
+        Type type;
+        const char *name;
+        size_t id;
+        Clock::duration time;
+        Clock::duration duration;
+        size_t value;
+    };
+
+    struct Tracer::Node {
+        NodeStatistics statistics;
+        Clock::time_point started;
+        Clock::time_point finished;
+        Clock::time_point last_wait;
+    };
+
+    std::shared_ptr<Tracer> Tracer::create(const Core::StreamContext &context) {
+        if (!context.args.count("trace_dir"))
+            return nullptr;
+        auto max_events = context.args.count("trace_max_events") ? context.args["trace_max_events"].as<size_t>()
+                                                                  : default_max_events;
+        return std::make_shared<Tracer>(context.args["trace_dir"].as<boost::filesystem::path>(), max_events);
+    }
+
+    Tracer::Tracer(boost::filesystem::path trace_directory, size_t max_events)
+        : trace_directory(std::move(trace_directory)), origin(Clock::now()), max_events(max_events) {}
+
+    Tracer::~Tracer() {
+        try {
+            auto nodes = statistics();
+            for (auto &node : nodes) {
+                GINFO_STREAM("Trace: " << node.name << " busy " << seconds(node.busy) << " s, idle "
+                                       << seconds(node.idle) << " s, received " << node.messages_in << " messages ("
+                                       << node.bytes_in << " bytes), sent " << node.messages_out << " messages ("
+                                       << node.bytes_out << " bytes)");
+            }
+
+            boost::filesystem::create_directories(trace_directory);
+            auto path = trace_directory / ("gadgetron_trace_" + timestamp() + "_" +
+                                           std::to_string(connection_counter++) + ".json");
+            std::ofstream stream(path.string());
+            write_trace(stream);
+            GINFO_STREAM("Trace written to " << path.string());
+            if (dropped_events)
+                GWARN_STREAM("Trace reached " << max_events << " events; " << dropped_events
+                                              << " later events were dropped");
+
+            write_counters(nodes);
+        } catch (const std::exception &e) {
+            GERROR_STREAM("Failed to write connection trace: " << e.what());
+        }
+    }
+
+    size_t Tracer::add_node(const std::string &name) {
+        std::lock_guard<std::mutex> guard(mutex);
+        nodes.emplace_back();
+        nodes.back().statistics.name = name;
+        return nodes.size() - 1;
+    }
+
+    size_t Tracer::add_channel(const std::string &name) {
+        std::lock_guard<std::mutex> guard(mutex);
+        channels.push_back(name);
+        return channels.size() - 1;
+    }
+
+    void Tracer::node_started(size_t node) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> guard(mutex);
+        nodes[node].started = nodes[node].last_wait = now;
+    }
+
+    void Tracer::node_finished(size_t node) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> guard(mutex);
+        auto &n    = nodes[node];
+        n.finished = now;
+        if (now > n.last_wait)
+            record({ Event::Type::slice, "busy", node, n.last_wait - origin, now - n.last_wait, 0 });
+    }
+
+    void Tracer::waited(size_t node, Wait wait, Clock::time_point begin, Clock::time_point end) {
+        if (node == none)
+            return;
+
+        std::lock_guard<std::mutex> guard(mutex);
+        auto &n = nodes[node];
+        if (begin > n.last_wait)
+            record({ Event::Type::slice, "busy", node, n.last_wait - origin, begin - n.last_wait, 0 });
+        record({ Event::Type::slice, wait == Wait::input ? "wait for input" : "wait for output", node,
+            begin - origin, end - begin, 0 });
+        n.last_wait = end;
+        n.statistics.idle += end - begin;
+    }
+
+    void Tracer::message_sent(size_t node, size_t channel, size_t sequence, size_t bytes, Clock::time_point time) {
+        if (node == none)
+            return;
+
+        std::lock_guard<std::mutex> guard(mutex);
+        nodes[node].statistics.messages_out++;
+        nodes[node].statistics.bytes_out += bytes;
+        record({ Event::Type::flow_start, "message", node, time - origin, {}, (channel << 32) | sequence });
+    }
+
+    void Tracer::message_received(size_t node, size_t channel, size_t sequence, size_t bytes, Clock::time_point time) {
+        if (node == none)
+            return;
+
+        std::lock_guard<std::mutex> guard(mutex);
+        nodes[node].statistics.messages_in++;
+        nodes[node].statistics.bytes_in += bytes;
+        record({ Event::Type::flow_end, "message", node, time - origin, {}, (channel << 32) | sequence });
+    }
+
+    void Tracer::queue_depth(size_t channel, size_t depth, Clock::time_point time) {
+        std::lock_guard<std::mutex> guard(mutex);
+        record({ Event::Type::counter, nullptr, channel, time - origin, {}, depth });
+    }
+
+    // Called with the mutex held.
+    void Tracer::record(const Event &event) {
+        if (events.size() < max_events)
+            events.push_back(event);
+        else
+            dropped_events++;
+    }
+
+    std::vector<Tracer::NodeStatistics> Tracer::statistics() {
+        std::lock_guard<std::mutex> guard(mutex);
+        std::vector<NodeStatistics> result;
+        for (auto &node : nodes) {
+            result.push_back(node.statistics);
+            result.back().busy = (node.finished - node.started) - node.statistics.idle;
+        }
+        return result;
+    }
+
+    void Tracer::write_trace(std::ostream &stream) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        // Events are written one at a time, as a full trace can hold millions of them.
+        bool first  = true;
+        auto output = [&](const json &event) {
+            stream << (first ? "\n" : ",\n") << event.dump();
+            first = false;
+        };
+
+        stream << R"({"displayTimeUnit": "ms", "otherData": {"dropped_events": )" << dropped_events
+               << R"(}, "traceEvents": [)";
+        for (size_t i = 0; i < nodes.size(); i++) {
+            output({ { "ph", "M" }, { "name", "thread_name" }, { "pid", 1 }, { "tid", i },
+                { "args", { { "name", nodes[i].statistics.name } } } });
+        }
+
+        for (auto &event : events) {
+            switch (event.type) {
+            case Event::Type::slice:
+                output({ { "ph", "X" }, { "name", event.name }, { "pid", 1 }, { "tid", event.id },
+                    { "ts", microseconds(event.time) }, { "dur", microseconds(event.duration) } });
+                break;
+            case Event::Type::flow_start:
+                output({ { "ph", "s" }, { "name", event.name }, { "cat", "message" }, { "pid", 1 },
+                    { "tid", event.id }, { "id", event.value }, { "ts", microseconds(event.time) } });
+                break;
+            case Event::Type::flow_end:
+                output({ { "ph", "f" }, { "bp", "e" }, { "name", event.name }, { "cat", "message" }, { "pid", 1 },
+                    { "tid", event.id }, { "id", event.value }, { "ts", microseconds(event.time) } });
+                break;
+            case Event::Type::counter:
+                output({ { "ph", "C" }, { "name", "queue " + channels[event.id] }, { "pid", 1 },
+                    { "ts", microseconds(event.time) }, { "args", { { "depth", event.value } } } });
+                break;
+            }
+        }
+        stream << "\n]}\n";
+    }
+
+    void Tracer::write_counters(const std::vector<NodeStatistics> &statistics) {
+        auto &counters = cumulative();
+        std::lock_guard<std::mutex> guard(counters.mutex);
+
+        counters.connections++;
+        for (auto &node : statistics) {
+            auto &total = counters.nodes[node.name];
+            total.name  = node.name;
+            total.busy += node.busy;
+            total.idle += node.idle;
+            total.messages_in += node.messages_in;
+            total.messages_out += node.messages_out;
+            total.bytes_in += node.bytes_in;
+            total.bytes_out += node.bytes_out;
+        }
+
+        json nodes = json::object();
+        for (auto &[name, total] : counters.nodes) {
+            nodes[name] = { { "busy_seconds", seconds(total.busy) }, { "idle_seconds", seconds(total.idle) },
+                { "messages_in", total.messages_in }, { "messages_out", total.messages_out },
+                { "bytes_in", total.bytes_in }, { "bytes_out", total.bytes_out } };
+        }
+        json document = { { "connections", counters.connections }, { "nodes", nodes } };
+
+        auto path      = trace_directory / "gadgetron_counters.json";
+        auto temporary = trace_directory / "gadgetron_counters.json.tmp";
+        {
+            std::ofstream stream(temporary.string());
+            stream << document.dump(2) << std::endl;
+        }
+        boost::filesystem::rename(temporary, path);
+    }
+
+    TracedProcessable::TracedProcessable(
+        std::shared_ptr<Processable> processable, std::shared_ptr<Tracer> tracer, size_t node)
+        : processable(std::move(processable)), tracer(std::move(tracer)), node(node) {}
+
+    void TracedProcessable::process(
+        Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler &error_handler) {
+        tracer->node_started(node);
+        try {
+            processable->process(std::move(input), std::move(output), error_handler);
+        } catch (...) {
+            tracer->node_finished(node);
+            throw;
+        }
+        tracer->node_finished(node);
+    }
+
+    const std::string &TracedProcessable::name() {
+        return processable->name();
+    }
+}
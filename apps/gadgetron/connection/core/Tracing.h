@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "Channel.h"
+#include "Context.h"
+
+#include "connection/core/Processable.h"
+
+namespace Gadgetron::Server::Connection {
+
+    /**
+     * Records what the nodes of a connection spend their time on.
+     *
+     * Every node is timed from start to finish. Time spent blocked on the input channel (waiting for work) or on the
+     * output channel (waiting for the next node to catch up) is idle time; the rest is busy time. Messages are
+     * followed from the node sending them to the node receiving them, and the depth of every channel is sampled on
+     * each push and pop.
+     *
+     * When the tracer is destroyed, the events are written as a Chrome trace (open in chrome://tracing or
+     * ui.perfetto.dev), a per-node summary is logged, and the counters accumulated over all connections are written
+     * next to the trace.
+     *
+     * A trace keeps at most max_events events, so a long running connection does not grow it without bound. Later
+     * events are dropped from the trace, and the number dropped is logged and noted in it; the per-node statistics
+     * and counters still cover the whole connection.
+     *
+     * Tracing is enabled by the trace_dir argument. Without it, no tracer is created and the nodes are connected
+     * exactly as they are otherwise.
+     */
+    class Tracer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// Stands in for a node outside the traced stream, such as the sender of the stream's input.
+        static constexpr size_t none = size_t(-1);
+
+        /// Returns a tracer for the connection if tracing is enabled, or nullptr if it is not.
+        static std::shared_ptr<Tracer> create(const Core::StreamContext &context);
+
+        static constexpr size_t default_max_events = 1u << 20;
+
+        explicit Tracer(boost::filesystem::path trace_directory, size_t max_events = default_max_events);
+        ~Tracer();
+
+        Tracer(const Tracer &) = delete;
+        Tracer &operator=(const Tracer &) = delete;
+
+        size_t add_node(const std::string &name);
+        size_t add_channel(const std::string &name);
+
+        void node_started(size_t node);
+        void node_finished(size_t node);
+
+        enum class Wait { input, output };
+        void waited(size_t node, Wait wait, Clock::time_point begin, Clock::time_point end);
+
+        void message_sent(size_t node, size_t channel, size_t sequence, size_t bytes, Clock::time_point time);
+        void message_received(size_t node, size_t channel, size_t sequence, size_t bytes, Clock::time_point time);
+        void queue_depth(size_t channel, size_t depth, Clock::time_point time);
+
+        struct NodeStatistics {
+            std::string name;
+            Clock::duration busy{};
+            Clock::duration idle{};
+            size_t messages_in  = 0;
+            size_t messages_out = 0;
+            size_t bytes_in     = 0;
+            size_t bytes_out    = 0;
+        };
+
+        std::vector<NodeStatistics> statistics();
+
+    private:
+        struct Event;
+        struct Node;
+
+        void record(const Event &event);
+        void write_trace(std::ostream &stream);
+        void write_counters(const std::vector<NodeStatistics> &statistics);
+
+        const boost::filesystem::path trace_directory;
+        const Clock::time_point origin;
+        const size_t max_events;
+
+        std::mutex mutex;
+        std::vector<Node> nodes;
+        std::vector<std::string> channels;
+        std::vector<Event> events;
+        size_t dropped_events = 0;
+    };
+
+    /**
+     * A channel reporting every push and pop to a Tracer. The sending node is the producer, the receiving node the
+     * consumer; either may be Tracer::none for the edges of a stream.
+     */
+    template <class CHANNEL> class TracedChannel : public CHANNEL {
+    public:
+        template <class... ARGS>
+        TracedChannel(std::shared_ptr<Tracer> tracer, size_t producer, size_t consumer, const std::string &name,
+            ARGS &&... args)
+            : CHANNEL(std::forward<ARGS>(args)...), tracer(std::move(tracer)), producer(producer), consumer(consumer),
+              id(this->tracer->add_channel(name)) {}
+
+    protected:
+        Core::Message pop() override {
+            auto begin = Tracer::Clock::now();
+            try {
+                auto message = CHANNEL::pop();
+                received(begin, message);
+                return message;
+            } catch (const Core::ChannelClosed &) {
+                tracer->waited(consumer, Tracer::Wait::input, begin, Tracer::Clock::now());
+                throw;
+            }
+        }
+
+        Core::optional<Core::Message> try_pop() override {
+            auto begin   = Tracer::Clock::now();
+            auto message = CHANNEL::try_pop();
+            if (message)
+                received(begin, *message);
+            return message;
+        }
+
+        void push_message(Core::Message message) override {
+            auto bytes    = message.size_in_bytes();
+            auto sequence = pushed++;
+            auto begin    = Tracer::Clock::now();
+            tracer->message_sent(producer, id, sequence, bytes, begin);
+            tracer->queue_depth(id, ++depth, begin);
+            CHANNEL::push_message(std::move(message));
+            tracer->waited(producer, Tracer::Wait::output, begin, Tracer::Clock::now());
+        }
+
+    private:
+        void received(Tracer::Clock::time_point begin, const Core::Message &message) {
+            auto end = Tracer::Clock::now();
+            tracer->waited(consumer, Tracer::Wait::input, begin, end);
+            tracer->message_received(consumer, id, popped++, message.size_in_bytes(), end);
+            tracer->queue_depth(id, --depth, end);
+        }
+
+        const std::shared_ptr<Tracer> tracer;
+        const size_t producer;
+        const size_t consumer;
+        const size_t id;
+
+        // Channels between nodes are first in, first out, so the n-th message popped is the n-th message pushed.
+        std::atomic<size_t> pushed{ 0 };
+        std::atomic<size_t> popped{ 0 };
+        std::atomic<size_t> depth{ 0 };
+    };
+
+    /**
+     * Runs a Processable, reporting its start and finish to a Tracer.
+     */
+    class TracedProcessable : public Processable {
+    public:
+        TracedProcessable(std::shared_ptr<Processable> processable, std::shared_ptr<Tracer> tracer, size_t node);
+
+        void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler &error_handler) override;
+
+        const std::string &name() override;
+
+    private:
+        const std::shared_ptr<Processable> processable;
+        const std::shared_ptr<Tracer> tracer;
+        const size_t node;
+    };
+}
@@ -1,5 +1,6 @@
 
 #include <list>
+#include <atomic>
 #include <algorithm>
 
 #include "Distributed.h"
@@ -17,38 +18,55 @@ namespace {
     using namespace Gadgetron::Server::Connection;
     using namespace Gadgetron::Server::Connection::Nodes;
 
+    // Partitions are not moved between peers once created, so new partitions go to the peer with the least work;
+    // fewest open partitions first, then fewest bytes sent.
+    struct Peer {
+        explicit Peer(Address address) : address(std::move(address)) {}
+
+        const Address address;
+        std::atomic<size_t> open_channels{0};
+        std::atomic<size_t> bytes_sent{0};
+    };
+
     class ChannelWrapper {
     public:
         ChannelWrapper(
-                const Address &peer,
+                std::shared_ptr<Peer> peer,
                 std::shared_ptr<Serialization> serialization,
                 std::shared_ptr<Configuration> configuration
         );
+        ~ChannelWrapper();
 
         void process_input(GenericInputChannel input);
         void process_output(OutputChannel output);
 
     private:
+        std::shared_ptr<Peer> peer;
         std::shared_ptr<ExternalChannel> external;
     };
 
     ChannelWrapper::ChannelWrapper(
-            const Address &peer,
+            std::shared_ptr<Peer> peer,
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration
-    ) {
-        GINFO_STREAM("Connecting to peer: " << peer);
+    ) : peer(std::move(peer)) {
+        GINFO_STREAM("Connecting to peer: " << this->peer->address);
         external = std::make_shared<ExternalChannel>(
-                connect(peer, configuration),
+                connect(this->peer->address, configuration),
                 std::move(serialization),
                 std::move(configuration)
         );
+        this->peer->open_channels++;
+    }
+
+    ChannelWrapper::~ChannelWrapper() {
+        peer->open_channels--;
     }
 
     void ChannelWrapper::process_input(GenericInputChannel input) {
         auto closer = make_closer(external);
         for (auto message : input) {
-            external->push_message(std::move(message));
+            peer->bytes_sent += external->push_message(std::move(message));
         }
     }
 
@@ -72,15 +90,15 @@ namespace {
         );
 
     private:
-        Address next_peer();
+        std::shared_ptr<Peer> next_peer();
 
         OutputChannel output;
 
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
 
-        std::list<Address> peers;
-        std::list<std::thread> threads;
+        std::list<std::shared_ptr<Peer>> peers;
+        std::list<CachedThread> threads;
 
         ErrorHandler error_handler;
     };
@@ -95,8 +113,7 @@ namespace {
         output(std::move(output_channel)),
         error_handler(error_handler, "Distributed") {
 
-        auto ps = discover_peers();
-        std::copy(ps.begin(), ps.end(), std::back_inserter(peers));
+        for (auto &address : discover_peers()) peers.push_back(std::make_shared<Peer>(address));
     }
 
     OutputChannel ChannelCreatorImpl::create() {
@@ -125,8 +142,15 @@ namespace {
         for (auto &thread : threads) thread.join();
     }
 
-    Address ChannelCreatorImpl::next_peer() {
-        auto peer = peers.front(); peers.pop_front();
+    std::shared_ptr<Peer> ChannelCreatorImpl::next_peer() {
+        auto least_loaded = std::min_element(peers.begin(), peers.end(), [](auto &a, auto &b) {
+            return std::make_pair(a->open_channels.load(), a->bytes_sent.load()) <
+                   std::make_pair(b->open_channels.load(), b->bytes_sent.load());
+        });
+
+        // Peers are rotated, so equally loaded peers are used in turn.
+        auto peer = *least_loaded;
+        peers.erase(least_loaded);
         peers.push_back(peer);
         return peer;
     }
@@ -3,6 +3,7 @@
 #include "common/Closer.h"
 #include "common/ExternalChannel.h"
 
+#include "connection/SharedMemoryStream.h"
 #include "connection/SocketStreamBuf.h"
 #include "connection/config/Config.h"
 
@@ -22,7 +23,7 @@ using tcp = boost::asio::ip::tcp;
 
 namespace {
 
-    const std::map<std::string, std::function<boost::process::child(const Config::Execute &, unsigned short, const StreamContext &)>> modules{
+    const std::map<std::string, std::function<boost::process::child(const Config::Execute &, unsigned short, const StreamContext &, const std::map<std::string, std::string> &)>> modules{
             {"python", start_python_module},
             {"matlab", start_matlab_module},
             {"julia", start_julia_module}
@@ -45,6 +46,21 @@ namespace {
             output.push_message(external->pop());
         }
     }
+
+    std::shared_ptr<Gadgetron::Connection::SharedMemorySegment> create_shared_memory(const StreamContext &context) {
+        if (!context.args.count("external_shared_memory")) return nullptr;
+
+        auto ring_size = context.args["external_shared_memory"].as<size_t>();
+        if (ring_size == 0) return nullptr;
+
+        try {
+            return Gadgetron::Connection::SharedMemorySegment::create(ring_size);
+        }
+        catch (const std::exception &e) {
+            GWARN_STREAM("Failed to create shared memory for external module; using TCP. " << e.what());
+            return nullptr;
+        }
+    }
 }
 
 namespace Gadgetron::Server::Connection::Nodes {
@@ -76,7 +92,12 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         GINFO_STREAM("Waiting for external module '" << execute.name << "' on port: " << port);
 
-        auto child = std::make_shared<boost::process::child>(modules.at(execute.type)(execute, port, context));
+        // A module that supports shared memory attaches to the segment before it connects; others ignore it.
+        auto shared_memory = create_shared_memory(context);
+        std::map<std::string, std::string> environment;
+        if (shared_memory) environment["GADGETRON_SHARED_MEMORY"] = shared_memory->name();
+
+        auto child = std::make_shared<boost::process::child>(modules.at(execute.type)(execute, port, context, environment));
 
         monitors.child = std::async(
                 std::launch::async,
@@ -93,7 +114,14 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         GINFO_STREAM("Connected to external module '" << execute.name << "' on port: " << port);
 
-        auto stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
+        std::unique_ptr<std::iostream> stream;
+        if (shared_memory && shared_memory->peer_attached()) {
+            GINFO_STREAM("External module '" << execute.name << "' uses shared memory " << shared_memory->name());
+            shared_memory->unlink();
+            stream = Gadgetron::Connection::stream_from_shared_memory(shared_memory, std::move(socket));
+        } else {
+            stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
+        }
         auto external_channel = std::make_shared<ExternalChannel>(
                 std::move(stream),
                 serialization,
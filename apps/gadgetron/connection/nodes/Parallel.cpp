@@ -87,7 +87,7 @@ namespace Gadgetron::Server::Connection::Nodes {
     ) {
         ErrorHandler nested_handler{error_handler, branch->key};
 
-        std::vector<std::thread> threads;
+        std::vector<CachedThread> threads;
         std::map<std::string, ChannelPair> input_channels;
         std::map<std::string, ChannelPair> output_channels;
 
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "PureStream.h"
+#include "common/ParallelRunner.h"
 #include "connection/core/Processable.h"
 
-#include <future>
-
 namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Runs a PureStream on the messages of its input concurrently, on the shared thread pool; see ParallelRunner for
+     * how many messages are processed and held at a time, and in which order results are sent.
+     */
     class ParallelProcess : public Processable {
 
     public:
@@ -13,13 +17,7 @@ namespace Gadgetron::Server::Connection::Nodes {
         void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler) override;
         const std::string& name() override;
     private:
-
-        using Queue = Core::MPMCChannel<std::future<Core::Message>>;
-
-        void process_input(Core::GenericInputChannel input, Queue &queue);
-        void process_output(Core::OutputChannel output, Queue &queue);
-
-        const size_t workers;
         const PureStream pureStream;
+        const ParallelRunner runner;
     };
 }
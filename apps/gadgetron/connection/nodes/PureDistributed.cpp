@@ -19,7 +19,7 @@ namespace {
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration
     ) {
-        return std::make_unique<Worker>(std::move(address), std::move(serialization), std::move(configuration));
+        return std::make_unique<RemoteWorker>(std::move(address), std::move(serialization), std::move(configuration));
     }
 
     std::list<std::future<std::unique_ptr<Worker>>> begin_connecting_to_peers(
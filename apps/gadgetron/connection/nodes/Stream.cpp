@@ -90,7 +90,8 @@ namespace {
 
 namespace Gadgetron::Server::Connection::Nodes {
 
-    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader) : key(config.key) {
+    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader)
+        : key(config.key), channel_capacity(config.channel_capacity), tracer(loader.tracer()) {
         for (auto &node_config : config.nodes) {
             nodes.emplace_back(
                     Core::visit([&](auto n) { return load_node(n, context, loader); }, node_config)
@@ -103,13 +104,15 @@ namespace Gadgetron::Server::Connection::Nodes {
             ErrorHandler &error_handler
     ) {
         if (empty()) return;
+        if (tracer) return process_traced(std::move(input), std::move(output), error_handler);
 
         std::vector<GenericInputChannel> input_channels{};
         input_channels.emplace_back(std::move(input));
         std::vector<OutputChannel> output_channels{};
 
         for (auto i = 0; i < nodes.size()-1; i++) {
-            auto channel = make_channel<MessageChannel>();
+            auto channel = channel_capacity ? make_channel<BoundedMessageChannel>(channel_capacity)
+                                            : make_channel<MessageChannel>();
             input_channels.emplace_back(std::move(channel.input));
             output_channels.emplace_back(std::move(channel.output));
         }
@@ -118,7 +121,7 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         ErrorHandler nested_handler{error_handler, name()};
 
-        std::vector<std::thread> threads(nodes.size());
+        std::vector<CachedThread> threads(nodes.size());
         for (auto i = 0; i < nodes.size(); i++) {
             threads[i] = Processable::process_async(
                 nodes[i],
@@ -133,6 +136,55 @@ namespace Gadgetron::Server::Connection::Nodes {
         }
     }
 
+    void Stream::process_traced(GenericInputChannel input,
+            OutputChannel output,
+            ErrorHandler &error_handler
+    ) {
+        // The input and output of the stream are relayed through traced channels as well, so the waits of the
+        // first and last node are recorded like those of all the others.
+        std::vector<size_t> ids{};
+        std::vector<std::shared_ptr<Processable>> traced_nodes{};
+        for (auto &node : nodes) {
+            ids.push_back(tracer->add_node(name() + "/" + node->name()));
+            traced_nodes.push_back(std::make_shared<TracedProcessable>(node, tracer, ids.back()));
+        }
+
+        std::vector<GenericInputChannel> input_channels{};
+        std::vector<OutputChannel> output_channels{};
+        for (auto i = 0; i <= nodes.size(); i++) {
+            auto producer = i == 0 ? Tracer::none : ids[i - 1];
+            auto consumer = i == nodes.size() ? Tracer::none : ids[i];
+            auto channel_name = name() + "[" + std::to_string(i) + "]";
+            auto channel = channel_capacity
+                    ? make_channel<TracedChannel<BoundedMessageChannel>>(tracer, producer, consumer, channel_name, channel_capacity)
+                    : make_channel<TracedChannel<MessageChannel>>(tracer, producer, consumer, channel_name);
+            input_channels.emplace_back(std::move(channel.input));
+            output_channels.emplace_back(std::move(channel.output));
+        }
+
+        ErrorHandler nested_handler{error_handler, name()};
+
+        auto relay = [](GenericInputChannel from, OutputChannel to) {
+            for (auto message : from) to.push_message(std::move(message));
+        };
+
+        std::vector<CachedThread> threads{};
+        threads.push_back(nested_handler.run(relay, std::move(input), std::move(output_channels[0])));
+        for (auto i = 0; i < nodes.size(); i++) {
+            threads.push_back(Processable::process_async(
+                traced_nodes[i],
+                std::move(input_channels[i]),
+                std::move(output_channels[i + 1]),
+                nested_handler
+            ));
+        }
+        threads.push_back(nested_handler.run(relay, std::move(input_channels[nodes.size()]), std::move(output)));
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
     bool Stream::empty() const { return nodes.empty(); }
 }
 
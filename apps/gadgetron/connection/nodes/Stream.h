@@ -7,6 +7,7 @@
 #include "connection/config/Config.h"
 
 #include "connection/core/Processable.h"
+#include "connection/core/Tracing.h"
 
 #include "Channel.h"
 #include "Context.h"
@@ -32,6 +33,10 @@ namespace Gadgetron::Server::Connection::Nodes {
         const std::string &name() override;
 
     private:
+        void process_traced(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler &);
+
         std::vector<std::shared_ptr<Processable>> nodes;
+        const size_t channel_capacity;
+        const std::shared_ptr<Tracer> tracer;
     };
 }
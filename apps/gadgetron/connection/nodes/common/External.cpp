@@ -1,13 +1,18 @@
 #include "External.h"
 
+#include <algorithm>
 #include <memory>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
 
 #include "system_info.h"
 
 #include "connection/SocketStreamBuf.h"
+#include "io/compressed_stream.h"
+#include "io/primitives.h"
 #include "log.h"
+#include "MessageID.h"
 
 namespace {
 
@@ -34,6 +39,56 @@ namespace {
     Remote as_remote(Remote remote, const std::shared_ptr<Configuration> &) {
         return remote;
     }
+
+    std::vector<std::string> codecs_supported_by_peer(std::iostream &stream) {
+        using namespace Gadgetron::Core;
+
+        IO::write(stream, QUERY);
+        IO::write(stream, uint64_t(0));
+        IO::write(stream, uint64_t(0));
+        IO::write_string_to_stream<uint64_t>(stream, "gadgetron::compression");
+        stream.flush();
+
+        auto id = IO::read<uint16_t>(stream);
+        if (id != RESPONSE) throw std::runtime_error("Unexpected response from peer: " + std::to_string(id));
+        IO::read<uint64_t>(stream);
+        auto answer = IO::read_string_from_stream<uint64_t>(stream);
+
+        // Peers from before compression answer 'Unknown query'.
+        std::vector<std::string> codecs;
+        boost::split(codecs, answer, boost::is_any_of(","));
+        return codecs;
+    }
+
+    std::unique_ptr<std::iostream> negotiate_compression(
+            std::unique_ptr<std::iostream> stream,
+            const std::string &codec,
+            int level
+    ) {
+        using namespace Gadgetron::Core;
+
+        auto local = IO::supported_codecs();
+        if (std::find(local.begin(), local.end(), codec) == local.end()) {
+            GWARN_STREAM("Compression codec " << codec << " is not supported by this build; sending data uncompressed.");
+            return stream;
+        }
+
+        auto remote = codecs_supported_by_peer(*stream);
+        if (std::find(remote.begin(), remote.end(), codec) == remote.end()) {
+            GWARN_STREAM("Peer does not support compression codec " << codec << "; sending data uncompressed.");
+            return stream;
+        }
+
+        IO::write(*stream, COMPRESSION);
+        IO::write_string_to_stream<uint32_t>(*stream, codec);
+        IO::write(*stream, int32_t(level));
+        stream->flush();
+
+        auto compressed = std::make_unique<IO::CompressibleStream>(std::move(stream));
+        compressed->buffer().decompress_input(codec);
+        compressed->buffer().compress_output(codec, level);
+        return std::move(compressed);
+    }
 }
 
 namespace Gadgetron::Server::Connection::Nodes {
@@ -77,6 +132,14 @@ namespace Gadgetron::Server::Connection::Nodes {
     }
 
     std::unique_ptr<std::iostream> connect(const Address &address, std::shared_ptr<Configuration> configuration) {
-        return connect(Core::visit([&](auto address) { return as_remote(address, configuration); }, address));
+        auto stream = connect(Core::visit([&](auto address) { return as_remote(address, configuration); }, address));
+
+        auto &args = configuration->context.args;
+        if (!args.count("distributed_compression")) return stream;
+
+        auto codec = args["distributed_compression"].as<std::string>();
+        if (codec == "none") return stream;
+
+        return negotiate_compression(std::move(stream), codec, args["distributed_compression_level"].as<int>());
     }
 }
@@ -30,5 +30,8 @@ namespace Gadgetron::Server::Connection::Nodes {
     std::unique_ptr<std::iostream> listen(std::string port);
     std::unique_ptr<std::iostream> connect(const std::string &address, const std::string &port);
     std::unique_ptr<std::iostream> connect(const Remote &remote);
+
+    /// Connects to a distributed worker; traffic is compressed if the distributed_compression option asks for it, and
+    /// the worker supports the codec.
     std::unique_ptr<std::iostream> connect(const Address &address, std::shared_ptr<Configuration> configuration);
 }
\ No newline at end of file
@@ -7,10 +7,39 @@
 
 using namespace Gadgetron::Core;
 
+namespace {
+
+    // Passes everything straight through to another buffer, counting the bytes written.
+    class CountingBuffer : public std::streambuf {
+    public:
+        explicit CountingBuffer(std::streambuf *buffer) : buffer(buffer) {}
+        size_t count = 0;
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+            auto result = buffer->sputc(traits_type::to_char_type(ch));
+            if (!traits_type::eq_int_type(result, traits_type::eof())) count++;
+            return result;
+        }
+
+        std::streamsize xsputn(const char *data, std::streamsize n) override {
+            auto written = buffer->sputn(data, n);
+            count += written;
+            return written;
+        }
+
+        int sync() override { return buffer->pubsync(); }
+
+    private:
+        std::streambuf *const buffer;
+    };
+}
+
 namespace Gadgetron::Server::Connection::Nodes {
 
     class ExternalChannel::Outbound::Closed : public ExternalChannel::Outbound {
-        void push(Core::Message message) override { throw Core::ChannelClosed(); }
+        size_t push(Core::Message message) override { throw Core::ChannelClosed(); }
         void close() override {}
     };
 
@@ -23,14 +52,22 @@ namespace Gadgetron::Server::Connection::Nodes {
     public:
         explicit Open(ExternalChannel *channel) : channel(channel) {}
 
-        void push(Core::Message message) override {
+        size_t push(Core::Message message) override {
             std::lock_guard<std::mutex> guard{channel->mutex};
-            channel->serialization->write(*channel->stream, std::move(message));
+
+            CountingBuffer buffer(channel->stream->rdbuf());
+            std::iostream stream(&buffer);
+            channel->serialization->write(stream, std::move(message));
+            stream.flush();
+            channel->stream->setstate(stream.rdstate());
+
+            return buffer.count;
         }
 
         void close() override {
             std::lock_guard<std::mutex> guard{channel->mutex};
             channel->serialization->close(*channel->stream);
+            channel->stream->flush();
             channel->outbound = std::make_unique<Outbound::Closed>();
         }
     private:
@@ -85,14 +122,15 @@ namespace Gadgetron::Server::Connection::Nodes {
             std::shared_ptr<Configuration> configuration
     ) : ExternalChannel(std::move(stream), std::move(serialization)) {
         configuration->send(*this->stream);
+        this->stream->flush();
     }
 
     Core::Message ExternalChannel::pop() {
         return inbound->pop();
     }
 
-    void ExternalChannel::push_message(Core::Message message) {
-        outbound->push(std::move(message));
+    size_t ExternalChannel::push_message(Core::Message message) {
+        return outbound->push(std::move(message));
     }
 
     void ExternalChannel::close() {
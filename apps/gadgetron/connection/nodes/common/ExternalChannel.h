@@ -29,7 +29,9 @@ namespace Gadgetron::Server::Connection::Nodes {
         );
 
         Core::Message pop();
-        void push_message(Core::Message message);
+
+        /// Returns the number of bytes the message took up on the wire.
+        size_t push_message(Core::Message message);
         void close();
         bool accepts(const Core::Message& message);
 
@@ -42,7 +44,7 @@ namespace Gadgetron::Server::Connection::Nodes {
         class Outbound {
         public:
             virtual ~Outbound() = default;
-            virtual void push(Core::Message message) = 0;
+            virtual size_t push(Core::Message message) = 0;
             virtual void close() = 0;
 
             class Open; class Closed;
@@ -0,0 +1,211 @@
+#include "ParallelRunner.h"
+
+#include "ThreadPool.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+
+using namespace Gadgetron::Core;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Counting semaphore with an adjustable limit. Closing it wakes everybody up, and makes acquire fail.
+     */
+    class Limit {
+    public:
+        explicit Limit(size_t limit) : limit(limit) {}
+
+        bool acquire() {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return closed || count < limit; });
+            if (closed) return false;
+            count++;
+            return true;
+        }
+
+        void release() {
+            std::lock_guard<std::mutex> guard(mutex);
+            count--;
+            changed.notify_all();
+        }
+
+        void set_limit(size_t new_limit) {
+            std::lock_guard<std::mutex> guard(mutex);
+            limit = new_limit;
+            changed.notify_all();
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> guard(mutex);
+            closed = true;
+            changed.notify_all();
+        }
+
+        void wait_until_idle() {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return count == 0; });
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        size_t limit;
+        size_t count = 0;
+        bool closed  = false;
+    };
+
+    double seconds(Clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    void update(double &average, double sample) {
+        constexpr double weight = 0.1;
+        average = average < 0 ? sample : (1 - weight) * average + weight * sample;
+    }
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    void WorkerScaling::arrived(Clock::duration wait) {
+        std::lock_guard<std::mutex> guard(mutex);
+        update(interarrival, seconds(wait));
+    }
+
+    void WorkerScaling::processed(Clock::duration duration) {
+        std::lock_guard<std::mutex> guard(mutex);
+        update(latency, seconds(duration));
+    }
+
+    size_t WorkerScaling::workers() {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (latency <= 0) return 1;
+        if (interarrival * max_workers <= latency) return max_workers;
+        // One worker more than the estimate absorbs jitter in the input rate.
+        auto needed = size_t(std::ceil(latency / interarrival)) + 1;
+        return std::clamp<size_t>(needed, 1, max_workers);
+    }
+
+    struct ParallelRunner::State {
+        State(size_t max_workers, size_t window, bool adaptive)
+            : max_workers(max_workers), window(window),
+              workers(adaptive ? 1 : max_workers), scaling(max_workers) {}
+
+        // Outstanding tasks reference the state, so it cannot go away before they are done.
+        ~State() { workers.wait_until_idle(); }
+
+        const size_t max_workers;
+        Queue queue;
+        Limit window;
+        Limit workers;
+        WorkerScaling scaling;
+    };
+
+    ParallelRunner::ParallelRunner(std::function<Message(Message)> function, Settings settings)
+        : function(std::move(function)), settings(settings) {}
+
+    void ParallelRunner::process_input(GenericInputChannel input, State &state) const {
+
+        auto &pool = ThreadPool::shared();
+        size_t current_workers = settings.adaptive ? 1 : state.max_workers;
+
+        struct Release {
+            Limit &limit;
+            ~Release() { limit.release(); }
+        };
+
+        auto process = [this, &state](Message message) {
+            auto start  = Clock::now();
+            auto result = function(std::move(message));
+            state.scaling.processed(Clock::now() - start);
+            return result;
+        };
+
+        auto submit = [&](Message message) {
+            // The pool is shared by every connection; the worker limit of the node caps how many of its messages
+            // are processed concurrently.
+            state.workers.acquire();
+
+            if (settings.ordered) {
+                state.queue.push(pool.async([&state, process](Message message) {
+                    Release release{state.workers};
+                    return process(std::move(message));
+                }, std::move(message)));
+                return;
+            }
+
+            pool.post([&state, process, message = std::move(message)]() mutable {
+                // Released after the result is queued, so the queue is not closed before the result is in it.
+                Release release{state.workers};
+                std::promise<Message> result;
+                try {
+                    result.set_value(process(std::move(message)));
+                } catch (...) {
+                    result.set_exception(std::current_exception());
+                }
+                state.queue.push(result.get_future());
+            });
+        };
+
+        try {
+            while (true) {
+                auto begin   = Clock::now();
+                auto message = input.pop();
+                state.scaling.arrived(Clock::now() - begin);
+
+                if (settings.adaptive) {
+                    auto target = state.scaling.workers();
+                    if (target != current_workers) {
+                        GDEBUG_STREAM("ParallelProcess: scaling from " << current_workers << " to " << target
+                                                                       << " workers");
+                        state.workers.set_limit(target);
+                        current_workers = target;
+                    }
+                }
+
+                // The window is released by the output, once the result has been sent on.
+                if (!state.window.acquire()) break;
+                submit(std::move(message));
+            }
+        } catch (const ChannelClosed &) {}
+
+        state.workers.wait_until_idle();
+        state.queue.close();
+    }
+
+    void ParallelRunner::process_output(OutputChannel output, State &state) const {
+        // If sending fails, the input must stop waiting for room in the window.
+        struct Close {
+            Limit &window;
+            ~Close() { window.close(); }
+        } close{state.window};
+
+        while (true) {
+            output.push_message(state.queue.pop().get());
+            state.window.release();
+        }
+    }
+
+    void ParallelRunner::process(GenericInputChannel input,
+            OutputChannel output,
+            ErrorHandler& error_handler
+    ) const {
+        const size_t max_workers = settings.workers ? settings.workers : ThreadPool::shared().size();
+        State state{max_workers, settings.window ? settings.window : 4 * max_workers, settings.adaptive};
+
+        auto input_thread = error_handler.run(
+                [&](auto input) { this->process_input(std::move(input), state); },
+                std::move(input)
+        );
+
+        auto output_thread = error_handler.run(
+                [&](auto output) { this->process_output(std::move(output), state); },
+                std::move(output)
+        );
+
+        input_thread.join(); output_thread.join();
+    }
+}
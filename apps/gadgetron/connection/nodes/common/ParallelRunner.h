@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+
+#include "Channel.h"
+#include "MPMCChannel.h"
+#include "connection/Core.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Estimates how many workers are needed to keep up with the input.
+     *
+     * By Little's law, the number of messages in processing is the arrival rate times the processing time. Both are
+     * tracked as exponentially weighted averages; the time between arrivals only counts the time spent waiting for
+     * the input, so a backlog upstream reads as arbitrarily fast input and scales the workers up to the maximum.
+     */
+    class WorkerScaling {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit WorkerScaling(size_t max_workers) : max_workers(max_workers) {}
+
+        void arrived(Clock::duration wait);
+        void processed(Clock::duration duration);
+
+        size_t workers();
+
+    private:
+        std::mutex mutex;
+        const size_t max_workers;
+        double interarrival = -1;
+        double latency      = -1;
+    };
+
+    /**
+     * Applies a function to the messages of a channel concurrently, on the shared thread pool.
+     *
+     * At most `workers` messages are processed at a time, and at most `window` messages are held between being
+     * received and being sent on, so a slow consumer throttles the input instead of buffering results. Results are
+     * sent in input order unless `ordered` is off. In adaptive mode, the number of concurrent workers follows a
+     * WorkerScaling estimate, so a node that keeps up with its input leaves the shared pool to other connections.
+     */
+    class ParallelRunner {
+    public:
+        struct Settings {
+            /// Zero means the size of the shared thread pool.
+            size_t workers = 0;
+            /// Zero means four per worker.
+            size_t window = 0;
+            bool ordered = true;
+            bool adaptive = false;
+        };
+
+        ParallelRunner(std::function<Core::Message(Core::Message)> function, Settings settings);
+
+        void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler &error_handler) const;
+
+    private:
+        using Queue = Core::MPMCChannel<std::future<Core::Message>>;
+        struct State;
+
+        void process_input(Core::GenericInputChannel input, State &state) const;
+        void process_output(Core::OutputChannel output, State &state) const;
+
+        const std::function<Core::Message(Core::Message)> function;
+        const Settings settings;
+    };
+}
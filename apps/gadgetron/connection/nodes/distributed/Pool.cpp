@@ -1,10 +1,6 @@
-
 #include "Pool.h"
 
-#include "connection/nodes/common/Discovery.h"
-
 #include "log.h"
-#include "io/iostream_operators.h"
 
 using namespace Gadgetron::Core;
 using namespace Gadgetron::Server::Connection::Nodes;
@@ -12,52 +8,178 @@ using namespace Gadgetron;
 
 namespace {
 
-    bool compare_load(const std::unique_ptr<Worker> &a, const std::unique_ptr<Worker> &b) {
-        return a->current_load() < b->current_load();
+    std::string describe(const std::exception_ptr &error) {
+        try {
+            std::rethrow_exception(error);
+        }
+        catch (const std::exception &e) {
+            return e.what();
+        }
+        catch (...) {
+            return "Unknown error";
+        }
+    }
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    Pool::Pool(
+            std::list<std::unique_ptr<Worker>> workers,
+            size_t jobs_per_worker,
+            size_t attempts
+    ) : jobs_per_worker(std::max<size_t>(jobs_per_worker, 1)), attempts(attempts) {
+        for (auto &worker : workers) members.push_back(Member{std::move(worker)});
+        dispatcher = std::thread([this]() { dispatch(); });
+    }
+
+    Pool::~Pool() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return pending.empty() && !jobs_in_flight; });
+        stopping = true;
+        cv.notify_all();
+        lock.unlock();
+
+        dispatcher.join();
+    }
+
+    std::future<Message> Pool::push(Message message) {
+        auto job = std::make_shared<Job>(Job{std::move(message)});
+        auto response = job->response.get_future();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        pending.push_back(std::move(job));
+        cv.notify_all();
+
+        return response;
     }
 
-    std::unique_ptr<Worker> &select_best_worker(std::list<std::unique_ptr<Worker>> &workers) {
-        return *std::min_element(workers.begin(), workers.end(), compare_load);
+    void Pool::dispatch() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&]() { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+
+            auto member = select_member(*pending.front());
+            if (!member) {
+                auto available = std::any_of(members.begin(), members.end(), [](auto &member) {
+                    return member.worker->load().available;
+                });
+                if (available) {
+                    // Every worker is busy; wait for one to finish a job.
+                    cv.wait(lock);
+                    continue;
+                }
+
+                auto failed = std::move(pending);
+                pending.clear();
+                cv.notify_all();
+                lock.unlock();
+
+                GWARN_STREAM("No workers are available; failing " << failed.size() << " jobs.");
+                for (auto &job : failed) {
+                    job->response.set_exception(
+                            std::make_exception_ptr(std::runtime_error("No workers are available to process the job.")));
+                }
+
+                lock.lock();
+                continue;
+            }
+
+            auto job = std::move(pending.front()); pending.pop_front();
+            member->jobs++; jobs_in_flight++;
+
+            lock.unlock();
+            send(*member, std::move(job));
+            lock.lock();
+        }
     }
 
-    Message send_to_best_worker(
-            Message message,
-            std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers,
-            size_t retries
-    ) {
+    Pool::Member *Pool::select_member(const Job &job) {
+        std::vector<Worker::Load> loads;
+        for (auto &member : members) loads.push_back(member.worker->load());
+
+        // Workers without measurements yet are assumed to be as fast as the others.
+        double measured_rate = 0; size_t measured = 0;
+        for (auto &load : loads) {
+            if (load.available && load.bytes_per_second > 0) {
+                measured_rate += load.bytes_per_second;
+                measured++;
+            }
+        }
+        auto default_rate = measured ? measured_rate / measured : 1.0;
+
+        auto failed_on = [&](const Member &member) {
+            return std::find(job.failed_on.begin(), job.failed_on.end(), &member) != job.failed_on.end();
+        };
+
+        // While another worker is available, a job waits for it rather than going back to a worker that failed it.
+        bool avoid_failed = false;
+        auto load = loads.begin();
+        for (auto &member : members) avoid_failed |= (load++)->available && !failed_on(member);
+
+        Member *best = nullptr;
+        double best_cost = 0;
+        load = loads.begin();
+        for (auto &member : members) {
+            auto &current = *load++;
+            if (!current.available || member.jobs >= jobs_per_worker) continue;
+            if (avoid_failed && failed_on(member)) continue;
 
-        if (!retries) throw std::runtime_error("Multiple workers failed processing job; aborting.");
+            // Jobs just handed to the worker have not been counted in its bytes in flight yet.
+            auto bytes_in_flight = std::max<double>(current.bytes_in_flight, member.jobs * bytes_per_job);
+            auto rate = current.bytes_per_second > 0 ? current.bytes_per_second : default_rate;
+            auto cost = (bytes_in_flight + bytes_per_job) / rate;
 
-        auto &worker = select_best_worker(*workers);
+            if (!best || cost < best_cost || (cost == best_cost && member.jobs < best->jobs)) {
+                best = &member;
+                best_cost = cost;
+            }
+        }
+        return best;
+    }
 
+    void Pool::send(Member &member, std::shared_ptr<Job> job) {
         try {
-            auto response = worker->push(message.clone());
-            GDEBUG_STREAM("Pushed message; waiting for response from worker " << worker->address);
-            auto response_message = response.get();
-            GDEBUG_STREAM("Response gotten from worker " << worker->address);
-            return std::move(response_message);
+            auto bytes = member.worker->push(
+                    job->message.clone(),
+                    [this, &member, job](Message response) { complete(member, job, std::move(response)); },
+                    [this, &member, job](std::exception_ptr error) { fail(member, job, error); }
+            );
+
+            std::lock_guard<std::mutex> guard(mutex);
+            if (bytes) bytes_per_job = bytes_per_job > 0 ? 0.9 * bytes_per_job + 0.1 * bytes : bytes;
         }
-        catch (const std::exception &e) {
-            GWARN_STREAM("Worker " << worker->address << " failed processing job. The job will be retried. [" << e.what() << "]");
-            return send_to_best_worker(std::move(message), std::move(workers), retries - 1);
+        catch (...) {
+            fail(member, std::move(job), std::current_exception());
         }
     }
-}
 
-namespace Gadgetron::Server::Connection::Nodes {
+    void Pool::complete(Member &member, std::shared_ptr<Job> job, Message response) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            member.jobs--; jobs_in_flight--;
+            cv.notify_all();
+        }
 
-    Pool::Pool(
-            std::list<std::unique_ptr<Worker>> workers
-    ) : workers(std::make_shared<std::list<std::unique_ptr<Worker>>>(std::move(workers))) {}
+        job->response.set_value(std::move(response));
+    }
 
-    std::future<Message> Pool::push(Message message) {
-        return std::async(
-                std::launch::async,
-                send_to_best_worker,
-                std::move(message),
-                workers,
-                3
-        );
+    void Pool::fail(Member &member, std::shared_ptr<Job> job, std::exception_ptr error) {
+        GWARN_STREAM("Worker " << member.worker->name() << " failed processing job [" << describe(error) << "]");
+
+        std::unique_lock<std::mutex> lock(mutex);
+        member.jobs--; jobs_in_flight--;
+        cv.notify_all();
+
+        job->failed_on.push_back(&member);
+        if (job->failed_on.size() < attempts) {
+            GWARN_STREAM("The job will be retried.");
+            pending.push_front(std::move(job));
+            return;
+        }
+
+        lock.unlock();
+        job->response.set_exception(
+                std::make_exception_ptr(std::runtime_error("Multiple workers failed processing job; aborting.")));
     }
 }
-
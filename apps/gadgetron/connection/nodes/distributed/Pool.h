@@ -1,13 +1,15 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <list>
 #include <mutex>
 #include <vector>
 #include <memory>
 #include <future>
+#include <thread>
 #include <algorithm>
 
-#include "connection/nodes/common/External.h"
-
 #include "Worker.h"
 
 #include "Message.h"
@@ -15,12 +17,56 @@
 
 namespace Gadgetron::Server::Connection::Nodes {
 
+    /**
+     * Distributes independent jobs over a set of workers.
+     *
+     * Jobs wait in the pool until a worker has room for them, rather than being queued on a worker up front; a worker
+     * that falls behind never holds a backlog that idle workers could have taken. Each worker has at most a few jobs
+     * in flight, and the next job goes to the worker expected to finish it first, judged by the bytes it has in
+     * flight and the throughput measured on its recent jobs.
+     *
+     * Jobs failed by a worker are put back in front of the queue and retried on another worker, up to the given number
+     * of attempts, from the thread receiving the worker's responses; no thread waits on any one job. A job only goes
+     * back to a worker that failed it if no other worker is available.
+     */
     class Pool {
     public:
-        explicit Pool(std::list<std::unique_ptr<Worker>> workers);
+        explicit Pool(std::list<std::unique_ptr<Worker>> workers, size_t jobs_per_worker = 2, size_t attempts = 3);
+
+        /// Waits for all jobs pushed to the pool to finish.
+        ~Pool();
+
         std::future<Core::Message> push(Core::Message message);
 
     private:
-        std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers;
+        struct Member {
+            std::unique_ptr<Worker> worker;
+            size_t jobs = 0;
+        };
+
+        struct Job {
+            Core::Message message;
+            std::promise<Core::Message> response;
+            std::vector<const Member *> failed_on;
+        };
+
+        void dispatch();
+        Member *select_member(const Job &job);
+        void send(Member &member, std::shared_ptr<Job> job);
+        void complete(Member &member, std::shared_ptr<Job> job, Core::Message response);
+        void fail(Member &member, std::shared_ptr<Job> job, std::exception_ptr error);
+
+        const size_t jobs_per_worker;
+        const size_t attempts;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::shared_ptr<Job>> pending;
+        std::list<Member> members;
+        size_t jobs_in_flight = 0;
+        double bytes_per_job = 0;
+        bool stopping = false;
+
+        std::thread dispatcher;
     };
-}
\ No newline at end of file
+}
@@ -1,8 +1,9 @@
 
 #include "Worker.h"
 
+#include <algorithm>
 #include <chrono>
-#include <future>
+#include <sstream>
 
 #include "connection/nodes/common/External.h"
 #include "connection/nodes/common/ExternalChannel.h"
@@ -12,82 +13,66 @@
 using namespace Gadgetron::Core;
 using namespace Gadgetron::Server::Connection::Nodes;
 
-namespace {
-
-    template<class T>
-    std::chrono::milliseconds time_since(std::chrono::time_point<T> instance) {
-        return std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - instance
-        );
-    }
-}
-
 namespace Gadgetron::Server::Connection::Nodes {
 
-    struct Worker::Job {
+    struct RemoteWorker::Job {
+        uint64_t id;
         std::chrono::time_point<std::chrono::steady_clock> start;
-        std::promise<Core::Message> response;
+        size_t bytes;
+        ResponseHandler on_response;
+        FailureHandler on_failure;
     };
 
     struct Module {
-        Worker& worker;
-        explicit Module(Worker &worker) : worker(worker) {}
+        RemoteWorker& worker;
+        explicit Module(RemoteWorker &worker) : worker(worker) {}
         virtual ~Module() = default;
     };
 
-    struct Worker::PushModule : public Module {
+    struct RemoteWorker::PushModule : public Module {
         using Module::Module;
 
-        virtual std::future<Message> push(Message message) {
+        virtual void push(Job job) {
             GDEBUG_STREAM("Pushing message to remote worker " << worker.address);
-
-            Job job {
-                    std::chrono::steady_clock::now(),
-                    std::promise<Message>()
-            };
-
-            auto future = job.response.get_future();
-            worker.channel->push_message(std::move(message));
             worker.jobs.push_back(std::move(job));
-            return future;
         };
     };
 
-    struct Worker::LoadModule : public Module {
+    struct RemoteWorker::LoadModule : public Module {
         using Module::Module;
 
-        virtual long long current_load() {
-            auto current_job_duration_estimate = std::max(
-                    worker.timing.latest.count(),
-                    time_since(worker.jobs.front().start).count()
-            );
-
-            return current_job_duration_estimate * worker.jobs.size();
+        virtual Load load() {
+            return Load{
+                true,
+                worker.jobs.size(),
+                worker.throughput.bytes_in_flight,
+                worker.throughput.bytes_per_second
+            };
         };
     };
 
-    struct Worker::ClosedPushModule : public Worker::PushModule {
-        using Worker::PushModule::PushModule;
-        std::future<Message> push(Message message) override {
+    struct RemoteWorker::ClosedPushModule : public RemoteWorker::PushModule {
+        using RemoteWorker::PushModule::PushModule;
+        void push(Job job) override {
             throw std::runtime_error("Cannot push message to closed/failed worker.");
         }
     };
 
-    struct Worker::ClosedLoadModule : public Worker::LoadModule {
-        using Worker::LoadModule::LoadModule;
-        long long current_load() override { return std::numeric_limits<long long>::max(); }
+    struct RemoteWorker::ClosedLoadModule : public RemoteWorker::LoadModule {
+        using RemoteWorker::LoadModule::LoadModule;
+        Load load() override { return Load{false, worker.jobs.size(), 0, 0}; }
     };
 }
 
 
 namespace Gadgetron::Server::Connection::Nodes {
 
-    Worker::~Worker() {
+    RemoteWorker::~RemoteWorker() {
         channel->close();
         inbound_thread.join();
     }
 
-    Worker::Worker(
+    RemoteWorker::RemoteWorker(
             Address address,
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration
@@ -106,52 +91,116 @@ namespace Gadgetron::Server::Connection::Nodes {
         inbound_thread = std::thread([=]() { handle_inbound_messages(); });
     }
 
-    long long Worker::current_load() const {
+    RemoteWorker::Load RemoteWorker::load() const {
         std::lock_guard<std::mutex> guard(mutex);
-        return load_module->current_load();
+        return load_module->load();
     }
 
-    std::future<Message> Worker::push(Message message) {
+    size_t RemoteWorker::push(Message message, ResponseHandler on_response, FailureHandler on_failure) {
+        // Jobs are answered in the order they are sent, so the job is queued and the message sent in one go. The job
+        // is queued first, as the response may arrive before the message has been written in full.
+        std::lock_guard<std::mutex> send_guard(send_mutex);
+
+        auto id = next_job_id++;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            push_module->push(Job{id, std::chrono::steady_clock::now(), 0, std::move(on_response), std::move(on_failure)});
+        }
+
+        auto find_job = [&]() {
+            return std::find_if(jobs.begin(), jobs.end(), [&](auto &job) { return job.id == id; });
+        };
+
+        size_t bytes;
+        try {
+            bytes = channel->push_message(std::move(message));
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> guard(mutex);
+            // If the worker failed meanwhile, the job has been failed along with the others; don't report it twice.
+            auto job = find_job();
+            if (job == jobs.end()) return 0;
+            jobs.erase(job);
+            throw;
+        }
+
         std::lock_guard<std::mutex> guard(mutex);
-        return push_module->push(std::move(message));
+        auto job = find_job();
+        if (job != jobs.end()) {
+            job->bytes = bytes;
+            throughput.bytes_in_flight += bytes;
+        }
+        return bytes;
     }
 
-    void Worker::close() {
+    void RemoteWorker::close() {
         std::lock_guard<std::mutex> guard(mutex);
         channel->close();
     }
 
-    void Worker::handle_inbound_messages() {
+    std::string RemoteWorker::name() const {
+        std::stringstream stream;
+        stream << address;
+        return stream.str();
+    }
+
+    void RemoteWorker::handle_inbound_messages() {
+        auto error = std::make_exception_ptr(std::runtime_error("Worker closed before responding to all jobs."));
         try {
             while(true) process_inbound_message(channel->pop());
         }
         catch (const ChannelClosed &) {}
         catch (const std::exception &e) {
             GWARN_STREAM("Worker " << address << " failed: " << e.what());
-            fail_pending_messages(std::current_exception());
+            error = std::current_exception();
         }
+
+        // Closed first, so jobs failed here are not retried on this worker.
         switch_to_closed_modules();
+        fail_pending_messages(error);
     }
 
-    void Worker::process_inbound_message(Core::Message message) {
+    void RemoteWorker::process_inbound_message(Core::Message message) {
         GDEBUG_STREAM("Received message from remote worker " << address);
 
-        std::lock_guard<std::mutex> guard(mutex);
+        Job job;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (jobs.empty()) throw std::runtime_error("Received message from worker without a pending job.");
+
+            job = std::move(jobs.front()); jobs.pop_front();
+
+            // The worker handles jobs one at a time, so a job has only been worked on since the previous response
+            // if it was sent before that.
+            auto now = std::chrono::steady_clock::now();
+            auto busy = std::chrono::duration<double>(now - std::max(job.start, throughput.latest_response)).count();
+            throughput.latest_response = now;
+
+            if (job.bytes) {
+                auto rate = job.bytes / std::max(busy, 1e-3);
+                throughput.bytes_in_flight -= std::min(throughput.bytes_in_flight, job.bytes);
+                throughput.bytes_per_second = throughput.bytes_per_second > 0 ?
+                        0.7 * throughput.bytes_per_second + 0.3 * rate :
+                        rate;
+            }
+        }
 
-        auto job = std::move(jobs.front()); jobs.pop_front();
-        timing.latest = time_since(job.start);
-        job.response.set_value(std::move(message));
+        // Handlers may push more work, so they are called without holding the lock.
+        job.on_response(std::move(message));
     }
 
-    void Worker::fail_pending_messages(const std::exception_ptr &e) {
-        std::lock_guard<std::mutex> guard(mutex);
-
-        for (auto &job : jobs) {
-            job.response.set_exception(e);
+    void RemoteWorker::fail_pending_messages(const std::exception_ptr &e) {
+        std::list<Job> failed;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            failed.swap(jobs);
+            throughput.bytes_in_flight = 0;
         }
+
+        for (auto &job : failed) job.on_failure(e);
     }
 
-    void Worker::switch_to_closed_modules() {
+    void RemoteWorker::switch_to_closed_modules() {
         std::lock_guard<std::mutex> guard(mutex);
         load_module = std::make_unique<ClosedLoadModule>(*this);
         push_module = std::make_unique<ClosedPushModule>(*this);
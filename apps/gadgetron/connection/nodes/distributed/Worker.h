@@ -1,8 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <future>
+#include <string>
 
 #include "connection/Core.h"
 #include "connection/nodes/common/Serialization.h"
@@ -14,29 +16,62 @@
 
 namespace Gadgetron::Server::Connection::Nodes {
 
+    /// Something a Pool can send jobs to; in practice a RemoteWorker.
     class Worker {
+    public:
+        virtual ~Worker() = default;
+
+        using ResponseHandler = std::function<void(Core::Message)>;
+        using FailureHandler = std::function<void(std::exception_ptr)>;
+
+        /**
+         * Sends the message to the worker. One of the handlers is called, from the thread receiving messages from
+         * the worker, once it has responded or failed. Returns the number of bytes sent.
+         */
+        virtual size_t push(Core::Message message, ResponseHandler on_response, FailureHandler on_failure) = 0;
+
+        struct Load {
+            bool available;
+            size_t jobs;
+            size_t bytes_in_flight;
+            double bytes_per_second; // Measured over recent jobs; 0 until the first response.
+        };
+        virtual Load load() const = 0;
+
+        virtual void close() = 0;
+
+        /// Identifies the worker in log messages.
+        virtual std::string name() const = 0;
+    };
+
+    class RemoteWorker : public Worker {
     public:
         const Address address;
 
-        ~Worker();
-        Worker(
+        ~RemoteWorker() override;
+        RemoteWorker(
                 Address address,
                 std::shared_ptr<Serialization> serialization,
                 std::shared_ptr<Configuration> configuration
         );
 
-        std::future<Core::Message> push(Core::Message message);
-        long long current_load() const;
-        void close();
+        size_t push(Core::Message message, ResponseHandler on_response, FailureHandler on_failure) override;
+        Load load() const override;
+        void close() override;
+        std::string name() const override;
 
     private:
         mutable std::mutex mutex;
+        std::mutex send_mutex;
+        uint64_t next_job_id = 0;
 
         std::thread inbound_thread;
 
-        struct Timing {
-            std::chrono::milliseconds latest = std::chrono::seconds(5);
-        } timing;
+        struct Throughput {
+            std::chrono::steady_clock::time_point latest_response;
+            size_t bytes_in_flight = 0;
+            double bytes_per_second = 0;
+        } throughput;
 
         struct Job;
         std::list<Job> jobs;
@@ -18,7 +18,8 @@ namespace Gadgetron::Server::Connection::Nodes {
     boost::process::child start_julia_module(
         const Config::Execute &execute,
         unsigned short port,
-        const StreamContext &context
+        const StreamContext &context,
+        const std::map<std::string, std::string> &environment
     ) {
         if (!execute.target) throw std::invalid_argument("Target must be specified for Julia modules");
 
@@ -33,6 +34,8 @@ namespace Gadgetron::Server::Connection::Nodes {
 
         env.set("GADGETRON_STORAGE_ADDRESS",context.storage_address);
 
+        for (auto &[key, value] : environment) env.set(key, value);
+
         auto module = Process::child(
                 boost::process::search_path("julia"),
                 boost::process::args = args,
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <map>
+#include <string>
+
 #include <boost/process.hpp>
 
 #include "connection/config/Config.h"
@@ -10,7 +13,8 @@ namespace Gadgetron::Server::Connection::Nodes {
     boost::process::child start_julia_module(
         const Config::Execute &,
         unsigned short port,
-        const Gadgetron::Core::StreamContext &
+        const Gadgetron::Core::StreamContext &,
+        const std::map<std::string, std::string> &environment
     );
     bool julia_available() noexcept;
 }
@@ -11,13 +11,15 @@ namespace Gadgetron::Server::Connection::Nodes {
     boost::process::child start_matlab_module(
         const Config::Execute &execute,
         unsigned short port,
-        const Gadgetron::Core::StreamContext &context
+        const Gadgetron::Core::StreamContext &context,
+        const std::map<std::string, std::string> &environment
     ) {
 
         auto env = boost::this_process::environment();
         env.set("GADGETRON_EXTERNAL_PORT",std::to_string(port));
         env.set("GADGETRON_EXTERNAL_MODULE",execute.name);
         env.set("GADGETRON_STORAGE_ADDRESS", context.storage_address);
+        for (auto &[key, value] : environment) env.set(key, value);
 
         auto module = Process::child(
                 boost::process::search_path("matlab"),
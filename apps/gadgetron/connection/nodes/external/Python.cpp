@@ -76,7 +76,8 @@ namespace Gadgetron::Server::Connection::Nodes {
     boost::process::child start_python_module(
         const Config::Execute &execute,
         unsigned short port,
-        const StreamContext &context
+        const StreamContext &context,
+        const std::map<std::string, std::string> &environment
     ) {
         auto python_path = (context.paths.gadgetron_home / "share" / "gadgetron" / "python").string();
 
@@ -99,6 +100,8 @@ namespace Gadgetron::Server::Connection::Nodes {
         
         env.set("GADGETRON_STORAGE_ADDRESS",context.storage_address);
 
+        for (auto &[key, value] : environment) env.set(key, value);
+
         auto module = Process::child(
                 boost::process::search_path(get_python_executable()),
                 boost::process::args = args,
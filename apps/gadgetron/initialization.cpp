@@ -1,8 +1,10 @@
 
 #include "log.h"
 #include "initialization.h"
+#include "hoNDFFT.h"
 
 #include <cstdlib>
+#include <mutex>
 #include <string>
 
 #include <boost/algorithm/string.hpp>
@@ -11,6 +13,23 @@
 #include <cblas.h>
 #endif
 #include <locale>
+
+namespace {
+    boost::filesystem::path wisdom_directory;
+    std::once_flag wisdom_saved;
+
+    void save_fft_wisdom() {
+        std::call_once(wisdom_saved, []() {
+            try {
+                if (!Gadgetron::FFT::export_wisdom(wisdom_directory)) {
+                    GDEBUG_STREAM("Could not save FFTW wisdom to " << wisdom_directory);
+                }
+            } catch (...) {
+            }
+        });
+    }
+}
+
 namespace Gadgetron::Server {
 
     void configure_blas_libraries() {
@@ -48,4 +67,21 @@ namespace Gadgetron::Server {
             std::locale::global(std::locale::classic());
         }
     }
+
+    void configure_fft(const boost::program_options::variables_map& args) {
+        auto rigor = FFT::planning_rigor_from_string(args["fft_planning"].as<std::string>());
+        FFT::set_planning_rigor(rigor);
+
+        // Wisdom shipped with an installation is read, but only ever written to the user's own directory.
+        wisdom_directory = args["fft_wisdom_dir"].as<boost::filesystem::path>();
+        for (auto& directory : { args["home"].as<boost::filesystem::path>() / "share" / "gadgetron" / "fftw",
+                                 wisdom_directory }) {
+            if (FFT::import_wisdom(directory)) {
+                GINFO_STREAM("Loaded FFTW wisdom from " << directory);
+            }
+        }
+
+        std::atexit(save_fft_wisdom);
+        std::at_quick_exit(save_fft_wisdom);
+    }
 }
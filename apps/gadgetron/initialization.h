@@ -1,5 +1,8 @@
 #pragma once
 
+#include <boost/filesystem/path.hpp>
+#include <boost/program_options/variables_map.hpp>
+
 namespace Gadgetron::Server {
     void configure_blas_libraries();
 
@@ -7,4 +10,9 @@ namespace Gadgetron::Server {
 
     void set_locale();
 
-}
\ No newline at end of file
+    /**
+     * Sets the FFT planning rigor and loads FFTW wisdom. New wisdom is saved once, when the process exits; a forked
+     * connection process saves its own on quick_exit.
+     */
+    void configure_fft(const boost::program_options::variables_map& args);
+}
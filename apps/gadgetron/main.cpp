@@ -13,6 +13,8 @@
 
 #include "Server.h"
 #include "StreamConsumer.h"
+#include "connection/SocketStreamBuf.h"
+#include "connection/core/Tracing.h"
 
 
 using namespace boost::filesystem;
@@ -55,6 +57,53 @@ int main(int argc, char *argv[]) {
             ("port,p",
                 value<unsigned short>()->default_value(9002),
                 "Listen for incoming connections on this port.")
+            ("max_connections",
+                value<unsigned int>()->default_value(0),
+                "Maximum number of connections handled concurrently. Additional connections are queued. "
+                "0 means no limit.")
+            ("connection_queue_timeout",
+                value<unsigned int>()->default_value(300),
+                "Seconds a queued connection may wait to be admitted before it is closed.")
+            ("socket_buffer_size",
+                value<size_t>()->default_value(Gadgetron::Connection::default_socket_buffer_size),
+                "Size in bytes of the send and receive buffers of each connection. "
+                "Larger reads go straight into the destination memory.")
+            ("external_shared_memory",
+                value<size_t>()->default_value(0),
+                "Size in bytes of each direction of a shared memory ring offered to external modules started by the "
+                "Gadgetron. Modules that attach to it exchange messages through it rather than over TCP; others keep "
+                "using TCP. Messages are serialized as over TCP, so array data is still copied on each side. No "
+                "Python, Julia or MATLAB module attaches to it yet. 0 disables shared memory.")
+            ("distributed_compression",
+                value<std::string>()->default_value("none"),
+                "Compress traffic to and from distributed workers with this codec, if the workers support it: none, "
+                "zstd, or zstd-shuffle, which groups the bytes of 32 bit values first and usually does better on "
+                "float data. Compression is lossless.")
+            ("distributed_compression_level",
+                value<int>()->default_value(1),
+                "Compression level for distributed traffic. Negative levels compress faster, at a lower ratio.")
+            ("fft_planning",
+                value<std::string>()->default_value("estimate"),
+                "FFTW planning rigor: estimate, measure or patient. Plans are cached, and measured plans are saved "
+                "as wisdom when the process exits.")
+            ("fft_wisdom_dir",
+                value<path>()->default_value(default_fft_wisdom_folder()),
+                "Directory in which to save FFTW wisdom. Wisdom is read from here, and from share/gadgetron/fftw "
+                "in the Gadgetron home directory.")
+            ("trace_dir",
+                value<path>(),
+                "Trace every connection, and write the traces to this directory. A trace records when each node is "
+                "busy or waiting, how messages flow between nodes and how full the channels are, and can be viewed "
+                "in chrome://tracing or Perfetto. Tracing is disabled if no directory is given.")
+            ("trace_max_events",
+                value<size_t>()->default_value(Gadgetron::Server::Connection::Tracer::default_max_events),
+                "Maximum number of events kept in the trace of a connection. Later events are left out of the trace, "
+                "but still count towards the per-node summary.")
+            ("preload_config",
+                value<std::vector<std::string>>(),
+                "Read this config, and load the libraries its readers, writers and gadgets come from, when the server "
+                "starts, rather than for each connection that uses it. May be given more than once. Libraries that "
+                "initialise a GPU when they are loaded should not be preloaded, as connections run in forked processes.")
             ("from_stream, s",
                 "Perform reconstruction from a local data stream")
             ("input_path,i",
@@ -89,7 +138,15 @@ int main(int argc, char *argv[]) {
                 "Directory in which to store the storage server database.")
             ("storage_dir,S",
                 value<path>()->default_value(default_storage_folder()),
-                "Directory in which to store data blobs.");
+                "Directory in which to store data blobs.")
+            ("storage_cache_dir",
+                value<path>()->default_value(default_storage_cache_folder()),
+                "Directory in which to keep local copies of items read from and stored to the storage server.")
+            ("storage_cache_ttl",
+                value<unsigned int>()->default_value(0),
+                "Seconds a local copy of an item is used before the storage server is asked again. "
+                "Items stored on this host replace their local copies straight away, but items stored by other "
+                "hosts are not seen until the local copy expires. 0, the default, disables the cache.");
 
     options_description desc;
     desc
@@ -104,6 +161,7 @@ int main(int argc, char *argv[]) {
         check_environment_variables();
         configure_blas_libraries();
         set_locale();
+        configure_fft(args);
 
         if (args.count("help")) {
             GINFO_STREAM(desc);
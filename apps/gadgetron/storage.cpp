@@ -13,6 +13,7 @@
 
 #include "IsmrmrdContextVariables.h"
 #include "Process.h"
+#include "StorageCache.h"
 #include "gadgetron_paths.h"
 #include "log.h"
 
@@ -82,8 +83,25 @@ std::tuple<std::string, std::optional<boost::process::child>> ensure_storage_ser
     return {uri, std::move(process)};
 }
 
-StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header) {
+std::shared_ptr<StorageClient> create_storage_client(const std::string& address, const variables_map& args) {
     auto client = std::make_shared<StorageClient>(address);
+    if (address.empty() || !args.count("storage_cache_ttl") || !args["storage_cache_ttl"].as<unsigned int>()) {
+        return client;
+    }
+
+    try {
+        return std::make_shared<CachingStorageClient>(
+            client, args["storage_cache_dir"].as<path>(),
+            std::chrono::seconds(args["storage_cache_ttl"].as<unsigned int>()));
+    } catch (filesystem_error const& e) {
+        GWARN_STREAM("Storage cache is unavailable, reading from the storage server directly: " << e.what());
+        return client;
+    }
+}
+
+StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header,
+                                   const variables_map& args) {
+    auto client = create_storage_client(address, args);
     IsmrmrdContextVariables variables(header);
     auto ttl = std::chrono::hours(48);
 
@@ -0,0 +1,290 @@
+#include "FakeStorageServer.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <date/date.h>
+#include <nlohmann/json.hpp>
+
+namespace ba = boost::asio;
+using tcp = ba::ip::tcp;
+using json = nlohmann::json;
+
+namespace {
+
+std::string decode(std::string const& encoded) {
+    std::string decoded;
+    for (size_t i = 0; i < encoded.size(); i++) {
+        if (encoded[i] == '%' && i + 2 < encoded.size()) {
+            decoded += char(std::stoi(encoded.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else if (encoded[i] == '+') {
+            decoded += ' ';
+        } else {
+            decoded += encoded[i];
+        }
+    }
+    return decoded;
+}
+
+std::multimap<std::string, std::string> parse_query(std::string const& query) {
+    std::multimap<std::string, std::string> parameters;
+    std::stringstream stream(query);
+    std::string parameter;
+    while (std::getline(stream, parameter, '&')) {
+        auto equals = parameter.find('=');
+        if (equals == std::string::npos) {
+            parameters.emplace(decode(parameter), "");
+        } else {
+            parameters.emplace(decode(parameter.substr(0, equals)), decode(parameter.substr(equals + 1)));
+        }
+    }
+    return parameters;
+}
+
+std::string format_time(std::chrono::system_clock::time_point time) {
+    return date::format("%FT%TZ", date::floor<std::chrono::seconds>(time));
+}
+
+std::string reason(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 400: return "Bad Request";
+    default: return "Not Found";
+    }
+}
+
+} // namespace
+
+namespace Gadgetron::Testing {
+
+FakeStorageServer::FakeStorageServer() : acceptor(ios, tcp::endpoint(ba::ip::address_v4::loopback(), 0)) {
+    thread = std::thread([this]() { serve(); });
+}
+
+FakeStorageServer::~FakeStorageServer() {
+    stopping = true;
+
+    // Wakes the accepting thread up, so it sees that the server is stopping.
+    boost::system::error_code ignored;
+    tcp::socket wake(ios);
+    wake.connect(acceptor.local_endpoint(), ignored);
+
+    thread.join();
+    for (auto& connection : connections) {
+        connection.join();
+    }
+}
+
+std::string FakeStorageServer::address() const {
+    return "http://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port());
+}
+
+size_t FakeStorageServer::items() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return stored.size();
+}
+
+void FakeStorageServer::serve() {
+    while (true) {
+        auto socket = std::make_shared<tcp::socket>(ios);
+        boost::system::error_code error;
+        acceptor.accept(*socket, error);
+        if (stopping) {
+            return;
+        }
+        if (error) {
+            continue;
+        }
+
+        // Each connection gets a thread, so a client slowly reading one item does not hold up other requests.
+        connections.emplace_back([this, socket]() {
+            try {
+                handle(*socket);
+            } catch (std::exception const&) {
+                // The client went away, as when an upload is aborted.
+            }
+        });
+    }
+}
+
+void FakeStorageServer::handle(tcp::socket& socket) {
+    ba::streambuf buffer;
+    std::istream stream(&buffer);
+    ba::read_until(socket, buffer, "\r\n\r\n");
+
+    std::string method, target, line;
+    stream >> method >> target;
+    std::getline(stream, line);
+
+    size_t content_length = 0;
+    bool chunked = false;
+    while (std::getline(stream, line) && line != "\r") {
+        auto colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+
+        auto name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        auto value = line.substr(colon + 1);
+        if (name == "content-length") {
+            content_length = std::stoul(value);
+        }
+        if (name == "transfer-encoding" && value.find("chunked") != std::string::npos) {
+            chunked = true;
+        }
+    }
+
+    auto read_exactly = [&](size_t size) {
+        if (buffer.size() < size) {
+            ba::read(socket, buffer, ba::transfer_exactly(size - buffer.size()));
+        }
+        std::string data(size, '\0');
+        stream.read(data.data(), size);
+        return data;
+    };
+
+    std::string body;
+    if (chunked) {
+        while (true) {
+            ba::read_until(socket, buffer, "\r\n");
+            std::getline(stream, line);
+            auto size = std::stoul(line, nullptr, 16);
+            if (!size) {
+                ba::read_until(socket, buffer, "\r\n");
+                std::getline(stream, line);
+                break;
+            }
+            body += read_exactly(size + 2).substr(0, size);
+        }
+    } else {
+        body = read_exactly(content_length);
+    }
+
+    auto question_mark = target.find('?');
+    auto path = target.substr(0, question_mark);
+    auto query = question_mark == std::string::npos ? std::multimap<std::string, std::string>{}
+                                                    : parse_query(target.substr(question_mark + 1));
+
+    auto response = respond(method, path, query, std::move(body));
+
+    std::stringstream header;
+    header << "HTTP/1.1 " << response.status << " " << reason(response.status) << "\r\n"
+           << "Content-Type: " << response.content_type << "\r\n"
+           << "Content-Length: " << response.body.size() << "\r\n"
+           << "Connection: close\r\n\r\n";
+    ba::write(socket, ba::buffer(header.str()));
+    ba::write(socket, ba::buffer(response.body));
+}
+
+FakeStorageServer::Response FakeStorageServer::respond(std::string const& method, std::string const& path,
+                                                       std::multimap<std::string, std::string> const& query,
+                                                       std::string body) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto now = std::chrono::system_clock::now();
+
+    if (method == "GET" && path == "/healthcheck") {
+        return {200, ""};
+    }
+
+    if (method == "POST" && path == "/v1/blobs/data") {
+        Item item{{}, std::move(body), now, std::nullopt};
+        for (auto& [name, value] : query) {
+            if (name == "_ttl") {
+                item.expires = now + std::chrono::seconds(std::stoul(value));
+            } else if (name.rfind('_', 0) != 0) {
+                item.tags.emplace(name, value);
+            }
+        }
+
+        if (!item.tags.count("subject")) {
+            return {400, "A subject is required"};
+        }
+
+        stored.push_back(std::move(item));
+        return {201, describe(stored.size() - 1), "application/json"};
+    }
+
+    if (method == "GET" && path == "/v1/blobs/data/latest") {
+        auto items = matching(query);
+        if (items.empty()) {
+            return {404, ""};
+        }
+
+        data_requests_++;
+        return {200, stored[items.back()].data};
+    }
+
+    if (method == "GET" && path == "/v1/blobs") {
+        auto items = matching(query);
+        auto limit = query.count("_limit") ? std::stoul(query.find("_limit")->second) : size_t(20);
+
+        auto list = json::array();
+        for (auto it = items.rbegin(); it != items.rend() && list.size() < limit; ++it) {
+            list.push_back(json::parse(describe(*it)));
+        }
+        return {200, json{{"items", list}}.dump(), "application/json"};
+    }
+
+    std::string prefix = "/v1/blobs/", suffix = "/data";
+    if (method == "GET" && path.rfind(prefix, 0) == 0 && path.size() > prefix.size() + suffix.size() &&
+        path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        auto index = std::stoul(path.substr(prefix.size(), path.size() - prefix.size() - suffix.size()));
+        if (index >= stored.size()) {
+            return {404, ""};
+        }
+
+        data_requests_++;
+        return {200, stored[index].data};
+    }
+
+    return {404, ""};
+}
+
+std::string FakeStorageServer::describe(size_t index) const {
+    auto& item = stored[index];
+    auto location = address() + "/v1/blobs/" + std::to_string(index);
+
+    json description{{"location", location},
+                     {"data", location + "/data"},
+                     {"contentType", "application/octet-stream"},
+                     {"lastModified", format_time(item.created)}};
+    if (item.expires) {
+        description["expires"] = format_time(*item.expires);
+    }
+
+    for (auto& [name, value] : item.tags) {
+        if (name == "subject" || name == "device" || name == "session" || name == "name") {
+            description[name] = value;
+        } else {
+            description[name].push_back(value);
+        }
+    }
+    return description.dump();
+}
+
+std::vector<size_t> FakeStorageServer::matching(std::multimap<std::string, std::string> const& query) const {
+    auto now = std::chrono::system_clock::now();
+
+    std::vector<size_t> items;
+    for (size_t index = 0; index < stored.size(); index++) {
+        auto& item = stored[index];
+        if (item.expires && *item.expires <= now) {
+            continue;
+        }
+
+        auto matches = std::all_of(query.begin(), query.end(), [&](auto& parameter) {
+            auto [first, last] = item.tags.equal_range(parameter.first);
+            return parameter.first.rfind('_', 0) == 0 ||
+                   std::any_of(first, last, [&](auto& tag) { return tag.second == parameter.second; });
+        });
+        if (matches) {
+            items.push_back(index);
+        }
+    }
+    return items;
+}
+
+} // namespace Gadgetron::Testing
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace Gadgetron::Testing {
+
+/**
+ * In-process stand-in for the MRD storage server, for tests that should not depend on 'mrd-storage-server' being
+ * installed.
+ *
+ * Serves the health check, storing items, reading the latest item for a set of tags, reading items by URL and listing
+ * items, over plain HTTP on a loopback port. Items are kept in memory. A query matches an item if every tag in the
+ * query is on the item; the latest item is the one stored last.
+ */
+class FakeStorageServer {
+  public:
+    FakeStorageServer();
+    ~FakeStorageServer();
+
+    std::string address() const;
+
+    /// Number of requests for item data, by tags or by URL, served so far.
+    size_t data_requests() const { return data_requests_; }
+
+    /// Number of items stored so far.
+    size_t items() const;
+
+  private:
+    struct Item {
+        std::multimap<std::string, std::string> tags;
+        std::string data;
+        std::chrono::system_clock::time_point created;
+        std::optional<std::chrono::system_clock::time_point> expires;
+    };
+
+    struct Response {
+        int status;
+        std::string body;
+        std::string content_type = "application/octet-stream";
+    };
+
+    void serve();
+    void handle(boost::asio::ip::tcp::socket& socket);
+    Response respond(std::string const& method, std::string const& path,
+                     std::multimap<std::string, std::string> const& query, std::string body);
+    std::string describe(size_t index) const;
+    std::vector<size_t> matching(std::multimap<std::string, std::string> const& query) const;
+
+    boost::asio::io_service ios;
+    boost::asio::ip::tcp::acceptor acceptor;
+    std::atomic<bool> stopping = false;
+    std::atomic<size_t> data_requests_ = 0;
+
+    mutable std::mutex mutex;
+    std::vector<Item> stored;
+
+    std::thread thread;
+    std::vector<std::thread> connections;
+};
+
+} // namespace Gadgetron::Testing
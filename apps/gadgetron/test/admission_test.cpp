@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../Admission.h"
+
+using namespace Gadgetron::Server;
+using boost::asio::ip::tcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+    // Records the connections that were admitted; they are closed by calling their callback.
+    struct Admitted {
+        std::vector<std::unique_ptr<tcp::socket>> sockets;
+        std::vector<std::function<void()>> close;
+
+        Admission::Handler handler() {
+            return [this](std::unique_ptr<tcp::socket> socket, std::function<void()> on_close) {
+                sockets.push_back(std::move(socket));
+                close.push_back(std::move(on_close));
+            };
+        }
+    };
+
+    // Connects a client to the acceptor; returns the client, and submits the server side of the connection.
+    tcp::socket connect(boost::asio::io_context &executor, tcp::acceptor &acceptor, Admission &admission) {
+        tcp::socket client(executor);
+        client.connect(acceptor.local_endpoint());
+        admission.submit(std::make_unique<tcp::socket>(acceptor.accept()));
+        return client;
+    }
+
+    bool closed_by_peer(tcp::socket &client) {
+        char byte;
+        boost::system::error_code ec;
+        client.read_some(boost::asio::buffer(&byte, 1), ec);
+        return ec == boost::asio::error::eof || ec == boost::asio::error::connection_reset;
+    }
+}
+
+TEST(AdmissionTest, connections_beyond_the_limit_are_queued) {
+    boost::asio::io_context executor;
+    tcp::acceptor acceptor(executor, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+    Admitted admitted;
+    Admission admission(executor, 2, 60s, admitted.handler());
+
+    auto first = connect(executor, acceptor, admission);
+    auto second = connect(executor, acceptor, admission);
+    auto third = connect(executor, acceptor, admission);
+    EXPECT_EQ(admitted.sockets.size(), 2u);
+
+    admitted.close[0]();
+    executor.poll();
+    EXPECT_EQ(admitted.sockets.size(), 3u);
+}
+
+TEST(AdmissionTest, no_limit_admits_everything) {
+    boost::asio::io_context executor;
+    tcp::acceptor acceptor(executor, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+    Admitted admitted;
+    Admission admission(executor, 0, 60s, admitted.handler());
+
+    std::vector<tcp::socket> clients;
+    for (int i = 0; i < 5; i++) clients.push_back(connect(executor, acceptor, admission));
+    EXPECT_EQ(admitted.sockets.size(), 5u);
+}
+
+TEST(AdmissionTest, queued_connections_are_rejected_after_the_timeout) {
+    boost::asio::io_context executor;
+    tcp::acceptor acceptor(executor, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+    Admitted admitted;
+    Admission admission(executor, 1, 1s, admitted.handler());
+
+    auto first = connect(executor, acceptor, admission);
+    auto second = connect(executor, acceptor, admission);
+    EXPECT_EQ(admitted.sockets.size(), 1u);
+
+    executor.run_for(1500ms);
+    EXPECT_TRUE(closed_by_peer(second));
+
+    // The slot that frees up afterwards is not handed to the rejected connection.
+    admitted.close[0]();
+    executor.restart();
+    executor.poll();
+    EXPECT_EQ(admitted.sockets.size(), 1u);
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "../connection/nodes/common/ParallelRunner.h"
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection;
+using namespace Gadgetron::Server::Connection::Nodes;
+using namespace std::chrono_literals;
+
+namespace {
+
+    class IgnoringErrorReporter : public ErrorReporter {
+    public:
+        void operator()(const std::string &, const std::string &) override {}
+    };
+
+    // Tracks how many calls are running at once.
+    struct Concurrency {
+        std::atomic<size_t> current{0}, peak{0}, calls{0};
+
+        struct Scope {
+            Concurrency &concurrency;
+            explicit Scope(Concurrency &concurrency) : concurrency(concurrency) {
+                concurrency.calls++;
+                auto now = ++concurrency.current, peak = concurrency.peak.load();
+                while (now > peak && !concurrency.peak.compare_exchange_weak(peak, now)) {}
+            }
+            ~Scope() { concurrency.current--; }
+        };
+    };
+
+    GenericInputChannel input_of(size_t count) {
+        auto channel = make_channel();
+        for (int i = 0; i < int(count); i++) channel.output.push(i);
+        return std::move(channel.input);
+    }
+
+    std::vector<int> values_of(GenericInputChannel channel) {
+        std::vector<int> values;
+        for (auto message : channel) values.push_back(force_unpack<int>(std::move(message)));
+        return values;
+    }
+
+    std::vector<int> run(const ParallelRunner &runner, GenericInputChannel input) {
+        IgnoringErrorReporter reporter;
+        ErrorHandler error_handler(reporter, "test");
+
+        auto output = make_channel();
+        runner.process(std::move(input), std::move(output.output), error_handler);
+        return values_of(std::move(output.input));
+    }
+
+    bool pool_is_concurrent() { return ThreadPool::shared().size() >= 2; }
+}
+
+TEST(WorkerScalingTest, starts_with_one_worker) {
+    WorkerScaling scaling(8);
+    EXPECT_EQ(scaling.workers(), 1u);
+    scaling.arrived(0ms);
+    EXPECT_EQ(scaling.workers(), 1u);
+}
+
+TEST(WorkerScalingTest, backlog_scales_to_the_maximum) {
+    WorkerScaling scaling(8);
+    for (int i = 0; i < 10; i++) {
+        scaling.arrived(0ms);
+        scaling.processed(10ms);
+    }
+    EXPECT_EQ(scaling.workers(), 8u);
+}
+
+TEST(WorkerScalingTest, follows_input_rate_and_processing_time) {
+    WorkerScaling slow_input(8);
+    for (int i = 0; i < 10; i++) {
+        slow_input.arrived(100ms);
+        slow_input.processed(10ms);
+    }
+    EXPECT_EQ(slow_input.workers(), 2u);
+
+    WorkerScaling busy_input(8);
+    for (int i = 0; i < 10; i++) {
+        busy_input.arrived(10ms);
+        busy_input.processed(25ms);
+    }
+    EXPECT_EQ(busy_input.workers(), 4u);
+}
+
+TEST(ParallelRunnerTest, ordered_results_keep_input_order) {
+    // Earlier messages take longer, so results are ready in roughly reverse order.
+    ParallelRunner runner([](Message message) {
+        auto value = force_unpack<int>(std::move(message));
+        std::this_thread::sleep_for(std::chrono::milliseconds(8 - value % 8));
+        return Message(value);
+    }, ParallelRunner::Settings{4, 0, true, false});
+
+    std::vector<int> expected(40);
+    for (int i = 0; i < 40; i++) expected[i] = i;
+    EXPECT_EQ(run(runner, input_of(40)), expected);
+}
+
+TEST(ParallelRunnerTest, unordered_results_are_sent_when_ready) {
+    if (!pool_is_concurrent()) GTEST_SKIP() << "Needs at least two pool threads";
+
+    // The first message is only done once the second has been processed.
+    std::promise<void> second_done;
+    auto second_future = second_done.get_future().share();
+    ParallelRunner runner([&, second_future](Message message) {
+        auto value = force_unpack<int>(std::move(message));
+        if (value == 0) second_future.wait();
+        if (value == 1) second_done.set_value();
+        return Message(value);
+    }, ParallelRunner::Settings{2, 0, false, false});
+
+    EXPECT_EQ(run(runner, input_of(2)), (std::vector<int>{1, 0}));
+}
+
+TEST(ParallelRunnerTest, window_bounds_messages_in_flight) {
+    constexpr size_t window = 4, output_capacity = 2, count = 50;
+
+    Concurrency concurrency;
+    ParallelRunner runner([&](Message message) {
+        Concurrency::Scope scope(concurrency);
+        return message;
+    }, ParallelRunner::Settings{2, window, true, false});
+
+    IgnoringErrorReporter reporter;
+    ErrorHandler error_handler(reporter, "test");
+
+    // Nobody reads the output for now, so once it is full, nothing leaves the window.
+    auto output = make_channel<BoundedMessageChannel>(output_capacity);
+    std::thread processing([&, input = input_of(count), sink = std::move(output.output)]() mutable {
+        runner.process(std::move(input), std::move(sink), error_handler);
+    });
+
+    std::this_thread::sleep_for(200ms);
+    EXPECT_GE(concurrency.calls.load(), window);
+    EXPECT_LE(concurrency.calls.load(), window + output_capacity);
+
+    auto values = values_of(std::move(output.input));
+    processing.join();
+
+    EXPECT_EQ(values.size(), count);
+    EXPECT_EQ(concurrency.calls.load(), count);
+}
+
+TEST(ParallelRunnerTest, workers_cap_concurrency) {
+    if (!pool_is_concurrent()) GTEST_SKIP() << "Needs at least two pool threads";
+
+    Concurrency concurrency;
+    ParallelRunner runner([&](Message message) {
+        Concurrency::Scope scope(concurrency);
+        std::this_thread::sleep_for(5ms);
+        return message;
+    }, ParallelRunner::Settings{2, 0, true, false});
+
+    EXPECT_EQ(run(runner, input_of(20)).size(), 20u);
+    EXPECT_EQ(concurrency.peak.load(), 2u);
+}
+
+TEST(ParallelRunnerTest, adaptive_starts_with_one_worker_and_scales_up_under_a_backlog) {
+    if (!pool_is_concurrent()) GTEST_SKIP() << "Needs at least two pool threads";
+    const size_t max_workers = std::min<size_t>(4, ThreadPool::shared().size());
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    Concurrency concurrency;
+    ParallelRunner runner([&, released](Message message) {
+        Concurrency::Scope scope(concurrency);
+        auto value = force_unpack<int>(std::move(message));
+        if (value == 0) released.wait();
+        std::this_thread::sleep_for(20ms);
+        return Message(value);
+    }, ParallelRunner::Settings{max_workers, 0, true, true});
+
+    auto result = std::async(std::launch::async, [&]() { return run(runner, input_of(20)); });
+
+    // Nothing has been measured yet, so the held up first message is all that is processed.
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(concurrency.peak.load(), 1u);
+
+    // Once it is done, the backlog reads as input faster than any number of workers can keep up with.
+    release.set_value();
+    EXPECT_EQ(result.get().size(), 20u);
+    EXPECT_EQ(concurrency.peak.load(), max_workers);
+}
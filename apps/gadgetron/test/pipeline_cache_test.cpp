@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "connection/PipelineCache.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Server::Connection;
+
+namespace {
+    boost::filesystem::path temporary_config() {
+        return boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gadgetron_config_%%%%%%%%.xml");
+    }
+
+    void write_config(const boost::filesystem::path &filename, const std::string &dll, const std::string &name) {
+        std::ofstream file(filename.string());
+        file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             << "<configuration>\n"
+             << "    <version>2</version>\n"
+             << "    <stream>\n"
+             << "        <gadget>\n"
+             << "            <name>" << name << "</name>\n"
+             << "            <dll>" << dll << "</dll>\n"
+             << "            <classname>AccumulatorGadget</classname>\n"
+             << "        </gadget>\n"
+             << "    </stream>\n"
+             << "</configuration>\n";
+    }
+
+    std::string gadget_name(const Config &config) {
+        return Core::get<Config::Gadget>(config.stream.nodes.at(0)).name;
+    }
+}
+
+TEST(PipelineCacheTest, cachesParsedConfig) {
+    PipelineCache cache;
+    auto filename = temporary_config();
+    write_config(filename, "gadgetron_mricore", "Accumulator");
+
+    EXPECT_EQ(gadget_name(cache.config(filename)), "Accumulator");
+    EXPECT_EQ(gadget_name(cache.config(filename)), "Accumulator");
+    EXPECT_EQ(cache.cached_configs(), 1);
+
+    boost::filesystem::remove(filename);
+}
+
+TEST(PipelineCacheTest, rereadsChangedConfig) {
+    PipelineCache cache;
+    auto filename = temporary_config();
+    write_config(filename, "gadgetron_mricore", "Accumulator");
+    EXPECT_EQ(gadget_name(cache.config(filename)), "Accumulator");
+
+    write_config(filename, "gadgetron_mricore", "RenamedAccumulator");
+    EXPECT_EQ(gadget_name(cache.config(filename)), "RenamedAccumulator");
+    EXPECT_EQ(cache.cached_configs(), 1);
+
+    boost::filesystem::remove(filename);
+}
+
+TEST(PipelineCacheTest, preloadFailsOnMissingLibrary) {
+    PipelineCache cache;
+    auto filename = temporary_config();
+    write_config(filename, "gadgetron_no_such_library", "Accumulator");
+
+    EXPECT_ANY_THROW(cache.preload(filename));
+    EXPECT_EQ(cache.loaded_libraries(), 0);
+
+    boost::filesystem::remove(filename);
+}
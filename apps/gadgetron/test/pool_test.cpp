@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../connection/nodes/distributed/Pool.h"
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+
+    // Holds on to the jobs it is sent until the test responds to them or fails them.
+    class FakeWorker : public Worker {
+    public:
+        static constexpr size_t bytes_per_job = 1000;
+
+        FakeWorker(std::string name, double bytes_per_second) : name_(std::move(name)), rate(bytes_per_second) {}
+
+        size_t push(Message message, ResponseHandler on_response, FailureHandler on_failure) override {
+            std::unique_lock<std::mutex> lock(mutex);
+            received++;
+            cv.notify_all();
+            if (draining) {
+                lock.unlock();
+                on_response(std::move(message));
+                return bytes_per_job;
+            }
+
+            jobs.push_back(Job{std::move(message), std::move(on_response), std::move(on_failure)});
+            return bytes_per_job;
+        }
+
+        Load load() const override {
+            std::lock_guard<std::mutex> guard(mutex);
+            return Load{true, jobs.size(), jobs.size() * bytes_per_job, rate};
+        }
+
+        void close() override {}
+
+        std::string name() const override { return name_; }
+
+        bool wait_for_received(size_t count) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return cv.wait_for(lock, std::chrono::seconds(5), [&]() { return received >= count; });
+        }
+
+        size_t jobs_held() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return jobs.size();
+        }
+
+        size_t jobs_received() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return received;
+        }
+
+        /// Answers the oldest jobs with the message they were sent with.
+        void respond(size_t count = std::numeric_limits<size_t>::max()) {
+            for (auto &job : take(count)) job.on_response(std::move(job.message));
+        }
+
+        void fail(size_t count = std::numeric_limits<size_t>::max()) {
+            for (auto &job : take(count))
+                job.on_failure(std::make_exception_ptr(std::runtime_error("Job failed on " + name_)));
+        }
+
+        /// Answers every job held now or sent later.
+        void drain() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                draining = true;
+            }
+            respond();
+        }
+
+    private:
+        struct Job {
+            Message message;
+            ResponseHandler on_response;
+            FailureHandler on_failure;
+        };
+
+        // Handlers take the lock of the pool, which holds it while asking for our load; call them without ours.
+        std::vector<Job> take(size_t count) {
+            std::lock_guard<std::mutex> guard(mutex);
+            std::vector<Job> taken;
+            while (!jobs.empty() && taken.size() < count) {
+                taken.push_back(std::move(jobs.front()));
+                jobs.pop_front();
+            }
+            return taken;
+        }
+
+        const std::string name_;
+        const double rate;
+
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Job> jobs;
+        size_t received = 0;
+        bool draining = false;
+    };
+
+    // Lets the pool finish its jobs when a test fails halfway; declared after the pool, so it goes first.
+    struct Drain {
+        std::vector<FakeWorker *> workers;
+        ~Drain() {
+            for (auto worker : workers) worker->drain();
+        }
+    };
+
+    std::list<std::unique_ptr<Worker>> workers(std::unique_ptr<FakeWorker> a, std::unique_ptr<FakeWorker> b = nullptr) {
+        std::list<std::unique_ptr<Worker>> list;
+        list.push_back(std::move(a));
+        if (b) list.push_back(std::move(b));
+        return list;
+    }
+}
+
+TEST(PoolTest, jobs_go_to_the_worker_expected_to_finish_first) {
+    auto slow_worker = std::make_unique<FakeWorker>("slow", 1e3);
+    auto fast_worker = std::make_unique<FakeWorker>("fast", 1e6);
+    auto &slow = *slow_worker, &fast = *fast_worker;
+
+    Pool pool(workers(std::move(slow_worker), std::move(fast_worker)), 4);
+    Drain drain{{&slow, &fast}};
+
+    std::vector<std::future<Message>> responses;
+    auto push = [&](int value) {
+        auto sent = slow.jobs_received() + fast.jobs_received();
+        responses.push_back(pool.push(Message(value)));
+        for (int tries = 0; tries < 5000 && slow.jobs_received() + fast.jobs_received() == sent; tries++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+
+    // Nothing is known about the size of jobs before the first one, so it goes to the first worker.
+    push(0);
+    ASSERT_EQ(slow.jobs_held(), 1u);
+
+    // The slow worker has room for more, but the fast one is expected to finish them sooner.
+    for (int i = 1; i < 5; i++) push(i);
+    EXPECT_EQ(slow.jobs_held(), 1u);
+    EXPECT_EQ(fast.jobs_held(), 4u);
+
+    // Only once the fast worker is full does the slow one get another job.
+    push(5);
+    EXPECT_EQ(slow.jobs_held(), 2u);
+
+    // A fast worker with room again takes the next job, although the slow one has room too.
+    fast.respond(1);
+    push(6);
+    EXPECT_EQ(fast.jobs_held(), 4u);
+    EXPECT_EQ(slow.jobs_held(), 2u);
+
+    fast.respond();
+    slow.respond();
+    for (int i = 0; i < int(responses.size()); i++)
+        EXPECT_EQ(force_unpack<int>(responses[i].get()), i);
+}
+
+TEST(PoolTest, failed_jobs_are_retried_on_another_worker) {
+    auto failing_worker = std::make_unique<FakeWorker>("failing", 0);
+    auto working_worker = std::make_unique<FakeWorker>("working", 0);
+    auto &failing = *failing_worker, &working = *working_worker;
+
+    Pool pool(workers(std::move(failing_worker), std::move(working_worker)), 1);
+    Drain drain{{&failing, &working}};
+
+    auto response = pool.push(Message(42));
+    ASSERT_TRUE(failing.wait_for_received(1));
+    failing.fail();
+
+    ASSERT_TRUE(working.wait_for_received(1));
+    working.respond();
+
+    EXPECT_EQ(force_unpack<int>(response.get()), 42);
+    EXPECT_EQ(failing.jobs_received(), 1u);
+    EXPECT_EQ(working.jobs_received(), 1u);
+}
+
+TEST(PoolTest, retried_job_goes_ahead_of_queued_jobs) {
+    auto failing_worker = std::make_unique<FakeWorker>("failing", 0);
+    auto working_worker = std::make_unique<FakeWorker>("working", 0);
+    auto &failing = *failing_worker, &working = *working_worker;
+
+    Pool pool(workers(std::move(failing_worker), std::move(working_worker)), 1);
+    Drain drain{{&failing, &working}};
+
+    auto first = pool.push(Message(1));
+    ASSERT_TRUE(failing.wait_for_received(1));
+    auto second = pool.push(Message(2));
+    ASSERT_TRUE(working.wait_for_received(1));
+    auto third = pool.push(Message(3));
+
+    // The failed job goes in front of the third, and waits for the working worker rather than going back.
+    failing.fail();
+    working.respond();
+    ASSERT_TRUE(working.wait_for_received(2));
+    EXPECT_EQ(force_unpack<int>(second.get()), 2);
+
+    // With the retried job out of the way, the third goes to the only worker with room.
+    ASSERT_TRUE(failing.wait_for_received(2));
+    failing.respond();
+    working.respond();
+
+    EXPECT_EQ(force_unpack<int>(first.get()), 1);
+    EXPECT_EQ(force_unpack<int>(third.get()), 3);
+    EXPECT_EQ(working.jobs_received(), 2u);
+}
+
+TEST(PoolTest, jobs_fail_after_the_last_attempt) {
+    auto failing_worker = std::make_unique<FakeWorker>("failing", 0);
+    auto &failing = *failing_worker;
+
+    Pool pool(workers(std::move(failing_worker)), 1, 3);
+    Drain drain{{&failing}};
+
+    auto response = pool.push(Message(42));
+    for (size_t attempt = 1; attempt <= 3; attempt++) {
+        // With no other worker about, the job goes back to the one that failed it.
+        ASSERT_TRUE(failing.wait_for_received(attempt));
+        failing.fail();
+    }
+
+    EXPECT_THROW(response.get(), std::runtime_error);
+    EXPECT_EQ(failing.jobs_received(), 3u);
+}
@@ -0,0 +1,157 @@
+#include <numeric>
+#include <thread>
+
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+
+#include "../connection/SharedMemoryStream.h"
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+using namespace Gadgetron;
+
+TEST(SharedMemoryTest, attach_marks_segment) {
+    auto owner = Connection::SharedMemorySegment::create(1024);
+    ASSERT_FALSE(owner->peer_attached());
+
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+    ASSERT_TRUE(owner->peer_attached());
+    ASSERT_EQ(peer->ring_size(), 1024u);
+
+    owner->unlink();
+    ASSERT_THROW(Connection::SharedMemorySegment::attach(owner->name()), std::system_error);
+}
+
+TEST(SharedMemoryTest, round_trip) {
+    auto owner = Connection::SharedMemorySegment::create(1024);
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+
+    auto owner_stream = Connection::stream_from_shared_memory(owner);
+    auto peer_stream = Connection::stream_from_shared_memory(peer);
+
+    uint16_t id = 1008;
+    owner_stream->write(reinterpret_cast<char *>(&id), sizeof(id));
+
+    uint16_t received_id = 0;
+    peer_stream->read(reinterpret_cast<char *>(&received_id), sizeof(received_id));
+    ASSERT_EQ(received_id, id);
+
+    peer_stream->put('x');
+    ASSERT_EQ(owner_stream->get(), 'x');
+}
+
+TEST(SharedMemoryTest, large_transfer_wraps_ring) {
+    auto owner = Connection::SharedMemorySegment::create(4099);
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+
+    auto owner_stream = Connection::stream_from_shared_memory(owner);
+    auto peer_stream = Connection::stream_from_shared_memory(peer);
+
+    auto data = std::vector<char>(1u << 22);
+    std::iota(data.begin(), data.end(), 0);
+
+    auto thread = std::thread([&]() {
+        owner_stream->write(data.data(), 3);
+        owner_stream->write(data.data() + 3, data.size() - 3);
+    });
+
+    auto header = std::vector<char>(3);
+    peer_stream->read(header.data(), header.size());
+
+    auto data2 = std::vector<char>(data.size() - header.size());
+    peer_stream->read(data2.data(), data2.size());
+    thread.join();
+
+    ASSERT_TRUE(std::equal(header.begin(), header.end(), data.begin()));
+    ASSERT_TRUE(std::equal(data2.begin(), data2.end(), data.begin() + header.size()));
+}
+
+TEST(SharedMemoryTest, closed_peer_ends_stream) {
+    auto owner = Connection::SharedMemorySegment::create(1024);
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+
+    auto owner_stream = Connection::stream_from_shared_memory(owner);
+    {
+        auto peer_stream = Connection::stream_from_shared_memory(peer);
+        peer_stream->write("abc", 3);
+    }
+
+    auto received = std::vector<char>(4);
+    owner_stream->read(received.data(), received.size());
+    ASSERT_EQ(owner_stream->gcount(), 3);
+    ASSERT_TRUE(owner_stream->eof());
+}
+
+TEST(SharedMemoryTest, socket_tells_when_peer_is_gone) {
+    ba::io_service ios{};
+    tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v4(), 0));
+
+    auto client = std::make_unique<tcp::socket>(ios);
+    client->connect(tcp::endpoint(ba::ip::address_v4::loopback(), acceptor.local_endpoint().port()));
+    auto server = std::make_unique<tcp::socket>(ios);
+    acceptor.accept(*server);
+
+    auto owner = Connection::SharedMemorySegment::create(1024);
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+    auto owner_stream = Connection::stream_from_shared_memory(owner, std::move(server));
+
+    // The peer process dies without closing its end of the rings.
+    client->close();
+
+    char byte;
+    owner_stream->read(&byte, 1);
+    ASSERT_TRUE(owner_stream->eof());
+}
+
+TEST(SharedMemoryTest, both_directions_at_once) {
+    auto owner = Connection::SharedMemorySegment::create(4096);
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+
+    auto owner_stream = Connection::stream_from_shared_memory(owner);
+    auto peer_stream = Connection::stream_from_shared_memory(peer);
+
+    // Each side sends more than a ring holds, so both writers wait on readers running at the same time.
+    auto to_peer = std::vector<char>(1u << 20);
+    auto to_owner = std::vector<char>(1u << 20);
+    std::iota(to_peer.begin(), to_peer.end(), 0);
+    std::iota(to_owner.rbegin(), to_owner.rend(), 0);
+
+    auto owner_writer = std::thread([&]() { owner_stream->write(to_peer.data(), to_peer.size()); owner_stream->flush(); });
+    auto peer_writer = std::thread([&]() { peer_stream->write(to_owner.data(), to_owner.size()); peer_stream->flush(); });
+
+    auto received_by_peer = std::vector<char>(to_peer.size());
+    auto peer_reader = std::thread([&]() { peer_stream->read(received_by_peer.data(), received_by_peer.size()); });
+    auto received_by_owner = std::vector<char>(to_owner.size());
+    owner_stream->read(received_by_owner.data(), received_by_owner.size());
+
+    owner_writer.join();
+    peer_writer.join();
+    peer_reader.join();
+
+    ASSERT_EQ(received_by_peer, to_peer);
+    ASSERT_EQ(received_by_owner, to_owner);
+}
+
+TEST(SharedMemoryTest, many_small_messages_keep_their_order) {
+    auto owner = Connection::SharedMemorySegment::create(1024);
+    auto peer = Connection::SharedMemorySegment::attach(owner->name());
+
+    auto owner_stream = Connection::stream_from_shared_memory(owner);
+    auto peer_stream = Connection::stream_from_shared_memory(peer);
+
+    constexpr uint32_t count = 100000;
+    auto thread = std::thread([&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            owner_stream->write(reinterpret_cast<const char *>(&i), sizeof(i));
+            if (i % 7 == 0) owner_stream->flush();
+        }
+        owner_stream->flush();
+    });
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t received = 0;
+        peer_stream->read(reinterpret_cast<char *>(&received), sizeof(received));
+        ASSERT_EQ(received, i);
+    }
+    thread.join();
+}
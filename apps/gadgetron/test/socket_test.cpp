@@ -1,6 +1,7 @@
 //
 // Created by dchansen on 9/10/19.
 //
+#include <numeric>
 #include <random>
 
 #include <boost/asio.hpp>
@@ -54,6 +55,28 @@ TEST_F(SocketTest, read_test) {
     ASSERT_EQ(data,data2);
 }
 
+TEST_F(SocketTest, large_read_test) {
+
+    auto data = std::vector<char>(1u << 22);
+    std::iota(data.begin(), data.end(), 0);
+
+    auto thread = std::thread([&](){ ba::write(*server_socket, ba::buffer(data.data(), data.size())); });
+
+    auto header = std::vector<char>(3);
+    socketstream->read(header.data(), header.size());
+
+    auto data2 = std::vector<char>(data.size() - header.size());
+    socketstream->read(data2.data(), data2.size());
+    thread.join();
+
+    ASSERT_TRUE(std::equal(header.begin(), header.end(), data.begin()));
+    ASSERT_TRUE(std::equal(data2.begin(), data2.end(), data.begin() + header.size()));
+
+    auto statistics = Connection::socket_statistics(*socketstream);
+    ASSERT_TRUE(statistics);
+    ASSERT_EQ(statistics->bytes_read, data.size());
+}
+
 TEST_F(SocketTest, write_test) {
 
     auto data = std::vector<char>(1u << 22,42);
@@ -0,0 +1,132 @@
+#include <chrono>
+#include <numeric>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "FakeStorageServer.h"
+#include "StorageCache.h"
+
+using namespace Gadgetron::Storage;
+using namespace Gadgetron;
+
+namespace {
+
+std::string read_all(std::istream& stream) {
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+StorageItemTags tags_named(std::string const& name) {
+    return StorageItemTags::Builder("mysubject").with_device("mydevice").with_name(name).build();
+}
+
+} // namespace
+
+class StorageCacheTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        cache_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        client = std::make_shared<StorageClient>(server.address());
+    }
+
+    void TearDown() override { boost::filesystem::remove_all(cache_dir); }
+
+    std::shared_ptr<CachingStorageClient> make_cache(std::chrono::seconds time_to_live = std::chrono::hours(1)) {
+        return std::make_shared<CachingStorageClient>(client, cache_dir, time_to_live, [this]() { return now; });
+    }
+
+    CachingStorageClient::Clock::time_point now = CachingStorageClient::Clock::now();
+
+    Testing::FakeStorageServer server;
+    std::shared_ptr<StorageClient> client;
+    boost::filesystem::path cache_dir;
+};
+
+TEST_F(StorageCacheTest, storage_client_streams_large_items) {
+    std::string data(24u << 20, '\0');
+    std::iota(data.begin(), data.end(), 0);
+
+    ASSERT_FALSE(client->health_check().has_value());
+
+    client->store_item_from(tags_named("large"), [&](std::ostream& stream) {
+        for (size_t offset = 0; offset < data.size(); offset += 1000003) {
+            stream.write(data.data() + offset, std::min<size_t>(1000003, data.size() - offset));
+        }
+    });
+
+    auto stored = client->get_latest_item(tags_named("large"));
+    ASSERT_TRUE(stored);
+    ASSERT_EQ(read_all(*stored), data);
+
+    ASSERT_FALSE(client->get_latest_item(tags_named("missing")));
+}
+
+TEST_F(StorageCacheTest, failing_writer_stores_nothing) {
+    auto writer = [](std::ostream& stream) {
+        stream << std::string(3u << 20, 'x');
+        throw std::runtime_error("serialization failed");
+    };
+
+    ASSERT_THROW(client->store_item_from(tags_named("broken"), writer), std::runtime_error);
+    ASSERT_EQ(server.items(), 0u);
+}
+
+TEST_F(StorageCacheTest, storage_space_round_trip) {
+    IsmrmrdContextVariables vars("mysubject", "mydevice", "mysession", "mymeasurement");
+    SessionSpace space(make_cache(), vars, std::chrono::hours(1));
+
+    auto values = std::vector<float>(1u << 20);
+    std::iota(values.begin(), values.end(), 0.0f);
+    space.store("values", values);
+
+    auto stored = space.get_latest<std::vector<float>>("values");
+    ASSERT_TRUE(stored);
+    ASSERT_EQ(*stored, values);
+    ASSERT_EQ(server.data_requests(), 0u);
+}
+
+TEST_F(StorageCacheTest, repeated_reads_are_served_locally) {
+    client->store_item_from(tags_named("noise"), [](std::ostream& stream) { stream << "covariance"; });
+
+    auto cache = make_cache();
+    ASSERT_EQ(read_all(*cache->get_latest_item(tags_named("noise"))), "covariance");
+    ASSERT_EQ(read_all(*cache->get_latest_item(tags_named("noise"))), "covariance");
+    ASSERT_EQ(server.data_requests(), 1u);
+
+    // Another client sharing the directory, as another process on the same host would.
+    auto other = make_cache();
+    ASSERT_EQ(read_all(*other->get_latest_item(tags_named("noise"))), "covariance");
+    ASSERT_EQ(server.data_requests(), 1u);
+
+    ASSERT_FALSE(cache->get_latest_item(tags_named("missing")));
+}
+
+TEST_F(StorageCacheTest, stored_items_replace_cached_copies) {
+    auto cache = make_cache();
+    cache->store_item_from(tags_named("kernel"), [](std::ostream& stream) { stream << "first"; });
+    ASSERT_EQ(read_all(*cache->get_latest_item(tags_named("kernel"))), "first");
+
+    std::stringstream second("second");
+    auto item = cache->store_item(tags_named("kernel"), second, std::chrono::seconds(60));
+    ASSERT_EQ(read_all(*cache->get_latest_item(tags_named("kernel"))), "second");
+    ASSERT_EQ(server.data_requests(), 0u);
+
+    // The item was stored on the server as well, and is found there by URL.
+    ASSERT_EQ(read_all(*client->get_latest_item(tags_named("kernel"))), "second");
+    ASSERT_EQ(read_all(*cache->get_item_by_url(item.data)), "second");
+    ASSERT_EQ(read_all(*cache->get_item_by_url(item.data)), "second");
+    ASSERT_EQ(server.data_requests(), 2u);
+}
+
+TEST_F(StorageCacheTest, expired_copies_are_read_again) {
+    auto cache = make_cache(std::chrono::seconds(60));
+    cache->store_item_from(tags_named("calibration"), [](std::ostream& stream) { stream << "old"; });
+
+    // Stored by another host, which this cache cannot know about until its copy expires.
+    client->store_item_from(tags_named("calibration"), [](std::ostream& stream) { stream << "new"; });
+    ASSERT_EQ(read_all(*cache->get_latest_item(tags_named("calibration"))), "old");
+
+    now += std::chrono::seconds(61);
+    ASSERT_EQ(read_all(*cache->get_latest_item(tags_named("calibration"))), "new");
+    ASSERT_EQ(server.data_requests(), 1u);
+}
@@ -45,7 +45,7 @@ class StorageTest : public ::testing::Test {
 
         storage_address = address;
         server = std::move(*process);
-        storage = Gadgetron::Server::setup_storage_spaces(address, header);
+        storage = Gadgetron::Server::setup_storage_spaces(address, header, args);
     }
 
     static void TearDownTestSuite() {
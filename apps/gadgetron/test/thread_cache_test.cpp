@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include "../connection/core/ThreadCache.h"
+
+#if !(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Gadgetron::Server::Connection;
+
+TEST(ThreadCacheTest, runAndJoin) {
+    ThreadCache cache;
+    std::atomic<int> value{0};
+    auto thread = cache.run([&]() { value = 42; });
+    thread.join();
+    EXPECT_EQ(value.load(), 42);
+    EXPECT_FALSE(thread.joinable());
+}
+
+TEST(ThreadCacheTest, reusesThreads) {
+    ThreadCache cache;
+    std::set<std::thread::id> ids;
+    for (int i = 0; i < 10; i++) {
+        std::thread::id id;
+        auto thread = cache.run([&]() { id = std::this_thread::get_id(); });
+        thread.join();
+        ids.insert(id);
+        // Give the worker a chance to park itself before the next job is submitted.
+        for (int tries = 0; tries < 1000 && cache.idle_threads() == 0; tries++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(ids.size(), 1);
+}
+
+TEST(ThreadCacheTest, idleThreadsExpire) {
+    ThreadCache cache(16, std::chrono::milliseconds(10));
+    cache.run([]() {}).join();
+    for (int tries = 0; tries < 1000 && cache.idle_threads() == 0; tries++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(cache.idle_threads(), 0);
+}
+
+TEST(ThreadCacheTest, concurrentJobs) {
+    ThreadCache cache;
+    std::atomic<int> count{0};
+    std::vector<CachedThread> threads;
+    for (int i = 0; i < 32; i++)
+        threads.push_back(cache.run([&]() { count++; }));
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(count.load(), 32);
+}
+
+#if !(_WIN32)
+TEST(ThreadCacheTest, forkedChildStartsWithAnEmptyCache) {
+    auto &cache = ThreadCache::instance();
+    cache.run([]() {}).join();
+    for (int tries = 0; tries < 1000 && cache.idle_threads() == 0; tries++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_GT(cache.idle_threads(), 0);
+
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // The parked thread of the parent does not exist here, so handing it a job would never finish.
+        auto &child_cache = ThreadCache::instance();
+        bool empty = child_cache.idle_threads() == 0;
+        std::atomic<int> value{0};
+        child_cache.run([&]() { value = 42; }).join();
+        _exit(empty && value == 42 ? 0 : 1);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_GT(cache.idle_threads(), 0);
+}
+#endif
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+#include <nlohmann/json.hpp>
+
+#include "Channel.h"
+#include "hoNDArray.h"
+
+#include "connection/core/Tracing.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection;
+
+namespace {
+    boost::filesystem::path temporary_directory() {
+        return boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gadgetron_trace_%%%%%%%%");
+    }
+}
+
+TEST(TracingTest, counts_messages_between_nodes) {
+    auto directory = temporary_directory();
+    {
+        auto tracer = std::make_shared<Tracer>(directory);
+
+        auto producer = tracer->add_node("producer");
+        auto consumer = tracer->add_node("consumer");
+        auto channel = make_channel<TracedChannel<MessageChannel>>(tracer, producer, consumer, "edge");
+
+        std::thread sender([&, output = std::move(channel.output)]() mutable {
+            tracer->node_started(producer);
+            for (int i = 0; i < 10; i++)
+                output.push(hoNDArray<float>(128));
+            tracer->node_finished(producer);
+        });
+
+        tracer->node_started(consumer);
+        size_t received = 0;
+        for (auto message : channel.input) received++;
+        tracer->node_finished(consumer);
+        sender.join();
+
+        EXPECT_EQ(received, 10);
+
+        auto statistics = tracer->statistics();
+        ASSERT_EQ(statistics.size(), 2);
+        EXPECT_EQ(statistics[0].name, "producer");
+        EXPECT_EQ(statistics[0].messages_out, 10);
+        EXPECT_EQ(statistics[0].bytes_out, 10 * 128 * sizeof(float));
+        EXPECT_EQ(statistics[1].messages_in, 10);
+        EXPECT_EQ(statistics[1].bytes_in, 10 * 128 * sizeof(float));
+        EXPECT_GT(statistics[1].idle.count(), 0);
+    }
+
+    boost::filesystem::remove_all(directory);
+}
+
+TEST(TracingTest, writes_chrome_trace_and_counters) {
+    auto directory = temporary_directory();
+    {
+        auto tracer = std::make_shared<Tracer>(directory);
+        auto node = tracer->add_node("node");
+        auto channel = make_channel<TracedChannel<BoundedMessageChannel>>(tracer, Tracer::none, node, "input", 4);
+
+        tracer->node_started(node);
+        channel.output.push(hoNDArray<float>(16));
+        { auto closed = std::move(channel.output); }
+        for (auto message : channel.input) {}
+        tracer->node_finished(node);
+    }
+
+    std::vector<boost::filesystem::path> traces;
+    for (auto &entry : boost::filesystem::directory_iterator(directory))
+        if (entry.path().filename().string().rfind("gadgetron_trace_", 0) == 0) traces.push_back(entry.path());
+    ASSERT_EQ(traces.size(), 1);
+
+    std::ifstream trace_file(traces.front().string());
+    auto trace = nlohmann::json::parse(trace_file);
+    auto &events = trace["traceEvents"];
+    ASSERT_TRUE(events.is_array());
+
+    auto count = [&](const std::string &phase) {
+        return std::count_if(events.begin(), events.end(), [&](auto &event) { return event["ph"] == phase; });
+    };
+    EXPECT_EQ(count("M"), 1);
+    EXPECT_EQ(count("f"), 1);
+    EXPECT_GT(count("X"), 0);
+    EXPECT_EQ(count("C"), 2);
+
+    std::ifstream counters_file((directory / "gadgetron_counters.json").string());
+    auto counters = nlohmann::json::parse(counters_file);
+    EXPECT_GE(counters["connections"].get<size_t>(), 1);
+    EXPECT_GE(counters["nodes"]["node"]["messages_in"].get<size_t>(), 1);
+
+    boost::filesystem::remove_all(directory);
+}
+
+TEST(TracingTest, caps_events_but_keeps_counting) {
+    auto directory = temporary_directory();
+    {
+        auto tracer = std::make_shared<Tracer>(directory, 16);
+        auto node = tracer->add_node("node");
+        auto channel = make_channel<TracedChannel<MessageChannel>>(tracer, Tracer::none, node, "input");
+
+        tracer->node_started(node);
+        for (int i = 0; i < 100; i++) channel.output.push(hoNDArray<float>(4));
+        { auto closed = std::move(channel.output); }
+        for (auto message : channel.input) {}
+        tracer->node_finished(node);
+
+        EXPECT_EQ(tracer->statistics()[0].messages_in, 100);
+    }
+
+    boost::filesystem::path trace_path;
+    for (auto &entry : boost::filesystem::directory_iterator(directory))
+        if (entry.path().filename().string().rfind("gadgetron_trace_", 0) == 0) trace_path = entry.path();
+    ASSERT_FALSE(trace_path.empty());
+
+    std::ifstream trace_file(trace_path.string());
+    auto trace = nlohmann::json::parse(trace_file);
+
+    // The thread name is metadata, not a recorded event.
+    EXPECT_EQ(trace["traceEvents"].size(), 16 + 1);
+    EXPECT_GT(trace["otherData"]["dropped_events"].get<size_t>(), 0);
+
+    boost::filesystem::remove_all(directory);
+}
@@ -5,6 +5,7 @@
 #include <memory>
 #include <mutex>
 
+#include "MPMCBoundedChannel.h"
 #include "MPMCChannel.h"
 #include "Message.h"
 #include "Types.h"
@@ -122,6 +123,26 @@ namespace Gadgetron { namespace Core {
         MPMCChannel<Message> channel;
     };
 
+    /**
+     * A MessageChannel with a fixed capacity. Pushing to a full channel blocks until the consumer catches up,
+     * which caps the memory held by messages in flight between two nodes.
+     */
+    class BoundedMessageChannel : public Channel {
+    public:
+        explicit BoundedMessageChannel(size_t capacity);
+
+    protected:
+        Message pop() override;
+
+        optional<Message> try_pop() override;
+
+        void close() override;
+
+        void push_message(Message) override;
+
+        MPMCBoundedChannel<Message> channel;
+    };
+
     /***
      * Creates a ChannelPair
      * @tparam ChannelType Type of Channel, typically MessageChannel
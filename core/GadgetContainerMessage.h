@@ -25,7 +25,7 @@ namespace Gadgetron {
         template<class... ARGS>
         explicit GadgetContainerMessage(ARGS&&... xs){
             message = std::make_unique<Core::TypedMessageChunk<T>>(std::forward<ARGS>(xs)...);
-            data = &message->data;
+            data = &message->get_mutable();
         }
 
          ~GadgetContainerMessage() override = default;
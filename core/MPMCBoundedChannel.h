@@ -0,0 +1,245 @@
+#pragma once
+
+#include "MPMCChannel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace Gadgetron::Core {
+
+    /**
+     * Bounded multi-producer/multi-consumer channel backed by a fixed size ring buffer.
+     *
+     * The fast path (try_push/try_pop) is lock free and does not allocate. Once the buffer is full, push blocks until
+     * a consumer has made room, providing backpressure to the producer. The mutex and condition variables are only
+     * touched when a thread actually has to wait.
+     *
+     * Capacity is rounded up to the nearest power of two.
+     */
+    template <class T> class MPMCBoundedChannel {
+    public:
+        explicit MPMCBoundedChannel(size_t capacity);
+        ~MPMCBoundedChannel();
+
+        MPMCBoundedChannel(const MPMCBoundedChannel&) = delete;
+        MPMCBoundedChannel& operator=(const MPMCBoundedChannel&) = delete;
+
+        /// Blocks until there is room in the channel. Throws ChannelClosed if the channel is closed.
+        void push(T);
+
+        template <class... ARGS> void emplace(ARGS&&... args);
+
+        /// Nonblocking push. Returns false if the channel is full. Throws ChannelClosed if the channel is closed.
+        bool try_push(T&);
+
+        /// Blocks until a value is available. Throws ChannelClosed if the channel is closed and empty.
+        T pop();
+        optional<T> try_pop();
+
+        void close();
+
+        size_t capacity() const { return mask + 1; }
+
+        /// Approximate number of elements in the channel.
+        size_t size() const;
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+            T* value() { return std::launder(reinterpret_cast<T*>(&storage)); }
+        };
+
+        // Padding to keep the producer and consumer indices on separate cache lines.
+        static constexpr size_t cache_line = 64;
+
+        bool enqueue(T& value);
+        optional<T> dequeue();
+
+        void notify_producers();
+        void notify_consumers();
+
+        const size_t mask;
+        std::unique_ptr<Cell[]> cells;
+
+        alignas(cache_line) std::atomic<size_t> enqueue_pos{0};
+        alignas(cache_line) std::atomic<size_t> dequeue_pos{0};
+
+        alignas(cache_line) std::atomic<bool> is_closed{false};
+        std::atomic<int> waiting_producers{0};
+        std::atomic<int> waiting_consumers{0};
+
+        std::mutex m;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+    };
+
+    /** Implementation **/
+
+    namespace detail {
+        inline size_t next_power_of_two(size_t value) {
+            size_t result = 1;
+            while (result < value)
+                result <<= 1;
+            return result;
+        }
+    }
+
+    template <class T>
+    MPMCBoundedChannel<T>::MPMCBoundedChannel(size_t capacity)
+        : mask{ detail::next_power_of_two(std::max<size_t>(capacity, 2)) - 1 }, cells{ new Cell[mask + 1] } {
+        for (size_t i = 0; i <= mask; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <class T> MPMCBoundedChannel<T>::~MPMCBoundedChannel() {
+        while (dequeue())
+            ;
+    }
+
+    template <class T> bool MPMCBoundedChannel<T>::enqueue(T& value) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell          = &cells[pos & mask];
+            size_t seq    = cell->sequence.load(std::memory_order_acquire);
+            auto distance = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (distance == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (distance < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::move(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T> optional<T> MPMCBoundedChannel<T>::dequeue() {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell          = &cells[pos & mask];
+            size_t seq    = cell->sequence.load(std::memory_order_acquire);
+            auto distance = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (distance == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (distance < 0) {
+                return none;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        optional<T> result{ std::move(*cell->value()) };
+        cell->value()->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return result;
+    }
+
+    template <class T> void MPMCBoundedChannel<T>::notify_producers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> guard(m);
+            not_full.notify_one();
+        }
+    }
+
+    template <class T> void MPMCBoundedChannel<T>::notify_consumers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> guard(m);
+            not_empty.notify_one();
+        }
+    }
+
+    template <class T> bool MPMCBoundedChannel<T>::try_push(T& message) {
+        if (is_closed.load(std::memory_order_acquire))
+            throw ChannelClosed();
+        if (!enqueue(message))
+            return false;
+        notify_consumers();
+        return true;
+    }
+
+    template <class T> void MPMCBoundedChannel<T>::push(T message) {
+        if (try_push(message))
+            return;
+
+        std::unique_lock<std::mutex> lock(m);
+        waiting_producers.fetch_add(1, std::memory_order_relaxed);
+        while (true) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (is_closed.load(std::memory_order_acquire)) {
+                waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+                throw ChannelClosed();
+            }
+            if (enqueue(message))
+                break;
+            not_full.wait(lock);
+        }
+        waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+        lock.unlock();
+        notify_consumers();
+    }
+
+    template <class T> template <class... ARGS> void MPMCBoundedChannel<T>::emplace(ARGS&&... args) {
+        push(T(std::forward<ARGS>(args)...));
+    }
+
+    template <class T> optional<T> MPMCBoundedChannel<T>::try_pop() {
+        auto message = dequeue();
+        if (message)
+            notify_producers();
+        return message;
+    }
+
+    template <class T> T MPMCBoundedChannel<T>::pop() {
+        if (auto message = try_pop())
+            return std::move(*message);
+
+        std::unique_lock<std::mutex> lock(m);
+        waiting_consumers.fetch_add(1, std::memory_order_relaxed);
+        optional<T> message;
+        while (true) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            message = dequeue();
+            if (message)
+                break;
+            if (is_closed.load(std::memory_order_acquire)) {
+                waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+                throw ChannelClosed();
+            }
+            not_empty.wait(lock);
+        }
+        waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+        lock.unlock();
+        notify_producers();
+        return std::move(*message);
+    }
+
+    template <class T> void MPMCBoundedChannel<T>::close() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            is_closed.store(true, std::memory_order_release);
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+    template <class T> size_t MPMCBoundedChannel<T>::size() const {
+        auto head = dequeue_pos.load(std::memory_order_relaxed);
+        auto tail = enqueue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+}
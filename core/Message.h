@@ -22,6 +22,9 @@ namespace Gadgetron {
         public:
             virtual ~MessageChunk() = default;
             virtual std::unique_ptr<MessageChunk> clone() const = 0;
+
+            /// Approximate size in bytes of the data held by the chunk. Array data is counted, other members are not.
+            virtual size_t size_in_bytes() const = 0;
         protected:
             virtual GadgetContainerMessageBase *to_container_message() = 0;
 
@@ -47,8 +50,12 @@ namespace Gadgetron {
 
             GadgetContainerMessageBase *to_container_message();
 
+            /// Clone sharing the data of every chunk; see TypedMessageChunk.
             Message clone();
 
+            /// Approximate size in bytes of the data held by the message; the sum over its chunks.
+            size_t size_in_bytes() const;
+
         private:
             std::vector<std::unique_ptr<MessageChunk>> messages_;
         };
@@ -73,12 +80,20 @@ namespace Gadgetron {
         optional<T> unpack(Message &&message);
 
 
+        /**
+         * Message chunk holding a value of type T.
+         *
+         * The value is reference counted: clone() shares it rather than copying it. The value is copied on write;
+         * get_mutable() and take() copy it if it is still shared, while the last chunk holding it gets it without a
+         * copy. Gadgets unpack their input through take(), so when a message is cloned to several branches, every
+         * branch but the last to unpack it still copies the value. Only get() (used by writers) never copies.
+         */
         template<class T>
         class TypedMessageChunk : public MessageChunk {
         public:
 
             template<class... ARGS>
-            explicit TypedMessageChunk(ARGS &&... xs) : data(std::forward<ARGS>(xs)...) {}
+            explicit TypedMessageChunk(ARGS &&... xs) : payload(std::make_shared<T>(std::forward<ARGS>(xs)...)) {}
 
             TypedMessageChunk(TypedMessageChunk &&other) = default;
 
@@ -92,10 +107,24 @@ namespace Gadgetron {
 
             std::unique_ptr<MessageChunk> clone() const override;
 
+            size_t size_in_bytes() const override;
+
             ~TypedMessageChunk() override = default;
 
-            T data;
+            /// Read only access to the value; never copies.
+            const T &get() const { return *payload; }
+
+            /// Mutable access to the value; copies it first if it is shared with a clone.
+            T &get_mutable();
 
+            /// Takes the value out of the chunk; moved if no clone shares it, copied otherwise.
+            T take();
+
+            /// True if a clone of this chunk holds the same value.
+            bool is_shared() const { return payload.use_count() > 1; }
+
+        private:
+            std::shared_ptr<T> payload;
         };
     }
 }
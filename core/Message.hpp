@@ -4,7 +4,9 @@
 #include <boost/optional.hpp>
 #include <boost/hana.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <utility>
 #include <boost/core/demangle.hpp>
 #include "Types.h"
 
@@ -13,18 +15,54 @@ namespace Gadgetron::Core {
 
     template<class T>
     GadgetContainerMessageBase* TypedMessageChunk<T>::to_container_message() {
-        return new GadgetContainerMessage<T>(std::move(data));
+        return new GadgetContainerMessage<T>(take());
     }
 
 
     template<class T>
     std::unique_ptr<MessageChunk> TypedMessageChunk<T>::clone() const {
-        return std::make_unique<TypedMessageChunk<T>>(data);
+        return std::make_unique<TypedMessageChunk<T>>(*this);
+    }
+
+    template<class T>
+    T &TypedMessageChunk<T>::get_mutable() {
+        if (payload.use_count() != 1) {
+            payload = std::make_shared<T>(std::as_const(*payload));
+        } else {
+            // Pairs with the release of the clones that used to share the value.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *payload;
+    }
+
+    template<class T>
+    T TypedMessageChunk<T>::take() {
+        if (payload.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return std::move(*payload);
+        }
+        return *payload;
+    }
+
+    namespace detail {
+        template<class T, class = void>
+        struct has_number_of_bytes : std::false_type {};
+
+        template<class T>
+        struct has_number_of_bytes<T, std::void_t<decltype(std::declval<const T&>().get_number_of_bytes())>>
+            : std::true_type {};
+    }
+
+    template<class T>
+    size_t TypedMessageChunk<T>::size_in_bytes() const {
+        if constexpr (detail::has_number_of_bytes<T>::value)
+            return get().get_number_of_bytes();
+        else
+            return sizeof(T);
     }
 
     namespace {
         namespace gadgetron_message_detail {
-
             template<class T>
             std::unique_ptr<MessageChunk> make_message(T &&input) {
                 return std::make_unique<TypedMessageChunk<std::remove_reference_t<T>>>(std::forward<T>(input));
@@ -109,7 +147,7 @@ namespace Gadgetron::Core {
 
                 template<class T, class... SARGS>
                 static hana::tuple<T, SARGS...> combine(T &&val1, hana::tuple<SARGS...> &&val2) {
-                    return hana::prepend(val2, std::forward<T>(val1));
+                    return hana::prepend(std::move(val2), std::forward<T>(val1));
                 }
 
 
@@ -146,21 +184,21 @@ namespace Gadgetron::Core {
 
                 template<class Iterator, class T>
                 static T convert(Iterator &it, const Iterator &it_end, const hana::basic_type<T>&) {
-                    return std::move(reinterpret_message<T>(**it).data);
+                    return reinterpret_message<T>(**it).take();
                 }
 
                 template<class Iterator, class T>
                 static optional <T> convert(Iterator &it, const Iterator &it_end, const hana::basic_type<optional < T>>
 
                 ) {
-                    if (convertible(it, it_end, hana::type_c<T>)) return reinterpret_message<T>(**it).data;
+                    if (convertible(it, it_end, hana::type_c<T>)) return reinterpret_message<T>(**it).take();
                     return optional<T>();
                 }
 
                 template<class Iterator, class T, class... TYPES>
                 static hana::tuple<T, TYPES...> convert(Iterator &it, const Iterator &it_end, const hana::basic_type<T>&,
                                                         const hana::basic_type<TYPES> &...xs) {
-                    auto &value = reinterpret_message<T>(**it).data;
+                    auto value = reinterpret_message<T>(**it).take();
                     return combine(std::move(value), convert(++it, it_end, xs...));
                 }
 
@@ -172,7 +210,7 @@ namespace Gadgetron::Core {
                 ) {
 
                     if (convertible(it, it_end, hana::basic_type<T>(), xs...)) {
-                        auto &val = reinterpret_message<T>(**it).data;
+                        auto val = reinterpret_message<T>(**it).take();
                         return combine(optional<T>(std::move(val)), convert(++it, it_end, xs...));
                     }
                     return combine(optional<T>(), convert(it, it_end, xs...));
@@ -181,7 +219,7 @@ namespace Gadgetron::Core {
                 template<class Iterator, class... TTYPES>
                 static tuple<TTYPES...>
                 convert(Iterator it, const Iterator &it_end, const hana::basic_type<tuple < TTYPES...>>&) {
-                    return hana::unpack(convert(it, it_end, hana::type_c<TTYPES>...), [](auto ...xs) {
+                    return hana::unpack(convert(it, it_end, hana::type_c<TTYPES>...), [](auto &&...xs) {
                         return std::make_tuple(std::move(xs)...);
                     });
                 }
@@ -214,7 +252,7 @@ namespace Gadgetron::Core {
                                       const hana::basic_type<TYPES> &... xs) {
 
                     auto result = convert(it, it_end, xs...);
-                    return hana::unpack(result, [](auto ...xs) {
+                    return hana::unpack(std::move(result), [](auto &&...xs) {
                         return std::make_tuple(std::move(xs)...);
                     });
 
@@ -12,6 +12,7 @@ namespace Gadgetron::Core {
         QUERY                                              = 6,
         RESPONSE                                           = 7,
         ERROR                                              = 8,
+        COMPRESSION                                        = 9,
 		GADGET_MESSAGE_EXT_ID_MIN                          = 1000,
 		GADGET_MESSAGE_ISMRMRD_ACQUISITION                 = 1008,
 		GADGET_MESSAGE_DICOM_WITHNAME                      = 1018,
@@ -1,6 +1,11 @@
 #include "StorageSetup.h"
 
+#include <condition_variable>
+#include <future>
 #include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <curl/curl.h>
 #include <date/date.h>
@@ -26,12 +31,146 @@ size_t content_write_callback(char* ptr, size_t size, size_t nmemb, std::strings
     return size * nmemb;
 }
 
-// Copies the request body
+// Copies the request body. A stream gone bad aborts the upload, rather than storing a truncated item.
 size_t content_read_callback(char* dest, size_t size, size_t nmemb, std::istream* stream) {
     stream->read(dest, size * nmemb);
+    if (stream->bad()) {
+        return CURL_READFUNC_ABORT;
+    }
     return stream->gcount();
 }
 
+// Bounded byte queue between two threads, so items pass between curl and the serializer without either side
+// holding a full copy.
+class Pipe {
+  public:
+    explicit Pipe(size_t capacity) : buffer(capacity) {}
+
+    // Blocks while the pipe is full. Returns false if the reading end has been closed.
+    bool write(const char* data, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (size) {
+            cv.wait(lock, [&]() { return read_closed || used < buffer.size(); });
+            if (read_closed) {
+                return false;
+            }
+
+            auto tail = (head + used) % buffer.size();
+            auto count = std::min(size, std::min(buffer.size() - used, buffer.size() - tail));
+            std::copy_n(data, count, buffer.begin() + tail);
+            used += count;
+            data += count;
+            size -= count;
+            cv.notify_all();
+        }
+        return true;
+    }
+
+    // Blocks while the pipe is empty. Returns 0 once the writing end has been closed and everything has been read,
+    // or throws the error the writing end was closed with.
+    size_t read(char* data, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return write_closed || used > 0; });
+        if (!used) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return 0;
+        }
+
+        auto count = std::min(size, std::min(used, buffer.size() - head));
+        std::copy_n(buffer.begin() + head, count, data);
+        head = (head + count) % buffer.size();
+        used -= count;
+        cv.notify_all();
+        return count;
+    }
+
+    void close_write(std::exception_ptr error = nullptr) {
+        std::lock_guard<std::mutex> guard(mutex);
+        write_closed = true;
+        this->error = error;
+        cv.notify_all();
+    }
+
+    void close_read() {
+        std::lock_guard<std::mutex> guard(mutex);
+        read_closed = true;
+        cv.notify_all();
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<char> buffer;
+    size_t head = 0;
+    size_t used = 0;
+    bool write_closed = false;
+    bool read_closed = false;
+    std::exception_ptr error;
+};
+
+constexpr size_t pipe_capacity = 1u << 20;
+constexpr size_t pipe_chunk_size = 1u << 16;
+
+class PipeOutputBuffer : public std::streambuf {
+  public:
+    explicit PipeOutputBuffer(Pipe& pipe) : pipe(pipe), buffer(pipe_chunk_size) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+  protected:
+    int_type overflow(int_type ch) override {
+        if (sync() != 0) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        if (count < epptr() - pptr()) {
+            return std::streambuf::xsputn(data, count);
+        }
+        if (sync() != 0 || !pipe.write(data, count)) {
+            return 0;
+        }
+        return count;
+    }
+
+    int sync() override {
+        auto pending = pptr() - pbase();
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return pipe.write(buffer.data(), pending) ? 0 : -1;
+    }
+
+  private:
+    Pipe& pipe;
+    std::vector<char> buffer;
+};
+
+class PipeInputBuffer : public std::streambuf {
+  public:
+    explicit PipeInputBuffer(Pipe& pipe) : pipe(pipe), buffer(pipe_chunk_size) {}
+
+  protected:
+    int_type underflow() override {
+        auto count = pipe.read(buffer.data(), buffer.size());
+        if (!count) {
+            return traits_type::eof();
+        }
+        setg(buffer.data(), buffer.data(), buffer.data() + count);
+        return traits_type::to_int_type(*gptr());
+    }
+
+  private:
+    Pipe& pipe;
+    std::vector<char> buffer;
+};
+
 template <typename T> using CurlHandle = std::unique_ptr<T, std::function<void(T*)>>;
 
 CurlHandle<CURL> create_curl_handle() {
@@ -47,6 +186,82 @@ CurlHandle<CURL> create_curl_handle() {
     return handle;
 }
 
+// Reads a response body while curl is still receiving it on another thread. The status code is known once the
+// first part of the body has arrived, or the transfer has finished.
+class DownloadStream : public std::istream {
+  public:
+    explicit DownloadStream(std::string const& url) : std::istream(nullptr), pipe(pipe_capacity), buffer(pipe) {
+        rdbuf(&buffer);
+        // A transfer failing halfway through is reported to the reader, rather than looking like the end of the item.
+        exceptions(std::ios::badbit);
+
+        curl_easy_setopt(curl_handle.get(), CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl_handle.get(), CURLOPT_WRITEFUNCTION, write_callback);
+        curl_easy_setopt(curl_handle.get(), CURLOPT_WRITEDATA, this);
+
+        transfer = std::thread([this]() { perform(); });
+    }
+
+    ~DownloadStream() override {
+        pipe.close_read();
+        if (transfer.joinable()) {
+            transfer.join();
+        }
+    }
+
+    long status_code() { return status.get(); }
+
+    // Waits for the transfer to finish. Only holds anything if the status code was not 200.
+    std::string const& error_body() {
+        transfer.join();
+        return body;
+    }
+
+  private:
+    void perform() {
+        auto res = curl_easy_perform(curl_handle.get());
+        if (res != CURLE_OK) {
+            auto error = std::make_exception_ptr(
+                std::runtime_error("Failed to get item: " + std::string(curl_easy_strerror(res))));
+            if (!code) {
+                status_promise.set_exception(error);
+            }
+            pipe.close_write(error);
+            return;
+        }
+
+        if (!code) {
+            curl_easy_getinfo(curl_handle.get(), CURLINFO_RESPONSE_CODE, &code);
+            status_promise.set_value(code);
+        }
+        pipe.close_write();
+    }
+
+    static size_t write_callback(char* ptr, size_t size, size_t nmemb, DownloadStream* self) {
+        if (!self->code) {
+            curl_easy_getinfo(self->curl_handle.get(), CURLINFO_RESPONSE_CODE, &self->code);
+            self->status_promise.set_value(self->code);
+        }
+
+        if (self->code != 200) {
+            self->body.append(ptr, size * nmemb);
+            return size * nmemb;
+        }
+
+        // Returning less than was given makes curl abort the transfer, once nobody is reading any more.
+        return self->pipe.write(ptr, size * nmemb) ? size * nmemb : 0;
+    }
+
+    Pipe pipe;
+    PipeInputBuffer buffer;
+    CurlHandle<CURL> curl_handle = create_curl_handle();
+    long code = 0;
+    std::promise<long> status_promise;
+    std::future<long> status = status_promise.get_future();
+    std::string body;
+    std::thread transfer;
+};
+
 StorageItem storage_item_from_json(json j) {
     StorageItem s;
     StorageItemTags::Builder tag_builder(j["subject"].get<std::string>());
@@ -182,22 +397,9 @@ std::shared_ptr<std::istream> StorageClient::get_latest_item(StorageItemTags con
 }
 
 std::shared_ptr<std::istream> StorageClient::get_item_by_url(const std::string& url) {
-    // Note that we are loading the entire response into memory here, which will be
-    // problematic for large items.
-
-    auto response_body = std::make_shared<std::stringstream>();
-    auto curl_handle = create_curl_handle();
-    curl_easy_setopt(curl_handle.get(), CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl_handle.get(), CURLOPT_WRITEFUNCTION, content_write_callback);
-    curl_easy_setopt(curl_handle.get(), CURLOPT_WRITEDATA, response_body.get());
-
-    auto res = curl_easy_perform(curl_handle.get());
-    if (res != CURLE_OK) {
-        throw std::runtime_error("Failed to get item: " + std::string(curl_easy_strerror(res)));
-    }
+    auto download = std::make_shared<DownloadStream>(url);
 
-    long status_code;
-    curl_easy_getinfo(curl_handle.get(), CURLINFO_RESPONSE_CODE, &status_code);
+    auto status_code = download->status_code();
     if (status_code == 404) {
         return {};
     }
@@ -205,10 +407,10 @@ std::shared_ptr<std::istream> StorageClient::get_item_by_url(const std::string&
     if (status_code != 200) {
         throw std::runtime_error("Storage server error when getting item.\n"
                                  "HTTP status code: " +
-                                 std::to_string(status_code) + "\n" + "Body: " + response_body->str());
+                                 std::to_string(status_code) + "\n" + "Body: " + download->error_body());
     }
 
-    return response_body;
+    return download;
 }
 
 StorageItem StorageClient::store_item(StorageItemTags const& tags, std::istream& data,
@@ -254,6 +456,48 @@ StorageItem StorageClient::store_item(StorageItemTags const& tags, std::istream&
     return storage_item_from_json(json::parse(response_body.str()));
 }
 
+StorageItem StorageClient::store_item_from(StorageItemTags const& tags,
+                                           std::function<void(std::ostream&)> const& writer,
+                                           std::optional<std::chrono::seconds> time_to_live) {
+    Pipe pipe(pipe_capacity);
+
+    std::exception_ptr writer_error;
+    std::thread serializer([&]() {
+        PipeOutputBuffer buffer(pipe);
+        std::ostream stream(&buffer);
+        try {
+            writer(stream);
+            stream.flush();
+        } catch (...) {
+            writer_error = std::current_exception();
+        }
+        // Closing with the error makes the upload abort, rather than store what was written so far.
+        pipe.close_write(writer_error);
+    });
+
+    PipeInputBuffer buffer(pipe);
+    std::istream data(&buffer);
+
+    std::optional<StorageItem> item;
+    std::exception_ptr upload_error;
+    try {
+        item = store_item(tags, data, time_to_live);
+    } catch (...) {
+        upload_error = std::current_exception();
+    }
+
+    pipe.close_read();
+    serializer.join();
+
+    if (writer_error) {
+        std::rethrow_exception(writer_error);
+    }
+    if (upload_error) {
+        std::rethrow_exception(upload_error);
+    }
+    return std::move(*item);
+}
+
 std::optional<std::string> StorageClient::health_check() {
     std::string url = base_url + "/healthcheck";
     std::stringstream response_body;
@@ -0,0 +1,265 @@
+#include "StorageCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "log.h"
+
+namespace fs = boost::filesystem;
+using namespace Gadgetron::Storage;
+
+namespace {
+
+using Clock = std::chrono::system_clock;
+
+constexpr uint64_t max_key_length = 1u << 16;
+
+// Temporary files this old were left behind by a process that did not finish writing them.
+constexpr auto abandoned_after = std::chrono::hours(1);
+
+int64_t milliseconds_since_epoch(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+// An entry starts with when it expires, in milliseconds since the epoch, followed by the key it was stored under.
+// The item makes up the rest of the file.
+void write_entry_header(std::ostream& stream, int64_t expires, std::string const& key) {
+    Gadgetron::Core::IO::write(stream, expires);
+    Gadgetron::Core::IO::write_string_to_stream(stream, key);
+}
+
+std::optional<std::pair<int64_t, std::string>> read_entry_header(std::istream& stream) {
+    auto expires = Gadgetron::Core::IO::read<int64_t>(stream);
+    auto length = Gadgetron::Core::IO::read<uint64_t>(stream);
+    if (!stream || length > max_key_length) {
+        return {};
+    }
+
+    std::string key(length, '\0');
+    stream.read(key.data(), length);
+    if (!stream) {
+        return {};
+    }
+    return std::make_pair(expires, key);
+}
+
+void copy_stream(std::istream& from, std::ostream& to) {
+    std::vector<char> buffer(1u << 16);
+    while (from) {
+        from.read(buffer.data(), buffer.size());
+        to.write(buffer.data(), from.gcount());
+    }
+}
+
+std::string latest_key(StorageItemTags const& tags) {
+    std::stringstream key;
+    auto write_field = [&](std::string const& name, std::string const& value) {
+        Gadgetron::Core::IO::write_string_to_stream(key, name);
+        Gadgetron::Core::IO::write_string_to_stream(key, value);
+    };
+
+    write_field("latest", tags.subject);
+    if (tags.device) {
+        write_field("device", *tags.device);
+    }
+    if (tags.session) {
+        write_field("session", *tags.session);
+    }
+    if (tags.name) {
+        write_field("name", *tags.name);
+    }
+    for (auto& [name, value] : tags.custom_tags) {
+        write_field("tag:" + name, value);
+    }
+    return key.str();
+}
+
+std::string url_key(std::string const& url) { return "url:" + url; }
+
+// FNV-1a; only used to name the files, the full key is checked on every lookup.
+std::string file_name(std::string const& key) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return name.str();
+}
+
+fs::path temporary_path(fs::path const& directory) {
+    return directory / fs::unique_path("%%%%-%%%%-%%%%-%%%%.tmp");
+}
+
+} // namespace
+
+namespace Gadgetron::Storage {
+
+CachingStorageClient::CachingStorageClient(std::shared_ptr<StorageClient> upstream, fs::path directory,
+                                           std::chrono::seconds time_to_live,
+                                           std::function<Clock::time_point()> clock)
+    : upstream(std::move(upstream)), directory(std::move(directory)), time_to_live(time_to_live),
+      clock(std::move(clock)) {
+    fs::create_directories(this->directory);
+    remove_expired_entries();
+}
+
+StorageItemList CachingStorageClient::list_items(StorageItemTags const& tags, size_t limit) {
+    return upstream->list_items(tags, limit);
+}
+
+StorageItemList CachingStorageClient::get_next_page_of_items(StorageItemList const& page) {
+    return upstream->get_next_page_of_items(page);
+}
+
+std::shared_ptr<std::istream> CachingStorageClient::get_latest_item(StorageItemTags const& tags) {
+    auto key = latest_key(tags);
+    if (auto cached = lookup(key)) {
+        return cached;
+    }
+
+    auto data = upstream->get_latest_item(tags);
+    if (!data) {
+        return data;
+    }
+    return insert(key, *data);
+}
+
+std::shared_ptr<std::istream> CachingStorageClient::get_item_by_url(std::string const& url) {
+    auto key = url_key(url);
+    if (auto cached = lookup(key)) {
+        return cached;
+    }
+
+    auto data = upstream->get_item_by_url(url);
+    if (!data) {
+        return data;
+    }
+    return insert(key, *data);
+}
+
+StorageItem CachingStorageClient::store_item(StorageItemTags const& tags, std::istream& data,
+                                             std::optional<std::chrono::seconds> time_to_live) {
+    return store_item_from(
+        tags, [&](std::ostream& stream) { copy_stream(data, stream); }, time_to_live);
+}
+
+StorageItem CachingStorageClient::store_item_from(StorageItemTags const& tags,
+                                                  std::function<void(std::ostream&)> const& writer,
+                                                  std::optional<std::chrono::seconds> time_to_live) {
+    auto key = latest_key(tags);
+    auto temporary = temporary_path(directory);
+    boost::system::error_code ignored;
+
+    // The item is written to the entry first, and uploaded from there; the expiry is filled in once the server has
+    // told us when the item expires.
+    StorageItem item;
+    try {
+        std::ofstream output(temporary.string(), std::ios::binary);
+        write_entry_header(output, 0, key);
+        writer(output);
+        output.close();
+        if (!output) {
+            throw std::runtime_error("Failed to write storage cache entry " + temporary.string());
+        }
+
+        std::ifstream input(temporary.string(), std::ios::binary);
+        read_entry_header(input);
+        item = upstream->store_item(tags, input, time_to_live);
+    } catch (...) {
+        fs::remove(temporary, ignored);
+        throw;
+    }
+
+    auto expires = clock() + this->time_to_live;
+    if (item.expires) {
+        expires = std::min(expires, *item.expires);
+    }
+
+    try {
+        std::fstream entry(temporary.string(), std::ios::binary | std::ios::in | std::ios::out);
+        Core::IO::write(entry, milliseconds_since_epoch(expires));
+        entry.close();
+        fs::rename(temporary, entry_path(key));
+    } catch (fs::filesystem_error const& e) {
+        // The item is on the server; only the local copy is missing.
+        GWARN_STREAM("Failed to add stored item to the storage cache: " << e.what());
+        fs::remove(temporary, ignored);
+    }
+
+    return item;
+}
+
+std::optional<std::string> CachingStorageClient::health_check() { return upstream->health_check(); }
+
+std::shared_ptr<std::istream> CachingStorageClient::lookup(std::string const& key) const {
+    auto file = std::make_shared<std::ifstream>(entry_path(key).string(), std::ios::binary);
+    if (!*file) {
+        return {};
+    }
+
+    auto header = read_entry_header(*file);
+    if (!header || header->second != key || header->first <= milliseconds_since_epoch(clock())) {
+        return {};
+    }
+    return file;
+}
+
+std::shared_ptr<std::istream> CachingStorageClient::insert(std::string const& key, std::istream& data) {
+    auto temporary = temporary_path(directory);
+    try {
+        std::ofstream output(temporary.string(), std::ios::binary);
+        write_entry_header(output, milliseconds_since_epoch(clock() + time_to_live), key);
+        copy_stream(data, output);
+        output.close();
+        if (!output) {
+            throw std::runtime_error("Failed to write storage cache entry " + temporary.string());
+        }
+
+        // The open file stays readable after the rename, even if another process replaces the entry meanwhile.
+        auto input = std::make_shared<std::ifstream>(temporary.string(), std::ios::binary);
+        read_entry_header(*input);
+        fs::rename(temporary, entry_path(key));
+        return input;
+    } catch (...) {
+        boost::system::error_code ignored;
+        fs::remove(temporary, ignored);
+        throw;
+    }
+}
+
+fs::path CachingStorageClient::entry_path(std::string const& key) const { return directory / file_name(key); }
+
+void CachingStorageClient::remove_expired_entries() const {
+    auto now = clock();
+    boost::system::error_code ignored;
+
+    for (auto& entry : fs::directory_iterator(directory)) {
+        if (!fs::is_regular_file(entry.status())) {
+            continue;
+        }
+
+        if (entry.path().extension() == ".tmp") {
+            // File times are real time, whatever the clock of the cache.
+            auto modified = Clock::from_time_t(fs::last_write_time(entry.path(), ignored));
+            if (Clock::now() - modified > abandoned_after) {
+                fs::remove(entry.path(), ignored);
+            }
+            continue;
+        }
+
+        std::ifstream file(entry.path().string(), std::ios::binary);
+        auto header = read_entry_header(file);
+        file.close();
+        if (!header || header->first <= milliseconds_since_epoch(now)) {
+            fs::remove(entry.path(), ignored);
+        }
+    }
+}
+
+} // namespace Gadgetron::Storage
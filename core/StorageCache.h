@@ -0,0 +1,60 @@
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <chrono>
+#include <functional>
+
+#include "StorageSetup.h"
+
+namespace Gadgetron::Storage {
+
+/**
+ * Storage client keeping copies of the items it reads and writes in a local directory, in front of another client.
+ *
+ * A latest item is served from the directory until the copy is older than the cache time to live, or the item
+ * expires on the storage server, whichever comes first. Storing an item through the cache replaces the copy for its
+ * tags, so reading back what was stored earlier in the session stays local; items stored by other clients are seen
+ * once the copy has expired. Items fetched by URL never change, and are kept for the cache time to live.
+ *
+ * Copies are written to a temporary file and renamed into place, so several processes may share a directory.
+ *
+ * The clock deciding when copies expire can be replaced, for tests.
+ */
+class CachingStorageClient : public StorageClient {
+  public:
+    using Clock = std::chrono::system_clock;
+
+    CachingStorageClient(std::shared_ptr<StorageClient> upstream, boost::filesystem::path directory,
+                         std::chrono::seconds time_to_live,
+                         std::function<Clock::time_point()> clock = &Clock::now);
+
+    StorageItemList list_items(StorageItemTags const& tags, size_t limit = 20) override;
+
+    StorageItemList get_next_page_of_items(StorageItemList const& page) override;
+
+    std::shared_ptr<std::istream> get_latest_item(StorageItemTags const& tags) override;
+
+    std::shared_ptr<std::istream> get_item_by_url(std::string const& url) override;
+
+    StorageItem store_item(StorageItemTags const& tags, std::istream& data,
+                           std::optional<std::chrono::seconds> time_to_live = {}) override;
+
+    StorageItem store_item_from(StorageItemTags const& tags, std::function<void(std::ostream&)> const& writer,
+                                std::optional<std::chrono::seconds> time_to_live = {}) override;
+
+    std::optional<std::string> health_check() override;
+
+  private:
+    std::shared_ptr<std::istream> lookup(std::string const& key) const;
+    std::shared_ptr<std::istream> insert(std::string const& key, std::istream& data);
+    boost::filesystem::path entry_path(std::string const& key) const;
+    void remove_expired_entries() const;
+
+    std::shared_ptr<StorageClient> upstream;
+    boost::filesystem::path directory;
+    std::chrono::seconds time_to_live;
+    std::function<Clock::time_point()> clock;
+};
+
+} // namespace Gadgetron::Storage
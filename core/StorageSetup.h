@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <istream>
 #include <map>
 #include <memory>
@@ -85,6 +86,7 @@ class StorageClient {
 
     virtual StorageItemList get_next_page_of_items(StorageItemList const& page);
 
+    /// The returned stream reads the item as it arrives from the server; it does not hold the whole item in memory.
     virtual std::shared_ptr<std::istream> get_latest_item(StorageItemTags const& tags);
 
     virtual std::shared_ptr<std::istream> get_item_by_url(std::string const& url);
@@ -92,8 +94,16 @@ class StorageClient {
     virtual StorageItem store_item(StorageItemTags const& tags, std::istream& data,
                                    std::optional<std::chrono::seconds> time_to_live = {});
 
+    /// Uploads what the writer writes to the stream it is given, as it is written. If the writer throws, the upload is
+    /// aborted and the exception is rethrown.
+    virtual StorageItem store_item_from(StorageItemTags const& tags, std::function<void(std::ostream&)> const& writer,
+                                        std::optional<std::chrono::seconds> time_to_live = {});
+
     virtual std::optional<std::string> health_check();
 
+  protected:
+    StorageClient() = default;
+
   private:
     std::string base_url;
 };
@@ -116,9 +126,9 @@ class StorageSpace {
     template <class T, typename Rep, typename Period>
     void store(const std::string& key, const T& value, std::chrono::duration<Rep, Period> duration) {
         auto tags = get_tag_builder(true).with_name(key).build();
-        std::stringstream stream;
-        Core::IO::write(stream, value);
-        client->store_item(tags, stream, std::chrono::duration_cast<std::chrono::seconds>(duration));
+        client->store_item_from(
+            tags, [&](std::ostream& stream) { Core::IO::write(stream, value); },
+            std::chrono::duration_cast<std::chrono::seconds>(duration));
     }
 
   protected:
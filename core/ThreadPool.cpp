@@ -0,0 +1,270 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    using namespace Gadgetron::Core;
+
+    thread_local ThreadPool* current_pool = nullptr;
+    thread_local size_t current_worker    = 0;
+
+    std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string token;
+        while (std::getline(stream, token, ',')) {
+            if (token.empty())
+                continue;
+            auto dash = token.find('-');
+            auto first = std::stoi(token.substr(0, dash));
+            auto last  = dash == std::string::npos ? first : std::stoi(token.substr(dash + 1));
+            for (auto cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<std::vector<int>> numa_nodes() {
+        std::vector<std::vector<int>> nodes;
+
+        boost::system::error_code ec;
+        boost::filesystem::path node_root("/sys/devices/system/node");
+        for (auto node = 0;; node++) {
+            auto cpulist = node_root / ("node" + std::to_string(node)) / "cpulist";
+            if (!boost::filesystem::exists(cpulist, ec))
+                break;
+            std::ifstream file(cpulist.string());
+            std::string list;
+            std::getline(file, list);
+            auto cpus = parse_cpu_list(list);
+            if (!cpus.empty())
+                nodes.push_back(std::move(cpus));
+        }
+
+        if (nodes.empty()) {
+            std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+            for (size_t i = 0; i < cpus.size(); i++)
+                cpus[i] = int(i);
+            nodes.push_back(std::move(cpus));
+        }
+        return nodes;
+    }
+
+    // Worker i is placed on NUMA node i % nodes, so consecutive workers are spread over the memory controllers.
+    std::vector<int> worker_cpus(size_t workers) {
+        auto nodes = numa_nodes();
+        std::vector<int> cpus;
+        for (size_t i = 0; i < workers; i++) {
+            auto& node = nodes[i % nodes.size()];
+            cpus.push_back(node[(i / nodes.size()) % node.size()]);
+        }
+        return cpus;
+    }
+
+    void pin_to_cpu(std::thread& thread, int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+    }
+
+    unsigned int shared_pool_size() {
+        if (auto workers = std::getenv("GADGETRON_THREADPOOL_WORKERS")) {
+            auto value = std::strtoul(workers, nullptr, 10);
+            if (value > 0)
+                return static_cast<unsigned int>(value);
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    bool shared_pool_pinned() {
+        auto pin = std::getenv("GADGETRON_THREADPOOL_PIN");
+        return pin && std::string(pin) != "0";
+    }
+}
+
+namespace Gadgetron::Core {
+
+    ThreadPool::ThreadPool(unsigned int workers, bool pin_workers) {
+        workers = std::max(1u, workers);
+        for (auto i = 0u; i < workers; i++)
+            queues.emplace_back(std::make_unique<WorkQueue>());
+
+        for (auto i = 0u; i < workers; i++)
+            threads.emplace_back([this, i]() { this->worker_loop(i); });
+
+        if (pin_workers) {
+            auto cpus = worker_cpus(workers);
+            for (auto i = 0u; i < workers; i++)
+                pin_to_cpu(threads[i], cpus[i]);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        join();
+    }
+
+    ThreadPool& ThreadPool::shared() {
+        // Created on first use, which keeps the workers out of the parent process when connections are forked.
+        static ThreadPool pool(shared_pool_size(), shared_pool_pinned());
+        return pool;
+    }
+
+    void ThreadPool::post(Task task) {
+        {
+            std::lock_guard<std::mutex> guard(sleep_mutex);
+            if (stopping)
+                throw ChannelClosed();
+        }
+        push(std::move(task));
+    }
+
+    void ThreadPool::push(Task task) {
+        auto index = current_pool == this ? current_worker
+                                          : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            auto& queue = *queues[index];
+            std::lock_guard<std::mutex> guard(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        pending.fetch_add(1);
+        if (sleeping.load() > 0) {
+            std::lock_guard<std::mutex> guard(sleep_mutex);
+            wake.notify_one();
+        }
+    }
+
+    bool ThreadPool::try_pop(size_t index, Task& task) {
+        auto& queue = *queues[index];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::try_steal(size_t index, Task& task) {
+        for (size_t offset = 1; offset < queues.size(); offset++) {
+            auto& queue = *queues[(index + offset) % queues.size()];
+            std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+            if (!lock || queue.tasks.empty())
+                continue;
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::worker_loop(size_t index) {
+        current_pool   = this;
+        current_worker = index;
+
+        Task task;
+        while (true) {
+            if (try_pop(index, task) || try_steal(index, task)) {
+                pending.fetch_sub(1);
+                task();
+                task = Task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleeping.fetch_add(1);
+            if (pending.load() > 0) {
+                sleeping.fetch_sub(1);
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            if (stopping) {
+                sleeping.fetch_sub(1);
+                return;
+            }
+            wake.wait(lock);
+            sleeping.fetch_sub(1);
+        }
+    }
+
+    void ThreadPool::join() {
+        std::lock_guard<std::mutex> join_guard(join_mutex);
+        if (joined)
+            return;
+        {
+            std::lock_guard<std::mutex> guard(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+        joined = true;
+    }
+
+    size_t ThreadPool::grain_size(size_t begin, size_t end, size_t grain) const {
+        if (grain)
+            return grain;
+        // Aim for a few chunks per worker, so stealing can even out imbalanced iterations.
+        return std::max<size_t>(1, (end - begin) / (4 * size()));
+    }
+
+    std::shared_ptr<ThreadPool::Range> ThreadPool::post_range(
+        size_t begin, size_t end, size_t grain, std::function<void(size_t)> f) {
+        auto range   = std::make_shared<Range>(begin, end, grain, std::move(f));
+        auto helpers = std::min(range->chunks, size());
+        for (size_t i = 0; i < helpers; i++)
+            post([range]() { range->run(); });
+        return range;
+    }
+
+    ThreadPool::Range::Range(size_t begin, size_t end, size_t grain, std::function<void(size_t)> f)
+        : begin{ begin }, end{ end }, grain{ grain }, chunks{ (end - begin + grain - 1) / grain }, f{ std::move(f) } {}
+
+    bool ThreadPool::Range::run() {
+        bool finished_last = false;
+        while (true) {
+            auto chunk = next_chunk.fetch_add(1);
+            if (chunk >= chunks)
+                return finished_last;
+
+            try {
+                auto chunk_begin = begin + chunk * grain;
+                auto chunk_end   = std::min(end, chunk_begin + grain);
+                for (auto i = chunk_begin; i < chunk_end; i++)
+                    f(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+
+            if (completed_chunks.fetch_add(1) + 1 == chunks) {
+                finished_last = true;
+                std::lock_guard<std::mutex> guard(mutex);
+                if (exception)
+                    promise.set_exception(exception);
+                else
+                    promise.set_value();
+                done.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::Range::wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return completed_chunks.load() == chunks; });
+    }
+}
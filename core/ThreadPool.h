@@ -5,101 +5,281 @@
 #pragma once
 #include "MPMCChannel.h"
 #include <boost/hana.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace Gadgetron::Core {
 
-
+    /**
+     * Work-stealing thread pool.
+     *
+     * Every worker owns a deque of tasks. Workers take work from the back of their own deque and steal from the
+     * front of the other workers' deques when they run dry. Tasks submitted from inside a worker go to that worker's
+     * deque, tasks submitted from outside are spread round-robin over the workers.
+     *
+     * Tasks store small callables inline, so post() does not allocate for small lambdas. async() additionally
+     * allocates the shared state of the returned future.
+     *
+     * ThreadPool::shared() returns a process-wide pool, which should be preferred over creating a pool per connection.
+     */
     class ThreadPool {
-    private:
-        class Work {
+    public:
+        /**
+         * Move-only, type erased callable with inline storage for small functors.
+         */
+        class Task {
         public:
-            virtual void execute() = 0;
-            virtual ~Work()        = default;
-        };
+            Task() = default;
 
-        template <class F, class... ARGS> class Storage{
-        public:
-            explicit Storage(F&& f, ARGS&&... args)
-                : f{ std::forward<F>(f) }, args{ std::forward<ARGS>(args)... } {}
-        protected:
-            F f;
-            boost::hana::tuple<std::decay_t<ARGS>...> args;
-        public:
-            using R = decltype(boost::hana::unpack(std::move(args),f));
-        protected:
-            std::promise<R> promise;
+            template <class F, class = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>>
+            Task(F&& f) {
+                using Functor = std::decay_t<F>;
+                if constexpr (fits_inline<Functor>()) {
+                    new (&storage) Functor(std::forward<F>(f));
+                    vtable = inline_vtable<Functor>();
+                } else {
+                    heap   = new Functor(std::forward<F>(f));
+                    vtable = heap_vtable<Functor>();
+                }
+            }
 
+            Task(Task&& other) noexcept { move_from(other); }
 
-        public:
-            std::future<R> get_future() {
-                return promise.get_future();
+            Task& operator=(Task&& other) noexcept {
+                if (this != &other) {
+                    reset();
+                    move_from(other);
+                }
+                return *this;
             }
-        };
-        template<class F, bool IS_VOID, class... ARGS> class ConcreteWorkImpl{};
 
-        template<class F, class... ARGS> class ConcreteWorkImpl<F,false,ARGS...> : public Work, public Storage<F,ARGS...> {
-        public:
-            using Storage<F,ARGS...>::Storage;
+            ~Task() { reset(); }
 
-            void execute() override {
-                try {
-                    auto val = boost::hana::unpack(std::move(this->args),this->f);
-                    this->promise.set_value(std::move(val));
-                } catch (...){
-                    this->promise.set_exception(std::current_exception());
-                }
+            void operator()() { vtable->invoke(*this); }
+
+            explicit operator bool() const { return vtable != nullptr; }
+
+        private:
+            static constexpr size_t inline_size = 64;
+
+            template <class Functor> static constexpr bool fits_inline() {
+                return sizeof(Functor) <= inline_size && alignof(Functor) <= alignof(std::max_align_t)
+                       && std::is_nothrow_move_constructible<Functor>::value;
             }
+
+            struct VTable {
+                void (*invoke)(Task&);
+                void (*move)(Task& destination, Task& source);
+                void (*destroy)(Task&);
+            };
+
+            template <class Functor> static Functor& inline_functor(Task& task) {
+                return *std::launder(reinterpret_cast<Functor*>(&task.storage));
+            }
+
+            template <class Functor> static const VTable* inline_vtable() {
+                static constexpr VTable vtable = {
+                    [](Task& task) { inline_functor<Functor>(task)(); },
+                    [](Task& destination, Task& source) {
+                        new (&destination.storage) Functor(std::move(inline_functor<Functor>(source)));
+                        inline_functor<Functor>(source).~Functor();
+                    },
+                    [](Task& task) { inline_functor<Functor>(task).~Functor(); }
+                };
+                return &vtable;
+            }
+
+            template <class Functor> static const VTable* heap_vtable() {
+                static constexpr VTable vtable = {
+                    [](Task& task) { (*static_cast<Functor*>(task.heap))(); },
+                    [](Task& destination, Task& source) { destination.heap = std::exchange(source.heap, nullptr); },
+                    [](Task& task) { delete static_cast<Functor*>(task.heap); }
+                };
+                return &vtable;
+            }
+
+            void move_from(Task& other) noexcept {
+                if (!other.vtable)
+                    return;
+                other.vtable->move(*this, other);
+                vtable = std::exchange(other.vtable, nullptr);
+            }
+
+            void reset() {
+                if (vtable)
+                    vtable->destroy(*this);
+                vtable = nullptr;
+            }
+
+            const VTable* vtable = nullptr;
+            union {
+                std::aligned_storage_t<inline_size, alignof(std::max_align_t)> storage;
+                void* heap;
+            };
         };
-        template<class F, class... ARGS> class ConcreteWorkImpl<F,true,ARGS...> : public Work, public Storage<F,ARGS...> {
+
+        /**
+         * @param workers Number of worker threads
+         * @param pin_workers Pin each worker to a cpu, spreading the workers round-robin over the NUMA nodes.
+         */
+        explicit ThreadPool(unsigned int workers, bool pin_workers = false);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// Process-wide pool. Size and pinning can be set with GADGETRON_THREADPOOL_WORKERS and GADGETRON_THREADPOOL_PIN.
+        static ThreadPool& shared();
+
+        /// Runs f(args...) on the pool, returning a future to the result.
+        template <class F, class... ARGS> auto async(F&& f, ARGS&&... args);
+
+        /// Runs f on the pool, without any way of waiting for the result.
+        void post(Task task);
+
+        /**
+         * Calls f(i) for every i in [begin, end). The range is split into chunks of size grain, which are executed
+         * by the pool as well as the calling thread. Blocks until all chunks have been processed, rethrowing the first
+         * exception thrown by f.
+         */
+        template <class F> void parallel_for(size_t begin, size_t end, F&& f, size_t grain = 0);
+
+        /// As parallel_for, but does not block. The returned future is ready once the whole range has been processed.
+        template <class F> std::future<void> async_range(size_t begin, size_t end, F f, size_t grain = 0);
+
+        /// Finishes the outstanding tasks and stops the workers. Tasks can no longer be submitted after join.
+        void join();
+
+        size_t size() const { return queues.size(); }
+
+    private:
+        struct alignas(64) WorkQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        struct Range;
+
+        void worker_loop(size_t index);
+        bool try_pop(size_t index, Task& task);
+        bool try_steal(size_t index, Task& task);
+        void push(Task task);
+
+        size_t grain_size(size_t begin, size_t end, size_t grain) const;
+        std::shared_ptr<Range> post_range(size_t begin, size_t end, size_t grain, std::function<void(size_t)>);
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> threads;
+
+        std::atomic<size_t> pending{ 0 };
+        std::atomic<size_t> next_queue{ 0 };
+        std::atomic<int> sleeping{ 0 };
+        bool stopping = false;
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+
+        std::mutex join_mutex;
+        bool joined = false;
+    };
+
+    /**
+     * Shared bookkeeping for a bulk submission. Chunks are handed out through an atomic counter, so any number of
+     * pool workers (and the submitting thread) can participate.
+     */
+    struct ThreadPool::Range {
+        Range(size_t begin, size_t end, size_t grain, std::function<void(size_t)> f);
+
+        /// Processes chunks until none are left. Returns true if the calling thread finished the last chunk.
+        bool run();
+        void wait();
+
+        const size_t begin, end, grain, chunks;
+        std::function<void(size_t)> f;
+
+        std::atomic<size_t> next_chunk{ 0 };
+        std::atomic<size_t> completed_chunks{ 0 };
+
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr exception;
+        std::promise<void> promise;
+    };
+
+    /** Implementation **/
+
+    namespace detail {
+        template <class F, class... ARGS> class AsyncTask {
         public:
-            using Storage<F,ARGS...>::Storage;
+            using R = decltype(boost::hana::unpack(std::declval<boost::hana::tuple<std::decay_t<ARGS>...>>(),
+                                                   std::declval<std::decay_t<F>&>()));
+
+            AsyncTask(F&& f, ARGS&&... args) : f{ std::forward<F>(f) }, args{ std::forward<ARGS>(args)... } {}
 
-            void execute() override {
+            std::future<R> get_future() { return promise.get_future(); }
+
+            void operator()() {
                 try {
-                    boost::hana::unpack(std::move(this->args),this->f);
-                    this->promise.set_value();
-                } catch (...){
-                    this->promise.set_exception(std::current_exception());
+                    if constexpr (std::is_void<R>::value) {
+                        boost::hana::unpack(std::move(args), f);
+                        promise.set_value();
+                    } else {
+                        promise.set_value(boost::hana::unpack(std::move(args), f));
+                    }
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
                 }
             }
-        };
 
-    template<class F, class... ARGS> class ConcreteWork : public ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...> {
-        public:
-            using ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...>::ConcreteWorkImpl;
+        private:
+            std::decay_t<F> f;
+            boost::hana::tuple<std::decay_t<ARGS>...> args;
+            std::promise<R> promise;
         };
+    }
 
-    public:
-        explicit ThreadPool(unsigned int workers) {
-            for (auto i = 0u; i < workers; i++) {
-                threads.emplace_back([this]() {
-                    try {
-                        while (true)
-                            this->work_queue.pop()->execute();
-                    } catch (const ChannelClosed&) {
-                    }
-                });
-            }
-        }
+    template <class F, class... ARGS> auto ThreadPool::async(F&& f, ARGS&&... args) {
+        detail::AsyncTask<F, ARGS...> work(std::forward<F>(f), std::forward<ARGS>(args)...);
+        auto future_result = work.get_future();
+        post(Task(std::move(work)));
+        return future_result;
+    }
 
-        template <class F, class... ARGS> auto async(F&& f, ARGS&&... args) {
-            auto work = std::make_unique<ConcreteWork<F, ARGS...>>(std::forward<F>(f), std::forward<ARGS>(args)...);
-            auto future_result = work->get_future();
-            work_queue.push(std::move(work));
-            return std::move(future_result);
-        }
+    template <class F> void ThreadPool::parallel_for(size_t begin, size_t end, F&& f, size_t grain) {
+        if (begin >= end)
+            return;
+        grain = grain_size(begin, end, grain);
 
-        void join(){
-            work_queue.close();
-            for (auto& thread : threads){
-                thread.join();
-            }
+        if (end - begin <= grain) {
+            for (size_t i = begin; i < end; i++)
+                f(i);
+            return;
         }
 
-    private:
-        MPMCChannel<std::unique_ptr<Work>> work_queue;
-        std::vector<std::thread> threads;
-    };
+        auto range = post_range(begin, end, grain, [&f](size_t i) { f(i); });
+        range->run();
+        range->wait();
+        if (range->exception)
+            std::rethrow_exception(range->exception);
+    }
 
+    template <class F> std::future<void> ThreadPool::async_range(size_t begin, size_t end, F f, size_t grain) {
+        if (begin >= end) {
+            std::promise<void> promise;
+            promise.set_value();
+            return promise.get_future();
+        }
+        auto range = post_range(begin, end, grain_size(begin, end, grain), std::move(f));
+        return range->promise.get_future();
+    }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <typeindex>
 #include <boost/dll.hpp>
 
@@ -55,6 +57,22 @@ namespace Gadgetron::Core {
             constexpr auto index_apply(F f) {
                 return index_apply_impl(f, std::make_index_sequence<N>{});
             }
+
+            // Types held by exactly one message chunk, which can be serialized without unpacking the message.
+            template<class T> struct is_single_chunk : std::true_type {};
+            template<class T> struct is_single_chunk<optional<T>> : std::false_type {};
+            template<class... TYPES> struct is_single_chunk<variant<TYPES...>> : std::false_type {};
+            template<class... TYPES> struct is_single_chunk<tuple<TYPES...>> : std::false_type {};
+
+            template<class T>
+            const T &chunk_value(const MessageChunk &chunk) {
+                auto typed = dynamic_cast<const TypedMessageChunk<T> *>(&chunk);
+                if (!typed) {
+                    throw std::runtime_error(
+                            std::string("Writer received a message part that is not a ") + typeid(T).name());
+                }
+                return typed->get();
+            }
         }
     }
 }
@@ -64,10 +82,21 @@ namespace Gadgetron::Core {
     template<class ...ARGS>
     void Gadgetron::Core::TypedWriter<ARGS...>::write(std::ostream &stream,  Message message) {
 
-        std::tuple<ARGS...> arg_tuple = force_unpack<ARGS...>(std::move(message));
+        if constexpr ((gadgetron_writer_detail::is_single_chunk<ARGS>::value && ...)) {
+            // Serialized straight from the chunks, so data shared with other branches is not copied.
+            auto &chunks = message.messages();
+            if (chunks.size() != sizeof...(ARGS)) {
+                throw std::runtime_error("Writer expected a message of " + std::to_string(sizeof...(ARGS)) +
+                                         " parts, but received " + std::to_string(chunks.size()));
+            }
+            gadgetron_writer_detail::index_apply<sizeof...(ARGS)>(
+                    [&](auto... Is) { this->serialize(stream, gadgetron_writer_detail::chunk_value<ARGS>(*chunks[Is])...); });
+        } else {
+            std::tuple<ARGS...> arg_tuple = force_unpack<ARGS...>(std::move(message));
 
-        gadgetron_writer_detail::index_apply<sizeof...(ARGS)>(
-                [&](auto... Is) { this->serialize(stream, std::move(std::get<Is>(arg_tuple))...); });
+            gadgetron_writer_detail::index_apply<sizeof...(ARGS)>(
+                    [&](auto... Is) { this->serialize(stream, std::move(std::get<Is>(arg_tuple))...); });
+        }
     }
 
 
@@ -1,5 +1,10 @@
 
+#include <algorithm>
 #include <map>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
 #include "AcquisitionDistributor.h"
 
 namespace {
@@ -25,8 +30,19 @@ namespace {
             {"user_7",               [](const Header &header) { return header.idx.user[7]; }}
     };
 
-    const std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)> &selector_function(const std::string &key) {
-        return function_map.at(key);
+    std::vector<std::function<uint16_t(const Header &)>> selector_functions(const std::string &dimensions) {
+        std::vector<std::string> keys;
+        boost::split(keys, dimensions, boost::is_any_of(", "), boost::token_compress_on);
+
+        std::vector<std::function<uint16_t(const Header &)>> selectors;
+        for (auto &key : keys) {
+            if (key.empty()) continue;
+            if (!function_map.count(key)) throw std::runtime_error("Unknown parallel dimension: " + key);
+            selectors.push_back(function_map.at(key));
+        }
+
+        if (selectors.empty()) throw std::runtime_error("No parallel dimension specified.");
+        return selectors;
     }
 }
 
@@ -36,10 +52,13 @@ namespace Gadgetron::Core::Distributed {
     void AcquisitionDistributor::process(InputChannel<Acquisition> &input,
             ChannelCreator &creator
     ) {
-        std::map<uint16_t, OutputChannel> channels{};
+        std::map<std::vector<uint16_t>, OutputChannel> channels{};
+        std::vector<uint16_t> index(selectors.size());
 
         for (Acquisition acq : input) {
-            auto index = selector(std::get<Header>(acq));
+            auto &header = std::get<Header>(acq);
+            std::transform(selectors.begin(), selectors.end(), index.begin(),
+                    [&](auto &selector) { return selector(header); });
 
             if (!channels.count(index)) channels.emplace(index, creator.create());
 
@@ -50,7 +69,7 @@ namespace Gadgetron::Core::Distributed {
     AcquisitionDistributor::AcquisitionDistributor(
             const Gadgetron::Core::Context &context,
             const Gadgetron::Core::GadgetProperties &props
-    ) : TypedDistributor(props), selector(selector_function(parallel_dimension)) {}
+    ) : TypedDistributor(props), selectors(selector_functions(parallel_dimension)) {}
 
     GADGETRON_DISTRIBUTOR_EXPORT(AcquisitionDistributor);
 }
\ No newline at end of file
@@ -12,10 +12,13 @@ namespace Gadgetron::Core::Distributed {
 
         void process(InputChannel<Acquisition> &input, ChannelCreator &creator) override;
 
-        NODE_PROPERTY(parallel_dimension, std::string, "Dimension that data will be parallelized over", "slice");
+        NODE_PROPERTY(parallel_dimension, std::string,
+                "Dimension that data will be parallelized over; several dimensions separated by commas, "
+                "e.g. 'slice,contrast', parallelize over each combination of their indices", "slice");
 
     private:
-        const std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)> &selector;
+        using Selector = std::function<uint16_t(const ISMRMRD::AcquisitionHeader&)>;
+        const std::vector<Selector> selectors;
     };
 }
 
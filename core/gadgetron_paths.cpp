@@ -133,6 +133,14 @@ namespace Gadgetron::Server {
     const boost::filesystem::path default_storage_folder() {
         return get_data_directory() / "storage";
     }
+
+    const boost::filesystem::path default_storage_cache_folder() {
+        return get_data_directory() / "storage_cache";
+    }
+
+    const boost::filesystem::path default_fft_wisdom_folder() {
+        return get_data_directory() / "fftw";
+    }
 }
 
 
@@ -7,6 +7,8 @@ namespace Gadgetron::Server {
     const boost::filesystem::path default_gadgetron_home();
     const boost::filesystem::path default_database_folder();
     const boost::filesystem::path default_storage_folder();
+    const boost::filesystem::path default_storage_cache_folder();
+    const boost::filesystem::path default_fft_wisdom_folder();
 }
 
 
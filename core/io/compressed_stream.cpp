@@ -0,0 +1,330 @@
+#include "compressed_stream.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef GADGETRON_COMPRESSION_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Each block starts with its size before and after compression, followed by how it was stored.
+    enum class Method : uint8_t { stored = 0, compressed = 1 };
+
+    struct BlockHeader {
+        uint32_t size;
+        uint32_t stored_size;
+        Method method;
+    };
+
+    constexpr size_t block_header_size = sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t);
+
+    void encode(const BlockHeader &header, char *destination) {
+        std::memcpy(destination, &header.size, sizeof(uint32_t));
+        std::memcpy(destination + sizeof(uint32_t), &header.stored_size, sizeof(uint32_t));
+        std::memcpy(destination + 2 * sizeof(uint32_t), &header.method, sizeof(uint8_t));
+    }
+
+    BlockHeader decode(const char *source) {
+        BlockHeader header{};
+        std::memcpy(&header.size, source, sizeof(uint32_t));
+        std::memcpy(&header.stored_size, source + sizeof(uint32_t), sizeof(uint32_t));
+        std::memcpy(&header.method, source + 2 * sizeof(uint32_t), sizeof(uint8_t));
+        return header;
+    }
+
+    int64_t nanoseconds_since(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+}
+
+namespace Gadgetron::Core::IO {
+
+    class CompressedStreamBuf::Codec {
+    public:
+        virtual ~Codec() = default;
+
+        /// Compresses into destination and returns the compressed size; 0 if the data does not get any smaller.
+        virtual size_t compress(const char *data, size_t length, std::vector<char> &destination) = 0;
+        virtual void decompress(const char *data, size_t length, char *destination, size_t decompressed_length) = 0;
+    };
+}
+
+namespace {
+    using Codec = Gadgetron::Core::IO::CompressedStreamBuf::Codec;
+
+#ifdef GADGETRON_COMPRESSION_ZSTD
+    // Groups the bytes of each 32 bit value by significance, so the exponent bytes of floats sit together rather than
+    // interleaved with the noisy mantissas. Trailing bytes that make up no full value are kept as they are.
+    void shuffle(const char *source, size_t length, char *destination) {
+        auto values = length / sizeof(uint32_t);
+        auto lanes = reinterpret_cast<uint8_t *>(destination);
+        for (size_t i = 0; i < values; i++) {
+            uint32_t value;
+            std::memcpy(&value, source + i * sizeof(uint32_t), sizeof(uint32_t));
+            lanes[i] = uint8_t(value);
+            lanes[values + i] = uint8_t(value >> 8);
+            lanes[2 * values + i] = uint8_t(value >> 16);
+            lanes[3 * values + i] = uint8_t(value >> 24);
+        }
+        std::memcpy(destination + values * sizeof(uint32_t), source + values * sizeof(uint32_t),
+                    length - values * sizeof(uint32_t));
+    }
+
+    void unshuffle(const char *source, size_t length, char *destination) {
+        auto values = length / sizeof(uint32_t);
+        auto lanes = reinterpret_cast<const uint8_t *>(source);
+        for (size_t i = 0; i < values; i++) {
+            uint32_t value = uint32_t(lanes[i]) |
+                             uint32_t(lanes[values + i]) << 8 |
+                             uint32_t(lanes[2 * values + i]) << 16 |
+                             uint32_t(lanes[3 * values + i]) << 24;
+            std::memcpy(destination + i * sizeof(uint32_t), &value, sizeof(uint32_t));
+        }
+        std::memcpy(destination + values * sizeof(uint32_t), source + values * sizeof(uint32_t),
+                    length - values * sizeof(uint32_t));
+    }
+
+    class ZstdCodec : public Codec {
+    public:
+        ZstdCodec(int level, bool shuffled) : level(level), shuffled(shuffled) {}
+
+        size_t compress(const char *data, size_t length, std::vector<char> &destination) override {
+            if (shuffled) {
+                scratch.resize(length);
+                shuffle(data, length, scratch.data());
+                data = scratch.data();
+            }
+
+            destination.resize(ZSTD_compressBound(length));
+            auto compressed = ZSTD_compressCCtx(compression.get(), destination.data(), destination.size(),
+                                                data, length, level);
+            if (ZSTD_isError(compressed))
+                throw std::runtime_error(std::string("Failed to compress block: ") + ZSTD_getErrorName(compressed));
+
+            return compressed < length ? compressed : 0;
+        }
+
+        void decompress(const char *data, size_t length, char *destination, size_t decompressed_length) override {
+            auto target = destination;
+            if (shuffled) {
+                scratch.resize(decompressed_length);
+                target = scratch.data();
+            }
+
+            auto decompressed = ZSTD_decompressDCtx(decompression.get(), target, decompressed_length, data, length);
+            if (ZSTD_isError(decompressed))
+                throw std::runtime_error(std::string("Failed to decompress block: ") + ZSTD_getErrorName(decompressed));
+            if (decompressed != decompressed_length)
+                throw std::runtime_error("Decompressed block does not match its declared size.");
+
+            if (shuffled) unshuffle(target, decompressed_length, destination);
+        }
+
+    private:
+        const int level;
+        const bool shuffled;
+        std::vector<char> scratch;
+
+        std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> compression{ZSTD_createCCtx(), &ZSTD_freeCCtx};
+        std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> decompression{ZSTD_createDCtx(), &ZSTD_freeDCtx};
+    };
+#endif
+
+    std::unique_ptr<Codec> make_codec(const std::string &name, int level) {
+#ifdef GADGETRON_COMPRESSION_ZSTD
+        if (name == "zstd-shuffle") return std::make_unique<ZstdCodec>(level, true);
+        if (name == "zstd") return std::make_unique<ZstdCodec>(level, false);
+#endif
+        throw std::runtime_error("Unsupported compression codec: " + name);
+    }
+}
+
+namespace Gadgetron::Core::IO {
+
+    std::vector<std::string> supported_codecs() {
+#ifdef GADGETRON_COMPRESSION_ZSTD
+        return {"zstd-shuffle", "zstd"};
+#else
+        return {};
+#endif
+    }
+
+    CompressedStreamBuf::CompressedStreamBuf(std::streambuf *buffer) : buffer(buffer), output(passthrough_size) {
+        setp(output.data(), output.data() + output.size());
+    }
+
+    CompressedStreamBuf::~CompressedStreamBuf() {
+        try {
+            sync();
+        } catch (...) {}
+    }
+
+    void CompressedStreamBuf::compress_output(const std::string &codec, int level) {
+        auto compressor = make_codec(codec, level);
+
+        flush_put_area();
+        output_codec = std::move(compressor);
+        output.resize(block_size);
+        setp(output.data(), output.data() + output.size());
+    }
+
+    void CompressedStreamBuf::decompress_input(const std::string &codec) {
+        if (gptr() != egptr()) throw std::runtime_error("Cannot change codec with decompressed input left unread.");
+        input_codec = make_codec(codec, 0);
+    }
+
+    CompressionStatistics CompressedStreamBuf::statistics() const {
+        return CompressionStatistics{
+                bytes_compressed.load(),
+                bytes_sent.load(),
+                bytes_decompressed.load(),
+                bytes_received.load(),
+                std::chrono::nanoseconds(compression_nanoseconds.load()),
+                std::chrono::nanoseconds(decompression_nanoseconds.load())
+        };
+    }
+
+    // Hands what is in the put area to the buffer, compressed or not, and empties the put area.
+    void CompressedStreamBuf::flush_put_area() {
+        auto length = size_t(pptr() - pbase());
+        if (length) {
+            if (output_codec) {
+                write_block(pbase(), length);
+            } else if (buffer->sputn(pbase(), length) != std::streamsize(length)) {
+                throw std::runtime_error("Failed to write to stream.");
+            }
+        }
+        setp(output.data(), output.data() + output.size());
+    }
+
+    std::streamsize CompressedStreamBuf::xsputn(const char_type *data, std::streamsize length) {
+        auto room = epptr() - pptr();
+        if (length <= room) {
+            std::memcpy(pptr(), data, length);
+            pbump(int(length));
+            return length;
+        }
+
+        flush_put_area();
+        if (!output_codec) return buffer->sputn(data, length);
+
+        // Full blocks are compressed straight from the source; what is left over waits in the put area.
+        std::streamsize written = 0;
+        while (size_t(length - written) >= block_size) {
+            write_block(data + written, block_size);
+            written += block_size;
+        }
+
+        auto remaining = length - written;
+        std::memcpy(pptr(), data + written, remaining);
+        pbump(int(remaining));
+        return length;
+    }
+
+    CompressedStreamBuf::int_type CompressedStreamBuf::overflow(int_type ch) {
+        flush_put_area();
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    int CompressedStreamBuf::sync() {
+        flush_put_area();
+        return buffer->pubsync();
+    }
+
+    void CompressedStreamBuf::write_block(const char *data, size_t length) {
+        if (!length) return;
+
+        auto start = Clock::now();
+        auto compressed_length = output_codec->compress(data, length, compressed_output);
+        compression_nanoseconds += nanoseconds_since(start);
+
+        auto header = compressed_length ?
+                BlockHeader{uint32_t(length), uint32_t(compressed_length), Method::compressed} :
+                BlockHeader{uint32_t(length), uint32_t(length), Method::stored};
+        auto payload = compressed_length ? compressed_output.data() : data;
+
+        char encoded[block_header_size];
+        encode(header, encoded);
+
+        // The header goes through the put area of the underlying buffer, so a socket sends it along with the payload.
+        for (auto c : encoded) {
+            if (traits_type::eq_int_type(buffer->sputc(c), traits_type::eof()))
+                throw std::runtime_error("Failed to write compressed block.");
+        }
+        if (buffer->sputn(payload, header.stored_size) != std::streamsize(header.stored_size))
+            throw std::runtime_error("Failed to write compressed block.");
+
+        bytes_compressed += length;
+        bytes_sent += block_header_size + header.stored_size;
+    }
+
+    bool CompressedStreamBuf::read_block() {
+        char encoded[block_header_size];
+        auto received = buffer->sgetn(encoded, block_header_size);
+        if (!received) return false;
+        if (received != std::streamsize(block_header_size))
+            throw std::runtime_error("Compressed stream ended in the middle of a block.");
+
+        auto header = decode(encoded);
+        auto valid = header.size && header.size <= block_size && (
+                (header.method == Method::stored && header.stored_size == header.size) ||
+                (header.method == Method::compressed && header.stored_size < header.size));
+        if (!valid) throw std::runtime_error("Received corrupt compressed block.");
+
+        input.resize(header.size);
+        auto payload = input.data();
+        if (header.method == Method::compressed) {
+            compressed_input.resize(header.stored_size);
+            payload = compressed_input.data();
+        }
+
+        if (buffer->sgetn(payload, header.stored_size) != std::streamsize(header.stored_size))
+            throw std::runtime_error("Compressed stream ended in the middle of a block.");
+
+        if (header.method == Method::compressed) {
+            auto start = Clock::now();
+            input_codec->decompress(payload, header.stored_size, input.data(), header.size);
+            decompression_nanoseconds += nanoseconds_since(start);
+        }
+
+        bytes_decompressed += header.size;
+        bytes_received += block_header_size + header.stored_size;
+
+        setg(input.data(), input.data(), input.data() + header.size);
+        return true;
+    }
+
+    std::streamsize CompressedStreamBuf::xsgetn(char_type *data, std::streamsize length) {
+        if (!input_codec) return buffer->sgetn(data, length);
+        return std::streambuf::xsgetn(data, length);
+    }
+
+    CompressedStreamBuf::int_type CompressedStreamBuf::underflow() {
+        if (!input_codec) return buffer->sgetc();
+        if (gptr() == egptr() && !read_block()) return traits_type::eof();
+        return traits_type::to_int_type(*gptr());
+    }
+
+    CompressedStreamBuf::int_type CompressedStreamBuf::uflow() {
+        if (!input_codec) return buffer->sbumpc();
+        return std::streambuf::uflow();
+    }
+
+    CompressibleStream::CompressibleStream(std::iostream &stream)
+        : std::iostream(nullptr), compressed(stream.rdbuf()) {
+        this->rdbuf(&compressed);
+    }
+
+    CompressibleStream::CompressibleStream(std::unique_ptr<std::iostream> stream)
+        : std::iostream(nullptr), owned(std::move(stream)), compressed(owned->rdbuf()) {
+        this->rdbuf(&compressed);
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Gadgetron::Core::IO {
+
+    /// Names of the codecs this build can compress streams with, in order of preference.
+    std::vector<std::string> supported_codecs();
+
+    struct CompressionStatistics {
+        size_t bytes_compressed;      ///< Bytes written to the stream, before compression.
+        size_t bytes_sent;            ///< Bytes written to the underlying buffer for them.
+        size_t bytes_decompressed;    ///< Bytes read from the stream, after decompression.
+        size_t bytes_received;        ///< Bytes read from the underlying buffer for them.
+        std::chrono::duration<double> compression_time;
+        std::chrono::duration<double> decompression_time;
+
+        double compression_ratio() const { return bytes_sent ? double(bytes_compressed) / bytes_sent : 1.0; }
+        double decompression_ratio() const { return bytes_received ? double(bytes_decompressed) / bytes_received : 1.0; }
+        double compression_rate() const { return compression_time.count() > 0 ? bytes_compressed / compression_time.count() : 0.0; }
+        double decompression_rate() const { return decompression_time.count() > 0 ? bytes_decompressed / decompression_time.count() : 0.0; }
+    };
+
+    /**
+     * Stream buffer compressing what is written to it and decompressing what is read from it, in front of another
+     * buffer.
+     *
+     * Data passes through unchanged until compression is switched on, separately for each direction, so the buffer
+     * can be put in front of a connection before the peers have agreed on a codec. Compressed data is sent in blocks
+     * of up to block_size bytes. Output is held back until the put area fills up or the buffer is flushed, so
+     * writers need to flush the stream at the end of each message.
+     *
+     * Reads and writes may happen on different threads, as on a socket. The output side takes no locks: writing,
+     * flushing and compress_output must all happen on the thread writing to the stream, and likewise for reading and
+     * decompress_input.
+     */
+    class CompressedStreamBuf : public std::streambuf {
+    public:
+        static constexpr size_t block_size = 1u << 20;
+
+        /// Size of the put area while output passes through uncompressed; larger writes go straight to the buffer.
+        static constexpr size_t passthrough_size = 1u << 16;
+
+        explicit CompressedStreamBuf(std::streambuf *buffer);
+        ~CompressedStreamBuf() override;
+
+        /// Compresses everything written from here on. Output written so far is sent first.
+        void compress_output(const std::string &codec, int level);
+
+        /// Decompresses everything read from here on.
+        void decompress_input(const std::string &codec);
+
+        CompressionStatistics statistics() const;
+
+        class Codec;
+
+    protected:
+        std::streamsize xsputn(const char_type *data, std::streamsize length) override;
+        int_type overflow(int_type ch) override;
+        int sync() override;
+
+        std::streamsize xsgetn(char_type *data, std::streamsize length) override;
+        int_type underflow() override;
+        int_type uflow() override;
+
+    private:
+        void write_block(const char *data, size_t length);
+        void flush_put_area();
+        bool read_block();
+
+        std::streambuf *const buffer;
+
+        std::unique_ptr<Codec> output_codec;
+        std::vector<char> output, compressed_output; // output backs the put area
+
+        std::unique_ptr<Codec> input_codec;
+        std::vector<char> input, compressed_input;
+
+        std::atomic<size_t> bytes_compressed{0}, bytes_sent{0}, bytes_decompressed{0}, bytes_received{0};
+        std::atomic<int64_t> compression_nanoseconds{0}, decompression_nanoseconds{0};
+    };
+
+    /// Stream over a CompressedStreamBuf in front of another stream, which it may own.
+    class CompressibleStream : public std::iostream {
+    public:
+        explicit CompressibleStream(std::iostream &stream);
+        explicit CompressibleStream(std::unique_ptr<std::iostream> stream);
+
+        CompressedStreamBuf &buffer() { return compressed; }
+
+    private:
+        std::unique_ptr<std::iostream> owned;
+        CompressedStreamBuf compressed;
+    };
+}
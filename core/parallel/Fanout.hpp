@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 namespace Gadgetron::Core::Parallel {
 
     template<class... ARGS>
@@ -11,11 +13,19 @@ namespace Gadgetron::Core::Parallel {
 
     template<class... ARGS>
     void Fanout<ARGS...>::process(InputChannel<ARGS...> &input, std::map<std::string, OutputChannel> output) {
+        std::vector<OutputChannel *> channels;
+        for (auto &pair : output) channels.push_back(&pair.second);
+
         for (auto thing : input) {
-            for (auto &pair : output) {
-                auto copy_of_thing = thing;
-                pair.second.push(std::move(copy_of_thing));
+            if (channels.empty()) continue;
+
+            // Every branch gets a clone of the same message. Clones share the data, which is only copied by the
+            // branches that take it while others still hold it.
+            Message message(std::move(thing));
+            for (size_t i = 0; i + 1 < channels.size(); i++) {
+                channels[i]->push_message(message.clone());
             }
+            channels.back()->push_message(std::move(message));
         }
     }
 }
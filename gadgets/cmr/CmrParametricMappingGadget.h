@@ -55,6 +55,7 @@ namespace Gadgetron {
 
         GADGET_PROPERTY(std_thres_masking, double, "Number of noise std for masking", 3.0);
         GADGET_PROPERTY(mapping_with_masking, bool, "Whether to compute and apply a mask for mapping", true);
+        GADGET_PROPERTY(batched_fitting, bool, "Whether to fit pixels in batches with the vectorized Levenberg-Marquardt solver instead of fitting every pixel with the simplex solver; map values differ slightly from the simplex ones", false);
 
         // ------------------------------------------------------------------------------------
 
@@ -123,12 +123,23 @@ namespace Gadgetron {
 
     }
 
-    void AcquisitionAccumulateTriggerGadget::send_data(Core::OutputChannel& out, std::map<unsigned short, AcquisitionBucket>& buckets,
-                                                       std::vector<Core::Waveform>& waveforms) {
+    void AcquisitionAccumulateTriggerGadget::accumulate(Core::Acquisition acquisition, unsigned short sorting_index) {
+        AcquisitionBucket& bucket = buckets[sorting_index];
+        bucket.add_acquisition(std::move(acquisition));
+    }
+
+    void AcquisitionAccumulateTriggerGadget::accumulate(Core::Waveform waveform) {
+        waveforms.emplace_back(std::move(waveform));
+    }
+
+    void AcquisitionAccumulateTriggerGadget::send_data(Core::OutputChannel& out) {
         trigger_events++;
         GDEBUG_STREAM("Trigger " << trigger_events << " occurred, sending out " << buckets.size() << " buckets, " << waveforms.size() << " waveforms ... ");
-        if(!waveforms.empty())
-        buckets.begin()->second.waveform_ = std::move(waveforms);
+        // Waveforms arriving before any acquisition are kept for the next trigger
+        if(!waveforms.empty() && !buckets.empty()) {
+            buckets.begin()->second.waveform_ = std::move(waveforms);
+            waveforms.clear();
+        }
         // Pass all buckets down the chain
         for (auto& bucket : buckets)
             out.push(std::move(bucket.second));
@@ -138,13 +149,11 @@ namespace Gadgetron {
     void AcquisitionAccumulateTriggerGadget ::process(
         Core::InputChannel<Core::variant<Core::Acquisition, Core::Waveform>>& in, Core::OutputChannel& out) {
 
-        auto waveforms = std::vector<Core::Waveform>{};
-        auto buckets   = std::map<unsigned short, AcquisitionBucket>{};
         auto trigger   = get_trigger(*this);
 
         for (auto message : in) {
             if (Core::holds_alternative<Core::Waveform>(message)) {
-                waveforms.emplace_back(std::move(Core::get<Core::Waveform>(message)));
+                accumulate(std::move(Core::get<Core::Waveform>(message)));
                 continue;
             }
 
@@ -154,17 +163,16 @@ namespace Gadgetron {
             auto head = std::get<ISMRMRD::AcquisitionHeader>(acq);
 
             if (trigger_before(trigger, head))
-                send_data(out, buckets, waveforms);
+                send_data(out);
             // It is enough to put the first one, since they are linked
             unsigned short sorting_index = get_index(head, sorting_dimension);
 
-            AcquisitionBucket& bucket = buckets[sorting_index];
-            bucket.add_acquisition(std::move(acq));
+            accumulate(std::move(acq), sorting_index);
 
             if (trigger_after(trigger, head))
-                send_data(out, buckets, waveforms);
+                send_data(out);
         }
-        send_data(out,buckets,waveforms);
+        send_data(out);
     }
     GADGETRON_GADGET_EXPORT(AcquisitionAccumulateTriggerGadget);
 
@@ -46,9 +46,17 @@ namespace Gadgetron {
         NODE_PROPERTY(n_acquisitions_before_ongoing_trigger, unsigned long, "Number of acquisition before ongoing triggers", 40);
 
         size_t trigger_events = 0;
+    protected:
+        // Collects the data arriving between triggers; sorting_index is the acquisition's sorting dimension.
+        virtual void accumulate(Core::Acquisition acquisition, unsigned short sorting_index);
+        virtual void accumulate(Core::Waveform waveform);
+
+        // Sends on what has been collected since the previous trigger.
+        virtual void send_data(Core::OutputChannel& out);
+
     private:
-        void send_data(Core::OutputChannel& out, std::map<unsigned short, AcquisitionBucket>& buckets,
-                       std::vector<Core::Waveform>& waveforms);
+        std::map<unsigned short, AcquisitionBucket> buckets;
+        std::vector<Core::Waveform> waveforms;
     };
 
     void from_string(const std::string& str, AcquisitionAccumulateTriggerGadget::TriggerDimension& val);
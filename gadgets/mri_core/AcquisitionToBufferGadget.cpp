@@ -0,0 +1,154 @@
+#include "AcquisitionToBufferGadget.h"
+#include "log.h"
+
+namespace Gadgetron {
+    using TriggerDimension = AcquisitionAccumulateTriggerGadget::TriggerDimension;
+
+    namespace {
+        bool is_reference(const ISMRMRD::AcquisitionHeader& head) {
+            return head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION)
+                || head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING);
+        }
+
+        bool is_imaging(const ISMRMRD::AcquisitionHeader& head) {
+            return !(head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION)
+                || head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA));
+        }
+
+        // Non-cartesian data without limits on E1 and E2 is sized by the lines received.
+        bool laid_out_by_limits(const ISMRMRD::Encoding& encoding) {
+            if (encoding.trajectory == ISMRMRD::TrajectoryType::CARTESIAN
+                || encoding.trajectory == ISMRMRD::TrajectoryType::EPI)
+                return true;
+
+            return encoding.encodingLimits.kspace_encoding_step_1.is_present()
+                && encoding.encodingLimits.kspace_encoding_step_2.is_present();
+        }
+
+        std::set<uint16_t> range(const ISMRMRD::Optional<ISMRMRD::Limit>& limit) {
+            if (!limit.is_present())
+                return { 0 };
+            return { limit->minimum, limit->maximum };
+        }
+
+        AcquisitionBucketStats stats_from_limits(const ISMRMRD::EncodingLimits& limits) {
+            AcquisitionBucketStats stats;
+            stats.kspace_encode_step_1 = range(limits.kspace_encoding_step_1);
+            stats.kspace_encode_step_2 = range(limits.kspace_encoding_step_2);
+            stats.average              = range(limits.average);
+            stats.slice                = range(limits.slice);
+            stats.contrast             = range(limits.contrast);
+            stats.phase                = range(limits.phase);
+            stats.repetition           = range(limits.repetition);
+            stats.set                  = range(limits.set);
+            stats.segment              = range(limits.segment);
+            return stats;
+        }
+
+        std::set<uint16_t>* labels_of(AcquisitionBucketStats& stats, TriggerDimension dimension) {
+            switch (dimension) {
+            case TriggerDimension::average: return &stats.average;
+            case TriggerDimension::slice: return &stats.slice;
+            case TriggerDimension::contrast: return &stats.contrast;
+            case TriggerDimension::phase: return &stats.phase;
+            case TriggerDimension::repetition: return &stats.repetition;
+            case TriggerDimension::set: return &stats.set;
+            case TriggerDimension::segment: return &stats.segment;
+            default: return nullptr;
+            }
+        }
+
+        bool within(const std::set<uint16_t>& labels, uint16_t label) {
+            return *labels.begin() <= label && label <= *labels.rbegin();
+        }
+
+        bool fits(const AcquisitionBucketStats& layout, const ISMRMRD::AcquisitionHeader& head) {
+            return within(layout.average, head.idx.average) && within(layout.slice, head.idx.slice)
+                && within(layout.contrast, head.idx.contrast) && within(layout.phase, head.idx.phase)
+                && within(layout.repetition, head.idx.repetition) && within(layout.set, head.idx.set)
+                && within(layout.segment, head.idx.segment);
+        }
+
+        void defer_reference(AcquisitionBucket& bucket, Core::Acquisition acquisition) {
+            auto espace = size_t{ std::get<ISMRMRD::AcquisitionHeader>(acquisition).encoding_space_ref };
+            if (bucket.refstats_.size() < (espace + 1)) {
+                bucket.refstats_.resize(espace + 1);
+            }
+            bucket.refstats_[espace].add_stats(std::get<ISMRMRD::AcquisitionHeader>(acquisition));
+            bucket.ref_.push_back(std::move(acquisition));
+        }
+    }
+
+    AcquisitionToBufferGadget::AcquisitionToBufferGadget(const Core::Context& context, const Core::GadgetProperties& props)
+        : AcquisitionAccumulateTriggerGadget(context, props), assembler(context, props) {}
+
+    const AcquisitionBucketStats& AcquisitionToBufferGadget::layout(Window& window, const ISMRMRD::AcquisitionHeader& head) {
+        auto espace = size_t{ head.encoding_space_ref };
+        if (window.layouts.size() < (espace + 1)) {
+            window.layouts.resize(espace + 1);
+        }
+
+        auto& layout = window.layouts[espace];
+        if (!layout) {
+            layout = stats_from_limits(header.encoding[espace].encodingLimits);
+
+            // The trigger and sorting dimensions take the index of the first readout, as every readout in the window
+            // shares it.
+            AcquisitionBucketStats first;
+            first.add_stats(head);
+            for (auto dimension : { trigger_dimension, sorting_dimension }) {
+                if (auto labels = labels_of(*layout, dimension))
+                    *labels = *labels_of(first, dimension);
+            }
+        }
+
+        if (!fits(*layout, head))
+            throw std::runtime_error("Readout " + std::to_string(head.scan_counter)
+                                     + " lies outside the encoding limits its buffer was allocated from; use "
+                                       "AcquisitionAccumulateTriggerGadget and BucketToBufferGadget for this data.");
+        return *layout;
+    }
+
+    void AcquisitionToBufferGadget::accumulate(Core::Acquisition acquisition, unsigned short sorting_index) {
+        const auto& head     = std::get<ISMRMRD::AcquisitionHeader>(acquisition);
+        const auto& encoding = header.encoding[head.encoding_space_ref];
+        auto& window         = windows[sorting_index];
+
+        if (!is_imaging(head) || !laid_out_by_limits(encoding)) {
+            window.deferred.add_acquisition(std::move(acquisition));
+            return;
+        }
+
+        assembler.add_readout(window.buffers, acquisition, layout(window, head), false);
+
+        if (is_reference(head))
+            defer_reference(window.deferred, std::move(acquisition));
+    }
+
+    void AcquisitionToBufferGadget::accumulate(Core::Waveform waveform) {
+        waveforms.emplace_back(std::move(waveform));
+    }
+
+    void AcquisitionToBufferGadget::send_data(Core::OutputChannel& out) {
+        trigger_events++;
+        GDEBUG_STREAM("Trigger " << trigger_events << " occurred, sending out buffers for " << windows.size()
+                                 << " sorting indices, " << waveforms.size() << " waveforms ... ");
+        if (windows.empty())
+            return;
+
+        // As with buckets, the waveforms go with the buffers of the first sorting index.
+        const auto no_waveforms = std::vector<Core::Waveform>{};
+        auto first              = true;
+        for (auto& entry : windows) {
+            auto& window = entry.second;
+            assembler.add_bucket(window.buffers, window.deferred);
+            assembler.send(out, window.buffers, first ? waveforms : no_waveforms);
+            first = false;
+        }
+
+        windows.clear();
+        waveforms.clear();
+    }
+
+    GADGETRON_GADGET_EXPORT(AcquisitionToBufferGadget);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "AcquisitionAccumulateTriggerGadget.h"
+#include "BucketToBufferGadget.h"
+
+#include <map>
+#include <vector>
+
+namespace Gadgetron {
+
+    // Does the work of an AcquisitionAccumulateTriggerGadget followed by a BucketToBufferGadget, and takes the
+    // properties of both, but copies each readout into its IsmrmrdReconData buffer as it arrives. The buffers are
+    // allocated when their first readout arrives and are sent on at the trigger as they are, so the k-space is neither
+    // held twice nor copied once the last readout is in.
+
+    // As the buffers are laid out before the data is in, their sizes come from the encoding limits rather than from the
+    // data received between triggers; the trigger and sorting dimensions hold a single index per buffer, as they would
+    // in a bucket. Reference data, and non-cartesian data without encoding limits, are laid out by the lines actually
+    // received, and are still assembled at the trigger.
+
+    class AcquisitionToBufferGadget : public AcquisitionAccumulateTriggerGadget {
+    public:
+        AcquisitionToBufferGadget(const Core::Context& context, const Core::GadgetProperties& props);
+
+    protected:
+        void accumulate(Core::Acquisition acquisition, unsigned short sorting_index) override;
+        void accumulate(Core::Waveform waveform) override;
+        void send_data(Core::OutputChannel& out) override;
+
+    private:
+        struct Window {
+            BucketToBufferGadget::ReconDataBuffers buffers;
+            std::vector<Core::optional<AcquisitionBucketStats>> layouts; // Per encoding space
+            AcquisitionBucket deferred;
+        };
+
+        const AcquisitionBucketStats& layout(Window& window, const ISMRMRD::AcquisitionHeader& head);
+
+        // Lays out and fills the buffers; it is not part of the chain.
+        BucketToBufferGadget assembler;
+
+        std::map<unsigned short, Window> windows;
+        std::vector<Core::Waveform> waveforms;
+    };
+}
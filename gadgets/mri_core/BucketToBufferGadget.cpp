@@ -10,14 +10,6 @@ using BufferKey =  Gadgetron::BucketToBufferGadget::BufferKey;
 
 
 namespace std {
-    template<>
-    struct less<BufferKey>{
-        bool operator()(const BufferKey& idx1, const BufferKey& idx2) const {
-            return std::tie(idx1.average,idx1.slice,idx1.contrast,idx1.phase,idx1.repetition,idx1.set,idx1.segment) <
-                std::tie(idx2.average,idx2.slice,idx2.contrast,idx2.phase,idx2.repetition,idx2.set,idx2.segment);
-        }
-    };
-
     template<> struct equal_to<BufferKey>{
         bool operator()(const BufferKey& idx1, const BufferKey& idx2) const {
             return idx1.average == idx2.average
@@ -29,7 +21,7 @@ namespace std {
 namespace Gadgetron {
     namespace {
 
-        IsmrmrdReconBit& getRBit(std::map<BufferKey, IsmrmrdReconData>& recon_data_buffers,
+        IsmrmrdReconBit& getRBit(BucketToBufferGadget::ReconDataBuffers& recon_data_buffers,
             const BufferKey& key, uint16_t espace) {
 
             // Look up the DataBuffered entry corresponding to this encoding space
@@ -46,62 +38,77 @@ namespace Gadgetron {
     void BucketToBufferGadget::process(Core::InputChannel<AcquisitionBucket>& input, Core::OutputChannel& out) {
 
         for (auto acq_bucket : input) {
-            std::map<BufferKey, IsmrmrdReconData> recon_data_buffers;
+            ReconDataBuffers recon_data_buffers;
             GDEBUG_STREAM("BUCKET_SIZE " << acq_bucket.data_.size() << " ESPACE " << acq_bucket.refstats_.size());
-            // Iterate over the reference data of the bucket
-            for (auto& acq : acq_bucket.ref_) {
-                // Get a reference to the header for this acquisition
-
-                const auto& acqhdr    = std::get<ISMRMRD::AcquisitionHeader>(acq);
-                auto key              = getKey(acqhdr.idx);
-                uint16_t espace       = acqhdr.encoding_space_ref;
-                IsmrmrdReconBit& rbit = getRBit(recon_data_buffers, key, espace);
-                if (!rbit.ref_) {
-                    rbit.ref_ = makeDataBuffer(acqhdr, header.encoding[espace], acq_bucket.refstats_[espace], true);
-                    rbit.ref_->sampling_ = createSamplingDescription(
-                        header.encoding[espace], acq_bucket.refstats_[espace], acqhdr, true);
-                }
 
-                add_acquisition(*rbit.ref_, acq, header.encoding[espace], acq_bucket.refstats_[espace], true);
+            add_bucket(recon_data_buffers, acq_bucket);
 
-                // Stuff the data, header and trajectory into this data buffer
-            }
+            // Send all the ReconData messages
+            GDEBUG("End of bucket reached, sending out %d ReconData buffers\n", recon_data_buffers.size());
+            send(out, recon_data_buffers, acq_bucket.waveform_);
+        }
+    }
 
-            // Iterate over the reference data of the bucket
-            for (auto& acq : acq_bucket.data_) {
-                // Get a reference to the header for this acquisition
-
-                const auto& acqhdr    = std::get<ISMRMRD::AcquisitionHeader>(acq);
-                auto key              = getKey(acqhdr.idx);
-                uint16_t espace       = acqhdr.encoding_space_ref;
-                IsmrmrdReconBit& rbit = getRBit(recon_data_buffers, key, espace);
-                if (rbit.data_.data_.empty()) {
-                    rbit.data_ = makeDataBuffer(acqhdr, header.encoding[espace], acq_bucket.datastats_[espace], false);
-                    rbit.data_.sampling_ = createSamplingDescription(
-                        header.encoding[espace], acq_bucket.datastats_[espace], acqhdr, false);
-                }
+    void BucketToBufferGadget::add_bucket(ReconDataBuffers& recon_data_buffers, const AcquisitionBucket& bucket) {
+
+        // Iterate over the reference data of the bucket
+        for (auto& acq : bucket.ref_) {
+            uint16_t espace = std::get<ISMRMRD::AcquisitionHeader>(acq).encoding_space_ref;
+            add_readout(recon_data_buffers, acq, bucket.refstats_[espace], true);
+        }
+
+        // Iterate over the imaging data of the bucket
+        for (auto& acq : bucket.data_) {
+            uint16_t espace = std::get<ISMRMRD::AcquisitionHeader>(acq).encoding_space_ref;
+            add_readout(recon_data_buffers, acq, bucket.datastats_[espace], false);
+        }
+    }
+
+    void BucketToBufferGadget::add_readout(ReconDataBuffers& recon_data_buffers, const Core::Acquisition& acq,
+        const AcquisitionBucketStats& stats, bool forref) {
 
-                add_acquisition(rbit.data_, acq, header.encoding[espace], acq_bucket.datastats_[espace], false);
+        // Get a reference to the header for this acquisition
+        const auto& acqhdr    = std::get<ISMRMRD::AcquisitionHeader>(acq);
+        auto key              = getKey(acqhdr.idx);
+        uint16_t espace       = acqhdr.encoding_space_ref;
+        const auto& encoding  = header.encoding[espace];
+        IsmrmrdReconBit& rbit = getRBit(recon_data_buffers, key, espace);
 
-                // Stuff the data, header and trajectory into this data buffer
+        if (forref) {
+            if (!rbit.ref_) {
+                rbit.ref_ = makeDataBuffer(acqhdr, encoding, stats, true);
+                rbit.ref_->sampling_ = createSamplingDescription(encoding, stats, acqhdr, true);
             }
 
-            // Send all the ReconData messages
-            GDEBUG("End of bucket reached, sending out %d ReconData buffers\n", recon_data_buffers.size());
+            // Stuff the data, header and trajectory into this data buffer
+            add_acquisition(*rbit.ref_, acq, encoding, stats, true);
+        } else {
+            if (rbit.data_.data_.empty()) {
+                rbit.data_ = makeDataBuffer(acqhdr, encoding, stats, false);
+                rbit.data_.sampling_ = createSamplingDescription(encoding, stats, acqhdr, false);
+            }
 
-            for (auto& recon_data_buffer : recon_data_buffers) {
-                if (acq_bucket.waveform_.empty())
-                {
-                    GDEBUG_STREAM("Sending out ReconData buffers without waveforms ...");
-                    out.push(recon_data_buffer.second);
-                }
-                else
-                {
-                    GDEBUG_STREAM("Sending out ReconData buffers with waveforms ...");
-                    out.push(recon_data_buffer.second, acq_bucket.waveform_);
-                }
+            add_acquisition(rbit.data_, acq, encoding, stats, false);
+        }
+    }
+
+    void BucketToBufferGadget::send(Core::OutputChannel& out, ReconDataBuffers& recon_data_buffers,
+        const std::vector<Core::Waveform>& waveforms) const {
+
+        // The buffers are moved on rather than copied; they are not used again after they are sent.
+        for (auto& recon_data_buffer : recon_data_buffers) {
+            if (waveforms.empty())
+            {
+                GDEBUG_STREAM("Sending out ReconData buffers without waveforms ...");
+                out.push(std::move(recon_data_buffer.second));
+            }
+            else
+            {
+                GDEBUG_STREAM("Sending out ReconData buffers with waveforms ...");
+                out.push(std::move(recon_data_buffer.second), waveforms);
             }
         }
+        recon_data_buffers.clear();
     }
 
     namespace {
@@ -427,7 +434,7 @@ namespace Gadgetron {
     }
 
     void BucketToBufferGadget::add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq,
-        ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref) {
+        const ISMRMRD::Encoding& encoding, const AcquisitionBucketStats& stats, bool forref) {
 
         // The acquisition header and data
         const auto& acqhdr  = std::get<ISMRMRD::AcquisitionHeader>(acq);
@@ -8,6 +8,8 @@
 #include <complex>
 #include <ismrmrd/ismrmrd.h>
 #include <ismrmrd/xml.h>
+#include <map>
+#include <tuple>
 
 namespace Gadgetron {
 
@@ -33,6 +35,19 @@ namespace Gadgetron {
         BufferKey(const ISMRMRD::EncodingCounters& idx) : average{idx.average}, slice{idx.slice},contrast{idx.contrast}, phase{idx.phase},repetition{idx.repetition},set{idx.set},segment{idx.segment} {}
     };
 
+        using ReconDataBuffers = std::map<BufferKey, IsmrmrdReconData>;
+
+        // Fills the buffers with the reference and imaging data of a bucket, sized by the data in the bucket.
+        void add_bucket(ReconDataBuffers& recon_data_buffers, const AcquisitionBucket& bucket);
+
+        // Places a single readout in the buffer it belongs to. A buffer is allocated when its first readout arrives,
+        // sized from the given stats, so later readouts are copied straight into place.
+        void add_readout(ReconDataBuffers& recon_data_buffers, const Core::Acquisition& acq,
+            const AcquisitionBucketStats& stats, bool forref);
+
+        void send(Core::OutputChannel& out, ReconDataBuffers& recon_data_buffers,
+            const std::vector<Core::Waveform>& waveforms) const;
+
     protected:
         NODE_PROPERTY(N_dimension, Dimension, "N-Dimensions", Dimension::none);
         NODE_PROPERTY(S_dimension, Dimension, "S-Dimensions", Dimension::none);
@@ -50,7 +65,7 @@ namespace Gadgetron {
 
         virtual SamplingDescription createSamplingDescription(const ISMRMRD::Encoding& encoding, const AcquisitionBucketStats& stats, const ISMRMRD::AcquisitionHeader& acqhdr, bool forref) const ;
 
-        void add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq, ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref);
+        void add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq, const ISMRMRD::Encoding& encoding, const AcquisitionBucketStats& stats, bool forref);
 
         virtual uint16_t getNE0(const ISMRMRD::AcquisitionHeader& acqhdr, const ISMRMRD::Encoding& encoding) const;
         virtual uint16_t getNE1(const ISMRMRD::Encoding& encoding, const AcquisitionBucketStats& stats, bool forref) const;
@@ -60,3 +75,13 @@ namespace Gadgetron {
 
     void from_string(const std::string&, BucketToBufferGadget::Dimension&);
 }
+
+namespace std {
+    template<>
+    struct less<Gadgetron::BucketToBufferGadget::BufferKey>{
+        bool operator()(const Gadgetron::BucketToBufferGadget::BufferKey& idx1, const Gadgetron::BucketToBufferGadget::BufferKey& idx2) const {
+            return std::tie(idx1.average,idx1.slice,idx1.contrast,idx1.phase,idx1.repetition,idx1.set,idx1.segment) <
+                std::tie(idx2.average,idx2.slice,idx2.contrast,idx2.phase,idx2.repetition,idx2.set,idx2.segment);
+        }
+    };
+}
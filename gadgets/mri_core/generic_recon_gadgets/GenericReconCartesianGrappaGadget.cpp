@@ -3,6 +3,11 @@
 #include "mri_core_grappa.h"
 #include "hoNDArray_reductions.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <tuple>
+
 /*
     The input is IsmrmrdReconData and output is single 2D or 3D ISMRMRD images
 
@@ -15,6 +20,40 @@
 
 namespace Gadgetron {
 
+    namespace {
+
+        // the calibration inputs of a held calibration are unchanged only if both the hash and the parameters agree
+        bool same_calib_inputs(const hoGriddingCacheKey& a, const hoGriddingCacheKey& b)
+        {
+            return a.value() == b.value() && a.parameters() == b.parameters();
+        }
+
+        std::string calib_storage_key(const hoGriddingCacheKey& key)
+        {
+            std::stringstream os;
+            os << "grappa_calib_" << std::hex << std::setw(16) << std::setfill('0') << key.value();
+            return os.str();
+        }
+
+        // the parameters of the key, followed by the kernel, kernelIm, unmixing coefficients and gfactor
+        using StoredCalib = std::tuple< std::vector<char>, hoNDArray< std::complex<float> >, hoNDArray< std::complex<float> >, hoNDArray< std::complex<float> >, hoNDArray<float> >;
+
+        // the slot-th of num equal parts of an array, without copying
+        template <typename T> hoNDArray<T> calib_slot(hoNDArray<T>& a, size_t slot, size_t num)
+        {
+            size_t n = a.get_number_of_elements() / num;
+            return hoNDArray<T>(n, a.begin() + slot * n);
+        }
+
+        // zero the parts of an array whose calibration is recomputed
+        template <typename T> void clear_uncached(hoNDArray<T>& a, const std::vector<char>& cached)
+        {
+            size_t n = a.get_number_of_elements() / cached.size();
+            for (size_t ii = 0; ii < cached.size(); ii++)
+                if (!cached[ii]) std::fill_n(a.begin() + ii * n, n, T(0));
+        }
+    }
+
     GenericReconCartesianGrappaGadget::GenericReconCartesianGrappaGadget() : BaseClass()
     {
     }
@@ -41,6 +80,8 @@ namespace Gadgetron {
         GDEBUG_CONDITION_STREAM(verbose.value(), "Number of encoding spaces: " << NE);
 
         recon_obj_.resize(NE);
+        calib_fingerprint_.resize(NE);
+        calib_gfactor_.resize(NE);
 
         GDEBUG("PATHNAME %s 'n",this->context.paths.gadgetron_home.c_str());
 
@@ -297,6 +338,7 @@ namespace Gadgetron {
             }
 
             recon_obj_[e].recon_res_.data_.clear();
+            if (grappa_calib_cache.value()) calib_gfactor_[e] = std::move(recon_obj_[e].gfactor_);
             recon_obj_[e].gfactor_.clear();
             recon_obj_[e].recon_res_.headers_.clear();
             recon_obj_[e].recon_res_.meta_.clear();
@@ -420,11 +462,31 @@ namespace Gadgetron {
 
         size_t dstCHA = dst.get_size(3);
 
+        // the [N S SLC] whose inputs are unchanged keep the calibration held in recon_obj
+        bool use_cache = grappa_calib_cache.value() && (acceFactorE1_[e] > 1 || acceFactorE2_[e] > 1);
+        std::vector<hoGriddingCacheKey> fingerprints;
+        std::vector<char> cached(ref_N * ref_S * ref_SLC, 0);
+
+        if (use_cache) {
+            fingerprints = this->compute_calib_fingerprints(recon_bit, recon_obj, e);
+            recon_obj.gfactor_ = std::move(calib_gfactor_[e]);
+
+            if (calib_fingerprint_[e].size() == cached.size()
+                && recon_obj.unmixing_coeff_.get_number_of_elements() == RO * E1 * E2 * srcCHA * cached.size()
+                && recon_obj.gfactor_.get_number_of_elements() == RO * E1 * E2 * cached.size()) {
+                for (size_t ii = 0; ii < cached.size(); ii++)
+                    cached[ii] = same_calib_inputs(calib_fingerprint_[e][ii], fingerprints[ii]);
+            }
+        }
+
+        // set again once the calibration is complete
+        calib_fingerprint_[e].clear();
+
         recon_obj.unmixing_coeff_.create(RO, E1, E2, srcCHA, ref_N, ref_S, ref_SLC);
         recon_obj.gfactor_.create(RO, E1, E2, 1, ref_N, ref_S, ref_SLC);
 
-        Gadgetron::clear(recon_obj.unmixing_coeff_);
-        Gadgetron::clear(recon_obj.gfactor_);
+        clear_uncached(recon_obj.unmixing_coeff_, cached);
+        clear_uncached(recon_obj.gfactor_, cached);
 
         if (acceFactorE1_[e] <= 1 && acceFactorE2_[e] <= 1) {
             Gadgetron::conjugate(recon_obj.coil_map_, recon_obj.unmixing_coeff_);
@@ -452,16 +514,23 @@ namespace Gadgetron {
 
             recon_obj.kernel_.create(convKRO, convKE1, convKE2, srcCHA, dstCHA, ref_N, ref_S, ref_SLC);
 
-            Gadgetron::clear(recon_obj.kernel_);
-            Gadgetron::clear(recon_obj.kernelIm_);
+            clear_uncached(recon_obj.kernel_, cached);
+            clear_uncached(recon_obj.kernelIm_, cached);
 
             long long num = ref_N * ref_S * ref_SLC;
 
             long long ii;
 
+            if (use_cache) {
+                for (ii = 0; ii < num; ii++)
+                    if (!cached[ii]) cached[ii] = this->load_calib(recon_obj, ii, fingerprints[ii]);
+            }
+
             // only allow this for loop openmp if num>1 and 2D recon
-#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, e, num, ref_N, ref_S, ref_RO, ref_E1, ref_E2, RO, E1, E2, dstCHA, srcCHA, convKRO, convKE1, convKE2, kRO, kNE1, kNE2, fitItself) if(num>1)
+#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, e, num, ref_N, ref_S, ref_RO, ref_E1, ref_E2, RO, E1, E2, dstCHA, srcCHA, convKRO, convKE1, convKE2, kRO, kNE1, kNE2, fitItself, cached) if(num>1)
             for (ii = 0; ii < num; ii++) {
+                if (cached[ii]) continue;
+
                 size_t slc = ii / (ref_N * ref_S);
                 size_t s = (ii - slc * ref_N * ref_S) / (ref_N);
                 size_t n = ii - slc * ref_N * ref_S - s * ref_N;
@@ -487,14 +556,14 @@ namespace Gadgetron {
                         Gadgetron::grappa3d_calib_convolution_kernel(ref_src, ref_dst, (size_t)acceFactorE1_[e],
                             (size_t)acceFactorE2_[e], grappa_reg_lamda.value(),
                             grappa_calib_over_determine_ratio.value(), kRO, kNE1,
-                            kNE2, ker);
+                            kNE2, ker, grappa_calib_block_size.value());
                     }
                     else
                     {
                         Gadgetron::grappa3d_calib_convolution_kernel(ref_src, ref_src, (size_t)acceFactorE1_[e],
                             (size_t)acceFactorE2_[e], grappa_reg_lamda.value(),
                             grappa_calib_over_determine_ratio.value(), kRO, kNE1,
-                            kNE2, ker);
+                            kNE2, ker, grappa_calib_block_size.value());
                     }
 
                     //if (!debug_folder_full_path_.empty())
@@ -533,12 +602,12 @@ namespace Gadgetron {
                     if (fitItself)
                     {
                         Gadgetron::grappa2d_calib_convolution_kernel(acsSrc, acsDst, (size_t)acceFactorE1_[e],
-                            grappa_reg_lamda.value(), kRO, kNE1, convKer);
+                            grappa_reg_lamda.value(), kRO, kNE1, convKer, grappa_calib_block_size.value());
                     }
                     else
                     {
                         Gadgetron::grappa2d_calib_convolution_kernel(acsSrc, acsSrc, (size_t)acceFactorE1_[e],
-                            grappa_reg_lamda.value(), kRO, kNE1, convKer);
+                            grappa_reg_lamda.value(), kRO, kNE1, convKer, grappa_calib_block_size.value());
                     }
                     Gadgetron::grappa2d_image_domain_kernel(convKer, RO, E1, kIm);
 
@@ -575,10 +644,130 @@ namespace Gadgetron {
 
                 // -----------------------------------
             }
+
+            if (use_cache) {
+                size_t hits = 0;
+                for (ii = 0; ii < num; ii++) {
+                    if (cached[ii])
+                        hits++;
+                    else
+                        this->save_calib(recon_obj, ii, fingerprints[ii]);
+                }
+
+                calib_fingerprint_[e] = fingerprints;
+                calib_cache_hits_ += hits;
+                calib_cache_misses_ += num - hits;
+                GDEBUG_CONDITION_STREAM(perform_timing.value(), "GenericReconCartesianGrappaGadget::perform_calib, encoding " << e
+                                        << " : calibration cache hits " << hits << ", misses " << num - hits);
+            }
         }
 
     }
 
+    std::vector<hoGriddingCacheKey>
+    GenericReconCartesianGrappaGadget::compute_calib_fingerprints(IsmrmrdReconBit &recon_bit, ReconObjType &recon_obj, size_t e) {
+
+        size_t RO = recon_bit.data_.data_.get_size(0);
+        size_t E1 = recon_bit.data_.data_.get_size(1);
+        size_t E2 = recon_bit.data_.data_.get_size(2);
+
+        hoNDArray<std::complex<float> > &src = recon_obj.ref_calib_;
+        hoNDArray<std::complex<float> > &dst = recon_obj.ref_calib_dst_;
+
+        size_t ref_RO = src.get_size(0);
+        size_t ref_E1 = src.get_size(1);
+        size_t ref_E2 = src.get_size(2);
+        size_t srcCHA = src.get_size(3);
+        size_t dstCHA = dst.get_size(3);
+
+        long long num = src.get_size(4) * src.get_size(5) * src.get_size(6);
+        long long ii;
+
+        size_t ref_slot = ref_RO * ref_E1 * ref_E2;
+        size_t coil_map_slot = RO * E1 * E2 * dstCHA;
+
+        hoGriddingCacheKey parameters;
+        for (size_t v : { RO, E1, E2, ref_RO, ref_E1, ref_E2, srcCHA, dstCHA,
+                          (size_t) grappa_kSize_RO.value(), (size_t) grappa_kSize_E1.value(), (size_t) grappa_kSize_E2.value(),
+                          (size_t) acceFactorE1_[e], (size_t) acceFactorE2_[e], (size_t) this->downstream_coil_compression.value(),
+                          grappa_calib_block_size.value() })
+            parameters.add(uint64_t(v));
+        parameters.add(grappa_reg_lamda.value());
+        parameters.add(grappa_calib_over_determine_ratio.value());
+
+        std::vector<hoGriddingCacheKey> fingerprints(num);
+
+#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, num, ref_slot, coil_map_slot, srcCHA, dstCHA, parameters, fingerprints) if(num>1)
+        for (ii = 0; ii < num; ii++) {
+            hoGriddingCacheKey fingerprint = parameters;
+            fingerprint.add(src.begin() + ii * ref_slot * srcCHA, ref_slot * srcCHA * sizeof(std::complex<float>));
+            fingerprint.add(dst.begin() + ii * ref_slot * dstCHA, ref_slot * dstCHA * sizeof(std::complex<float>));
+            fingerprint.add(recon_obj.coil_map_.begin() + ii * coil_map_slot, coil_map_slot * sizeof(std::complex<float>));
+            fingerprints[ii] = std::move(fingerprint);
+        }
+
+        return fingerprints;
+    }
+
+    bool GenericReconCartesianGrappaGadget::load_calib(ReconObjType &recon_obj, size_t slot, const hoGriddingCacheKey& fingerprint) {
+
+        if (!grappa_calib_cache_storage.value() || !this->context.storage.session) return false;
+
+        size_t num = recon_obj.ref_calib_.get_size(4) * recon_obj.ref_calib_.get_size(5) * recon_obj.ref_calib_.get_size(6);
+
+        try {
+            auto stored = this->context.storage.session->get_latest<StoredCalib>(calib_storage_key(fingerprint));
+            if (!stored) return false;
+
+            auto kernel = calib_slot(recon_obj.kernel_, slot, num);
+            auto kernelIm = calib_slot(recon_obj.kernelIm_, slot, num);
+            auto unmixing_coeff = calib_slot(recon_obj.unmixing_coeff_, slot, num);
+            auto gfactor = calib_slot(recon_obj.gfactor_, slot, num);
+
+            auto& [stored_parameters, stored_kernel, stored_kernelIm, stored_unmixing_coeff, stored_gfactor] = *stored;
+            // a calibration stored for other inputs whose hash happens to be the same
+            if (std::string(stored_parameters.begin(), stored_parameters.end()) != fingerprint.parameters())
+                return false;
+
+            if (stored_kernel.get_number_of_elements() != kernel.get_number_of_elements()
+                || stored_kernelIm.get_number_of_elements() != kernelIm.get_number_of_elements()
+                || stored_unmixing_coeff.get_number_of_elements() != unmixing_coeff.get_number_of_elements()
+                || stored_gfactor.get_number_of_elements() != gfactor.get_number_of_elements())
+                return false;
+
+            std::copy_n(stored_kernel.begin(), kernel.get_number_of_elements(), kernel.begin());
+            std::copy_n(stored_kernelIm.begin(), kernelIm.get_number_of_elements(), kernelIm.begin());
+            std::copy_n(stored_unmixing_coeff.begin(), unmixing_coeff.get_number_of_elements(), unmixing_coeff.begin());
+            std::copy_n(stored_gfactor.begin(), gfactor.get_number_of_elements(), gfactor.begin());
+            return true;
+        }
+        catch (const std::exception& e) {
+            GWARN_STREAM("Failed to read grappa calibration from the storage : " << e.what());
+        }
+
+        return false;
+    }
+
+    void GenericReconCartesianGrappaGadget::save_calib(ReconObjType &recon_obj, size_t slot, const hoGriddingCacheKey& fingerprint) {
+
+        if (!grappa_calib_cache_storage.value() || !this->context.storage.session) return;
+
+        size_t num = recon_obj.ref_calib_.get_size(4) * recon_obj.ref_calib_.get_size(5) * recon_obj.ref_calib_.get_size(6);
+
+        try {
+            this->context.storage.session->store(calib_storage_key(fingerprint),
+                std::make_tuple(std::vector<char>(fingerprint.parameters().begin(), fingerprint.parameters().end()),
+                                calib_slot(recon_obj.kernel_, slot, num), calib_slot(recon_obj.kernelIm_, slot, num),
+                                calib_slot(recon_obj.unmixing_coeff_, slot, num), calib_slot(recon_obj.gfactor_, slot, num)));
+        }
+        catch (const IncompleteStorageContextException& e) {
+            GWARN_STREAM("Grappa calibration is not stored : " << e.what());
+        }
+        catch (const std::exception& e) {
+            GWARN_STREAM("Failed to store grappa calibration : " << e.what());
+        }
+    }
+
     void GenericReconCartesianGrappaGadget::perform_unwrapping(IsmrmrdReconBit &recon_bit, ReconObjType &recon_obj,
                                                                size_t e) {
 
@@ -747,6 +936,9 @@ namespace Gadgetron {
     {
         GDEBUG_CONDITION_STREAM(this->verbose.value(), "GenericReconCartesianGrappaGadget - close(flags) : " << flags);
         if (BaseClass::close(flags) != GADGET_OK) return GADGET_FAIL;
+        GDEBUG_CONDITION_STREAM(perform_timing.value() && grappa_calib_cache.value(),
+                                "GenericReconCartesianGrappaGadget - calibration cache hits " << calib_cache_hits_
+                                << ", misses " << calib_cache_misses_);
         this->gt_streamer_.close_stream_buffer();
         return GADGET_OK;
     }
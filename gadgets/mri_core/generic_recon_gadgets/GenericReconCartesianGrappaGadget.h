@@ -6,6 +6,9 @@
 #pragma once
 
 #include "GenericReconGadget.h"
+#include "hoGriddingCache.h"
+
+#include <cstdint>
 
 namespace Gadgetron {
 
@@ -77,6 +80,20 @@ namespace Gadgetron {
         GADGET_PROPERTY(grappa_kSize_E2, int, "Grappa kernel size E2", 4);
         GADGET_PROPERTY(grappa_reg_lamda, double, "Grappa regularization threshold", 0.0005);
         GADGET_PROPERTY(grappa_calib_over_determine_ratio, double, "Grappa calibration overdermination ratio", 45);
+        /// if grappa_calib_block_size > 0, the calibration matrix is never formed; its normal equations are accumulated
+        /// over blocks of this many calibration points instead, which bounds the memory for large 3D calibrations
+        GADGET_PROPERTY(grappa_calib_block_size, size_t, "Grappa calibration points per block of the normal equations, 0 to form the whole calibration matrix", 0);
+
+        /// ------------------------------------------------------------------------------------
+        /// calibration cache
+        /// the calibration of every [N S SLC] of an encoding space is kept in recon_obj_ with a fingerprint of its reference data,
+        /// coil map and grappa parameters; the fingerprint hashes the data and keeps the parameters and sizes verbatim;
+        /// if new reference data gives the same hash and parameters, the kernels, unmixing coefficients and gfactor held
+        /// from the previous calibration are reused instead of recomputed
+        /// if grappa_calib_cache_storage==true, calibrations are also stored in and looked up from the session storage space,
+        /// so repeated series in the same session reuse them
+        GADGET_PROPERTY(grappa_calib_cache, bool, "Whether to reuse grappa calibrations when the reference data is unchanged", true);
+        GADGET_PROPERTY(grappa_calib_cache_storage, bool, "Whether to store and look up grappa calibrations in the session storage space", false);
 
         /// ------------------------------------------------------------------------------------
         /// down stream coil compression
@@ -95,6 +112,13 @@ namespace Gadgetron {
         // record the recon kernel, coil maps etc. for every encoding space
         std::vector< ReconObjType > recon_obj_;
 
+        // for every encoding space, the fingerprint of the calibration inputs of every [N S SLC] held in recon_obj_
+        std::vector< std::vector<hoGriddingCacheKey> > calib_fingerprint_;
+        // for every encoding space, the gfactor of the held calibration; process() does not send it again with later data
+        std::vector< hoNDArray<float> > calib_gfactor_;
+        size_t calib_cache_hits_ = 0;
+        size_t calib_cache_misses_ = 0;
+
         // --------------------------------------------------
         // gadget functions
         // --------------------------------------------------
@@ -113,6 +137,13 @@ namespace Gadgetron {
         // calibration, if only one dst channel is prescribed, the GrappaOne is used
         virtual void perform_calib(IsmrmrdReconBit& recon_bit, ReconObjType& recon_obj, size_t encoding);
 
+        // fingerprints of the calibration inputs of every [N S SLC]
+        virtual std::vector<hoGriddingCacheKey> compute_calib_fingerprints(IsmrmrdReconBit& recon_bit, ReconObjType& recon_obj, size_t encoding);
+        // read the calibration with this fingerprint from the session storage into the slot-th [N S SLC]; false if not found or stored for other parameters
+        virtual bool load_calib(ReconObjType& recon_obj, size_t slot, const hoGriddingCacheKey& fingerprint);
+        // store the calibration of the slot-th [N S SLC] in the session storage with the parameters of its fingerprint, if prescribed
+        virtual void save_calib(ReconObjType& recon_obj, size_t slot, const hoGriddingCacheKey& fingerprint);
+
         // unwrapping or coil combination
         virtual void perform_unwrapping(IsmrmrdReconBit& recon_bit, ReconObjType& recon_obj, size_t encoding);
 
@@ -4,6 +4,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include "hoNFFT.h"
+#include "hoGriddingCache.h"
 #include "hoNDArray.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
@@ -27,5 +28,14 @@ namespace Gadgetron{
 
     }
 
+    int CPUGriddingReconGadget::close(unsigned long flags) {
+        if (flags) {
+            auto stats = hoGriddingCache::instance().statistics();
+            GDEBUG_STREAM("Gridding cache: " << stats.hits << " hits, " << stats.disk_hits << " loaded from disk, "
+                          << stats.misses << " misses, " << stats.entries << " entries (" << stats.bytes << " bytes)");
+        }
+        return GriddingReconGadgetBase<hoNDArray>::close(flags);
+    }
+
     GADGET_FACTORY_DECLARE(CPUGriddingReconGadget);
 }
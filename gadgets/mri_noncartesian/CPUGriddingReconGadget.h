@@ -23,7 +23,9 @@ namespace Gadgetron{
 		CPUGriddingReconGadget();
 
 		~CPUGriddingReconGadget();
-	
+
+		/** Reports how often gridding plans were reused from hoGriddingCache. */
+		virtual int close(unsigned long flags) override;
 
 
 	};
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "distributed/AcquisitionDistributor.h"
+#include "gadgets/setup_gadget.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Core::Distributed;
+
+namespace {
+
+    class CollectingChannelCreator : public ChannelCreator {
+    public:
+        OutputChannel create() override {
+            auto channel = make_channel();
+            partitions.push_back(std::move(channel.input));
+            return std::move(channel.output);
+        }
+
+        std::vector<GenericInputChannel> partitions;
+    };
+
+    Acquisition acquisition(uint16_t slice, uint16_t contrast) {
+        auto acq = Test::generate_acquisition(16, 2);
+        std::get<ISMRMRD::AcquisitionHeader>(acq).idx.slice = slice;
+        std::get<ISMRMRD::AcquisitionHeader>(acq).idx.contrast = contrast;
+        return acq;
+    }
+
+    std::vector<std::set<std::pair<uint16_t, uint16_t>>> distribute(
+            const std::string &dimensions,
+            const std::vector<std::pair<uint16_t, uint16_t>> &indices
+    ) {
+        AcquisitionDistributor distributor(Test::generate_context(), {{"parallel_dimension", dimensions}});
+        CollectingChannelCreator creator;
+
+        auto input = make_channel();
+        auto bypass = make_channel();
+        {
+            auto output = std::move(input.output);
+            for (auto [slice, contrast] : indices) output.push(acquisition(slice, contrast));
+        }
+
+        Distributor &base = distributor;
+        base.process(std::move(input.input), creator, std::move(bypass.output));
+
+        std::vector<std::set<std::pair<uint16_t, uint16_t>>> partitions;
+        for (auto &partition : creator.partitions) {
+            std::set<std::pair<uint16_t, uint16_t>> seen;
+            for (auto message : partition) {
+                auto header = std::get<ISMRMRD::AcquisitionHeader>(force_unpack<Acquisition>(std::move(message)));
+                seen.emplace(header.idx.slice, header.idx.contrast);
+            }
+            partitions.push_back(std::move(seen));
+        }
+        return partitions;
+    }
+}
+
+TEST(AcquisitionDistributorTest, single_dimension) {
+    auto partitions = distribute("slice", {{0, 0}, {1, 0}, {0, 1}, {1, 1}});
+
+    ASSERT_EQ(partitions.size(), 2u);
+    for (auto &partition : partitions) {
+        EXPECT_EQ(partition.size(), 2u);
+        EXPECT_EQ(partition.begin()->first, partition.rbegin()->first);
+    }
+}
+
+TEST(AcquisitionDistributorTest, composite_dimensions_partition_on_each_combination) {
+    std::vector<std::pair<uint16_t, uint16_t>> indices;
+    for (int repeat = 0; repeat < 3; repeat++)
+        for (uint16_t slice = 0; slice < 2; slice++)
+            for (uint16_t contrast = 0; contrast < 3; contrast++)
+                indices.emplace_back(slice, contrast);
+
+    for (auto dimensions : {"slice,contrast", "slice, contrast", "contrast,slice"}) {
+        auto partitions = distribute(dimensions, indices);
+
+        ASSERT_EQ(partitions.size(), 6u) << dimensions;
+        std::set<std::pair<uint16_t, uint16_t>> combinations;
+        for (auto &partition : partitions) {
+            ASSERT_EQ(partition.size(), 1u) << dimensions;
+            combinations.insert(*partition.begin());
+        }
+        EXPECT_EQ(combinations.size(), 6u) << dimensions;
+    }
+}
+
+TEST(AcquisitionDistributorTest, rejects_unknown_dimensions) {
+    EXPECT_THROW(distribute("slice,colour", {{0, 0}}), std::runtime_error);
+    EXPECT_THROW(distribute(",", {{0, 0}}), std::runtime_error);
+}
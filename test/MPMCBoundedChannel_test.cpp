@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "MPMCBoundedChannel.h"
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron::Core;
+
+TEST(MPMCBoundedChannelTest, capacityRoundsToPowerOfTwo) {
+    MPMCBoundedChannel<int> channel{ 5 };
+    EXPECT_EQ(channel.capacity(), 8);
+}
+
+TEST(MPMCBoundedChannelTest, tryPushFailsWhenFull) {
+    MPMCBoundedChannel<int> channel{ 2 };
+    int a = 1, b = 2, c = 3;
+    EXPECT_TRUE(channel.try_push(a));
+    EXPECT_TRUE(channel.try_push(b));
+    EXPECT_FALSE(channel.try_push(c));
+    EXPECT_EQ(channel.pop(), 1);
+    EXPECT_TRUE(channel.try_push(c));
+    EXPECT_EQ(channel.pop(), 2);
+    EXPECT_EQ(channel.pop(), 3);
+    EXPECT_FALSE(channel.try_pop());
+}
+
+TEST(MPMCBoundedChannelTest, closeDrainsRemaining) {
+    MPMCBoundedChannel<std::unique_ptr<int>> channel{ 4 };
+    channel.push(std::make_unique<int>(4));
+    channel.close();
+    EXPECT_THROW(channel.push(std::make_unique<int>(5)), ChannelClosed);
+    EXPECT_EQ(*channel.pop(), 4);
+    EXPECT_THROW(channel.pop(), ChannelClosed);
+}
+
+TEST(MPMCBoundedChannelTest, multipleProducersAndConsumers) {
+    MPMCBoundedChannel<int> channel{ 4 };
+    constexpr int producers = 4, consumers = 4, count = 10000;
+
+    std::vector<std::thread> producer_threads;
+    for (int p = 0; p < producers; p++) {
+        producer_threads.emplace_back([&]() {
+            for (int i = 1; i <= count; i++)
+                channel.push(i);
+        });
+    }
+
+    std::vector<long long> sums(consumers, 0);
+    std::vector<std::thread> consumer_threads;
+    for (int c = 0; c < consumers; c++) {
+        consumer_threads.emplace_back([&, c]() {
+            try {
+                while (true)
+                    sums[c] += channel.pop();
+            } catch (const ChannelClosed&) {
+            }
+        });
+    }
+
+    for (auto& thread : producer_threads)
+        thread.join();
+    channel.close();
+    for (auto& thread : consumer_threads)
+        thread.join();
+
+    auto total = std::accumulate(sums.begin(), sums.end(), 0ll);
+    EXPECT_EQ(total, producers * (static_cast<long long>(count) * (count + 1) / 2));
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <complex>
+#include <random>
+#include <sstream>
+
+#include "io/compressed_stream.h"
+#include "io/primitives.h"
+
+using namespace Gadgetron::Core::IO;
+
+namespace {
+
+    std::vector<std::complex<float>> make_kspace(size_t samples) {
+        std::mt19937 engine(5489u);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+
+        std::vector<std::complex<float>> kspace(samples);
+        for (size_t i = 0; i < samples; i++) {
+            auto weight = std::exp(-float(i % 256) / 32.0f);
+            kspace[i] = std::complex<float>(noise(engine), noise(engine)) * weight;
+        }
+        return kspace;
+    }
+
+    class CompressedStreamCodecTest : public ::testing::TestWithParam<std::string> {
+    protected:
+        void SetUp() override {
+            auto codecs = supported_codecs();
+            if (std::find(codecs.begin(), codecs.end(), GetParam()) == codecs.end())
+                GTEST_SKIP() << GetParam() << " is not supported by this build.";
+        }
+    };
+}
+
+TEST(CompressedStreamTest, passes_data_through_until_compression_is_enabled) {
+    std::stringstream wire;
+    {
+        CompressibleStream stream(wire);
+        write(stream, uint16_t(1008));
+        write_string_to_stream<uint32_t>(stream, "uncompressed");
+    }
+
+    std::stringstream expected;
+    write(expected, uint16_t(1008));
+    write_string_to_stream<uint32_t>(expected, "uncompressed");
+
+    EXPECT_EQ(wire.str(), expected.str());
+}
+
+TEST(CompressedStreamTest, buffers_small_writes_and_keeps_order_with_large_ones) {
+    std::vector<char> large(3 * CompressedStreamBuf::passthrough_size + 5);
+    for (size_t i = 0; i < large.size(); i++) large[i] = char(i);
+
+    std::stringstream wire, expected;
+    CompressibleStream stream(wire);
+    for (auto out : {static_cast<std::ostream *>(&stream), static_cast<std::ostream *>(&expected)}) {
+        for (uint16_t i = 0; i < 1000; i++) write(*out, i);
+        out->write(large.data(), large.size());
+        out->put('x');
+        write_string_to_stream<uint32_t>(*out, "tail");
+    }
+
+    stream.flush();
+    EXPECT_EQ(wire.str(), expected.str());
+}
+
+TEST(CompressedStreamTest, rejects_unknown_codecs) {
+    std::stringstream wire;
+    CompressibleStream stream(wire);
+
+    EXPECT_THROW(stream.buffer().compress_output("unknown", 1), std::runtime_error);
+    EXPECT_THROW(stream.buffer().decompress_input("unknown"), std::runtime_error);
+}
+
+TEST_P(CompressedStreamCodecTest, round_trips_messages_across_blocks) {
+    auto kspace = make_kspace(3 * CompressedStreamBuf::block_size / sizeof(std::complex<float>) + 17);
+
+    std::stringstream wire;
+    {
+        CompressibleStream stream(wire);
+        write_string_to_stream<uint32_t>(stream, "handshake");
+        stream.flush();
+
+        stream.buffer().compress_output(GetParam(), 1);
+        write(stream, uint16_t(1008));
+        write(stream, kspace);
+        stream.flush();
+
+        write_string_to_stream<uint32_t>(stream, "after flush");
+    }
+
+    CompressibleStream stream(wire);
+    EXPECT_EQ(read_string_from_stream<uint32_t>(stream), "handshake");
+
+    stream.buffer().decompress_input(GetParam());
+    EXPECT_EQ(read<uint16_t>(stream), 1008);
+    EXPECT_EQ(read<std::vector<std::complex<float>>>(stream), kspace);
+    EXPECT_EQ(read_string_from_stream<uint32_t>(stream), "after flush");
+    EXPECT_EQ(stream.peek(), std::char_traits<char>::eof());
+
+    auto statistics = stream.buffer().statistics();
+    EXPECT_GT(statistics.bytes_decompressed, kspace.size() * sizeof(std::complex<float>));
+    EXPECT_EQ(statistics.bytes_received + std::string("handshake").size() + sizeof(uint32_t), wire.str().size());
+}
+
+TEST_P(CompressedStreamCodecTest, stores_incompressible_blocks) {
+    std::vector<char> noise(CompressedStreamBuf::block_size / 2);
+    std::mt19937 engine(5489u);
+    for (auto &c : noise) c = char(engine());
+
+    std::stringstream wire;
+    {
+        CompressibleStream stream(wire);
+        stream.buffer().compress_output(GetParam(), 1);
+        stream.write(noise.data(), noise.size());
+    }
+
+    CompressibleStream stream(wire);
+    stream.buffer().decompress_input(GetParam());
+
+    std::vector<char> received(noise.size());
+    stream.read(received.data(), received.size());
+    EXPECT_EQ(received, noise);
+    EXPECT_LT(wire.str().size(), noise.size() + 16);
+}
+
+INSTANTIATE_TEST_SUITE_P(Codecs, CompressedStreamCodecTest, ::testing::Values("zstd", "zstd-shuffle"));
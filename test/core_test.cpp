@@ -3,6 +3,9 @@
 #include "Message.h"
 #include "Channel.h"
 #include "Types.h"
+#include "Writer.h"
+
+#include <sstream>
 
 TEST(TypeTests, multitype) {
     using namespace Gadgetron::Core;
@@ -227,3 +230,61 @@ TEST(TypeTests, tupletype3) {
 }
 
 
+
+TEST(MessageTests, cloneSharesData) {
+    using namespace Gadgetron::Core;
+
+    Message message(std::vector<int>(1000, 3), std::string("hello"));
+    auto &chunk = static_cast<TypedMessageChunk<std::vector<int>> &>(*message.messages()[0]);
+    const int *original = chunk.get().data();
+
+    auto clone = message.clone();
+    auto &cloned_chunk = static_cast<TypedMessageChunk<std::vector<int>> &>(*clone.messages()[0]);
+    EXPECT_EQ(cloned_chunk.get().data(), original);
+    EXPECT_TRUE(chunk.is_shared());
+}
+
+TEST(MessageTests, copyOnTakeWhileShared) {
+    using namespace Gadgetron::Core;
+
+    Message message(std::vector<int>(1000, 3), std::string("hello"));
+    const int *original = static_cast<TypedMessageChunk<std::vector<int>> &>(*message.messages()[0]).get().data();
+
+    auto [copy, text] = force_unpack<std::vector<int>, std::string>(message.clone());
+    EXPECT_NE(copy.data(), original);
+    EXPECT_EQ(copy, std::vector<int>(1000, 3));
+    EXPECT_EQ(text, "hello");
+
+    // The clone is gone, so the last holder gets the data without a copy.
+    auto [data, text2] = force_unpack<std::vector<int>, std::string>(std::move(message));
+    EXPECT_EQ(data.data(), original);
+}
+
+namespace {
+    class IntTextWriter : public Gadgetron::Core::TypedWriter<int, std::string> {
+    protected:
+        void serialize(std::ostream &stream, const int &number, const std::string &text) override {
+            stream << number << text;
+        }
+    };
+}
+
+TEST(MessageTests, writerSerializesSharedChunks) {
+    using namespace Gadgetron::Core;
+
+    IntTextWriter writer;
+    Message message(4, std::string("four"));
+    std::stringstream stream;
+    writer.write(stream, message.clone());
+    EXPECT_EQ(stream.str(), "4four");
+}
+
+TEST(MessageTests, writerRejectsMismatchedMessages) {
+    using namespace Gadgetron::Core;
+
+    IntTextWriter writer;
+    std::stringstream stream;
+    EXPECT_THROW(writer.write(stream, Message(4)), std::runtime_error);
+    EXPECT_THROW(writer.write(stream, Message(4, 5)), std::runtime_error);
+    EXPECT_THROW(writer.write(stream, Message(4, std::string("four"), 5)), std::runtime_error);
+}
@@ -14,6 +14,8 @@
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
 #include "cmr_t1_mapping.h"
+#include "cmr_parametric_fitting.h"
+#include "hoNDArray_elemwise_kernels.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
 
@@ -233,3 +235,121 @@ TYPED_TEST(curveFitting_test, T1SRMapping)
     // test hole filling
     EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.36963, 1.0);
 }
+
+TYPED_TEST(curveFitting_test, T1SRMappingBatched)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = true;
+    t1_sr.max_size_of_holes_ = 20;
+    t1_sr.hole_marking_value_ = 0;
+    t1_sr.compute_SD_maps_ = true;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+
+    t1_sr.max_iter_ = 150;
+    t1_sr.thres_fun_ = 1e-4;
+    t1_sr.max_map_value_ = 4000;
+
+    t1_sr.use_batched_fitting_ = true;
+
+    // an odd image size, so the last batch of pixels is a partial one
+    size_t RO = 61;
+    size_t E1 = 47;
+    size_t N = t1_sr.ti_.size();
+
+    float y[11] = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    t1_sr.data_.create(RO, E1, N, 1, 1);
+    for (size_t n = 0; n < N; n++)
+    {
+        Gadgetron::hoNDArray<float> data2D(RO, E1, &(t1_sr.data_(0, 0, n, 0, 0)));
+        Gadgetron::fill(data2D, y[n]);
+    }
+
+    t1_sr.mask_for_mapping_.create(RO, E1, 1);
+    Gadgetron::fill(t1_sr.mask_for_mapping_, (float)1);
+
+    t1_sr.mask_for_mapping_(12, 23, 0) = 0;
+    t1_sr.mask_for_mapping_(12, 24, 0) = 0;
+    t1_sr.mask_for_mapping_(13, 23, 0) = 0;
+
+    t1_sr.perform_parametric_mapping();
+
+    // Levenberg-Marquardt finds the least square solution, which the simplex solver approximates
+    EXPECT_NEAR(t1_sr.para_(0, 0, 0, 0, 0), 471.0636, 0.003);
+    EXPECT_NEAR(t1_sr.para_(RO / 2, E1 / 2, 0, 0, 0), 471.0636, 0.003);
+
+    EXPECT_NEAR(t1_sr.map_(0, 0, 0, 0), 1122.3631, 0.003);
+    EXPECT_NEAR(t1_sr.map_(RO/2, E1/2, 0, 0), 1122.3631, 0.003);
+    EXPECT_NEAR(t1_sr.map_(RO-1, E1-1, 0, 0), 1122.3631, 0.003);
+    EXPECT_NEAR(t1_sr.map_(37, 36, 0, 0), 1122.3631, 0.003);
+
+    EXPECT_GT(t1_sr.sd_map_(RO / 2, E1 / 2, 0, 0), 0);
+
+    // test hole filling
+    EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.3631, 1.0);
+}
+
+TYPED_TEST(curveFitting_test, BatchedFitting)
+{
+    using namespace Gadgetron::parametric_fitting;
+
+    std::vector<float> x = { 100, 180, 260, 1000, 1080, 1900, 2700, 3500 };
+
+    // 37 pixels: two full batches and a partial one
+    size_t num = 37;
+
+    for (auto level : { elemwise::SimdLevel::scalar, elemwise::SimdLevel::avx2, elemwise::SimdLevel::avx512 })
+    {
+        auto previous = elemwise::simd_level();
+        elemwise::set_simd_level(level);
+
+        for (Model model : { Model::two_para_exp_decay, Model::two_para_exp_recovery, Model::three_para_exp_recovery })
+        {
+            size_t num_paras = get_num_of_paras(model);
+
+            std::vector<float> y(x.size() * num), b(num_paras * num), truth(num_paras * num), cost(num);
+
+            for (size_t p = 0; p < num; p++)
+            {
+                float A = 200.0f + 10.0f * p;
+                float T = 300.0f + 40.0f * p;
+
+                truth[p] = A;
+                if (num_paras == 2)
+                {
+                    truth[num + p] = T;
+                }
+                else
+                {
+                    truth[num + p] = 1.9f * A;
+                    truth[2 * num + p] = T;
+                }
+
+                for (size_t n = 0; n < x.size(); n++)
+                {
+                    float e = std::exp(-x[n] / T);
+                    float v = (model == Model::two_para_exp_decay) ? A * e : (model == Model::two_para_exp_recovery) ? A - A * e : A - 1.9f * A * e;
+                    y[n * num + p] = v;
+                }
+
+                for (size_t i = 0; i < num_paras; i++) b[i * num + p] = 0.8f * truth[i * num + p];
+            }
+
+            fit(model, x, num, y.data(), b.data(), cost.data(), 150, 1e-8f);
+
+            for (size_t p = 0; p < num; p++)
+            {
+                for (size_t i = 0; i < num_paras; i++)
+                {
+                    EXPECT_NEAR(b[i * num + p], truth[i * num + p], 1e-3 * truth[i * num + p]);
+                }
+                EXPECT_LT(cost[p], 1e-2);
+            }
+        }
+
+        elemwise::set_simd_level(previous);
+    }
+}
@@ -0,0 +1,115 @@
+#include "../../gadgets/mri_core/AcquisitionAccumulateTriggerGadget.h"
+#include "../../gadgets/mri_core/AcquisitionToBufferGadget.h"
+#include "../../gadgets/mri_core/BucketToBufferGadget.h"
+#include "setup_gadget.h"
+#include <future>
+#include <gtest/gtest.h>
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+using namespace std::chrono_literals;
+
+namespace {
+
+    Core::Context generate_multislice_context() {
+        auto context  = generate_context();
+        auto& limits  = context.header.encoding[0].encodingLimits;
+        limits.kspace_encoding_step_2 = ISMRMRD::Limit(0, 0, 0);
+        limits.slice                  = ISMRMRD::Limit(0, 1, 0);
+        limits.contrast               = ISMRMRD::Limit(0, 1, 0);
+        return context;
+    }
+
+    std::vector<Core::Acquisition> generate_acquisitions() {
+        std::vector<Core::Acquisition> acquisitions;
+        for (uint16_t slice = 0; slice < 2; slice++) {
+            for (uint16_t contrast = 0; contrast < 2; contrast++) {
+                for (uint16_t line = 80; line < 112; line++) {
+                    auto acq                      = generate_acquisition(192, 4);
+                    auto& head                    = std::get<ISMRMRD::AcquisitionHeader>(acq);
+                    head.idx.slice                = slice;
+                    head.idx.contrast             = contrast;
+                    head.idx.kspace_encode_step_1 = line;
+                    head.scan_counter             = uint32_t(acquisitions.size());
+
+                    auto& data = std::get<hoNDArray<std::complex<float>>>(acq);
+                    for (size_t i = 0; i < data.size(); i++)
+                        data[i] = std::complex<float>(float(i), float(head.scan_counter));
+
+                    acquisitions.push_back(std::move(acq));
+                }
+            }
+        }
+        return acquisitions;
+    }
+
+    Core::Message pop(Core::GenericInputChannel& channel) {
+        auto message_future = std::async([&]() { return channel.pop(); });
+        if (message_future.wait_for(1000ms) != std::future_status::ready)
+            throw std::runtime_error("No message arrived.");
+        return message_future.get();
+    }
+}
+
+TEST(AcquisitionToBufferTest, matches_bucket_to_buffer) {
+
+    auto properties = Core::GadgetProperties{ { "trigger_dimension"s, "slice"s }, { "N_dimension"s, "contrast"s } };
+    auto context    = generate_multislice_context();
+
+    auto streamed  = setup_gadget<AcquisitionToBufferGadget>(properties, context);
+    auto triggered = setup_gadget<AcquisitionAccumulateTriggerGadget>(properties, context);
+    auto buffered  = setup_gadget<BucketToBufferGadget>(properties, context);
+
+    for (auto& acq : generate_acquisitions()) {
+        streamed.input.push(acq);
+        triggered.input.push(acq);
+    }
+
+    // The first slice is sent when the second one begins.
+    auto streamed_message = pop(streamed.output);
+    buffered.input.push_message(pop(triggered.output));
+    auto buffered_message = pop(buffered.output);
+
+    ASSERT_TRUE(Core::convertible_to<IsmrmrdReconData>(streamed_message));
+    auto expected = Core::force_unpack<IsmrmrdReconData>(std::move(buffered_message));
+    auto actual   = Core::force_unpack<IsmrmrdReconData>(std::move(streamed_message));
+
+    ASSERT_EQ(actual.rbit_.size(), expected.rbit_.size());
+    auto& expected_data = expected.rbit_[0].data_;
+    auto& actual_data   = actual.rbit_[0].data_;
+
+    ASSERT_EQ(actual_data.data_.dimensions(), expected_data.data_.dimensions());
+    EXPECT_EQ(actual_data.data_.get_size(4), 2);
+    EXPECT_TRUE(std::equal(actual_data.data_.begin(), actual_data.data_.end(), expected_data.data_.begin()));
+
+    ASSERT_EQ(actual_data.headers_.dimensions(), expected_data.headers_.dimensions());
+    for (size_t contrast = 0; contrast < 2; contrast++) {
+        for (size_t line = 80; line < 112; line++)
+            EXPECT_EQ(actual_data.headers_(line, 0, contrast, 0, 0).scan_counter,
+                expected_data.headers_(line, 0, contrast, 0, 0).scan_counter);
+    }
+
+    EXPECT_EQ(actual_data.sampling_.sampling_limits_[1].min_, expected_data.sampling_.sampling_limits_[1].min_);
+    EXPECT_EQ(actual_data.sampling_.sampling_limits_[1].max_, expected_data.sampling_.sampling_limits_[1].max_);
+}
+
+TEST(AcquisitionToBufferTest, rejects_readouts_outside_the_encoding_limits) {
+
+    auto properties = Core::GadgetProperties{ { "N_dimension"s, "contrast"s } };
+    auto context    = generate_multislice_context();
+
+    auto acq   = generate_acquisition(192, 4);
+    auto& head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+    head.idx.contrast = 2;
+
+    AcquisitionToBufferGadget gadget(context, properties);
+    auto channels = Core::make_channel();
+    {
+        auto input = std::move(channels.output);
+        input.push(std::move(acq));
+    }
+
+    Core::Node& node = gadget;
+    auto output      = Core::make_channel();
+    EXPECT_THROW(node.process(channels.input, output.output), std::runtime_error);
+}
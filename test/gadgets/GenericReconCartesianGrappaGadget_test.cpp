@@ -0,0 +1,139 @@
+#include "../../gadgets/mri_core/generic_recon_gadgets/GenericReconCartesianGrappaGadget.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // Runs the calibration of a single encoding space with an acceleration of 2 in E1.
+    class CalibratingGadget : public GenericReconCartesianGrappaGadget {
+    public:
+        CalibratingGadget() {
+            acceFactorE1_ = { 2 };
+            acceFactorE2_ = { 1 };
+            recon_obj_.resize(1);
+            calib_fingerprint_.resize(1);
+            calib_gfactor_.resize(1);
+        }
+
+        void calibrate(IsmrmrdReconBit& recon_bit) {
+            perform_calib(recon_bit, recon_obj_[0], 0);
+        }
+
+        // process() takes the gfactor out of the recon object once the images are sent
+        void images_sent() {
+            calib_gfactor_[0] = std::move(recon_obj_[0].gfactor_);
+        }
+
+        ReconObjType& recon_obj() { return recon_obj_[0]; }
+        size_t hits() const { return calib_cache_hits_; }
+        size_t misses() const { return calib_cache_misses_; }
+    };
+
+    constexpr size_t RO = 32, E1 = 32, ref_E1 = 24, CHA = 4, N = 2;
+
+    void fill_random(hoNDArray<std::complex<float>>& array, std::mt19937& rng) {
+        std::normal_distribution<float> dist;
+        for (auto& v : array) v = { dist(rng), dist(rng) };
+    }
+
+    void setup(CalibratingGadget& gadget, IsmrmrdReconBit& recon_bit, std::mt19937& rng) {
+        recon_bit.data_.data_.create(RO, E1, 1, CHA, N, 1, 1);
+
+        auto& recon_obj = gadget.recon_obj();
+        recon_obj.ref_calib_.create(RO, ref_E1, 1, CHA, N, 1, 1);
+        fill_random(recon_obj.ref_calib_, rng);
+        recon_obj.ref_calib_dst_ = recon_obj.ref_calib_;
+        recon_obj.coil_map_.create(RO, E1, 1, CHA, N, 1, 1);
+        fill_random(recon_obj.coil_map_, rng);
+    }
+
+    std::vector<std::complex<float>> slot_of(const hoNDArray<std::complex<float>>& array, size_t n) {
+        size_t slot = array.get_number_of_elements() / N;
+        return std::vector<std::complex<float>>(array.begin() + n * slot, array.begin() + (n + 1) * slot);
+    }
+}
+
+TEST(GenericReconCartesianGrappaGadgetTest, unchanged_reference_reuses_calibration) {
+    std::mt19937 rng(42);
+    CalibratingGadget gadget;
+    IsmrmrdReconBit recon_bit;
+    setup(gadget, recon_bit, rng);
+
+    gadget.calibrate(recon_bit);
+    EXPECT_EQ(gadget.hits(), 0u);
+    EXPECT_EQ(gadget.misses(), N);
+
+    auto kernel = gadget.recon_obj().kernel_;
+    auto unmixing_coeff = gadget.recon_obj().unmixing_coeff_;
+    auto gfactor = gadget.recon_obj().gfactor_;
+    gadget.images_sent();
+
+    // Marks the held kernel, so it shows whether the calibration was computed again.
+    gadget.recon_obj().kernel_(0) += 1.0f;
+    auto marked = gadget.recon_obj().kernel_;
+
+    gadget.calibrate(recon_bit);
+    EXPECT_EQ(gadget.hits(), N);
+    EXPECT_EQ(gadget.misses(), N);
+
+    EXPECT_EQ(gadget.recon_obj().kernel_, marked);
+    EXPECT_EQ(gadget.recon_obj().unmixing_coeff_, unmixing_coeff);
+    EXPECT_EQ(gadget.recon_obj().gfactor_, gfactor);
+    EXPECT_NE(gadget.recon_obj().kernel_, kernel);
+}
+
+TEST(GenericReconCartesianGrappaGadgetTest, changed_reference_recalibrates) {
+    std::mt19937 rng(42);
+    CalibratingGadget gadget;
+    IsmrmrdReconBit recon_bit;
+    setup(gadget, recon_bit, rng);
+
+    gadget.calibrate(recon_bit);
+    auto kernel = gadget.recon_obj().kernel_;
+    auto unmixing_coeff = gadget.recon_obj().unmixing_coeff_;
+    gadget.images_sent();
+
+    // Only the reference of the second N changes.
+    auto& ref = gadget.recon_obj().ref_calib_;
+    std::normal_distribution<float> dist;
+    for (size_t i = ref.get_number_of_elements() / N; i < ref.get_number_of_elements(); i++) ref(i) = { dist(rng), dist(rng) };
+    gadget.recon_obj().ref_calib_dst_ = ref;
+
+    gadget.calibrate(recon_bit);
+    EXPECT_EQ(gadget.hits(), 1u);
+    EXPECT_EQ(gadget.misses(), N + 1);
+
+    EXPECT_EQ(slot_of(gadget.recon_obj().kernel_, 0), slot_of(kernel, 0));
+    EXPECT_NE(slot_of(gadget.recon_obj().kernel_, 1), slot_of(kernel, 1));
+    EXPECT_EQ(slot_of(gadget.recon_obj().unmixing_coeff_, 0), slot_of(unmixing_coeff, 0));
+    EXPECT_EQ(gadget.recon_obj().gfactor_.get_number_of_elements(), RO * E1 * N);
+
+    // A changed coil map changes the unmixing coefficients, so it recalibrates as well.
+    gadget.images_sent();
+    gadget.recon_obj().coil_map_(0) += 1.0f;
+    gadget.calibrate(recon_bit);
+    EXPECT_EQ(gadget.hits(), 2u);
+    EXPECT_EQ(gadget.misses(), N + 2);
+}
+
+TEST(GenericReconCartesianGrappaGadgetTest, sign_flips_recalibrate) {
+    std::mt19937 rng(42);
+    CalibratingGadget gadget;
+    IsmrmrdReconBit recon_bit;
+    setup(gadget, recon_bit, rng);
+
+    gadget.calibrate(recon_bit);
+    gadget.images_sent();
+
+    // Flips the top bit of two 64 bit words of the first N's reference.
+    auto& ref = gadget.recon_obj().ref_calib_;
+    ref(0) = std::conj(ref(0));
+    ref(1) = std::conj(ref(1));
+    gadget.recon_obj().ref_calib_dst_ = ref;
+
+    gadget.calibrate(recon_bit);
+    EXPECT_EQ(gadget.hits(), 1u);
+    EXPECT_EQ(gadget.misses(), N + 1);
+}
@@ -0,0 +1,151 @@
+#include "hoCgSolver.h"
+#include "linearOperator.h"
+
+#include <gtest/gtest.h>
+#include <boost/make_shared.hpp>
+#include <complex>
+#include <type_traits>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+
+  template <class T> T conjugate(const T& value) {
+    if constexpr (std::is_arithmetic<T>::value)
+      return value;
+    else
+      return std::conj(value);
+  }
+
+  // Dense Hermitian positive definite matrix A = B^H B + n I, for a deterministic B
+  template <class T> class hermitianOperator : public linearOperator<hoNDArray<T>> {
+  public:
+    explicit hermitianOperator(size_t n) : n_(n), A_(n, n) {
+      hoNDArray<T> B(n, n);
+      for (size_t i = 0; i < B.size(); i++)
+        B[i] = value(i);
+
+      for (size_t row = 0; row < n; row++) {
+        for (size_t col = 0; col < n; col++) {
+          T element = row == col ? T(n) : T(0);
+          for (size_t k = 0; k < n; k++)
+            element += conjugate(B[k * n + row]) * B[k * n + col];
+          A_[row * n + col] = element;
+        }
+      }
+
+      std::vector<size_t> dims{ n };
+      this->set_domain_dimensions(dims);
+      this->set_codomain_dimensions(dims);
+    }
+
+    void mult_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+      for (size_t row = 0; row < n_; row++) {
+        T element = T(0);
+        for (size_t col = 0; col < n_; col++)
+          element += A_[row * n_ + col] * (*in)[col];
+        (*out)[row] = accumulate ? (*out)[row] + element : element;
+      }
+    }
+
+    void mult_MH(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+      mult_M(in, out, accumulate);
+    }
+
+    static T value(size_t i) {
+      if constexpr (std::is_arithmetic<T>::value)
+        return T(i % 11) / T(7) - T(0.5);
+      else
+        return T((i % 11) / 7.0 - 0.5, (i % 5) / 3.0 - 0.5);
+    }
+
+  private:
+    size_t n_;
+    hoNDArray<T> A_;
+  };
+
+  // Relative residual termination, counting the iterations
+  template <class T> class countingTCB : public relativeResidualTCB<hoNDArray<T>> {
+  public:
+    typedef typename relativeResidualTCB<hoNDArray<T>>::REAL REAL;
+
+    bool iterate(unsigned int iteration, REAL* tc_metric, bool* tc_terminate) override {
+      iterations = iteration + 1;
+      return relativeResidualTCB<hoNDArray<T>>::iterate(iteration, tc_metric, tc_terminate);
+    }
+
+    unsigned int iterations = 0;
+  };
+}
+
+template <typename T> class hoCgSolver_Test : public ::testing::Test {
+protected:
+  typedef typename realType<T>::Type REAL;
+
+  virtual void SetUp() {
+    op = boost::make_shared<hermitianOperator<T>>(n);
+    truth = hoNDArray<T>(n);
+    data = hoNDArray<T>(n);
+    for (size_t i = 0; i < n; i++)
+      truth[i] = hermitianOperator<T>::value(3 * i + 1);
+    op->mult_M(&truth, &data);
+  }
+
+  // Solves with the given solver, returning the solution and the number of iterations run
+  std::pair<hoNDArray<T>, unsigned int> solve(cgSolver<hoNDArray<T>>& solver,
+                                              boost::shared_ptr<cgPreconditioner<hoNDArray<T>>> precond = {}) {
+    auto tcb = boost::make_shared<countingTCB<T>>();
+    solver.set_encoding_operator(op);
+    solver.set_termination_callback(tcb);
+    solver.set_max_iterations(100);
+    solver.set_tc_tolerance(REAL(1e-6));
+    solver.set_output_mode(cgSolver<hoNDArray<T>>::OUTPUT_SILENT);
+    if (precond)
+      solver.set_preconditioner(precond);
+    auto x = solver.solve(&data);
+    return { *x, tcb->iterations };
+  }
+
+  boost::shared_ptr<cgPreconditioner<hoNDArray<T>>> diagonal_preconditioner() {
+    auto weights = boost::make_shared<hoNDArray<T>>(n);
+    for (size_t i = 0; i < n; i++)
+      (*weights)[i] = T(1) / T(REAL(n + i % 3));
+    auto precond = boost::make_shared<cgPreconditioner<hoNDArray<T>>>();
+    precond->set_weights(weights);
+    return precond;
+  }
+
+  void expect_same_solution(const std::pair<hoNDArray<T>, unsigned int>& fused,
+                            const std::pair<hoNDArray<T>, unsigned int>& unfused) {
+    EXPECT_EQ(fused.second, unfused.second);
+    EXPECT_GT(fused.second, 1u);
+    EXPECT_LT(fused.second, 100u);
+
+    for (size_t i = 0; i < n; i++) {
+      EXPECT_NEAR(std::abs(fused.first[i] - truth[i]), 0, 1e-2) << "at " << i;
+      EXPECT_NEAR(std::abs(fused.first[i] - unfused.first[i]), 0, 1e-4) << "at " << i;
+    }
+  }
+
+  const size_t n = 24;
+  boost::shared_ptr<hermitianOperator<T>> op;
+  hoNDArray<T> truth;
+  hoNDArray<T> data;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> cgTypes;
+TYPED_TEST_SUITE(hoCgSolver_Test, cgTypes);
+
+TYPED_TEST(hoCgSolver_Test, matches_unfused_solver) {
+  hoCgSolver<TypeParam> fused;
+  cgSolver<hoNDArray<TypeParam>> unfused;
+  this->expect_same_solution(this->solve(fused), this->solve(unfused));
+}
+
+TYPED_TEST(hoCgSolver_Test, matches_unfused_solver_preconditioned) {
+  hoCgSolver<TypeParam> fused;
+  cgSolver<hoNDArray<TypeParam>> unfused;
+  this->expect_same_solution(this->solve(fused, this->diagonal_preconditioner()),
+                             this->solve(unfused, this->diagonal_preconditioner()));
+}
@@ -0,0 +1,126 @@
+#include "hoNDArray.h"
+#include "hoNDArrayAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron;
+
+TEST(hoNDArrayPoolAllocator, alignment) {
+    hoNDArrayPoolAllocator pool(1 << 20);
+    for (size_t bytes : { 1, 63, 64, 65, 257, 1000, 12345, 1 << 20 }) {
+        auto data = pool.allocate(bytes);
+        ASSERT_NE(data, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % hoNDArrayAllocator::alignment, 0u);
+        pool.deallocate(data, bytes);
+    }
+}
+
+TEST(hoNDArrayPoolAllocator, reuse) {
+    hoNDArrayPoolAllocator pool(1 << 20);
+
+    auto first = pool.allocate(1000);
+    pool.deallocate(first, 1000);
+    auto second = pool.allocate(1000);
+
+    EXPECT_EQ(first, second);
+    auto statistics = pool.statistics();
+    EXPECT_EQ(statistics.hits, 1u);
+    EXPECT_EQ(statistics.misses, 1u);
+    EXPECT_GE(statistics.bytes_in_use, 1000u);
+
+    pool.deallocate(second, 1000);
+    EXPECT_EQ(pool.statistics().bytes_in_use, 0u);
+    EXPECT_GE(pool.statistics().peak_bytes_in_use, 1000u);
+}
+
+TEST(hoNDArrayPoolAllocator, cacheLimit) {
+    hoNDArrayPoolAllocator pool(4096);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 8; i++)
+        blocks.push_back(pool.allocate(1024));
+    for (auto block : blocks)
+        pool.deallocate(block, 1024);
+
+    EXPECT_LE(pool.statistics().bytes_cached, 4096u);
+
+    pool.trim();
+    EXPECT_EQ(pool.statistics().bytes_cached, 0u);
+}
+
+TEST(hoNDArrayPoolAllocator, crossThreadDeallocation) {
+    hoNDArrayPoolAllocator pool(1 << 24);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 64; i++)
+        blocks.push_back(pool.allocate(4096));
+
+    std::thread([&]() {
+        for (auto block : blocks)
+            pool.deallocate(block, 4096);
+    }).join();
+
+    // The exiting thread hands its cached blocks to the shared cache.
+    for (int i = 0; i < 64; i++)
+        blocks[i] = pool.allocate(4096);
+    EXPECT_EQ(pool.statistics().hits, 64u);
+
+    for (auto block : blocks)
+        pool.deallocate(block, 4096);
+}
+
+namespace {
+    // Frees its block in a thread_local destructor, after the caches of the thread are gone
+    struct LateFree {
+        ~LateFree() {
+            if (pool)
+                pool->deallocate(data, 4096);
+        }
+        hoNDArrayPoolAllocator* pool = nullptr;
+        void* data = nullptr;
+    };
+}
+
+TEST(hoNDArrayPoolAllocator, deallocationAfterThreadCacheDestroyed) {
+    hoNDArrayPoolAllocator pool(1 << 24);
+
+    std::thread([&]() {
+        // Constructed before the thread's caches, hence destroyed after them.
+        thread_local LateFree late;
+        late.pool = &pool;
+        late.data = pool.allocate(4096);
+    }).join();
+
+    EXPECT_EQ(pool.statistics().bytes_in_use, 0u);
+
+    // The block went to the shared cache.
+    auto data = pool.allocate(4096);
+    EXPECT_EQ(pool.statistics().hits, 1u);
+    pool.deallocate(data, 4096);
+}
+
+TEST(hoNDArrayAllocator, arrays) {
+    hoNDArray<std::complex<float>> array(31, 17);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(array.data()) % hoNDArrayAllocator::alignment, 0u);
+    array.fill(std::complex<float>(1, 2));
+
+    auto copy = array;
+    auto moved = std::move(copy);
+    EXPECT_EQ(moved(30, 16), std::complex<float>(1, 2));
+
+    moved.create(64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(moved.data()) % hoNDArrayAllocator::alignment, 0u);
+
+    auto external = new float[16];
+    hoNDArray<float> adopted(16, external, true);
+    adopted.fill(3.0f);
+
+    hoNDArray<std::string> strings(4);
+    EXPECT_TRUE(strings(3).empty());
+}
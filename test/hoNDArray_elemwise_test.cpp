@@ -1,4 +1,5 @@
 #include "hoNDArray_elemwise.h"
+#include "hoNDArray_elemwise_kernels.h"
 #include "complext.h"
 
 #include <gtest/gtest.h>
@@ -725,3 +726,87 @@ TYPED_TEST(hoNDArray_operators_TestCplx, nrm2) {
     EXPECT_FLOAT_EQ(1*this->dims[2], real(this->Array2[122]));
     EXPECT_FLOAT_EQ(2*this->dims[2], imag(this->Array2[122]));
 }
+
+template <typename T> class hoNDArray_elemwise_kernels_Test : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    // Large enough to be split over threads, with a broadcast period not a multiple of the chunk size
+    x = hoNDArray<T>(37, 49, 23, 19);
+    y = hoNDArray<T>(37, 49);
+    for (size_t i = 0; i < x.size(); i++) x[i] = value(i);
+    for (size_t i = 0; i < y.size(); i++) y[i] = value(3 * i + 1);
+  }
+  virtual void TearDown() { elemwise::set_simd_level(elemwise::supported_simd_level()); }
+
+  static T value(size_t i) {
+    if constexpr (std::is_arithmetic<T>::value)
+      return T(1) + T(i % 101) / T(7);
+    else
+      return T(1 + (i % 101) / 7.0, 0.5 - (i % 53) / 11.0);
+  }
+
+  // Runs f once for every instruction set supported by this cpu
+  template <class F> void for_each_simd_level(F&& f) {
+    for (auto level : { elemwise::SimdLevel::scalar, elemwise::SimdLevel::avx2, elemwise::SimdLevel::avx512 }) {
+      if (level > elemwise::supported_simd_level()) continue;
+      elemwise::set_simd_level(level);
+      ASSERT_EQ(elemwise::simd_level(), level);
+      f();
+    }
+  }
+
+  hoNDArray<T> x;
+  hoNDArray<T> y;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> kernelImplementations;
+
+TYPED_TEST_SUITE(hoNDArray_elemwise_kernels_Test, kernelImplementations);
+
+TYPED_TEST(hoNDArray_elemwise_kernels_Test, broadcast){
+  this->for_each_simd_level([this]() {
+    hoNDArray<TypeParam> sum, product;
+    add(this->x, this->y, sum);
+    multiply(this->x, this->y, product);
+    auto period = this->y.size();
+    for (size_t i = 0; i < this->x.size(); i += 997) {
+      EXPECT_NEAR(0, std::abs(sum[i] - (this->x[i] + this->y[i % period])), 1e-5 * std::abs(sum[i]));
+      EXPECT_NEAR(0, std::abs(product[i] - this->x[i] * this->y[i % period]), 1e-5 * std::abs(product[i]));
+    }
+  });
+}
+
+TYPED_TEST(hoNDArray_elemwise_kernels_Test, inplace){
+  this->for_each_simd_level([this]() {
+    auto z = this->x;
+    z -= this->y;
+    auto period = this->y.size();
+    for (size_t i = 0; i < this->x.size(); i += 997)
+      EXPECT_NEAR(0, std::abs(z[i] - (this->x[i] - this->y[i % period])), 1e-5 * std::abs(this->x[i]));
+  });
+}
+
+TYPED_TEST(hoNDArray_elemwise_kernels_Test, multiplyConjAndAbs){
+  this->for_each_simd_level([this]() {
+    auto w = this->x;
+    for (size_t i = 0; i < w.size(); i++) w[i] = this->x[(i * 7) % w.size()];
+    hoNDArray<TypeParam> r;
+    multiplyConj(this->x, w, r);
+    auto magnitude = abs(this->x);
+    for (size_t i = 0; i < this->x.size(); i += 997) {
+      TypeParam expected = this->x[i] * w[i];
+      if constexpr (!std::is_arithmetic<TypeParam>::value) expected = this->x[i] * std::conj(w[i]);
+      EXPECT_NEAR(0, std::abs(r[i] - expected), 1e-5 * std::abs(r[i]));
+      EXPECT_NEAR(std::abs(this->x[i]), magnitude[i], 1e-5 * magnitude[i]);
+    }
+  });
+}
+
+TEST(hoNDArray_elemwise_kernels, argument){
+  hoNDArray<std::complex<float>> x(1000, 100);
+  for (size_t i = 0; i < x.size(); i++) x[i] = std::polar(1.0f + i % 3, -3.0f + 6.0f * (i % 1000) / 1000.0f);
+  hoNDArray<float> phase;
+  argument(x, phase);
+  for (size_t i = 0; i < x.size(); i += 101)
+    EXPECT_NEAR(std::arg(x[i]), phase[i], 1e-5);
+}
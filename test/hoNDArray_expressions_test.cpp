@@ -0,0 +1,115 @@
+#include "hoNDArray_expressions.h"
+#include "hoNDArray_reductions.h"
+#include "complext.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+using namespace Gadgetron;
+using namespace Gadgetron::expressions;
+using testing::Types;
+
+template <class T> double magnitude(const T& value) {
+  using std::abs;
+  using Gadgetron::abs;
+  return abs(value);
+}
+
+template <typename T> class hoNDArray_expressions_Test : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    dims = {37, 49, 23, 19}; //Using prime numbers for setup because they are messy
+    a = hoNDArray<T>(dims);
+    b = hoNDArray<T>(dims);
+    c = hoNDArray<T>(dims);
+    for (size_t i = 0; i < a.size(); i++) {
+      a[i] = value(i);
+      b[i] = value(7 * i + 3);
+      c[i] = value(13 * i + 5);
+    }
+  }
+
+  static T value(size_t i) {
+    if constexpr (std::is_arithmetic<T>::value)
+      return T(1) + T(i % 101) / T(17);
+    else
+      return T(1 + (i % 101) / 17.0, 0.5 - (i % 53) / 23.0);
+  }
+
+  std::vector<size_t> dims;
+  hoNDArray<T> a;
+  hoNDArray<T> b;
+  hoNDArray<T> c;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>, float_complext, double_complext> implementations;
+
+TYPED_TEST_SUITE(hoNDArray_expressions_Test, implementations);
+
+TYPED_TEST(hoNDArray_expressions_Test, materialize){
+  TypeParam alpha = TypeParam(2.5);
+  hoNDArray<TypeParam> r = alpha * lazy(this->a) * lazy(this->b) + lazy(this->c);
+  EXPECT_EQ(r.dimensions(), this->dims);
+  for (size_t i = 0; i < r.size(); i += 1013) {
+    TypeParam expected = alpha * this->a[i] * this->b[i] + this->c[i];
+    EXPECT_NEAR(0, magnitude(r[i] - expected), 1e-5 * magnitude(expected));
+  }
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, assignInPlace){
+  auto data = this->a.get_data_ptr();
+  auto original = this->a;
+  this->a = lazy(this->b) - lazy(this->a) / lazy(this->c);
+  EXPECT_EQ(data, this->a.get_data_ptr());
+  for (size_t i = 0; i < this->a.size(); i += 1013) {
+    TypeParam expected = this->b[i] - original[i] / this->c[i];
+    EXPECT_NEAR(0, magnitude(this->a[i] - expected), 1e-5 * magnitude(expected));
+  }
+
+  hoNDArray<TypeParam> empty;
+  empty = lazy(this->b) + TypeParam(1);
+  EXPECT_EQ(empty.dimensions(), this->dims);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, compoundAssignment){
+  auto original = this->a;
+  TypeParam alpha = TypeParam(-0.5);
+  this->a += alpha * lazy(this->b);
+  this->a *= lazy(this->c);
+  for (size_t i = 0; i < this->a.size(); i += 1013) {
+    TypeParam expected = (original[i] + alpha * this->b[i]) * this->c[i];
+    EXPECT_NEAR(0, magnitude(this->a[i] - expected), 1e-5 * magnitude(expected));
+  }
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, reductions){
+  // The reference reductions accumulate 1.5M elements sequentially, so single precision needs a looser bound
+  double tolerance = std::is_same<realType_t<TypeParam>, float>::value ? 1e-3 : 1e-6;
+  hoNDArray<TypeParam> d = lazy(this->a) - lazy(this->b);
+
+  auto fused = dot(lazy(this->a) - lazy(this->b), lazy(this->a) - lazy(this->b));
+  auto reference = dot(&d, &d);
+  EXPECT_NEAR(0, magnitude(fused - reference), tolerance * magnitude(reference));
+
+  EXPECT_NEAR(nrm2(&d), nrm2(lazy(this->a) - lazy(this->b)), tolerance * nrm2(&d));
+
+  auto total = sum(lazy(this->c));
+  EXPECT_NEAR(0, magnitude(total - sum(&this->c)), tolerance * magnitude(total));
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, unary){
+  hoNDArray<realType_t<TypeParam>> modulus = abs(conj(lazy(this->a)));
+  hoNDArray<realType_t<TypeParam>> squared = norm(lazy(this->a));
+  for (size_t i = 0; i < this->a.size(); i += 1013) {
+    EXPECT_NEAR(magnitude(this->a[i]), modulus[i], 1e-5 * modulus[i]);
+    EXPECT_NEAR(modulus[i] * modulus[i], squared[i], 1e-4 * squared[i]);
+  }
+}
+
+TEST(hoNDArray_expressions, mismatchedSizes){
+  hoNDArray<float> x(10);
+  hoNDArray<float> y(11);
+  EXPECT_THROW(lazy(x) + lazy(y), std::runtime_error);
+}
@@ -2,6 +2,7 @@
 #include "hoNDArray_math.h"
 #include "complext.h"
 #include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
 #include <boost/random.hpp>
 #include <random>
 
@@ -168,3 +169,49 @@ TEST(FFTshiftTest, shift3d_random){
 }
 
 
+
+TEST(FFTPlanningTest, measured_plans_match_estimated_plans){
+
+    auto array = hoNDArray<std::complex<float>>(32, 48, 5);
+    std::mt19937 engine;
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    for (auto& value : array) value = std::complex<float>(distribution(engine), distribution(engine));
+
+    FFT::set_planning_rigor(FFT::PlanningRigor::estimate);
+    auto estimated = FFT::fft2c(array);
+    auto estimated_again = FFT::fft2c(array);
+
+    FFT::set_planning_rigor(FFT::PlanningRigor::measure);
+    auto measured = FFT::fft2c(array);
+    auto inverted = FFT::ifft2c(measured);
+    FFT::set_planning_rigor(FFT::PlanningRigor::estimate);
+
+    for (size_t i = 0; i < array.size(); i++) {
+        EXPECT_EQ(estimated[i], estimated_again[i]);
+        EXPECT_NEAR(std::abs(estimated[i] - measured[i]), 0.0f, 1e-4f);
+        EXPECT_NEAR(std::abs(array[i] - inverted[i]), 0.0f, 1e-4f);
+    }
+}
+
+TEST(FFTPlanningTest, wisdom_round_trip){
+
+    auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+    FFT::set_planning_rigor(FFT::PlanningRigor::measure);
+    auto array = hoNDArray<std::complex<double>>(40, 24);
+    array.fill(1.0);
+    FFT::fft(array, 0);
+    FFT::set_planning_rigor(FFT::PlanningRigor::estimate);
+
+    EXPECT_TRUE(FFT::export_wisdom(directory));
+    EXPECT_TRUE(FFT::import_wisdom(directory));
+    EXPECT_FALSE(FFT::import_wisdom(directory / "missing"));
+
+    boost::filesystem::remove_all(directory);
+}
+
+TEST(FFTPlanningTest, planning_rigor_from_string){
+    EXPECT_EQ(FFT::planning_rigor_from_string("estimate"), FFT::PlanningRigor::estimate);
+    EXPECT_EQ(FFT::planning_rigor_from_string("patient"), FFT::PlanningRigor::patient);
+    EXPECT_THROW(FFT::planning_rigor_from_string("exhaustive"), std::invalid_argument);
+}
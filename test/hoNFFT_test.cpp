@@ -3,10 +3,20 @@
 #include "hoNDArray_reductions.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNFFT.h"
+#include "hoGriddingConvolution.h"
+#include "hoGriddingCache.h"
+#include "hoNFFTToeplitzOperator.h"
+#include "NDArray_utils.h"
 #include "vector_td_utilities.h"
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
 
+#include <boost/make_shared.hpp>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
 using namespace Gadgetron;
 using testing::Types;
 
@@ -151,3 +161,337 @@ TYPED_TEST(hoNFFT_2D_NC2C_BACKWARDS, randomTestOne)
 
     EXPECT_LE(v/norm_ref, 0.00001);
 }
+
+TEST(hoGriddingConvolution, coilsAndAdjoint)
+{
+    typedef complext<float> T;
+
+    const size_t samples = 700, frames = 2, coils = 3;
+    vector_td<size_t, 2> matrix_size(24, 24);
+    vector_td<size_t, 2> matrix_size_os(48, 48);
+    KaiserKernel<float, 2> kernel(vector_td<unsigned int, 2>(matrix_size),
+                                  vector_td<unsigned int, 2>(matrix_size_os), 5.5f);
+    auto conv = GriddingConvolution<hoNDArray, T, 2, KaiserKernel>::make(
+        matrix_size, matrix_size_os, kernel);
+
+    hoNDArray<vector_td<float, 2>> trajectory(samples, frames);
+    for (size_t i = 0; i < trajectory.get_number_of_elements(); i++)
+        trajectory[i] = vector_td<float, 2>(0.45f * std::sin(0.1f * i), 0.45f * std::cos(0.37f * i));
+    conv->preprocess(trajectory);
+
+    hoNDArray<T> image(48, 48, frames, coils);
+    for (size_t i = 0; i < image.get_number_of_elements(); i++)
+        image[i] = T(std::cos(0.01f * i), std::sin(0.03f * i));
+    hoNDArray<T> kspace(samples, frames, coils);
+    for (size_t i = 0; i < kspace.get_number_of_elements(); i++)
+        kspace[i] = T(std::sin(0.02f * i), 1.0f - std::cos(0.05f * i));
+
+    hoNDArray<T> forward(kspace.dimensions());
+    conv->compute(image, forward, GriddingConvolutionMode::C2NC);
+    hoNDArray<T> adjoint(image.dimensions());
+    conv->compute(kspace, adjoint, GriddingConvolutionMode::NC2C);
+
+    auto inner = [](const hoNDArray<T>& x, const hoNDArray<T>& y) {
+        complext<double> sum(0);
+        for (size_t i = 0; i < x.get_number_of_elements(); i++)
+            sum += complext<double>(conj(x[i]) * y[i]);
+        return sum;
+    };
+
+    // <A x, y> == <x, A^H y>
+    auto lhs = inner(forward, kspace);
+    auto rhs = inner(image, adjoint);
+    EXPECT_NEAR(abs(lhs - rhs) / abs(lhs), 0, 1e-4);
+
+    // All coils are processed together; each must match processing the coil on its own.
+    for (size_t c = 0; c < coils; c++)
+    {
+        hoNDArray<T> coil_image, coil_forward;
+        coil_image.create(48, 48, frames, image.get_data_ptr() + c * 48 * 48 * frames);
+        coil_forward.create(samples, frames);
+        conv->compute(coil_image, coil_forward, GriddingConvolutionMode::C2NC);
+
+        for (size_t i = 0; i < coil_forward.get_number_of_elements(); i++)
+            EXPECT_NEAR(abs(coil_forward[i] - forward[c * samples * frames + i]), 0, 1e-5);
+    }
+
+    // Accumulating adds to the existing output.
+    hoNDArray<T> twice = adjoint;
+    conv->compute(kspace, twice, GriddingConvolutionMode::NC2C, true);
+    for (size_t i = 0; i < twice.get_number_of_elements(); i += 101)
+        EXPECT_NEAR(abs(twice[i] - T(2) * adjoint[i]), 0, 1e-4 * (1 + abs(adjoint[i])));
+}
+
+namespace
+{
+    hoGriddingCacheKey cache_key(int n)
+    {
+        return hoGriddingCacheKey().add(n);
+    }
+
+    std::string hex_string(uint64_t value)
+    {
+        std::ostringstream stream;
+        stream << std::hex << std::setw(16) << std::setfill('0') << value;
+        return stream.str();
+    }
+}
+
+TEST(hoGriddingCache, evictsLeastRecentlyUsed)
+{
+    const size_t elements = 1000;
+    hoGriddingCache cache(3 * elements * sizeof(float));
+
+    auto weights = [&](float value) {
+        auto array = std::make_shared<hoNDArray<float>>(elements);
+        array->fill(value);
+        return std::shared_ptr<const hoNDArray<float>>(array);
+    };
+
+    cache.insert(cache_key(1), weights(1));
+    cache.insert(cache_key(2), weights(2));
+    cache.insert(cache_key(3), weights(3));
+    ASSERT_TRUE(cache.find<hoNDArray<float>>(cache_key(1)));
+
+    // Entry 2 is now the least recently used.
+    cache.insert(cache_key(4), weights(4));
+    EXPECT_FALSE(cache.find<hoNDArray<float>>(cache_key(2)));
+    EXPECT_EQ((*cache.find<hoNDArray<float>>(cache_key(1)))[0], 1.0f);
+    EXPECT_EQ((*cache.find<hoNDArray<float>>(cache_key(3)))[0], 3.0f);
+    EXPECT_EQ((*cache.find<hoNDArray<float>>(cache_key(4)))[0], 4.0f);
+
+    // A value of another type is not returned for the same key.
+    EXPECT_FALSE(cache.find<hoNDArray<double>>(cache_key(1)));
+
+    // Values larger than the budget are not kept.
+    cache.insert(cache_key(5), std::shared_ptr<const hoNDArray<float>>(std::make_shared<hoNDArray<float>>(4 * elements)));
+    EXPECT_FALSE(cache.find<hoNDArray<float>>(cache_key(5)));
+
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.entries, 3);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.bytes, 3 * elements * sizeof(float));
+    EXPECT_EQ(stats.hits, 4);
+    EXPECT_EQ(stats.misses, 3);
+}
+
+TEST(hoGriddingCache, persistsToDisk)
+{
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("gadgetron_gridding_cache_" + std::to_string(std::random_device()()));
+
+    hoNDArray<vector_td<float, 2>> trajectory(300, 2);
+    for (size_t i = 0; i < trajectory.get_number_of_elements(); i++)
+        trajectory[i] = vector_td<float, 2>(10 + 8 * std::sin(0.1f * i), 10 + 8 * std::cos(0.3f * i));
+    KaiserKernel<float, 2> kernel(vector_td<unsigned int, 2>(12, 12), vector_td<unsigned int, 2>(24, 24), 4.0f);
+
+    auto plan = std::make_shared<hoGriddingPlan<float>>();
+    for (auto frame : NDArrayViewRange<hoNDArray<vector_td<float, 2>>>(trajectory, 0))
+    {
+        plan->conv_matrix.push_back(ConvInternal::make_conv_matrix(frame, vector_td<size_t, 2>(24, 24), kernel));
+        plan->conv_matrix_T.push_back(ConvInternal::transpose(plan->conv_matrix.back()));
+    }
+
+    auto weights = std::make_shared<hoNDArray<double>>(30, 4);
+    for (size_t i = 0; i < weights->get_number_of_elements(); i++)
+        (*weights)[i] = 0.5 * i;
+
+    {
+        hoGriddingCache cache(1 << 20, directory.string());
+        cache.insert(cache_key(7), std::shared_ptr<const hoGriddingPlan<float>>(plan));
+        cache.insert(cache_key(8), std::shared_ptr<const hoNDArray<double>>(weights));
+    }
+
+    // A fresh cache, as in another process, finds both on disk.
+    hoGriddingCache cache(1 << 20, directory.string());
+    auto loaded_plan = cache.find<hoGriddingPlan<float>>(cache_key(7));
+    auto loaded_weights = cache.find<hoNDArray<double>>(cache_key(8));
+    ASSERT_TRUE(loaded_plan);
+    ASSERT_TRUE(loaded_weights);
+    EXPECT_FALSE(cache.find<hoNDArray<double>>(cache_key(9)));
+    EXPECT_EQ(cache.statistics().disk_hits, 2);
+
+    ASSERT_EQ(loaded_plan->conv_matrix.size(), plan->conv_matrix.size());
+    ASSERT_EQ(loaded_plan->conv_matrix_T.size(), plan->conv_matrix_T.size());
+    for (size_t m = 0; m < plan->conv_matrix.size(); m++)
+    {
+        for (auto matrices : { std::make_pair(&plan->conv_matrix[m], &loaded_plan->conv_matrix[m]),
+                               std::make_pair(&plan->conv_matrix_T[m], &loaded_plan->conv_matrix_T[m]) })
+        {
+            EXPECT_EQ(matrices.first->n_rows, matrices.second->n_rows);
+            EXPECT_EQ(matrices.first->n_cols, matrices.second->n_cols);
+            EXPECT_EQ(matrices.first->offsets, matrices.second->offsets);
+            EXPECT_EQ(matrices.first->indices, matrices.second->indices);
+            EXPECT_EQ(matrices.first->weights, matrices.second->weights);
+        }
+    }
+
+    EXPECT_EQ(loaded_weights->dimensions(), weights->dimensions());
+    for (size_t i = 0; i < weights->get_number_of_elements(); i++)
+        EXPECT_EQ((*loaded_weights)[i], (*weights)[i]);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(hoGriddingCache, replacesFilesOnDisk)
+{
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("gadgetron_gridding_cache_" + std::to_string(std::random_device()()));
+
+    auto weights = [&](float value) {
+        auto array = std::make_shared<hoNDArray<float>>(10);
+        array->fill(value);
+        return std::shared_ptr<const hoNDArray<float>>(array);
+    };
+
+    {
+        hoGriddingCache cache(1 << 20, directory.string());
+        cache.insert(cache_key(1), weights(1));
+        cache.insert(cache_key(1), weights(2));
+    }
+
+    hoGriddingCache cache(1 << 20, directory.string());
+    auto loaded = cache.find<hoNDArray<float>>(cache_key(1));
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ((*loaded)[0], 2.0f);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(hoGriddingCache, comparesKeyParameters)
+{
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("gadgetron_gridding_cache_" + std::to_string(std::random_device()()));
+
+    hoNDArray<float> trajectory(8, 4);
+    trajectory.fill(0.25f);
+    auto key = hoGriddingCacheKey().add(std::string("test")).add(2.0f).add(trajectory);
+    EXPECT_EQ(key.parameters().find("test;"), 0);
+
+    {
+        hoGriddingCache cache(1 << 20, directory.string());
+        cache.insert(key, std::shared_ptr<const hoNDArray<float>>(std::make_shared<hoNDArray<float>>(trajectory)));
+    }
+
+    // A file stored for other parameters, as after a hash collision, is not returned.
+    auto other = hoGriddingCacheKey().add(std::string("test")).add(1.5f).add(trajectory);
+    std::filesystem::rename(directory / ("gridding_" + hex_string(key.value()) + ".sfndam"),
+                            directory / ("gridding_" + hex_string(other.value()) + ".sfndam"));
+
+    hoGriddingCache cache(1 << 20, directory.string());
+    EXPECT_FALSE(cache.find<hoNDArray<float>>(other));
+    EXPECT_EQ(cache.statistics().disk_hits, 0);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(hoGriddingConvolution, reusesCachedPlan)
+{
+    typedef complext<float> T;
+
+    auto& cache = hoGriddingCache::instance();
+    auto budget = cache.get_memory_budget();
+    cache.set_memory_budget(64 << 20);
+
+    vector_td<size_t, 2> matrix_size(16, 16);
+    vector_td<size_t, 2> matrix_size_os(32, 32);
+    KaiserKernel<float, 2> kernel(vector_td<unsigned int, 2>(matrix_size),
+                                  vector_td<unsigned int, 2>(matrix_size_os), 5.5f);
+    auto make = [&]() {
+        return GriddingConvolution<hoNDArray, T, 2, KaiserKernel>::make(matrix_size, matrix_size_os, kernel);
+    };
+
+    hoNDArray<vector_td<float, 2>> trajectory(400);
+    for (size_t i = 0; i < trajectory.get_number_of_elements(); i++)
+        trajectory[i] = vector_td<float, 2>(0.4f * std::sin(0.7f * i), 0.4f * std::cos(0.2f * i));
+
+    hoNDArray<T> samples(400);
+    for (size_t i = 0; i < samples.get_number_of_elements(); i++)
+        samples[i] = T(std::cos(0.3f * i), std::sin(0.1f * i));
+
+    auto first = make();
+    auto before = cache.statistics();
+    first->preprocess(trajectory, GriddingConvolutionPrepMode::C2NC);
+
+    // The transposes are added to the cached plan when needed.
+    auto second = make();
+    second->preprocess(trajectory);
+    hoNDArray<T> image(32, 32);
+    second->compute(samples, image, GriddingConvolutionMode::NC2C);
+
+    auto third = make();
+    third->preprocess(trajectory);
+    auto after = cache.statistics();
+    EXPECT_EQ(after.hits - before.hits, 2);
+
+    hoNDArray<T> cached_image(32, 32);
+    third->compute(samples, cached_image, GriddingConvolutionMode::NC2C);
+    for (size_t i = 0; i < image.get_number_of_elements(); i++)
+        EXPECT_EQ(abs(image[i] - cached_image[i]), 0.0f);
+
+    // Any change to the trajectory is a different plan.
+    trajectory[17][0] += 0.01f;
+    auto fourth = make();
+    fourth->preprocess(trajectory);
+    EXPECT_EQ(cache.statistics().hits, after.hits);
+
+    cache.set_memory_budget(budget);
+}
+
+TEST(hoNFFTToeplitzOperator, matchesGriddingNormalOperator)
+{
+    typedef complext<float> T;
+
+    const size_t n = 32, readout = 64, spokes = 40, coils = 2;
+    vector_td<size_t, 2> matrix_size(n, n);
+    vector_td<size_t, 2> matrix_size_os(2 * n, 2 * n);
+
+    // Radial trajectory with ramp density compensation.
+    hoNDArray<vector_td<float, 2>> trajectory(readout * spokes);
+    auto dcw = boost::make_shared<hoNDArray<float>>(readout * spokes);
+    for (size_t s = 0; s < spokes; s++) {
+        float angle = float(M_PI) * s / spokes;
+        for (size_t r = 0; r < readout; r++) {
+            float k = (float(r) - readout / 2) / readout;
+            trajectory[s * readout + r] = vector_td<float, 2>(k * std::cos(angle), k * std::sin(angle));
+            (*dcw)[s * readout + r] = std::abs(k) + 0.5f / readout;
+        }
+    }
+
+    std::vector<size_t> image_dims = { n, n, 1, coils };
+    std::vector<size_t> data_dims = { readout * spokes, 1, coils };
+
+    NFFTOperator<hoNDArray, float, 2> gridding;
+    gridding.setup(matrix_size, matrix_size_os, 5.5f);
+    gridding.set_domain_dimensions(image_dims);
+    gridding.set_codomain_dimensions(data_dims);
+    gridding.set_dcw(dcw);
+    gridding.preprocess(trajectory);
+
+    hoNFFTToeplitzOperator<float, 2> toeplitz;
+    toeplitz.setup(matrix_size, matrix_size_os, 5.5f);
+    toeplitz.set_domain_dimensions(image_dims);
+    toeplitz.set_codomain_dimensions(data_dims);
+    toeplitz.set_dcw(dcw);
+    toeplitz.preprocess(trajectory);
+
+    hoNDArray<T> image(image_dims);
+    for (size_t i = 0; i < image.get_number_of_elements(); i++)
+        image[i] = T(std::cos(0.05f * i) + 0.3f * std::sin(0.011f * i * i), std::sin(0.07f * i));
+
+    hoNDArray<T> expected(image_dims);
+    gridding.mult_MH_M(&image, &expected);
+    hoNDArray<T> result(image_dims);
+    toeplitz.mult_MH_M(&image, &result);
+
+    hoNDArray<T> difference = result;
+    difference -= expected;
+    EXPECT_LE(nrm2(&difference) / nrm2(&expected), 1e-2);
+
+    // Accumulating adds to the existing output.
+    hoNDArray<T> twice = result;
+    toeplitz.mult_MH_M(&image, &twice, true);
+    twice -= result;
+    twice -= result;
+    EXPECT_LE(nrm2(&twice) / nrm2(&result), 1e-5);
+}
@@ -37,6 +37,7 @@ default_config_values = {
         'value_comparison_threshold': '0.01',
         'scale_comparison_threshold': '0.01',
         'node_port_base': '9050',
+        'compression': 'none',
         'dataset_group': 'dataset',
         'reference_group': 'dataset',
         'disable_image_header_test': 'false',
@@ -169,9 +170,9 @@ def start_storage_server(*, log, port, storage_folder):
                 raise
 
 
-def start_gadgetron_instance(*, log_stdout, log_stderr, port, storage_address, env=environment):
+def start_gadgetron_instance(*, log_stdout, log_stderr, port, storage_address, env=environment, additional_arguments=[]):
     print("Starting Gadgetron instance on port", port)
-    proc = subprocess.Popen(["gadgetron", "-p", port, "-E", storage_address],
+    proc = subprocess.Popen(["gadgetron", "-p", port, "-E", storage_address] + additional_arguments,
                             stdout=log_stdout,
                             stderr=log_stderr,
                             env=env)
@@ -421,11 +422,15 @@ def ensure_gadgetron_instance(args, config):
 
     gadgetron = Gadgetron(host=str(args.host), port=str(args.port))
 
+    additional_arguments = []
+    if config.has_section('distributed'):
+        additional_arguments = ['--distributed_compression', config['distributed']['compression']]
+
     def start_gadgetron_action(cont, *, storage, env=environment, **state):
         with open(os.path.join(args.test_folder, 'gadgetron.log.out'), 'w') as log_stdout:
             with open(os.path.join(args.test_folder, 'gadgetron.log.err'), 'w') as log_stderr:
                 with start_gadgetron_instance(log_stdout=log_stdout, log_stderr=log_stderr, port=gadgetron.port, storage_address=storage.address,
-                                            env=env) as instance:
+                                            env=env, additional_arguments=additional_arguments) as instance:
                     try:
                         return cont(gadgetron=gadgetron, storage=storage, **state)
                     finally:
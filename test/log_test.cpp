@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "log.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Gadgetron;
+
+namespace {
+
+    struct TestLogger : public GadgetronLogger {
+        TestLogger() : output(tmpfile()) {
+            setOutput(output);
+        }
+
+        ~TestLogger() override {
+            disableAsync();
+            // The base destructor flushes once more, so it must not see the closed file.
+            setOutput(stderr);
+            fclose(output);
+        }
+
+        std::vector<std::string> lines() {
+            flush();
+            std::vector<std::string> result;
+            rewind(output);
+            char buffer[1024];
+            while (fgets(buffer, sizeof(buffer), output)) result.emplace_back(buffer);
+            return result;
+        }
+
+        FILE* output;
+    };
+
+    struct Counted {
+        int* count;
+    };
+
+    std::ostream& operator<<(std::ostream& stream, const Counted& counted) {
+        (*counted.count)++;
+        return stream << "counted";
+    }
+}
+
+TEST(LogTest, textFormat) {
+    TestLogger logger;
+    logger.disableOutputOption(GADGETRON_LOG_PRINT_DATETIME);
+
+    logger.log(GADGETRON_LOG_LEVEL_WARNING, "/some/folder/file.cpp", 42, "value %d\n", 7);
+
+    auto lines = logger.lines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0], "WARNING [file.cpp:42] value 7\n");
+}
+
+TEST(LogTest, jsonFormat) {
+    TestLogger logger;
+    logger.setFormat(GADGETRON_LOG_FORMAT_JSON);
+
+    logger.log(GADGETRON_LOG_LEVEL_ERROR, "file.cpp", 3, "a \"quoted\"\tpath\\name\n");
+
+    auto lines = logger.lines();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0].front(), '{');
+    EXPECT_NE(lines[0].find("\"level\":\"ERROR\""), std::string::npos);
+    EXPECT_NE(lines[0].find("\"file\":\"file.cpp\",\"line\":3"), std::string::npos);
+    EXPECT_NE(lines[0].find("\"message\":\"a \\\"quoted\\\"\\tpath\\\\name\"}"), std::string::npos);
+}
+
+TEST(LogTest, rateLimit) {
+    TestLogger logger;
+    logger.disableAllOutputOptions();
+    logger.setRateLimit(3);
+
+    for (int i = 0; i < 10; i++) logger.log(GADGETRON_LOG_LEVEL_INFO, "file.cpp", 1, "repeated\n");
+    logger.log(GADGETRON_LOG_LEVEL_INFO, "file.cpp", 2, "elsewhere\n");
+
+    auto lines = logger.lines();
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[2], "repeated\n");
+    EXPECT_EQ(lines[3], "elsewhere\n");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    logger.log(GADGETRON_LOG_LEVEL_INFO, "file.cpp", 1, "repeated\n");
+
+    lines = logger.lines();
+    ASSERT_EQ(lines.size(), 6u);
+    EXPECT_EQ(lines[4], "Suppressed 7 messages logged here within a second\n");
+    EXPECT_EQ(lines[5], "repeated\n");
+}
+
+TEST(LogTest, asyncFromManyThreads) {
+    TestLogger logger;
+    logger.disableAllOutputOptions();
+    logger.enableAsync();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&logger]() {
+            for (int i = 0; i < 2000; i++) logger.log(GADGETRON_LOG_LEVEL_DEBUG, "file.cpp", 1, "message %d\n", i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    auto lines = logger.lines();
+    EXPECT_EQ(lines.size(), 8000u);
+    EXPECT_EQ(lines.front(), "message 0\n");
+}
+
+#ifndef _WIN32
+TEST(LogTest, asyncAcrossFork) {
+    TestLogger logger;
+    logger.disableAllOutputOptions();
+    logger.enableAsync();
+
+    // A thread with a ring of its own that is still registered at the fork
+    std::thread([&logger]() { logger.log(GADGETRON_LOG_LEVEL_INFO, "file.cpp", 1, "parent\n"); }).join();
+    logger.flush();
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        logger.log(GADGETRON_LOG_LEVEL_INFO, "file.cpp", 2, "child\n");
+        logger.flush();
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+
+    auto lines = logger.lines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "parent\n");
+    EXPECT_EQ(lines[1], "child\n");
+}
+#endif
+
+TEST(LogTest, disabledLevelIsNotFormatted) {
+    int formatted = 0;
+
+    GadgetronLogger::instance()->disableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+    GDEBUG_STREAM(Counted{&formatted});
+    GadgetronLogger::instance()->enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+
+    EXPECT_EQ(formatted, 0);
+}
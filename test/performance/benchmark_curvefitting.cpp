@@ -2,14 +2,17 @@
 // Created by dch on 21/02/18.
 //
 #include "cmr_t1_mapping.h"
+#include "cmr_parametric_fitting.h"
 #include "curveFittingCostFunction.h"
 #include "GadgetronTimer.h"
+#include "hoNDArray_elemwise_kernels.h"
 #include "hoNDArray_math.h"
 #include "hoNDHarrWavelet.h"
 #include "hoNDRedundantWavelet.h"
 #include "ImageIOAnalyze.h"
 #include "log.h"
 #include "simplexLagariaSolver.h"
+#include "threeParaExpRecoveryOperator.h"
 #include "twoParaExpDecayOperator.h"
 #include "twoParaExpRecoveryOperator.h"
 
@@ -21,7 +24,10 @@
 
 #include <ceres/ceres.h>
 #include <numeric>
+#include <omp.h>
+#include <random>
 #define ITERATIONS 10000
+#define PIXELS 65536
 
 
 class twoParaExpRecovery  {
@@ -249,7 +255,122 @@ void time_gadgetron(){
     GINFO_STREAM("Best cost " << best_cost << " " << b[0] << " " << b[1] <<  std::endl);
 }
 using namespace Gadgetron;
+
+// Noisy synthetic pixels of the model, in the layout of parametric_fitting::fit, with initial guesses 20% off
+struct SyntheticPixels {
+    std::vector<float> x, y, guess;
+};
+
+SyntheticPixels make_pixels(parametric_fitting::Model model){
+    SyntheticPixels pixels;
+    pixels.x = {100, 180, 260, 1000, 1080, 1900, 2700, 3500};
+
+    size_t num_x = pixels.x.size();
+    size_t num_paras = parametric_fitting::get_num_of_paras(model);
+    pixels.y.resize(num_x * PIXELS);
+    pixels.guess.resize(num_paras * PIXELS);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> amplitude(200, 800), time(300, 2000);
+    std::normal_distribution<float> noise(0, 2);
+
+    for (size_t p = 0; p < PIXELS; p++) {
+        float b[3] = {amplitude(gen), 0, time(gen)};
+        b[1] = (num_paras == 3) ? 1.9f * b[0] : b[2];
+        for (size_t n = 0; n < num_x; n++) {
+            float e = std::exp(-pixels.x[n] / b[num_paras - 1]);
+            float v = (model == parametric_fitting::Model::two_para_exp_decay) ? b[0] * e :
+                      (model == parametric_fitting::Model::two_para_exp_recovery) ? b[0] - b[0] * e : b[0] - b[1] * e;
+            pixels.y[n * PIXELS + p] = v + noise(gen);
+        }
+        for (size_t i = 0; i < num_paras; i++) pixels.guess[i * PIXELS + p] = 1.2f * b[i];
+    }
+    return pixels;
+}
+
+// Fits every pixel on its own with the simplex solver, as CmrParametricMapping does without batched fitting
+template <class SignalType>
+double time_simplex(const SyntheticPixels& pixels, size_t num_paras, size_t num_pixels){
+    typedef Gadgetron::leastSquareErrorCostFunction<std::vector<float> > CostType;
+
+    SignalType signal_model;
+    CostType lse;
+
+    Gadgetron::simplexLagariaSolver<std::vector<float>, SignalType, CostType> solver;
+    solver.signal_model_ = &signal_model;
+    solver.cf_ = &lse;
+    solver.max_iter_ = 150;
+    solver.max_fun_eval_ = 1000;
+    solver.thres_fun_ = 1e-4;
+    solver.x_ = pixels.x;
+    solver.y_.resize(pixels.x.size());
+
+    std::vector<float> b(num_paras), guess(num_paras);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t p = 0; p < num_pixels; p++) {
+        for (size_t n = 0; n < pixels.x.size(); n++) solver.y_[n] = pixels.y[n * PIXELS + p];
+        for (size_t i = 0; i < num_paras; i++) guess[i] = pixels.guess[i * PIXELS + p];
+        solver.solve(b, guess);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return num_pixels / std::chrono::duration<double>(end - start).count();
+}
+
+double time_batched(parametric_fitting::Model model, const SyntheticPixels& pixels){
+    std::vector<float> b(pixels.guess);
+    auto start = std::chrono::high_resolution_clock::now();
+    parametric_fitting::fit(model, pixels.x, PIXELS, pixels.y.data(), b.data(), NULL, 150, 1e-4f);
+    auto end = std::chrono::high_resolution_clock::now();
+    return PIXELS / std::chrono::duration<double>(end - start).count();
+}
+
+void time_pixel_throughput(){
+    const std::pair<parametric_fitting::Model, std::string> models[] = {
+        {parametric_fitting::Model::two_para_exp_decay, "two_para_exp_decay"},
+        {parametric_fitting::Model::two_para_exp_recovery, "two_para_exp_recovery"},
+        {parametric_fitting::Model::three_para_exp_recovery, "three_para_exp_recovery"}};
+    const std::pair<elemwise::SimdLevel, std::string> levels[] = {
+        {elemwise::SimdLevel::scalar, "scalar"}, {elemwise::SimdLevel::avx2, "avx2"}, {elemwise::SimdLevel::avx512, "avx512"}};
+
+    auto max_threads = omp_get_max_threads();
+
+    for (auto& model : models) {
+        auto pixels = make_pixels(model.first);
+        size_t num_paras = parametric_fitting::get_num_of_paras(model.first);
+
+        // the simplex solver is slow, so a fraction of the pixels is enough
+        double simplex = 0;
+        switch (model.first) {
+        case parametric_fitting::Model::two_para_exp_decay:
+            simplex = time_simplex<twoParaExpDecayOperator<std::vector<float> > >(pixels, num_paras, PIXELS / 16);
+            break;
+        case parametric_fitting::Model::two_para_exp_recovery:
+            simplex = time_simplex<twoParaExpRecoveryOperator<std::vector<float> > >(pixels, num_paras, PIXELS / 16);
+            break;
+        case parametric_fitting::Model::three_para_exp_recovery:
+            simplex = time_simplex<threeParaExpRecoveryOperator<std::vector<float> > >(pixels, num_paras, PIXELS / 16);
+            break;
+        }
+        GINFO_STREAM(model.second << " simplex threads 1: " << simplex << " pixels/s" << std::endl);
+
+        for (auto& level : levels) {
+            if (level.first > elemwise::supported_simd_level()) continue;
+            elemwise::set_simd_level(level.first);
+            for (auto threads : {1, max_threads}) {
+                omp_set_num_threads(threads);
+                GINFO_STREAM(model.second << " batched " << level.second << " threads " << threads << ": "
+                                          << time_batched(model.first, pixels) << " pixels/s" << std::endl);
+                if (max_threads == 1) break;
+            }
+            omp_set_num_threads(max_threads);
+        }
+        elemwise::set_simd_level(elemwise::supported_simd_level());
+    }
+}
+
 int main(){
+    time_pixel_throughput();
     time_gadgetron();
     time_dlib();
     time_ceres();
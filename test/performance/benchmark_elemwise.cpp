@@ -0,0 +1,143 @@
+//
+// Compares the element-wise hoNDArray kernels over instruction sets and thread counts, and against the serial
+// scalar loop transform_impl ran before the kernels were added.
+//
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_elemwise_kernels.h"
+#include "log.h"
+
+#include <chrono>
+#include <complex>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#define ITERATIONS 50
+
+using namespace Gadgetron;
+
+namespace {
+
+    std::string level_name(elemwise::SimdLevel level) {
+        switch (level) {
+        case elemwise::SimdLevel::avx512: return "avx512";
+        case elemwise::SimdLevel::avx2: return "avx2";
+        default: return "scalar";
+        }
+    }
+
+    template <class T> struct internal_type { typedef T type; };
+    template <class T> struct internal_type<std::complex<T>> { typedef complext<T> type; };
+
+    //
+    // The loop transform_impl ran before the vectorized kernels: one thread, no SIMD dispatch, on the internal
+    // complext types, broadcasting y over the outer dimensions of x.
+    //
+    template <class T, class R, class BinaryOperator>
+    void baseline_transform(const hoNDArray<T>& x, const hoNDArray<T>& y, hoNDArray<R>& r, BinaryOperator op) {
+        using I = typename internal_type<T>::type;
+        using IR = typename internal_type<R>::type;
+        auto a = reinterpret_cast<const I*>(x.get_data_ptr());
+        auto b = reinterpret_cast<const I*>(y.get_data_ptr());
+        auto c = reinterpret_cast<IR*>(r.get_data_ptr());
+
+        long long inner = y.get_number_of_elements();
+        long long outer = x.get_number_of_elements() / inner;
+        for (long long o = 0; o < outer; o++) {
+            for (long long n = 0; n < inner; n++) {
+                c[o * inner + n] = op(a[o * inner + n], b[n]);
+            }
+        }
+    }
+
+    template <class T, class R, class UnaryOperator>
+    void baseline_transform(const hoNDArray<T>& x, hoNDArray<R>& r, UnaryOperator op) {
+        auto a = x.get_data_ptr();
+        auto c = r.get_data_ptr();
+        for (long long n = 0; n < (long long)x.get_number_of_elements(); n++) {
+            c[n] = op(a[n]);
+        }
+    }
+
+    // Returns the time per call in milliseconds
+    double time_operation(const std::function<void()>& operation) {
+        operation();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < ITERATIONS; i++)
+            operation();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / ITERATIONS;
+    }
+
+    void time_all(const std::string& name, size_t bytes_per_call, const std::function<void()>& baseline,
+                  const std::function<void()>& operation) {
+        auto baseline_ms = time_operation(baseline);
+        GINFO_STREAM(name << " baseline: " << baseline_ms << " ms, " << bytes_per_call / (baseline_ms * 1e6)
+                          << " GB/s" << std::endl);
+
+        auto max_threads = omp_get_max_threads();
+        std::vector<int> thread_counts = { 1 };
+        if (max_threads > 1)
+            thread_counts.push_back(max_threads);
+
+        for (auto level : { elemwise::SimdLevel::scalar, elemwise::SimdLevel::avx2, elemwise::SimdLevel::avx512 }) {
+            if (level > elemwise::supported_simd_level())
+                continue;
+            elemwise::set_simd_level(level);
+            for (auto threads : thread_counts) {
+                omp_set_num_threads(threads);
+                auto ms = time_operation(operation);
+                GINFO_STREAM(name << " " << level_name(level) << " threads " << threads << ": " << ms << " ms, "
+                                  << bytes_per_call / (ms * 1e6) << " GB/s, " << baseline_ms / ms
+                                  << "x baseline" << std::endl);
+            }
+            omp_set_num_threads(max_threads);
+        }
+        elemwise::set_simd_level(elemwise::supported_simd_level());
+    }
+
+    template <class T> void time_type(const std::string& type_name) {
+        // 128 x 128 x 32 channels x 16 slices: a typical multi-coil volume
+        hoNDArray<T> x(128, 128, 32, 16);
+        hoNDArray<T> y(128, 128, 32, 16);
+        hoNDArray<T> coil_map(128, 128, 32);
+        hoNDArray<T> r(x.dimensions());
+        hoNDArray<realType_t<T>> magnitude(x.dimensions());
+        fill(&x, T(1.5));
+        fill(&y, T(0.5));
+        fill(&coil_map, T(0.25));
+
+        auto bytes = x.get_number_of_bytes();
+        time_all("add " + type_name, 3 * bytes,
+            [&]() { baseline_transform(x, y, r, [](auto a, auto b) { return a + b; }); },
+            [&]() { add(x, y, r); });
+        time_all("multiply " + type_name, 3 * bytes,
+            [&]() { baseline_transform(x, y, r, [](auto a, auto b) { return a * b; }); },
+            [&]() { multiply(x, y, r); });
+        time_all("multiply (broadcast) " + type_name, 2 * bytes,
+            [&]() { baseline_transform(x, coil_map, r, [](auto a, auto b) { return a * b; }); },
+            [&]() { multiply(x, coil_map, r); });
+        time_all("multiplyConj " + type_name, 3 * bytes,
+            [&]() { baseline_transform(x, y, r, [](auto a, auto b) { return a * conj(b); }); },
+            [&]() { multiplyConj(x, y, r); });
+        time_all("abs " + type_name, bytes + magnitude.get_number_of_bytes(),
+            [&]() { baseline_transform(x, magnitude, [](auto v) { using std::abs; return abs(v); }); },
+            [&]() { abs(x, magnitude); });
+    }
+}
+
+int main() {
+    GINFO_STREAM("Supported instruction set: " << level_name(elemwise::supported_simd_level()) << std::endl);
+    time_type<float>("float");
+    time_type<std::complex<float>>("complex<float>");
+    time_type<std::complex<double>>("complex<double>");
+
+    hoNDArray<std::complex<float>> x(128, 128, 32, 16);
+    hoNDArray<float> phase(x.dimensions());
+    fill(&x, std::complex<float>(1, 2));
+    time_all("argument complex<float>", x.get_number_of_bytes() + phase.get_number_of_bytes(),
+        [&]() { baseline_transform(x, phase, [](auto v) { return std::arg(v); }); },
+        [&]() { argument(x, phase); });
+}
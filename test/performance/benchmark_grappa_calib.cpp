@@ -0,0 +1,101 @@
+//
+// Compares GRAPPA calibration from the explicit calibration matrix with the blockwise accumulated normal equations.
+//
+#include "mri_core_grappa.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "log.h"
+
+#include <chrono>
+#include <complex>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#define ITERATIONS 3
+
+using namespace Gadgetron;
+
+namespace {
+
+    // Returns the time per call in milliseconds
+    double time_operation(const std::function<void()>& operation) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < ITERATIONS; i++)
+            operation();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / ITERATIONS;
+    }
+
+    hoNDArray<std::complex<float>> make_acs(const std::vector<size_t>& dims) {
+        hoNDArray<std::complex<float>> acs(dims);
+        std::mt19937 engine(42);
+        std::normal_distribution<float> noise(0, 1);
+        for (auto& value : acs)
+            value = std::complex<float>(noise(engine), noise(engine));
+        return acs;
+    }
+
+    double megabytes(size_t elements) {
+        return double(elements * sizeof(std::complex<float>)) / (1024 * 1024);
+    }
+
+    void report(const std::string& name, size_t rows, size_t colA, size_t colB, size_t block_size,
+        const std::function<void(size_t, hoNDArray<std::complex<float>>&)>& calibrate) {
+
+        hoNDArray<std::complex<float>> expected, result;
+        auto explicit_ms = time_operation([&]() { calibrate(0, expected); });
+        auto blockwise_ms = time_operation([&]() { calibrate(block_size, result); });
+
+        result -= expected;
+        auto error = nrm2(result) / nrm2(expected);
+
+        // Working set of the calibration equations, besides the kernel itself.
+        auto explicit_mb = megabytes(rows * (colA + colB) + colA * (colA + colB));
+        auto blockwise_mb = megabytes(block_size * (colA + colB) + colA * (colA + colB));
+
+        GINFO_STREAM(name << ": calibration points " << rows << ", unknowns " << colA << " x " << colB << std::endl);
+        GINFO_STREAM("    explicit matrix: " << explicit_ms << " ms, " << explicit_mb << " MB" << std::endl);
+        GINFO_STREAM("    blocks of " << block_size << ": " << blockwise_ms << " ms, " << blockwise_mb
+                                      << " MB, relative difference " << error << std::endl);
+    }
+
+    void benchmark_2d(size_t RO, size_t E1, size_t CHA, size_t accel, size_t block_size) {
+        const size_t kRO = 5, kNE1 = 4;
+        auto acs = make_acs({ RO, E1, CHA });
+
+        size_t rows = (RO - kRO + 1) * (E1 - (kNE1 - 1) * accel);
+        size_t colA = kRO * kNE1 * CHA;
+        size_t colB = CHA * (accel - 1);
+
+        report("2D " + std::to_string(RO) + "x" + std::to_string(E1) + ", " + std::to_string(CHA) + " coils, R" + std::to_string(accel),
+            rows, colA, colB, block_size, [&](size_t block, hoNDArray<std::complex<float>>& ker) {
+                grappa2d_calib_convolution_kernel(acs, acs, accel, 0.0005, kRO, kNE1, ker, block);
+            });
+    }
+
+    void benchmark_3d(size_t RO, size_t E1, size_t E2, size_t CHA, size_t accel, size_t block_size) {
+        const size_t kRO = 5, kNE1 = 4, kNE2 = 4;
+        const double over_determine_ratio = 45;
+        auto acs = make_acs({ RO, E1, E2, CHA });
+
+        size_t colA = kRO * kNE1 * kNE2 * CHA;
+        size_t colB = CHA * (accel - 1) * (accel - 1);
+        size_t lenE1 = E1 - (kNE1 - 1) * accel;
+        size_t lenE2 = E2 - (kNE2 - 1) * accel;
+        size_t lenRO = std::min(RO - kRO + 1, size_t(std::ceil(over_determine_ratio * colA)) / (lenE1 * lenE2));
+        size_t rows = lenRO * lenE1 * lenE2;
+
+        report("3D " + std::to_string(RO) + "x" + std::to_string(E1) + "x" + std::to_string(E2) + ", " + std::to_string(CHA) + " coils, R" + std::to_string(accel) + "x" + std::to_string(accel),
+            rows, colA, colB, block_size, [&](size_t block, hoNDArray<std::complex<float>>& ker) {
+                grappa3d_calib_convolution_kernel(acs, acs, accel, accel, 0.0005, over_determine_ratio, kRO, kNE1, kNE2, ker, block);
+            });
+    }
+}
+
+int main() {
+    benchmark_2d(192, 48, 32, 4, 4096);
+    benchmark_3d(128, 32, 32, 16, 2, 4096);
+    benchmark_3d(128, 32, 32, 32, 2, 4096);
+}
@@ -0,0 +1,89 @@
+//
+// Compares the gridding and the Toeplitz embedded NFFT normal operators on radial trajectories.
+//
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "hoNFFTToeplitzOperator.h"
+#include "log.h"
+
+#include <boost/make_shared.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define ITERATIONS 10
+
+using namespace Gadgetron;
+
+namespace {
+
+    // Returns the time per call in milliseconds
+    double time_operation(const std::function<void()>& operation, int iterations = ITERATIONS) {
+        operation();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+            operation();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    }
+
+    template <class OPERATOR>
+    void setup(OPERATOR& op, size_t n, std::vector<size_t> image_dims, std::vector<size_t> data_dims,
+        boost::shared_ptr<hoNDArray<float>> dcw, const hoNDArray<vector_td<float, 2>>& trajectory) {
+        op.setup(vector_td<size_t, 2>(n, n), vector_td<size_t, 2>(2 * n, 2 * n), 5.5f);
+        op.set_domain_dimensions(image_dims);
+        op.set_codomain_dimensions(data_dims);
+        op.set_dcw(dcw);
+        op.preprocess(trajectory);
+    }
+
+    void compare(size_t n, size_t spokes, size_t coils) {
+        typedef complext<float> T;
+        const size_t readout = 2 * n;
+
+        hoNDArray<vector_td<float, 2>> trajectory(readout * spokes);
+        auto dcw = boost::make_shared<hoNDArray<float>>(readout * spokes);
+        for (size_t s = 0; s < spokes; s++) {
+            float angle = float(M_PI) * s / spokes;
+            for (size_t r = 0; r < readout; r++) {
+                float k = (float(r) - readout / 2) / readout;
+                trajectory[s * readout + r] = vector_td<float, 2>(k * std::cos(angle), k * std::sin(angle));
+                (*dcw)[s * readout + r] = std::abs(k) + 0.5f / readout;
+            }
+        }
+
+        std::vector<size_t> image_dims = { n, n, 1, coils };
+        std::vector<size_t> data_dims  = { readout * spokes, 1, coils };
+
+        NFFTOperator<hoNDArray, float, 2> gridding;
+        hoNFFTToeplitzOperator<float, 2> toeplitz;
+        auto gridding_setup = time_operation([&]() { setup(gridding, n, image_dims, data_dims, dcw, trajectory); }, 1);
+        auto toeplitz_setup = time_operation([&]() { setup(toeplitz, n, image_dims, data_dims, dcw, trajectory); }, 1);
+
+        hoNDArray<T> image(image_dims);
+        for (size_t i = 0; i < image.get_number_of_elements(); i++)
+            image[i] = T(std::cos(0.05f * i), std::sin(0.07f * i));
+        hoNDArray<T> expected(image_dims);
+        hoNDArray<T> result(image_dims);
+
+        auto gridding_ms = time_operation([&]() { gridding.mult_MH_M(&image, &expected); });
+        auto toeplitz_ms = time_operation([&]() { toeplitz.mult_MH_M(&image, &result); });
+
+        result -= expected;
+        auto error = nrm2(&result) / nrm2(&expected);
+
+        GINFO_STREAM("matrix " << n << " spokes " << spokes << " coils " << coils << ": setup gridding "
+                               << gridding_setup << " ms, toeplitz " << toeplitz_setup << " ms; mult_MH_M gridding "
+                               << gridding_ms << " ms, toeplitz " << toeplitz_ms << " ms, speedup "
+                               << gridding_ms / toeplitz_ms << ", relative error " << error << std::endl);
+    }
+}
+
+int main() {
+    for (size_t n : { 128, 256 })
+        for (size_t coils : { 1, 8, 32 })
+            compare(n, n, coils);
+}
@@ -0,0 +1,98 @@
+//
+// Throughput against compression ratio of the codecs available for distributed worker traffic, on synthetic k-space.
+//
+#include "io/compressed_stream.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define ITERATIONS 3
+
+using namespace Gadgetron::Core::IO;
+
+namespace {
+
+    // 10 Gb/s Ethernet, in bytes per second.
+    constexpr double link_rate = 10e9 / 8;
+
+    // Coil k-space with most of its energy near the centre, as in a readout line. Scanner data comes from 16 bit ADC
+    // samples; quantized data is scaled from integers, as that data is, and keeps fewer significant bits.
+    std::vector<std::complex<float>> make_kspace(size_t readout, size_t lines, size_t coils, bool quantized) {
+        std::mt19937 engine(42);
+        std::normal_distribution<float> noise(0, 1);
+
+        std::vector<std::complex<float>> kspace(readout * lines * coils);
+        for (size_t coil = 0; coil < coils; coil++) {
+            for (size_t line = 0; line < lines; line++) {
+                for (size_t sample = 0; sample < readout; sample++) {
+                    auto kx = (double(sample) - readout / 2.0) / readout;
+                    auto ky = (double(line) - lines / 2.0) / lines;
+                    auto signal = float(2000.0 * std::exp(-(kx * kx + ky * ky) * 200.0) + 20.0);
+
+                    std::complex<float> value(signal * noise(engine), signal * noise(engine));
+                    if (quantized) value = std::complex<float>(std::round(value.real()), std::round(value.imag())) * 0.25f;
+                    kspace[(coil * lines + line) * readout + sample] = value;
+                }
+            }
+        }
+        return kspace;
+    }
+
+    void report(const std::string &name, const std::vector<std::complex<float>> &kspace) {
+        GINFO_STREAM(name << ": " << kspace.size() * sizeof(std::complex<float>) / (1024 * 1024) << " MiB" << std::endl);
+        GINFO_STREAM("    uncompressed: " << link_rate / (1024 * 1024) << " MiB/s on a 10 Gb/s link" << std::endl);
+
+        for (auto &codec : supported_codecs()) {
+            for (auto level : {-5, -1, 1, 3}) {
+                CompressionStatistics sent{}, received{};
+
+                for (int i = 0; i < ITERATIONS; i++) {
+                    std::stringstream wire;
+                    {
+                        CompressibleStream stream(wire);
+                        stream.buffer().compress_output(codec, level);
+                        stream.write(reinterpret_cast<const char *>(kspace.data()), kspace.size() * sizeof(kspace[0]));
+                        stream.flush();
+                        sent = stream.buffer().statistics();
+                    }
+
+                    std::vector<std::complex<float>> result(kspace.size());
+                    CompressibleStream stream(wire);
+                    stream.buffer().decompress_input(codec);
+                    stream.read(reinterpret_cast<char *>(result.data()), result.size() * sizeof(result[0]));
+                    received = stream.buffer().statistics();
+
+                    if (result != kspace) GERROR_STREAM("Data did not survive compression with " << codec << std::endl);
+                }
+
+                // Compression, transfer and decompression overlap, so the slowest of them sets the pace. Blocks that
+                // did not compress are sent as they are, and take no time to decompress.
+                auto pace = [](double rate) { return rate > 0 ? rate : std::numeric_limits<double>::infinity(); };
+                auto effective = std::min({pace(sent.compression_rate()), link_rate * sent.compression_ratio(),
+                                           pace(received.decompression_rate())});
+
+                GINFO_STREAM("    " << codec << " level " << level << ": ratio " << sent.compression_ratio()
+                                    << ", compress " << sent.compression_rate() / (1024 * 1024)
+                                    << " MiB/s, decompress " << received.decompression_rate() / (1024 * 1024)
+                                    << " MiB/s, effective " << effective / (1024 * 1024) << " MiB/s" << std::endl);
+            }
+        }
+    }
+}
+
+int main() {
+    if (supported_codecs().empty()) {
+        GERROR_STREAM("No compression codecs available in this build." << std::endl);
+        return 1;
+    }
+
+    report("Gaussian k-space, 256 x 192, 32 coils", make_kspace(256, 192, 32, false));
+    report("Quantized k-space, 256 x 192, 32 coils", make_kspace(256, 192, 32, true));
+}
@@ -5,6 +5,10 @@
 #include <gtest/gtest.h>
 #include "ThreadPool.h"
 
+#include <array>
+#include <atomic>
+#include <numeric>
+
 using namespace Gadgetron::Core;
 TEST(ThreadPoolTest,VoidTest){
     ThreadPool pool{4};
@@ -24,3 +28,61 @@ TEST(ThreadPoolTest,moveTest){
     pool.join();
 
 }
+
+TEST(ThreadPoolTest,exceptionTest){
+    ThreadPool pool{2};
+    auto return_value = pool.async([](){ throw std::runtime_error("Oh no"); });
+    EXPECT_THROW(return_value.get(),std::runtime_error);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,largeTaskTest){
+    ThreadPool pool{2};
+    std::array<double,64> values{};
+    values[63] = 2.0;
+    auto return_value = pool.async([values](){ return values[63]; });
+    EXPECT_EQ(return_value.get(),2.0);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,parallelForTest){
+    ThreadPool pool{4};
+    std::vector<int> values(10000,0);
+    pool.parallel_for(0,values.size(),[&](size_t i){ values[i] = int(i); });
+    for (size_t i = 0; i < values.size(); i++) EXPECT_EQ(values[i],int(i));
+    pool.join();
+}
+
+TEST(ThreadPoolTest,nestedParallelForTest){
+    ThreadPool pool{2};
+    std::atomic<int> count{0};
+    pool.parallel_for(0,8,[&](size_t){
+        pool.parallel_for(0,100,[&](size_t){ count++; });
+    },1);
+    EXPECT_EQ(count.load(),800);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,parallelForExceptionTest){
+    ThreadPool pool{4};
+    EXPECT_THROW(pool.parallel_for(0,1000,[](size_t i){ if (i == 500) throw std::runtime_error("Oh no"); }),std::runtime_error);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,asyncRangeTest){
+    ThreadPool pool{4};
+    auto values = std::make_shared<std::vector<int>>(1000,0);
+    auto done = pool.async_range(0,values->size(),[values](size_t i){ (*values)[i] = 1; });
+    done.get();
+    EXPECT_EQ(std::accumulate(values->begin(),values->end(),0),1000);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,joinFinishesPendingTasks){
+    ThreadPool pool{1};
+    std::atomic<int> count{0};
+    for (int i = 0; i < 100; i++) pool.post([&](){ count++; });
+    pool.join();
+    EXPECT_EQ(count.load(),100);
+    EXPECT_THROW(pool.post([](){}),ChannelClosed);
+}
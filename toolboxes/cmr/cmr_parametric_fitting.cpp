@@ -0,0 +1,100 @@
+/** \file   cmr_parametric_fitting.cpp
+    \brief  Batched pixel-wise fitting of the exponential signal models used for T1/T2 mapping
+*/
+
+#define GADGETRON_PARAMETRIC_FITTING_ISA scalar
+#include "cmr_parametric_fitting_kernels.hxx"
+
+#include "hoNDArray_elemwise_kernels.h"
+#include "log.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GADGETRON_PARAMETRIC_FITTING_X86
+#endif
+
+namespace Gadgetron {
+    namespace parametric_fitting {
+
+#ifdef GADGETRON_PARAMETRIC_FITTING_X86
+        // Defined in cmr_parametric_fitting_avx2.cpp and cmr_parametric_fitting_avx512.cpp
+        namespace avx2 {
+            void fit_batch(Model, size_t, const float*, const float*, size_t, float*, size_t, float*, size_t, float);
+        }
+        namespace avx512 {
+            void fit_batch(Model, size_t, const float*, const float*, size_t, float*, size_t, float*, size_t, float);
+        }
+#endif
+
+        size_t get_num_of_paras(Model model)
+        {
+            switch (model)
+            {
+            case Model::two_para_exp_decay:
+            case Model::two_para_exp_recovery:
+                return 2;
+            case Model::three_para_exp_recovery:
+                return 3;
+            }
+            GADGET_THROW("Unknown model in parametric_fitting::get_num_of_paras(...) ... ");
+        }
+
+        void fit(Model model, const std::vector<float>& x, size_t num_pixels, const float* y, float* b, float* cost,
+            size_t max_iter, float thres_fun)
+        {
+            const size_t num_x = x.size();
+            const size_t num_paras = get_num_of_paras(model);
+            const long long num_batches = num_pixels / batch_size;
+
+            auto level = elemwise::simd_level();
+
+            auto fit_batch = [&](const float* yb, size_t stride, float* bb, size_t b_stride, float* cb) {
+#ifdef GADGETRON_PARAMETRIC_FITTING_X86
+                switch (level)
+                {
+                case elemwise::SimdLevel::avx512:
+                    avx512::fit_batch(model, num_x, x.data(), yb, stride, bb, b_stride, cb, max_iter, thres_fun);
+                    break;
+                case elemwise::SimdLevel::avx2:
+                    avx2::fit_batch(model, num_x, x.data(), yb, stride, bb, b_stride, cb, max_iter, thres_fun);
+                    break;
+                default:
+                    scalar::fit_batch(model, num_x, x.data(), yb, stride, bb, b_stride, cb, max_iter, thres_fun);
+                    break;
+                }
+#else
+                scalar::fit_batch(model, num_x, x.data(), yb, stride, bb, b_stride, cb, max_iter, thres_fun);
+#endif
+            };
+
+            // full batches are fitted where they are
+#pragma omp parallel for schedule(dynamic) if (num_batches > 1)
+            for (long long batch = 0; batch < num_batches; batch++)
+            {
+                size_t offset = batch * batch_size;
+                fit_batch(y + offset, num_pixels, b + offset, num_pixels, cost ? cost + offset : NULL);
+            }
+
+            // the pixels left over are copied into a full batch, padded by repeating the last pixel
+            size_t remaining = num_pixels - num_batches * batch_size;
+            if (remaining == 0) return;
+
+            size_t offset = num_batches * batch_size;
+            std::vector<float> yb(num_x * batch_size), bb(num_paras * batch_size), cb(batch_size);
+
+            for (size_t l = 0; l < batch_size; l++)
+            {
+                size_t p = offset + std::min(l, remaining - 1);
+                for (size_t n = 0; n < num_x; n++) yb[n * batch_size + l] = y[n * num_pixels + p];
+                for (size_t i = 0; i < num_paras; i++) bb[i * batch_size + l] = b[i * num_pixels + p];
+            }
+
+            fit_batch(yb.data(), batch_size, bb.data(), batch_size, cb.data());
+
+            for (size_t l = 0; l < remaining; l++)
+            {
+                for (size_t i = 0; i < num_paras; i++) b[i * num_pixels + offset + l] = bb[i * batch_size + l];
+                if (cost) cost[offset + l] = cb[l];
+            }
+        }
+    }
+}
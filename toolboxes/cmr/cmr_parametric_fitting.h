@@ -0,0 +1,44 @@
+/** \file   cmr_parametric_fitting.h
+    \brief  Batched pixel-wise fitting of the exponential signal models used for T1/T2 mapping
+
+            Many pixels are fitted together with Levenberg-Marquardt, in structure-of-arrays layout: every array has
+            the pixel index running fastest, so the signal model, its residual and its Jacobian are evaluated for
+            batch_size pixels at once with SIMD instructions. The kernels are compiled once per instruction set, and
+            the one matching Gadgetron::elemwise::simd_level() is used. No memory is allocated per pixel.
+*/
+
+#pragma once
+
+#include "cmr_export.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Gadgetron {
+    namespace parametric_fitting {
+
+        /// Signal models, matching the curve fitting operators of the same name
+        enum class Model
+        {
+            two_para_exp_decay,         ///< y = b[0] * exp(-x/b[1]), see twoParaExpDecayOperator
+            two_para_exp_recovery,      ///< y = b[0] - b[0] * exp(-x/b[1]), see twoParaExpRecoveryOperator
+            three_para_exp_recovery     ///< y = b[0] - b[1] * exp(-x/b[2]), see threeParaExpRecoveryOperator
+        };
+
+        /// number of parameters of the model
+        EXPORTCMR size_t get_num_of_paras(Model model);
+
+        /// number of pixels fitted together by one call of the kernels
+        constexpr size_t batch_size = 16;
+
+        /// Fits the model to num_pixels pixels, in parallel over batches of pixels.
+        /// x: the parametric times (inversion/saturation/echo times), shared by all pixels
+        /// y: [num_pixels x.size()], measured signal
+        /// b: [num_pixels num_paras], initial guess on input, fitted parameters on output
+        /// cost: [num_pixels], mean square error of the fit; may be NULL
+        /// max_iter: maximal number of iterations
+        /// thres_fun: a pixel has converged once an iteration lowers its mean square error by less than this fraction
+        EXPORTCMR void fit(Model model, const std::vector<float>& x, size_t num_pixels, const float* y, float* b, float* cost,
+            size_t max_iter, float thres_fun);
+    }
+}
@@ -0,0 +1,3 @@
+// Compiled with AVX2 and FMA enabled, see CMakeLists.txt
+#define GADGETRON_PARAMETRIC_FITTING_ISA avx2
+#include "cmr_parametric_fitting_kernels.hxx"
@@ -0,0 +1,3 @@
+// Compiled with AVX-512 enabled, see CMakeLists.txt
+#define GADGETRON_PARAMETRIC_FITTING_ISA avx512
+#include "cmr_parametric_fitting_kernels.hxx"
@@ -0,0 +1,295 @@
+//
+// Levenberg-Marquardt kernel of the batched parametric fitting. This file is compiled once per instruction set, by
+// translation units defining GADGETRON_PARAMETRIC_FITTING_ISA (the namespace holding that instruction set's kernel)
+// and setting matching compiler flags.
+//
+// A batch of batch_size pixels is fitted in lock step. Every loop over the pixels of the batch is written so the
+// compiler can vectorize it: pixels take and reject steps independently, through selects rather than branches, and
+// pixels that have converged keep their parameters while the others carry on. The normal equations have at most
+// three unknowns, so they are accumulated while the residuals are computed and solved in closed form.
+//
+
+#include "cmr_parametric_fitting.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Gadgetron {
+    namespace parametric_fitting {
+        namespace GADGETRON_PARAMETRIC_FITTING_ISA {
+
+            namespace {
+
+                constexpr size_t W = batch_size;
+
+                // exp(v) to within a few ulp, for v in the range of float exp. Unlike std::exp, it vectorizes.
+                // n = round(v/ln2) is found by adding 1.5*2^23, which leaves n in the low bits of the sum; a float to
+                // integer conversion would keep the clamped loop from being vectorized with trapping math.
+                inline float exp_approx(float v) {
+                    constexpr float shifter = 12582912.0f;
+
+                    v = std::min(std::max(v, -87.0f), 88.0f);
+
+                    float shifted = v * 1.44269504088896341f + shifter;
+                    float n       = shifted - shifter;
+                    float r       = v - n * 0.693359375f;
+                    r             = r + n * 2.12194440e-4f;
+
+                    float p = 1.9875691500e-4f;
+                    p = p * r + 1.3981999507e-3f;
+                    p = p * r + 8.3334519073e-3f;
+                    p = p * r + 4.1665795894e-2f;
+                    p = p * r + 1.6666665459e-1f;
+                    p = p * r + 5.0000001201e-1f;
+                    p = p * r * r + r + 1.0f;
+
+                    int32_t bits, shifter_bits;
+                    std::memcpy(&bits, &shifted, sizeof(bits));
+                    std::memcpy(&shifter_bits, &shifter, sizeof(shifter_bits));
+                    bits = (bits - shifter_bits + 127) << 23;
+
+                    float scale;
+                    std::memcpy(&scale, &bits, sizeof(scale));
+                    return p * scale;
+                }
+
+                // 1/b, with b kept away from zero as the curve fitting operators do
+                inline float safe_reciprocal(float b) {
+                    return 1.0f / std::copysign(std::max(std::abs(b), FLT_EPSILON), b);
+                }
+
+                template <Model M> struct Paras;
+                template <> struct Paras<Model::two_para_exp_decay> { static constexpr size_t N = 2; };
+                template <> struct Paras<Model::two_para_exp_recovery> { static constexpr size_t N = 2; };
+                template <> struct Paras<Model::three_para_exp_recovery> { static constexpr size_t N = 3; };
+
+                // Per pixel sums over the time points: the square error, J'r and the upper triangle of J'J
+                template <size_t N> struct Normal
+                {
+                    static constexpr size_t H = N * (N + 1) / 2;
+
+                    alignas(64) float cost[W];
+                    alignas(64) float g[N][W];
+                    alignas(64) float h[H][W];
+                };
+
+                /// Evaluates the model for parameters b, and accumulates the normal equations over the time points.
+                template <Model M>
+                void evaluate(size_t num_x, const float* x, const float* y, size_t stride,
+                    const float (&b)[Paras<M>::N][W], Normal<Paras<M>::N>& normal) {
+
+                    constexpr size_t N = Paras<M>::N;
+
+                    std::fill(&normal.cost[0], &normal.cost[0] + W, 0.0f);
+                    std::fill(&normal.g[0][0], &normal.g[0][0] + N * W, 0.0f);
+                    std::fill(&normal.h[0][0], &normal.h[0][0] + Normal<N>::H * W, 0.0f);
+
+                    for (size_t n = 0; n < num_x; n++) {
+                        const float xn = x[n];
+                        const float* yn = y + n * stride;
+
+#pragma omp simd
+                        for (size_t l = 0; l < W; l++) {
+                            float f, d0, d1, d2 = 0.0f;
+
+                            if constexpr (M == Model::two_para_exp_decay) {
+                                // y = b[0] * exp(-x/b[1])
+                                float rb = safe_reciprocal(b[1][l]);
+                                float e  = exp_approx(-xn * rb);
+                                f  = b[0][l] * e;
+                                d0 = e;
+                                d1 = f * xn * rb * rb;
+                            } else if constexpr (M == Model::two_para_exp_recovery) {
+                                // y = b[0] - b[0] * exp(-x/b[1])
+                                float rb = safe_reciprocal(b[1][l]);
+                                float e  = exp_approx(-xn * rb);
+                                f  = b[0][l] - b[0][l] * e;
+                                d0 = 1.0f - e;
+                                d1 = -b[0][l] * e * xn * rb * rb;
+                            } else {
+                                // y = b[0] - b[1] * exp(-x/b[2])
+                                float rb = safe_reciprocal(b[2][l]);
+                                float e  = exp_approx(-xn * rb);
+                                f  = b[0][l] - b[1][l] * e;
+                                d0 = 1.0f;
+                                d1 = -e;
+                                d2 = -b[1][l] * e * xn * rb * rb;
+                            }
+
+                            float r = f - yn[l];
+                            normal.cost[l] += r * r;
+
+                            normal.g[0][l] += d0 * r;
+                            normal.g[1][l] += d1 * r;
+                            normal.h[0][l] += d0 * d0;
+                            normal.h[1][l] += d0 * d1;
+
+                            if constexpr (N == 2) {
+                                normal.h[2][l] += d1 * d1;
+                            } else {
+                                normal.g[2][l] += d2 * r;
+                                normal.h[2][l] += d0 * d2;
+                                normal.h[3][l] += d1 * d1;
+                                normal.h[4][l] += d1 * d2;
+                                normal.h[5][l] += d2 * d2;
+                            }
+                        }
+                    }
+
+                    const float scale = num_x > 1 ? 1.0f / num_x : 1.0f;
+#pragma omp simd
+                    for (size_t l = 0; l < W; l++)
+                        normal.cost[l] *= scale;
+                }
+
+                /// Solves (J'J + mu*diag(J'J)) step = -J'r for pixel l. The step is zero if the system is singular.
+                inline void solve(const Normal<2>& normal, size_t l, float mu, float (&step)[2][W]) {
+                    float a00 = normal.h[0][l] * (1.0f + mu);
+                    float a01 = normal.h[1][l];
+                    float a11 = normal.h[2][l] * (1.0f + mu);
+                    float g0  = normal.g[0][l];
+                    float g1  = normal.g[1][l];
+
+                    float det = a00 * a11 - a01 * a01;
+                    bool valid = det > 0.0f;
+                    float rdet = valid ? 1.0f / det : 0.0f;
+
+                    step[0][l] = -(a11 * g0 - a01 * g1) * rdet;
+                    step[1][l] = -(a00 * g1 - a01 * g0) * rdet;
+                }
+
+                inline void solve(const Normal<3>& normal, size_t l, float mu, float (&step)[3][W]) {
+                    float a00 = normal.h[0][l] * (1.0f + mu);
+                    float a01 = normal.h[1][l];
+                    float a02 = normal.h[2][l];
+                    float a11 = normal.h[3][l] * (1.0f + mu);
+                    float a12 = normal.h[4][l];
+                    float a22 = normal.h[5][l] * (1.0f + mu);
+                    float g0  = normal.g[0][l];
+                    float g1  = normal.g[1][l];
+                    float g2  = normal.g[2][l];
+
+                    // the matrix is symmetric, so its inverse is the transposed cofactor matrix over the determinant
+                    float c00 = a11 * a22 - a12 * a12;
+                    float c01 = a02 * a12 - a01 * a22;
+                    float c02 = a01 * a12 - a02 * a11;
+                    float c11 = a00 * a22 - a02 * a02;
+                    float c12 = a01 * a02 - a00 * a12;
+                    float c22 = a00 * a11 - a01 * a01;
+
+                    float det = a00 * c00 + a01 * c01 + a02 * c02;
+                    bool valid = det > 0.0f;
+                    float rdet = valid ? 1.0f / det : 0.0f;
+
+                    step[0][l] = -(c00 * g0 + c01 * g1 + c02 * g2) * rdet;
+                    step[1][l] = -(c01 * g0 + c11 * g1 + c12 * g2) * rdet;
+                    step[2][l] = -(c02 * g0 + c12 * g1 + c22 * g2) * rdet;
+                }
+
+                template <Model M>
+                void fit_batch(size_t num_x, const float* x, const float* y, size_t stride, float* b, size_t b_stride,
+                    float* cost, size_t max_iter, float thres_fun) {
+
+                    constexpr size_t N = Paras<M>::N;
+
+                    // damping is raised on every rejected step; a pixel that cannot improve even with this much has converged
+                    constexpr float initial_mu = 1e-3f;
+                    constexpr float max_mu = 1e8f;
+
+                    alignas(64) float paras[N][W];
+                    alignas(64) float trial[N][W];
+                    alignas(64) float step[N][W];
+                    alignas(64) float mu[W];
+                    alignas(64) float active[W];
+                    alignas(64) float better[W];
+
+                    Normal<N> current, candidate;
+
+                    for (size_t i = 0; i < N; i++)
+                        std::copy(b + i * b_stride, b + i * b_stride + W, &paras[i][0]);
+
+                    std::fill(&mu[0], &mu[0] + W, initial_mu);
+                    std::fill(&active[0], &active[0] + W, 1.0f);
+
+                    evaluate<M>(num_x, x, y, stride, paras, current);
+
+                    for (size_t iter = 0; iter < max_iter; iter++) {
+
+#pragma omp simd
+                        for (size_t l = 0; l < W; l++)
+                            solve(current, l, mu[l], step);
+
+                        // pixels that have converged stay where they are
+                        for (size_t i = 0; i < N; i++) {
+#pragma omp simd
+                            for (size_t l = 0; l < W; l++)
+                                trial[i][l] = paras[i][l] + active[l] * step[i][l];
+                        }
+
+                        evaluate<M>(num_x, x, y, stride, trial, candidate);
+
+                        float num_active = 0;
+#pragma omp simd reduction(+:num_active)
+                        for (size_t l = 0; l < W; l++) {
+                            float old_cost = current.cost[l];
+                            float new_cost = candidate.cost[l];
+                            bool improved  = active[l] > 0.0f && new_cost < old_cost;
+
+                            float m = improved ? std::max(mu[l] * (1.0f / 3.0f), 1e-7f) : mu[l] * 4.0f;
+                            mu[l] = m;
+
+                            bool converged = (improved && (old_cost - new_cost) <= thres_fun * old_cost)
+                                || (!improved && m > max_mu)
+                                || !(old_cost == old_cost);
+
+                            better[l] = improved ? 1.0f : 0.0f;
+                            current.cost[l] = improved ? new_cost : old_cost;
+                            active[l] = converged ? 0.0f : active[l];
+                            num_active += active[l];
+                        }
+
+                        for (size_t i = 0; i < N; i++) {
+#pragma omp simd
+                            for (size_t l = 0; l < W; l++) {
+                                paras[i][l] = better[l] > 0.0f ? trial[i][l] : paras[i][l];
+                                current.g[i][l] = better[l] > 0.0f ? candidate.g[i][l] : current.g[i][l];
+                            }
+                        }
+                        for (size_t k = 0; k < Normal<N>::H; k++) {
+#pragma omp simd
+                            for (size_t l = 0; l < W; l++)
+                                current.h[k][l] = better[l] > 0.0f ? candidate.h[k][l] : current.h[k][l];
+                        }
+
+                        if (num_active == 0) break;
+                    }
+
+                    for (size_t i = 0; i < N; i++)
+                        std::copy(&paras[i][0], &paras[i][0] + W, b + i * b_stride);
+
+                    if (cost)
+                        std::copy(&current.cost[0], &current.cost[0] + W, cost);
+                }
+            }
+
+            /// Fits batch_size pixels: y has its time points stride floats apart, b its parameters b_stride floats apart
+            void fit_batch(Model model, size_t num_x, const float* x, const float* y, size_t stride, float* b,
+                size_t b_stride, float* cost, size_t max_iter, float thres_fun) {
+                switch (model) {
+                case Model::two_para_exp_decay:
+                    fit_batch<Model::two_para_exp_decay>(num_x, x, y, stride, b, b_stride, cost, max_iter, thres_fun);
+                    break;
+                case Model::two_para_exp_recovery:
+                    fit_batch<Model::two_para_exp_recovery>(num_x, x, y, stride, b, b_stride, cost, max_iter, thres_fun);
+                    break;
+                case Model::three_para_exp_recovery:
+                    fit_batch<Model::three_para_exp_recovery>(num_x, x, y, stride, b, b_stride, cost, max_iter, thres_fun);
+                    break;
+                }
+            }
+        }
+    }
+}
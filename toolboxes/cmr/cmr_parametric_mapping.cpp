@@ -192,6 +192,8 @@ CmrParametricMapping<T>::CmrParametricMapping()
     max_map_value_ = -1;
     min_map_value_ = 0;
 
+    use_batched_fitting_ = false;
+
     verbose_ = false;
     perform_timing_ = false;
 
@@ -260,7 +262,10 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
             if (!debug_folder_.empty()) gt_exporter_.export_array(this->mask_for_mapping_, debug_folder_ + "CmrParametricMapping_mask_for_mapping");
         }
 
-        if (this->perform_timing_) { gt_timer_.start("perform pixel-wise mapping ... "); }
+        parametric_fitting::Model batched_model;
+        bool batched = this->use_batched_fitting_ && this->get_batched_model(batched_model);
+
+        if (this->perform_timing_) { gt_timer_.start(batched ? "perform batched pixel-wise mapping ... " : "perform pixel-wise mapping ... "); }
 
         long long ro, e1;
 
@@ -287,6 +292,12 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
                     pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
                 }
 
+                if (batched)
+                {
+                    this->perform_batched_fitting(batched_model, pData, pMaskCurr, RO*E1, pMap, pPara, pMapSD, pParaSD);
+                    continue;
+                }
+
 #pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
                 {
                     std::vector<T> yi(num_ti, 0);
@@ -437,6 +448,131 @@ void CmrParametricMapping<T>::compute_map(const std::vector<T>& ti, const std::v
     map_v = 0;
 }
 
+template <typename T>
+bool CmrParametricMapping<T>::get_batched_model(parametric_fitting::Model& model) const
+{
+    return false;
+}
+
+template <typename T>
+void CmrParametricMapping<T>::compute_map_value(const VectorType& bi, T& map_v)
+{
+    map_v = 0;
+}
+
+template <typename T>
+void CmrParametricMapping<T>::perform_batched_fitting(parametric_fitting::Model model, const T* pData, const T* pMask, size_t num_pixels,
+    T* pMap, T* pPara, T* pMapSD, T* pParaSD)
+{
+    try
+    {
+        size_t num_ti = ti_.size();
+        size_t NUM = this->get_num_of_paras();
+
+        GADGET_CHECK_THROW(NUM == parametric_fitting::get_num_of_paras(model));
+
+        // pixels to fit, packed so the solver sees them in consecutive lanes
+        std::vector<size_t> pixels;
+        pixels.reserve(num_pixels);
+
+        size_t p;
+        for (p = 0; p < num_pixels; p++)
+        {
+            if (pMask == NULL || pMask[p] > 0) pixels.push_back(p);
+        }
+
+        long long num = (long long)pixels.size();
+        if (num == 0) return;
+
+        std::vector<T> y(num*num_ti), b(num*NUM);
+
+        long long i;
+        size_t n;
+
+#pragma omp parallel private(i, n) shared(num, num_ti, NUM, pixels, pData, num_pixels, y, b)
+        {
+            std::vector<T> yi(num_ti, 0);
+            std::vector<T> guess(NUM + 1, 0);
+
+#pragma omp for
+            for (i = 0; i < num; i++)
+            {
+                for (n = 0; n < num_ti; n++)
+                {
+                    yi[n] = pData[pixels[i] + n*num_pixels];
+                    y[i + n*num] = yi[n];
+                }
+
+                this->get_initial_guess(ti_, yi, guess);
+
+                for (n = 0; n < NUM; n++)
+                {
+                    b[i + n*num] = guess[n];
+                }
+            }
+        }
+
+        parametric_fitting::fit(model, ti_, num, y.data(), b.data(), NULL, max_iter_, thres_fun_);
+
+#pragma omp parallel private(i, n) shared(num, num_ti, NUM, pixels, num_pixels, y, b, pMap, pPara, pMapSD, pParaSD)
+        {
+            std::vector<T> yi(num_ti, 0);
+            std::vector<T> bi(NUM, 0);
+            std::vector<T> sd(NUM + 1, 0);
+
+            T map_v(0), map_sd(0);
+
+#pragma omp for
+            for (i = 0; i < num; i++)
+            {
+                size_t offset = pixels[i];
+
+                for (n = 0; n < NUM; n++)
+                {
+                    bi[n] = b[i + n*num];
+                    pPara[offset + n*num_pixels] = bi[n];
+                }
+
+                this->compute_map_value(bi, map_v);
+                pMap[offset] = map_v;
+
+                // compute SD if needed
+                if (this->compute_SD_maps_)
+                {
+                    for (n = 0; n < num_ti; n++)
+                    {
+                        yi[n] = y[i + n*num];
+                    }
+
+                    try
+                    {
+                        this->compute_sd(ti_, yi, bi, sd, map_sd);
+                    }
+                    catch(...)
+                    {
+                        for (n = 0; n < NUM; n++)
+                        {
+                            sd[n] = 0;
+                        }
+
+                        map_sd = 0;
+                    }
+
+                    pMapSD[offset] = map_sd;
+                    for (n = 0; n < NUM; n++)
+                    {
+                        pParaSD[offset + n*num_pixels] = sd[n];
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Error happened in CmrParametricMapping<T>::perform_batched_fitting ... ");
+    }
+}
+
 template <typename T>
 void CmrParametricMapping<T>::compute_sd(const std::vector<T>& ti, const std::vector<T>& yi, const std::vector<T>& bi, std::vector<T>& sd, T& map_sd)
 {
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "cmr_export.h"
+#include "cmr_parametric_fitting.h"
 
 #include "GadgetronTimer.h"
 
@@ -106,6 +107,11 @@ namespace Gadgetron {
         T max_map_value_;
         T min_map_value_;
 
+        /// whether to fit pixels in batches with the vectorized Levenberg-Marquardt solver, if the mapping has a batched model
+        /// if false (default), every pixel is fitted by compute_map; the batched fit reaches the least square minimum,
+        /// so its map values differ slightly from the simplex ones
+        bool use_batched_fitting_;
+
         // ======================================================================================
         /// parameter for debugging
         // ======================================================================================
@@ -134,6 +140,18 @@ namespace Gadgetron {
         /// compute map values for every parameters in bi
         virtual void compute_map(const VectorType& ti, const VectorType& yi, const VectorType& guess, VectorType& bi, T& map_v);
 
+        /// signal model fitted to all pixels at once when use_batched_fitting_ is true
+        /// return false if the mapping has no batched model, and every pixel is fitted by compute_map
+        virtual bool get_batched_model(parametric_fitting::Model& model) const;
+
+        /// compute map value from the fitted parameters bi
+        virtual void compute_map_value(const VectorType& bi, T& map_v);
+
+        /// fit all pixels in the mask of one [RO E1 N] data block in batches
+        /// pixel offsets are in [RO E1], parameters and sd are stored num_pixels apart
+        virtual void perform_batched_fitting(parametric_fitting::Model model, const T* pData, const T* pMask, size_t num_pixels,
+            T* pMap, T* pPara, T* pMapSD, T* pParaSD);
+
         /// compute SD values for every parameters in bi
         virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
@@ -84,12 +84,7 @@ void CmrT1SRMapping<T>::compute_map(const VectorType& ti, const VectorType& yi,
 
         solver.solve(bi, guess);
 
-        if (bi[0] > 0 && bi[1] > 0)
-        {
-            map_v = bi[1];
-            if (map_v >= max_map_value_) map_v = hole_marking_value_;
-            if (map_v <= min_map_value_) map_v = hole_marking_value_;
-        }
+        this->compute_map_value(bi, map_v);
     }
     catch (...)
     {
@@ -97,6 +92,26 @@ void CmrT1SRMapping<T>::compute_map(const VectorType& ti, const VectorType& yi,
     }
 }
 
+template <typename T>
+bool CmrT1SRMapping<T>::get_batched_model(parametric_fitting::Model& model) const
+{
+    model = parametric_fitting::Model::two_para_exp_recovery;
+    return true;
+}
+
+template <typename T>
+void CmrT1SRMapping<T>::compute_map_value(const VectorType& bi, T& map_v)
+{
+    map_v = 0;
+
+    if (bi[0] > 0 && bi[1] > 0)
+    {
+        map_v = bi[1];
+        if (map_v >= max_map_value_) map_v = hole_marking_value_;
+        if (map_v <= min_map_value_) map_v = hole_marking_value_;
+    }
+}
+
 template <typename T>
 void CmrT1SRMapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd)
 {
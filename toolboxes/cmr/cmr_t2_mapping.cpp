@@ -121,12 +121,7 @@ void CmrT2Mapping<T>::compute_map(const VectorType& ti, const VectorType& yi, co
 
         solver.solve(bi, guess);
 
-        if (bi[0] > 0 && bi[1] > 0)
-        {
-            map_v = bi[1];
-            if (map_v >= max_map_value_) map_v = hole_marking_value_;
-            if (map_v <= min_map_value_) map_v = hole_marking_value_;
-        }
+        this->compute_map_value(bi, map_v);
     }
     catch (...)
     {
@@ -134,6 +129,26 @@ void CmrT2Mapping<T>::compute_map(const VectorType& ti, const VectorType& yi, co
     }
 }
 
+template <typename T>
+bool CmrT2Mapping<T>::get_batched_model(parametric_fitting::Model& model) const
+{
+    model = parametric_fitting::Model::two_para_exp_decay;
+    return true;
+}
+
+template <typename T>
+void CmrT2Mapping<T>::compute_map_value(const VectorType& bi, T& map_v)
+{
+    map_v = 0;
+
+    if (bi[0] > 0 && bi[1] > 0)
+    {
+        map_v = bi[1];
+        if (map_v >= max_map_value_) map_v = hole_marking_value_;
+        if (map_v <= min_map_value_) map_v = hole_marking_value_;
+    }
+}
+
 template <typename T>
 void CmrT2Mapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd)
 {
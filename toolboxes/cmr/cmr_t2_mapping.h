@@ -46,6 +46,12 @@ public:
     /// compute map values for every parameters in bi
     virtual void compute_map(const VectorType& ti, const VectorType& yi, const VectorType& guess, VectorType& bi, T& map_v);
 
+    /// fitted in batches with the same signal model as compute_map
+    virtual bool get_batched_model(parametric_fitting::Model& model) const;
+
+    /// compute map value from the fitted parameters bi
+    virtual void compute_map_value(const VectorType& bi, T& map_v);
+
     /// compute SD values for every parameters in bi
     virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
@@ -72,6 +78,7 @@ public:
     using BaseClass::thres_fun_;
     using BaseClass::max_map_value_;
     using BaseClass::min_map_value_;
+    using BaseClass::use_batched_fitting_;
 
     using BaseClass::verbose_;
     using BaseClass::debug_folder_;
@@ -5,12 +5,20 @@
 #include <intrin.h>
 #define cpuid(info, level) __cpuid(info, level)
 #define cpuidex(info, leaf, subleaf) __cpuidex(info, leaf, subleaf)
+#define xgetbv(index) _xgetbv(index)
 #else
 // SIMD intrinsics for GCC
 #include <x86intrin.h>
 #include <cpuid.h>
 #define cpuid(info, level) __cpuid(level, info[0], info[1], info[2], info[3]);
 #define cpuidex(info, leaf, subleaf) __cpuid_count(leaf, subleaf, info[0], info[1], info[2], info[3]);
+// _xgetbv needs -mxsave, which would allow the compiler to use XSAVE everywhere in this file.
+static inline unsigned long long xgetbv(unsigned int index)
+{
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+	return ((unsigned long long)edx << 32) | eax;
+}
 #endif
 
 #include "cpuisa.h"
@@ -71,6 +79,7 @@ namespace {
 		BitSet f_7_ECX_;
 		BitSet f_81_ECX_;
 		BitSet f_81_EDX_;
+		unsigned long long xcr0_;
 	};
 
 	InstructionSet::InstructionSet()
@@ -81,7 +90,8 @@ namespace {
 		f_7_EBX_{},
 		f_7_ECX_{},
 		f_81_ECX_{},
-		f_81_EDX_{}
+		f_81_EDX_{},
+		xcr0_{ 0 }
 	{
 		int cpui[4] = { -1 };
 
@@ -118,6 +128,12 @@ namespace {
 			f_1_EDX_ = data_[1][3];
 		}
 
+		// XGETBV is only available if OSXSAVE is set.
+		if (f_1_ECX_[27])
+		{
+			xcr0_ = xgetbv(0);
+		}
+
 		// load bitset with flags for function 0x00000007  
 		if (nIds_ >= 7)
 		{
@@ -221,4 +237,8 @@ bool CPU_supports_RDTSCP() { return CPU_Rep.isIntel_ && CPU_Rep.f_81_EDX_[27]; }
 bool CPU_supports_3DNOWEXT() { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[30]; }
 bool CPU_supports_3DNOW() { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[31]; }
 
+// XMM and YMM state (bits 1-2); for AVX-512 also opmask and ZMM state (bits 5-7).
+bool OS_supports_AVX() { return (CPU_Rep.xcr0_ & 0x06) == 0x06; }
+bool OS_supports_AVX512() { return (CPU_Rep.xcr0_ & 0xe6) == 0xe6; }
+
 
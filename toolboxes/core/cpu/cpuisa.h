@@ -0,0 +1,87 @@
+//
+// This is a cross-platform adapataion of the MSDN sample
+// https://docs.microsoft.com/en-us/cpp/intrinsics/cpuid-cpuidex
+//
+#pragma once
+
+#include "cpucore_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	EXPORTCPUCORE const char* CPU_Vendor();
+	EXPORTCPUCORE const char* CPU_Brand();
+
+	EXPORTCPUCORE bool CPU_supports_SSE3();
+	EXPORTCPUCORE bool CPU_supports_PCLMULQDQ();
+	EXPORTCPUCORE bool CPU_supports_MONITOR();
+	EXPORTCPUCORE bool CPU_supports_SSSE3();
+	EXPORTCPUCORE bool CPU_supports_FMA();
+	EXPORTCPUCORE bool CPU_supports_CMPXCHG16B();
+	EXPORTCPUCORE bool CPU_supports_AVX512POPCNTDQ();
+	EXPORTCPUCORE bool CPU_supports_SSE41();
+	EXPORTCPUCORE bool CPU_supports_SSE42();
+	EXPORTCPUCORE bool CPU_supports_MOVBE();
+	EXPORTCPUCORE bool CPU_supports_POPCNT();
+	EXPORTCPUCORE bool CPU_supports_AES();
+	EXPORTCPUCORE bool CPU_supports_XSAVE();
+	EXPORTCPUCORE bool CPU_supports_OSXSAVE();
+	EXPORTCPUCORE bool CPU_supports_AVX();
+	EXPORTCPUCORE bool CPU_supports_F16C();
+	EXPORTCPUCORE bool CPU_supports_RDRAND();
+
+	EXPORTCPUCORE bool CPU_supports_MSR();
+	EXPORTCPUCORE bool CPU_supports_CX8();
+	EXPORTCPUCORE bool CPU_supports_SEP();
+	EXPORTCPUCORE bool CPU_supports_CMOV();
+	EXPORTCPUCORE bool CPU_supports_CLFSH();
+	EXPORTCPUCORE bool CPU_supports_MMX();
+	EXPORTCPUCORE bool CPU_supports_FXSR();
+	EXPORTCPUCORE bool CPU_supports_SSE();
+	EXPORTCPUCORE bool CPU_supports_SSE2();
+
+	EXPORTCPUCORE bool CPU_supports_FSGSBASE();
+	EXPORTCPUCORE bool CPU_supports_BMI1();
+	EXPORTCPUCORE bool CPU_supports_HLE();
+	EXPORTCPUCORE bool CPU_supports_AVX2();
+	EXPORTCPUCORE bool CPU_supports_BMI2();
+	EXPORTCPUCORE bool CPU_supports_ERMS();
+	EXPORTCPUCORE bool CPU_supports_INVPCID();
+	EXPORTCPUCORE bool CPU_supports_RTM();
+	EXPORTCPUCORE bool CPU_supports_AVX512F();
+	EXPORTCPUCORE bool CPU_supports_AVX512DQ();
+	EXPORTCPUCORE bool CPU_supports_RDSEED();
+	EXPORTCPUCORE bool CPU_supports_ADX();
+	EXPORTCPUCORE bool CPU_supports_AVX512IFMA();
+	EXPORTCPUCORE bool CPU_supports_AVX512PF();
+	EXPORTCPUCORE bool CPU_supports_AVX512ER();
+	EXPORTCPUCORE bool CPU_supports_AVX512CD();
+	EXPORTCPUCORE bool CPU_supports_SHA();
+	EXPORTCPUCORE bool CPU_supports_AVX512BW();
+	EXPORTCPUCORE bool CPU_supports_AVX512VL();
+
+	EXPORTCPUCORE bool CPU_supports_PREFETCHWT1();
+
+	EXPORTCPUCORE bool CPU_supports_LAHF();
+	EXPORTCPUCORE bool CPU_supports_LZCNT();
+	EXPORTCPUCORE bool CPU_supports_ABM();
+	EXPORTCPUCORE bool CPU_supports_SSE4a();
+	EXPORTCPUCORE bool CPU_supports_XOP();
+	EXPORTCPUCORE bool CPU_supports_TBM();
+
+	EXPORTCPUCORE bool CPU_supports_SYSCALL();
+	EXPORTCPUCORE bool CPU_supports_MMXEXT();
+	EXPORTCPUCORE bool CPU_supports_RDTSCP();
+	EXPORTCPUCORE bool CPU_supports_3DNOWEXT();
+	EXPORTCPUCORE bool CPU_supports_3DNOW();
+
+	// Whether the OS saves the extended registers on context switches (XCR0, read with XGETBV).
+	// Required on top of the CPU flags before AVX or AVX-512 instructions may be used.
+	EXPORTCPUCORE bool OS_supports_AVX();
+	EXPORTCPUCORE bool OS_supports_AVX512();
+
+#ifdef __cplusplus
+}
+#endif
+
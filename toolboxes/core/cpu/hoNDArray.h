@@ -11,6 +11,7 @@
 #include <boost/shared_ptr.hpp>
 #include <stdexcept>
 #include "TypeTraits.h"
+#include "hoNDArrayAllocator.h"
 
 namespace Gadgetron{
 
@@ -63,6 +64,10 @@ namespace Gadgetron{
     }
    template<class T> class hoNDArray;
 
+   namespace expressions {
+       template <class Node> class hoNDExpression;
+   }
+
 
    template<class T, size_t D, bool contigous = false>
    class hoNDArrayView {
@@ -153,6 +158,10 @@ namespace Gadgetron{
     template<unsigned int D, bool C>
     hoNDArray& operator=(const hoNDArrayView<T,D,C>& view);
 
+    // Evaluates a lazy expression (see hoNDArray_expressions.h) in a single pass, reusing the memory of this array
+    template<class Node>
+    hoNDArray& operator=(const expressions::hoNDExpression<Node>& expression);
+
     bool operator==(const hoNDArray& rhs) const;
 
     virtual void create(const std::vector<size_t>& dimensions);
@@ -284,17 +293,35 @@ namespace Gadgetron{
 
     // Generic allocator / deallocator
     //
+    // Plain data goes through hoNDArrayAllocator (aligned, uninitialized, pooled). Memory handed to the array by the
+    // user (create(dimensions, data, true)) is still expected to come from new[].
 
     template<class X> void _allocate_memory( size_t size, X** data )
     {
-      *data = new X[size];
+      if constexpr (detail::uses_hoNDArrayAllocator<X>) {
+        allocator_ = &hoNDArrayAllocator::get_default();
+        allocated_bytes_ = size * sizeof(X);
+        *data = static_cast<X*>(allocator_->allocate(allocated_bytes_));
+      } else {
+        allocator_ = nullptr;
+        *data = new X[size];
+      }
     }
 
     template<class X> void _deallocate_memory( X* data )
     {
-      delete [] data;
+      if (allocator_) {
+        allocator_->deallocate(data, allocated_bytes_);
+        allocator_ = nullptr;
+      } else {
+        delete [] data;
+      }
     }
 
+    // Allocator that owns data_, or nullptr if data_ was allocated with new[]
+    hoNDArrayAllocator* allocator_ = nullptr;
+    size_t allocated_bytes_ = 0;
+
 
   };
 
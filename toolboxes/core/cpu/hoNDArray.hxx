@@ -6,6 +6,7 @@
 #include "vector_td_utilities.h"
 #include <cstring>
 #include <numeric>
+#include <utility>
 
 namespace Gadgetron {
     template<typename T>
@@ -219,6 +220,8 @@ namespace Gadgetron {
         a.data_ = nullptr;
         this->offsetFactors_ = a.offsetFactors_;
         this->delete_data_on_destruct_ = a.delete_data_on_destruct_;
+        this->allocator_ = std::exchange(a.allocator_, nullptr);
+        this->allocated_bytes_ = a.allocated_bytes_;
     }
 
 
@@ -263,6 +266,8 @@ namespace Gadgetron {
         data_ = rhs.data_;
         rhs.data_ = nullptr;
         this->delete_data_on_destruct_ = rhs.delete_data_on_destruct_;
+        this->allocator_ = std::exchange(rhs.allocator_, nullptr);
+        this->allocated_bytes_ = rhs.allocated_bytes_;
         return *this;
     }
 
@@ -298,6 +303,7 @@ namespace Gadgetron {
 
             BaseClass::create(dimensions, data, delete_data_on_destruct);
         }
+        this->allocator_ = nullptr;
     }
 
     template<class T>
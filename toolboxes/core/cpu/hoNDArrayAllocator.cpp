@@ -0,0 +1,282 @@
+#include "hoNDArrayAllocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#if defined(_WIN32)
+#include <intrin.h>
+#include <malloc.h>
+#endif
+
+namespace Gadgetron {
+
+    namespace {
+
+        void* aligned_allocate(size_t bytes) {
+            bytes = std::max(bytes, hoNDArrayAllocator::alignment);
+#if defined(_WIN32)
+            return _aligned_malloc(bytes, hoNDArrayAllocator::alignment);
+#else
+            void* data = nullptr;
+            if (posix_memalign(&data, hoNDArrayAllocator::alignment, bytes))
+                return nullptr;
+            return data;
+#endif
+        }
+
+        void aligned_free(void* data) {
+#if defined(_WIN32)
+            _aligned_free(data);
+#else
+            std::free(data);
+#endif
+        }
+
+        size_t floor_log2(size_t value) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return index;
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+        void update_peak(std::atomic<size_t>& peak, size_t value) {
+            auto current = peak.load(std::memory_order_relaxed);
+            while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+                ;
+        }
+
+        size_t default_cache_limit() {
+            if (auto limit = std::getenv("GADGETRON_MEMORY_POOL_LIMIT_MB"))
+                return size_t(std::strtoull(limit, nullptr, 10)) << 20;
+            return size_t(1) << 30;
+        }
+
+        // Sizes up to 256 bytes are rounded to multiples of 64. Beyond that, every power of two [2^p, 2^(p+1)) is
+        // split into four classes, wasting at most 25%.
+        size_t size_class(size_t bytes) {
+            if (bytes <= 256)
+                return bytes ? (bytes - 1) / 64 : 0;
+            size_t p = floor_log2(bytes - 1);
+            size_t step = size_t(1) << (p - 2);
+            size_t k = (bytes - (size_t(1) << p) + step - 1) / step;
+            return 4 + (p - 8) * 4 + (k - 1);
+        }
+
+        size_t class_size(size_t size_class) {
+            if (size_class < 4)
+                return (size_class + 1) * 64;
+            size_t p = (size_class - 4) / 4 + 8;
+            size_t k = (size_class - 4) % 4 + 1;
+            return (size_t(1) << p) + k * (size_t(1) << (p - 2));
+        }
+
+        std::mutex default_mutex;
+        hoNDArrayAllocator* default_allocator = nullptr;
+    }
+
+    hoNDArrayAllocator& hoNDArrayAllocator::get_default() {
+        std::lock_guard<std::mutex> guard(default_mutex);
+        if (!default_allocator)
+            default_allocator = new hoNDArrayPoolAllocator(default_cache_limit());
+        return *default_allocator;
+    }
+
+    void hoNDArrayAllocator::set_default(std::unique_ptr<hoNDArrayAllocator> allocator) {
+        std::lock_guard<std::mutex> guard(default_mutex);
+        default_allocator = allocator.release();
+    }
+
+    void* hoNDArrayAlignedAllocator::allocate(size_t bytes) {
+        auto data = aligned_allocate(bytes);
+        if (data) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+            update_peak(peak_bytes_in_use, bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        }
+        return data;
+    }
+
+    void hoNDArrayAlignedAllocator::deallocate(void* data, size_t bytes) {
+        aligned_free(data);
+        bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    hoNDArrayAllocatorStatistics hoNDArrayAlignedAllocator::statistics() const {
+        return { 0, allocations.load(), bytes_in_use.load(), peak_bytes_in_use.load(), 0 };
+    }
+
+    /**
+     * Blocks cached by a single thread. A thread can use several pools, although one is by far the common case.
+     */
+    struct hoNDArrayPoolAllocator::ThreadCache {
+        explicit ThreadCache(hoNDArrayPoolAllocator& pool) : pool{ pool } {}
+
+        ~ThreadCache() { clear(); }
+
+        void clear() {
+            for (size_t size_class = 0; size_class < blocks.size(); size_class++) {
+                for (auto data : blocks[size_class])
+                    pool.release(size_class, data);
+                blocks[size_class].clear();
+            }
+            bytes = 0;
+        }
+
+        hoNDArrayPoolAllocator& pool;
+        std::array<std::vector<void*>, number_of_classes> blocks;
+        size_t bytes = 0;
+    };
+
+    namespace {
+        // Set once the caches of the thread are gone. Arrays freed later in the thread's (or the process') teardown,
+        // e.g. by function-local statics, go straight to the shared cache. Being trivially destructible, the flag
+        // itself stays usable until the thread exits.
+        thread_local bool thread_caches_destroyed = false;
+
+        struct ThreadCaches {
+            ~ThreadCaches() {
+                thread_caches_destroyed = true;
+                caches.clear();
+            }
+            std::vector<std::unique_ptr<hoNDArrayPoolAllocator::ThreadCache>> caches;
+        };
+        thread_local ThreadCaches thread_caches;
+    }
+
+    hoNDArrayPoolAllocator::hoNDArrayPoolAllocator(size_t cache_limit)
+        : limit{ cache_limit }, thread_limit{ cache_limit / 8 } {}
+
+    hoNDArrayPoolAllocator::~hoNDArrayPoolAllocator() {
+        if (!thread_caches_destroyed) {
+            auto& caches = thread_caches.caches;
+            caches.erase(std::remove_if(caches.begin(), caches.end(), [this](auto& cache) { return &cache->pool == this; }),
+                caches.end());
+        }
+        for (auto& shared_class : shared) {
+            for (auto data : shared_class.blocks)
+                aligned_free(data);
+        }
+    }
+
+    hoNDArrayPoolAllocator::ThreadCache* hoNDArrayPoolAllocator::thread_cache() {
+        if (thread_caches_destroyed)
+            return nullptr;
+        for (auto& cache : thread_caches.caches)
+            if (&cache->pool == this)
+                return cache.get();
+        thread_caches.caches.push_back(std::make_unique<ThreadCache>(*this));
+        return thread_caches.caches.back().get();
+    }
+
+    // Moves a block from a thread cache to the shared cache.
+    void hoNDArrayPoolAllocator::release(size_t size_class, void* data) {
+        std::lock_guard<std::mutex> guard(shared[size_class].mutex);
+        shared[size_class].blocks.push_back(data);
+    }
+
+    void* hoNDArrayPoolAllocator::allocate(size_t bytes) {
+        if (bytes > max_pooled_size) {
+            auto data = aligned_allocate(bytes);
+            if (data) {
+                misses.fetch_add(1, std::memory_order_relaxed);
+                update_peak(peak_bytes_in_use, bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+            }
+            return data;
+        }
+
+        auto index = size_class(bytes);
+        auto size  = class_size(index);
+
+        void* data = nullptr;
+        auto cache = thread_cache();
+        if (cache && !cache->blocks[index].empty()) {
+            data = cache->blocks[index].back();
+            cache->blocks[index].pop_back();
+            cache->bytes -= size;
+        } else {
+            std::lock_guard<std::mutex> guard(shared[index].mutex);
+            if (!shared[index].blocks.empty()) {
+                data = shared[index].blocks.back();
+                shared[index].blocks.pop_back();
+            }
+        }
+
+        if (data) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            bytes_cached.fetch_sub(size, std::memory_order_relaxed);
+        } else {
+            data = aligned_allocate(size);
+            if (!data) {
+                // Cached blocks are of no use if we are out of memory.
+                trim();
+                data = aligned_allocate(size);
+                if (!data)
+                    return nullptr;
+            }
+            misses.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        update_peak(peak_bytes_in_use, bytes_in_use.fetch_add(size, std::memory_order_relaxed) + size);
+        return data;
+    }
+
+    void hoNDArrayPoolAllocator::deallocate(void* data, size_t bytes) {
+        if (!data)
+            return;
+
+        if (bytes > max_pooled_size) {
+            aligned_free(data);
+            bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+            return;
+        }
+
+        auto index = size_class(bytes);
+        auto size  = class_size(index);
+        bytes_in_use.fetch_sub(size, std::memory_order_relaxed);
+
+        if (bytes_cached.fetch_add(size, std::memory_order_relaxed) + size > limit) {
+            bytes_cached.fetch_sub(size, std::memory_order_relaxed);
+            aligned_free(data);
+            return;
+        }
+
+        auto cache = thread_cache();
+        if (cache && cache->bytes + size <= thread_limit) {
+            cache->blocks[index].push_back(data);
+            cache->bytes += size;
+        } else {
+            release(index, data);
+        }
+    }
+
+    void hoNDArrayPoolAllocator::trim() {
+        auto cache = thread_cache();
+        size_t released = 0;
+        for (size_t index = 0; index < number_of_classes; index++) {
+            if (cache) {
+                for (auto data : cache->blocks[index]) {
+                    aligned_free(data);
+                    released += class_size(index);
+                }
+                cache->blocks[index].clear();
+            }
+
+            std::lock_guard<std::mutex> guard(shared[index].mutex);
+            for (auto data : shared[index].blocks) {
+                aligned_free(data);
+                released += class_size(index);
+            }
+            shared[index].blocks.clear();
+        }
+        if (cache)
+            cache->bytes = 0;
+        bytes_cached.fetch_sub(released, std::memory_order_relaxed);
+    }
+
+    hoNDArrayAllocatorStatistics hoNDArrayPoolAllocator::statistics() const {
+        return { hits.load(), misses.load(), bytes_in_use.load(), peak_bytes_in_use.load(), bytes_cached.load() };
+    }
+}
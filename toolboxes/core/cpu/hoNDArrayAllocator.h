@@ -0,0 +1,152 @@
+/** \file hoNDArrayAllocator.h
+    \brief Memory allocators for hoNDArray.
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+
+#include <array>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "complext.h"
+
+namespace Gadgetron {
+
+    struct hoNDArrayAllocatorStatistics {
+        /// Allocations served from a pool
+        size_t hits;
+        /// Allocations that had to go to the system allocator
+        size_t misses;
+        /// Bytes currently handed out to arrays
+        size_t bytes_in_use;
+        /// Highest value of bytes_in_use seen so far
+        size_t peak_bytes_in_use;
+        /// Bytes held in the pools, ready for reuse
+        size_t bytes_cached;
+    };
+
+    /**
+     * Source of memory for hoNDArray.
+     *
+     * Memory is aligned to 64 bytes (an AVX-512 register) and is not initialized. Arrays remember the allocator their
+     * memory came from, so an allocator must outlive every array it has allocated for.
+     */
+    class EXPORTCPUCORE hoNDArrayAllocator {
+    public:
+        static constexpr size_t alignment = 64;
+
+        virtual ~hoNDArrayAllocator() = default;
+
+        /// Returns nullptr if the memory could not be allocated.
+        virtual void* allocate(size_t bytes) = 0;
+        virtual void deallocate(void* data, size_t bytes) = 0;
+
+        virtual hoNDArrayAllocatorStatistics statistics() const = 0;
+
+        /// Allocator used for new arrays. Defaults to a hoNDArrayPoolAllocator.
+        static hoNDArrayAllocator& get_default();
+
+        /**
+         * Replaces the allocator used for new arrays. The allocator is kept alive for the rest of the process, since
+         * existing arrays may still hold memory from it.
+         */
+        static void set_default(std::unique_ptr<hoNDArrayAllocator> allocator);
+    };
+
+    /**
+     * Plain aligned allocation, with every deallocation returned to the system.
+     */
+    class EXPORTCPUCORE hoNDArrayAlignedAllocator : public hoNDArrayAllocator {
+    public:
+        void* allocate(size_t bytes) override;
+        void deallocate(void* data, size_t bytes) override;
+        hoNDArrayAllocatorStatistics statistics() const override;
+
+    private:
+        std::atomic<size_t> allocations{ 0 };
+        std::atomic<size_t> bytes_in_use{ 0 };
+        std::atomic<size_t> peak_bytes_in_use{ 0 };
+    };
+
+    /**
+     * Recycles memory of recently destroyed arrays.
+     *
+     * Allocations are rounded up to size classes (four per power of two), and freed blocks are kept in a small
+     * per-thread cache, overflowing into a shared cache. Reconstructions creating and destroying temporaries of the
+     * same size over and over will mostly be served without touching the system allocator, avoiding both page faults
+     * and allocator lock contention.
+     *
+     * The total amount of memory cached (in all threads) is capped; anything beyond the cap is returned to the system.
+     * Blocks larger than max_pooled_size are never cached.
+     *
+     * A pool must outlive every thread that has used it; the default pool is never destroyed.
+     */
+    class EXPORTCPUCORE hoNDArrayPoolAllocator : public hoNDArrayAllocator {
+    public:
+        static constexpr size_t max_pooled_size = size_t(1) << 32;
+
+        /**
+         * @param cache_limit Maximum number of bytes kept for reuse, over all threads
+         */
+        explicit hoNDArrayPoolAllocator(size_t cache_limit);
+        ~hoNDArrayPoolAllocator() override;
+
+        void* allocate(size_t bytes) override;
+        void deallocate(void* data, size_t bytes) override;
+        hoNDArrayAllocatorStatistics statistics() const override;
+
+        /// Returns the cached blocks of the calling thread and of the shared cache to the system.
+        void trim();
+
+        size_t cache_limit() const { return limit; }
+
+        struct ThreadCache;
+
+    private:
+        static constexpr size_t number_of_classes = 4 + 4 * (32 - 8) + 1;
+
+        struct SharedClass {
+            std::mutex mutex;
+            std::vector<void*> blocks;
+        };
+
+        /// Cache of the calling thread, or nullptr once the thread's caches have been destroyed
+        ThreadCache* thread_cache();
+        void release(size_t size_class, void* data);
+
+        const size_t limit;
+        const size_t thread_limit;
+
+        std::array<SharedClass, number_of_classes> shared;
+
+        std::atomic<size_t> hits{ 0 };
+        std::atomic<size_t> misses{ 0 };
+        std::atomic<size_t> bytes_in_use{ 0 };
+        std::atomic<size_t> peak_bytes_in_use{ 0 };
+        std::atomic<size_t> bytes_cached{ 0 };
+
+        friend struct ThreadCache;
+    };
+
+    namespace detail {
+        /**
+         * Types hoNDArray allocates through hoNDArrayAllocator, i.e. types for which skipping construction and
+         * destruction is safe. Anything else is allocated with new[].
+         */
+        template <class T> struct is_complex_value : std::false_type {};
+        template <class T> struct is_complex_value<std::complex<T>> : std::is_arithmetic<T> {};
+        template <class T> struct is_complex_value<complext<T>> : std::is_arithmetic<T> {};
+
+        template <class T>
+        constexpr bool uses_hoNDArrayAllocator =
+            std::is_trivially_destructible<T>::value && std::is_trivially_copyable<T>::value
+            && (std::is_trivially_default_constructible<T>::value || is_complex_value<T>::value);
+    }
+}
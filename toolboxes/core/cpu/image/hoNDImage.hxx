@@ -525,6 +525,7 @@ namespace Gadgetron
 
         this->data_ = data;
         this->delete_data_on_destruct_ = delete_data_on_destruct;
+        this->allocator_ = nullptr;
         this->dimensions_ = dimensions;
 
         unsigned int ii;
@@ -565,6 +566,7 @@ namespace Gadgetron
 
         this->data_ = data;
         this->delete_data_on_destruct_ = delete_data_on_destruct;
+        this->allocator_ = nullptr;
         this->dimensions_ = dimensions;
 
         unsigned int ii;
@@ -605,6 +607,7 @@ namespace Gadgetron
 
         this->data_ = data;
         this->delete_data_on_destruct_ = delete_data_on_destruct;
+        this->allocator_ = nullptr;
         this->dimensions_ = dimensions;
 
         unsigned int ii;
@@ -661,6 +664,7 @@ namespace Gadgetron
 
         this->data_ = data;
         this->delete_data_on_destruct_ = delete_data_on_destruct;
+        this->allocator_ = nullptr;
 
         dimensions_ = dimensions;
 
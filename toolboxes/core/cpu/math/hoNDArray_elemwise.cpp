@@ -32,7 +32,9 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        Gadgetron::transform(x,r,[](auto val){return conj(val);});
+        using K = typename ::gadgetron_detail::kernelType<T>::type;
+        elemwise::conjugate(x.get_number_of_elements(), reinterpret_cast<const K*>(x.get_data_ptr()),
+            reinterpret_cast<K*>(r.get_data_ptr()));
     }
 
     template  void conjugate(
@@ -65,16 +67,16 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        using std::arg;
-        transform(x,r,[](auto val){return arg(val);});
+        elemwise::argument(x.get_number_of_elements(), x.get_data_ptr(), r.get_data_ptr());
     }
 
     template  void argument(const hoNDArray<std::complex<float>>& x, hoNDArray<float>& r);
     template  void argument(const hoNDArray<std::complex<double>>& x, hoNDArray<double>& r);
 
     template <class T> hoNDArray<realType_t<T>> argument(const hoNDArray<T>& x) {
-        using std::arg;
-        return Gadgetron::transform(x,[](const auto& v){return arg(v);});
+        hoNDArray<realType_t<T>> r(x.dimensions());
+        argument(x, r);
+        return r;
     }
 
     template  hoNDArray<float> argument(const hoNDArray<std::complex<float>>& x);
@@ -102,7 +104,12 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        transform(x,r,[](auto val){return abs(val);});
+        using K = typename ::gadgetron_detail::kernelType<T>::type;
+        if constexpr (std::is_same<R, realType_t<T>>::value && !std::is_void<K>::value) {
+            elemwise::abs(x.get_number_of_elements(), reinterpret_cast<const K*>(x.get_data_ptr()), r.get_data_ptr());
+        } else {
+            transform(x,r,[](auto val){return abs(val);});
+        }
     }
 
     template  void abs(const hoNDArray<float>& x, hoNDArray<float>& r);
@@ -117,8 +124,9 @@ namespace Gadgetron {
     template  void abs(const hoNDArray<complext<double>>& x, hoNDArray<complext<double>>& r);
 
     template <class T> hoNDArray<realType_t<T>> abs(const hoNDArray<T>& x) {
-        using std::abs;
-        return transform(x,[](auto val){return abs(val);}) ;
+        hoNDArray<realType_t<T>> r(x.dimensions());
+        abs(x, r);
+        return r;
     }
 
     template  hoNDArray<float> abs(const hoNDArray<float>& x);
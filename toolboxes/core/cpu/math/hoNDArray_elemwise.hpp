@@ -3,6 +3,12 @@
 //
 
 #pragma once
+
+#include "hoNDArray_elemwise_kernels.h"
+
+#include <functional>
+#include <type_traits>
+
 namespace {
     using namespace Gadgetron;
     namespace gadgetron_detail {
@@ -13,6 +19,41 @@ namespace {
         template <class T> struct mathInternalType { typedef T type; };
         template <class T> struct mathInternalType<std::complex<T>> { typedef Gadgetron::complext<T> type; };
 
+        //
+        // Element type of the vectorized kernels in hoNDArray_elemwise_kernels.h, or void if there is no kernel for T.
+        // complext<T> has the same layout as std::complex<T>.
+        //
+        template <class T> struct kernelType { typedef void type; };
+        template <> struct kernelType<float> { typedef float type; };
+        template <> struct kernelType<double> { typedef double type; };
+        template <class T> struct kernelType<std::complex<T>> { typedef std::complex<T> type; };
+        template <class T> struct kernelType<Gadgetron::complext<T>> { typedef std::complex<T> type; };
+        template <> struct kernelType<std::complex<long double>> { typedef void type; };
+        template <> struct kernelType<Gadgetron::complext<long double>> { typedef void type; };
+
+        struct multiplies_conj {
+            template <class A, class B> auto operator()(const A& a, const B& b) const { return a * conj(b); }
+        };
+
+        // Kernel implementing BinaryOperator, if any
+        template <class BinaryOperator> struct kernelOperation { static constexpr bool supported = false; };
+        template <> struct kernelOperation<std::plus<>> {
+            static constexpr bool supported = true;
+            static constexpr elemwise::BinaryOperation value = elemwise::BinaryOperation::add;
+        };
+        template <> struct kernelOperation<std::minus<>> {
+            static constexpr bool supported = true;
+            static constexpr elemwise::BinaryOperation value = elemwise::BinaryOperation::subtract;
+        };
+        template <> struct kernelOperation<std::multiplies<>> {
+            static constexpr bool supported = true;
+            static constexpr elemwise::BinaryOperation value = elemwise::BinaryOperation::multiply;
+        };
+        template <> struct kernelOperation<multiplies_conj> {
+            static constexpr bool supported = true;
+            static constexpr elemwise::BinaryOperation value = elemwise::BinaryOperation::multiply_conj;
+        };
+
         // --------------------------------------------------------------------------------
 
         // internal low level function for element-wise addition of two arrays
@@ -20,6 +61,14 @@ namespace {
         inline void transform_impl(size_t sizeX, size_t sizeY, const T *x, const S *y,
                                    typename mathReturnType<T, S>::type *r, BinaryOperator op) {
 
+            using K = typename kernelType<T>::type;
+            if constexpr (std::is_same<T, S>::value && !std::is_void<K>::value
+                          && kernelOperation<std::decay_t<BinaryOperator>>::supported) {
+                elemwise::binary(kernelOperation<std::decay_t<BinaryOperator>>::value, sizeX, sizeY,
+                    reinterpret_cast<const K*>(x), reinterpret_cast<const K*>(y), reinterpret_cast<K*>(r));
+                return;
+            }
+
             // cast to internal types
             const typename mathInternalType<T>::type *a
                     = reinterpret_cast<const typename mathInternalType<T>::type *>(x);
@@ -31,25 +80,22 @@ namespace {
             if (sizeX == sizeY) {
                 // No Broadcasting
                 long long loopsize = sizeX;
-                long long n;
 
-                for ( long long n = 0; n < loopsize; n++) {
+#pragma omp parallel for if (sizeX > elemwise::numElementsUseThreading)
+                for (long long n = 0; n < loopsize; n++) {
                     c[n] = op(a[n], b[n]);
                 }
-            } else {
+            } else if (sizeY > 0) {
                 // Broadcasting
                 long long outerloopsize = sizeX / sizeY;
-                long long innerloopsize = sizeX / outerloopsize;
-                // No OMP at All
+                long long innerloopsize = sizeY;
+
+#pragma omp parallel for collapse(2) if (sizeX > elemwise::numElementsUseThreading)
                 for (long long outer = 0; outer < outerloopsize; outer++) {
-                    size_t offset = outer * innerloopsize;
-                    const typename mathInternalType<T>::type *ai = &a[offset];
-                    typename mathInternalType<typename mathReturnType<T, S>::type>::type *ci = &c[offset];
                     for (long long n = 0; n < innerloopsize; n++) {
-                        ci[n] = op(ai[n], b[n]);
+                        c[outer * innerloopsize + n] = op(a[outer * innerloopsize + n], b[n]);
                     }
                 }
-
             }
         }
 
@@ -117,7 +163,7 @@ void Gadgetron::divide(
 template <class T, class S>
 void Gadgetron::multiplyConj(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); });
+    ::gadgetron_detail::transform_arrays(x, y, r, ::gadgetron_detail::multiplies_conj());
 }
 
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator+=(hoNDArray<T>& x, const hoNDArray<S>& y) {
@@ -0,0 +1,181 @@
+#define GADGETRON_ELEMWISE_ISA scalar
+#include "hoNDArray_elemwise_kernels.hxx"
+
+#include "cpuisa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GADGETRON_ELEMWISE_X86
+#endif
+
+namespace Gadgetron {
+    namespace elemwise {
+
+#ifdef GADGETRON_ELEMWISE_X86
+        // Defined in hoNDArray_elemwise_kernels_avx2.cpp and hoNDArray_elemwise_kernels_avx512.cpp
+        namespace avx2 {
+            template <class T> void binary(BinaryOperation, size_t, const T*, const T*, T*);
+            template <class T> void binary(BinaryOperation, size_t, const std::complex<T>*, const std::complex<T>*, std::complex<T>*);
+            template <class T> void abs(size_t, const T*, T*);
+            void abs(size_t, const std::complex<float>*, float*);
+            void abs(size_t, const std::complex<double>*, double*);
+            template <class T> void argument(size_t, const std::complex<T>*, T*);
+            template <class T> void conjugate(size_t, const std::complex<T>*, std::complex<T>*);
+        }
+        namespace avx512 {
+            template <class T> void binary(BinaryOperation, size_t, const T*, const T*, T*);
+            template <class T> void binary(BinaryOperation, size_t, const std::complex<T>*, const std::complex<T>*, std::complex<T>*);
+            template <class T> void abs(size_t, const T*, T*);
+            void abs(size_t, const std::complex<float>*, float*);
+            void abs(size_t, const std::complex<double>*, double*);
+            template <class T> void argument(size_t, const std::complex<T>*, T*);
+            template <class T> void conjugate(size_t, const std::complex<T>*, std::complex<T>*);
+        }
+#endif
+
+        namespace {
+            // Elements per chunk handed to a thread. Large enough to amortize the dispatch, small enough to stay in L2.
+            constexpr size_t chunk_size = 16 * 1024;
+
+            SimdLevel detect_simd_level() {
+#ifdef GADGETRON_ELEMWISE_X86
+                if (!CPU_supports_OSXSAVE() || !OS_supports_AVX())
+                    return SimdLevel::scalar;
+                if (CPU_supports_AVX512F() && CPU_supports_AVX512DQ() && OS_supports_AVX512())
+                    return SimdLevel::avx512;
+                if (CPU_supports_AVX2() && CPU_supports_FMA())
+                    return SimdLevel::avx2;
+#endif
+                return SimdLevel::scalar;
+            }
+
+            SimdLevel initial_simd_level() {
+                auto supported = supported_simd_level();
+                auto requested = std::getenv("GADGETRON_SIMD");
+                if (!requested)
+                    return supported;
+
+                auto level = std::string(requested);
+                if (level == "scalar")
+                    return SimdLevel::scalar;
+                if (level == "avx2")
+                    return std::min(supported, SimdLevel::avx2);
+                return supported;
+            }
+
+            std::atomic<SimdLevel>& current_level() {
+                static std::atomic<SimdLevel> level{ initial_simd_level() };
+                return level;
+            }
+
+            /**
+             * Calls f(offset, period_offset, length) for pieces of [0, size) covering at most chunk_size elements and
+             * not crossing a multiple of period, in parallel for large arrays.
+             */
+            template <class F> void for_chunks(size_t size, size_t period, F&& f) {
+                if (size == 0 || period == 0)
+                    return;
+
+                if (period >= chunk_size) {
+                    const long long chunks_per_period = (period + chunk_size - 1) / chunk_size;
+                    const long long chunks            = (size / period) * chunks_per_period;
+#pragma omp parallel for schedule(static) if (size > numElementsUseThreading)
+                    for (long long chunk = 0; chunk < chunks; chunk++) {
+                        size_t outer = chunk / chunks_per_period;
+                        size_t inner = (chunk % chunks_per_period) * chunk_size;
+                        f(outer * period + inner, inner, std::min(chunk_size, period - inner));
+                    }
+                } else {
+                    // Short periods are grouped, so every chunk handles several repetitions of y.
+                    const long long periods           = size / period;
+                    const long long periods_per_chunk = chunk_size / period;
+                    const long long chunks            = (periods + periods_per_chunk - 1) / periods_per_chunk;
+#pragma omp parallel for schedule(static) if (size > numElementsUseThreading)
+                    for (long long chunk = 0; chunk < chunks; chunk++) {
+                        auto last = std::min(periods, (chunk + 1) * periods_per_chunk);
+                        for (auto outer = chunk * periods_per_chunk; outer < last; outer++)
+                            f(outer * period, 0, period);
+                    }
+                }
+            }
+        }
+
+        SimdLevel supported_simd_level() {
+            static const SimdLevel level = detect_simd_level();
+            return level;
+        }
+
+        SimdLevel simd_level() {
+            return current_level().load(std::memory_order_relaxed);
+        }
+
+        void set_simd_level(SimdLevel level) {
+            current_level().store(std::min(level, supported_simd_level()), std::memory_order_relaxed);
+        }
+
+        // Invokes ISA::kernel(args...) for the selected instruction set.
+#ifdef GADGETRON_ELEMWISE_X86
+#define GADGETRON_ELEMWISE_DISPATCH(level, kernel, ...)                                                                 \
+    switch (level) {                                                                                                   \
+    case SimdLevel::avx512: avx512::kernel(__VA_ARGS__); break;                                                        \
+    case SimdLevel::avx2: avx2::kernel(__VA_ARGS__); break;                                                            \
+    default: scalar::kernel(__VA_ARGS__); break;                                                                       \
+    }
+#else
+#define GADGETRON_ELEMWISE_DISPATCH(level, kernel, ...) scalar::kernel(__VA_ARGS__);
+#endif
+
+        template <class T>
+        void binary(BinaryOperation operation, size_t size, size_t period, const T* x, const T* y, T* r) {
+            auto level = simd_level();
+            for_chunks(size, period, [&](size_t offset, size_t period_offset, size_t length) {
+                GADGETRON_ELEMWISE_DISPATCH(level, binary, operation, length, x + offset, y + period_offset, r + offset)
+            });
+        }
+
+        template <class T> void abs(size_t size, const T* x, typename realType<T>::Type* r) {
+            auto level = simd_level();
+            for_chunks(size, size, [&](size_t offset, size_t, size_t length) {
+                GADGETRON_ELEMWISE_DISPATCH(level, abs, length, x + offset, r + offset)
+            });
+        }
+
+        template <class T> void argument(size_t size, const std::complex<T>* x, T* r) {
+            auto level = simd_level();
+            for_chunks(size, size, [&](size_t offset, size_t, size_t length) {
+                GADGETRON_ELEMWISE_DISPATCH(level, argument, length, x + offset, r + offset)
+            });
+        }
+
+        template <class T> void conjugate(size_t size, const std::complex<T>* x, std::complex<T>* r) {
+            auto level = simd_level();
+            for_chunks(size, size, [&](size_t offset, size_t, size_t length) {
+                GADGETRON_ELEMWISE_DISPATCH(level, conjugate, length, x + offset, r + offset)
+            });
+        }
+
+#undef GADGETRON_ELEMWISE_DISPATCH
+
+        template void binary(BinaryOperation, size_t, size_t, const float*, const float*, float*);
+        template void binary(BinaryOperation, size_t, size_t, const double*, const double*, double*);
+        template void binary(BinaryOperation, size_t, size_t, const std::complex<float>*, const std::complex<float>*,
+            std::complex<float>*);
+        template void binary(BinaryOperation, size_t, size_t, const std::complex<double>*,
+            const std::complex<double>*, std::complex<double>*);
+
+        template void abs(size_t, const float*, float*);
+        template void abs(size_t, const double*, double*);
+        template void abs(size_t, const std::complex<float>*, float*);
+        template void abs(size_t, const std::complex<double>*, double*);
+
+        template void argument(size_t, const std::complex<float>*, float*);
+        template void argument(size_t, const std::complex<double>*, double*);
+
+        template void conjugate(size_t, const std::complex<float>*, std::complex<float>*);
+        template void conjugate(size_t, const std::complex<double>*, std::complex<double>*);
+    }
+}
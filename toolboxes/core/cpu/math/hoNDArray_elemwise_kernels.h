@@ -0,0 +1,47 @@
+/** \file   hoNDArray_elemwise_kernels.h
+    \brief  Vectorized, multi-threaded kernels behind the element-wise hoNDArray operations.
+
+    The kernels are compiled once per instruction set (plain, AVX2 and AVX-512), and the best one supported by the cpu
+    is picked at runtime. Arrays larger than numElementsUseThreading are split into chunks processed by OpenMP threads.
+
+    The kernels work on raw pointers, and support the same broadcasting as hoNDArray_elemwise.h: y (of size period) is
+    repeated over x and r (of size size). r may alias x or y, but must not partially overlap them.
+ */
+
+#pragma once
+
+#include "complext.h"
+
+#include <complex>
+#include <cstddef>
+
+namespace Gadgetron {
+    namespace elemwise {
+
+        /// Arrays with more elements than this are processed by several threads.
+        constexpr size_t numElementsUseThreading = 64 * 1024;
+
+        enum class SimdLevel { scalar, avx2, avx512 };
+
+        /// Highest instruction set supported by both this build and the cpu.
+        SimdLevel supported_simd_level();
+
+        /// Instruction set currently used. Defaults to supported_simd_level(), unless GADGETRON_SIMD is set to "scalar", "avx2" or "avx512".
+        SimdLevel simd_level();
+
+        /// Selects the instruction set used by the kernels. Levels not supported by the cpu fall back to the best supported one.
+        void set_simd_level(SimdLevel level);
+
+        enum class BinaryOperation { add, subtract, multiply, multiply_conj };
+
+        /// r = x op y, with y repeated every period elements. Defined for float, double, std::complex<float> and std::complex<double>.
+        template <class T>
+        void binary(BinaryOperation operation, size_t size, size_t period, const T* x, const T* y, T* r);
+
+        template <class T> void abs(size_t size, const T* x, typename realType<T>::Type* r);
+
+        template <class T> void argument(size_t size, const std::complex<T>* x, T* r);
+
+        template <class T> void conjugate(size_t size, const std::complex<T>* x, std::complex<T>* r);
+    }
+}
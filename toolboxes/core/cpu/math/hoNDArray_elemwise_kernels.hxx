@@ -0,0 +1,130 @@
+//
+// Loop bodies of the element-wise kernels. This file is compiled once per instruction set, by translation units
+// defining GADGETRON_ELEMWISE_ISA (the namespace holding that instruction set's kernels) and setting matching compiler
+// flags. The loops are written so the compiler can vectorize them; complex numbers are treated as interleaved pairs of
+// reals, which lets the compiler use the full vector width instead of going through std::complex operators.
+//
+
+#include "hoNDArray_elemwise_kernels.h"
+
+#include <cmath>
+
+namespace Gadgetron {
+    namespace elemwise {
+        namespace GADGETRON_ELEMWISE_ISA {
+
+            template <class T>
+            void binary(BinaryOperation operation, size_t size, const T* x, const T* y, T* r) {
+                switch (operation) {
+                case BinaryOperation::add:
+#pragma omp simd
+                    for (size_t i = 0; i < size; i++)
+                        r[i] = x[i] + y[i];
+                    break;
+                case BinaryOperation::subtract:
+#pragma omp simd
+                    for (size_t i = 0; i < size; i++)
+                        r[i] = x[i] - y[i];
+                    break;
+                case BinaryOperation::multiply:
+                case BinaryOperation::multiply_conj:
+#pragma omp simd
+                    for (size_t i = 0; i < size; i++)
+                        r[i] = x[i] * y[i];
+                    break;
+                }
+            }
+
+            template <class T>
+            void binary(BinaryOperation operation, size_t size, const std::complex<T>* x, const std::complex<T>* y,
+                std::complex<T>* r) {
+                auto a = reinterpret_cast<const T*>(x);
+                auto b = reinterpret_cast<const T*>(y);
+                auto c = reinterpret_cast<T*>(r);
+
+                switch (operation) {
+                case BinaryOperation::add:
+                case BinaryOperation::subtract:
+                    binary(operation, 2 * size, a, b, c);
+                    break;
+                case BinaryOperation::multiply:
+#pragma omp simd
+                    for (size_t i = 0; i < size; i++) {
+                        T ar = a[2 * i], ai = a[2 * i + 1];
+                        T br = b[2 * i], bi = b[2 * i + 1];
+                        c[2 * i]     = ar * br - ai * bi;
+                        c[2 * i + 1] = ar * bi + ai * br;
+                    }
+                    break;
+                case BinaryOperation::multiply_conj:
+#pragma omp simd
+                    for (size_t i = 0; i < size; i++) {
+                        T ar = a[2 * i], ai = a[2 * i + 1];
+                        T br = b[2 * i], bi = b[2 * i + 1];
+                        c[2 * i]     = ar * br + ai * bi;
+                        c[2 * i + 1] = ai * br - ar * bi;
+                    }
+                    break;
+                }
+            }
+
+            template <class T> void abs(size_t size, const T* x, T* r) {
+#pragma omp simd
+                for (size_t i = 0; i < size; i++)
+                    r[i] = std::abs(x[i]);
+            }
+
+            // Single precision magnitudes are accumulated in double, so they can neither overflow nor underflow.
+            void abs(size_t size, const std::complex<float>* x, float* r) {
+                auto a = reinterpret_cast<const float*>(x);
+#pragma omp simd
+                for (size_t i = 0; i < size; i++) {
+                    double re = a[2 * i], im = a[2 * i + 1];
+                    r[i] = float(std::sqrt(re * re + im * im));
+                }
+            }
+
+            void abs(size_t size, const std::complex<double>* x, double* r) {
+                auto a = reinterpret_cast<const double*>(x);
+#pragma omp simd
+                for (size_t i = 0; i < size; i++) {
+                    double re = a[2 * i], im = a[2 * i + 1];
+                    r[i] = std::sqrt(re * re + im * im);
+                }
+            }
+
+            template <class T> void argument(size_t size, const std::complex<T>* x, T* r) {
+                auto a = reinterpret_cast<const T*>(x);
+#pragma omp simd
+                for (size_t i = 0; i < size; i++)
+                    r[i] = std::atan2(a[2 * i + 1], a[2 * i]);
+            }
+
+            template <class T> void conjugate(size_t size, const std::complex<T>* x, std::complex<T>* r) {
+                auto a = reinterpret_cast<const T*>(x);
+                auto c = reinterpret_cast<T*>(r);
+#pragma omp simd
+                for (size_t i = 0; i < size; i++) {
+                    c[2 * i]     = a[2 * i];
+                    c[2 * i + 1] = -a[2 * i + 1];
+                }
+            }
+
+            template void binary(BinaryOperation, size_t, const float*, const float*, float*);
+            template void binary(BinaryOperation, size_t, const double*, const double*, double*);
+            template void binary(BinaryOperation, size_t, const std::complex<float>*, const std::complex<float>*,
+                std::complex<float>*);
+            template void binary(BinaryOperation, size_t, const std::complex<double>*, const std::complex<double>*,
+                std::complex<double>*);
+
+            template void abs(size_t, const float*, float*);
+            template void abs(size_t, const double*, double*);
+
+            template void argument(size_t, const std::complex<float>*, float*);
+            template void argument(size_t, const std::complex<double>*, double*);
+
+            template void conjugate(size_t, const std::complex<float>*, std::complex<float>*);
+            template void conjugate(size_t, const std::complex<double>*, std::complex<double>*);
+        }
+    }
+}
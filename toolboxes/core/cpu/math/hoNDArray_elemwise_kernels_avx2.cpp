@@ -0,0 +1,3 @@
+// Compiled with AVX2 and FMA enabled, see CMakeLists.txt
+#define GADGETRON_ELEMWISE_ISA avx2
+#include "hoNDArray_elemwise_kernels.hxx"
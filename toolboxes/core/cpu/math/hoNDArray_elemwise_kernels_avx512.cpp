@@ -0,0 +1,3 @@
+// Compiled with AVX-512 enabled, see CMakeLists.txt
+#define GADGETRON_ELEMWISE_ISA avx512
+#include "hoNDArray_elemwise_kernels.hxx"
@@ -0,0 +1,365 @@
+/** \file   hoNDArray_expressions.h
+    \brief  Lazy, fused evaluation of element-wise hoNDArray arithmetic.
+
+    Every function in hoNDArray_elemwise.h makes a full pass over memory and materializes its result, so an expression
+    like r = a * x + y reads and writes every element several times. For large arrays this is limited by memory
+    bandwidth rather than arithmetic.
+
+    The expressions in this file are opt-in: wrapping an array in lazy() turns arithmetic on it into an expression tree,
+    which is evaluated in a single (OpenMP parallel) pass when it is assigned to a hoNDArray or reduced to a scalar:
+
+        using namespace Gadgetron::expressions;
+        hoNDArray<float> r = a * lazy(x) + lazy(y);      // one pass, no temporaries
+        y += alpha * lazy(x);                            // axpy
+        auto residual = nrm2(lazy(b) - lazy(Ax));        // no temporary for b - Ax
+        auto d = dot(lazy(a) - lazy(b), lazy(a) - lazy(b));
+
+    Expressions hold references to the arrays they were built from, so they must not outlive them. All arrays in an
+    expression must have the same number of elements; broadcasting is not supported. Assigning an expression to one of
+    its own operands is fine, as every element only depends on the same element of the operands.
+
+    Complex values are computed as complext internally, regardless of whether the arrays hold std::complex or complext.
+ */
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "complext.h"
+
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Gadgetron {
+    namespace expressions {
+
+        template <class Node> class hoNDExpression;
+
+        namespace detail {
+
+            // Arrays smaller than this are evaluated by the calling thread only
+            constexpr long long elements_use_threading = 64 * 1024;
+
+            // Reductions sum blocks of this size first, which keeps results independent of the number of threads
+            constexpr size_t reduction_block_size = 4096;
+
+            template <class T> struct internal_type { using type = T; };
+            template <class T> struct internal_type<std::complex<T>> { using type = complext<T>; };
+            template <class T> using internal_type_t = typename internal_type<T>::type;
+
+            template <class T> struct is_scalar : std::is_arithmetic<T> {};
+            template <class T> struct is_scalar<std::complex<T>> : std::true_type {};
+            template <class T> struct is_scalar<complext<T>> : std::true_type {};
+
+            template <class T> struct is_expression : std::false_type {};
+            template <class Node> struct is_expression<hoNDExpression<Node>> : std::true_type {};
+
+            template <class T> struct is_array : std::false_type {};
+            template <class T> struct is_array<hoNDArray<T>> : std::true_type {};
+
+            template <class T>
+            constexpr bool is_operand = is_scalar<T>::value || is_expression<T>::value || is_array<T>::value;
+
+            // Converts an internal value to the type stored in an array or returned to the caller
+            template <class T, class V> T to_element(const V& value) {
+                if constexpr (std::is_same<T, std::complex<realType_t<T>>>::value)
+                    return T(Gadgetron::real(value), Gadgetron::imag(value));
+                else
+                    return T(value);
+            }
+
+            template <class T> struct ArrayNode {
+                using element_type = T;
+                using value_type   = internal_type_t<T>;
+
+                explicit ArrayNode(const hoNDArray<T>& array)
+                    : data{ reinterpret_cast<const value_type*>(array.get_data_ptr()) }, array{ &array } {}
+
+                value_type operator[](size_t i) const { return data[i]; }
+                size_t size() const { return array->get_number_of_elements(); }
+                const std::vector<size_t>* shape() const { return &array->dimensions(); }
+
+                const value_type* data;
+                const hoNDArray<T>* array;
+            };
+
+            template <class T> struct ScalarNode {
+                using element_type = T;
+                using value_type   = internal_type_t<T>;
+
+                explicit ScalarNode(const T& value) : value{ value } {}
+
+                value_type operator[](size_t) const { return value; }
+                size_t size() const { return 0; }
+                const std::vector<size_t>* shape() const { return nullptr; }
+
+                value_type value;
+            };
+
+            template <class Op, class L, class R> struct BinaryNode {
+                using element_type = typename Op::template element_type<typename L::element_type, typename R::element_type>;
+                using value_type = decltype(Op::apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+
+                BinaryNode(L left, R right) : left{ std::move(left) }, right{ std::move(right) } {
+                    if (this->left.size() && this->right.size() && this->left.size() != this->right.size())
+                        throw std::runtime_error("hoNDExpression: operands have different number of elements");
+                }
+
+                value_type operator[](size_t i) const { return Op::apply(left[i], right[i]); }
+                size_t size() const { return left.size() ? left.size() : right.size(); }
+                const std::vector<size_t>* shape() const { return left.size() ? left.shape() : right.shape(); }
+
+                L left;
+                R right;
+            };
+
+            template <class Op, class E> struct UnaryNode {
+                using element_type = typename Op::template element_type<typename E::element_type>;
+                using value_type   = decltype(Op::apply(std::declval<typename E::value_type>()));
+
+                explicit UnaryNode(E operand) : operand{ std::move(operand) } {}
+
+                value_type operator[](size_t i) const { return Op::apply(operand[i]); }
+                size_t size() const { return operand.size(); }
+                const std::vector<size_t>* shape() const { return operand.shape(); }
+
+                E operand;
+            };
+
+            struct Plus {
+                template <class A, class B> using element_type = decltype(std::declval<A>() + std::declval<B>());
+                template <class A, class B> static auto apply(const A& a, const B& b) { return a + b; }
+            };
+            struct Minus {
+                template <class A, class B> using element_type = decltype(std::declval<A>() - std::declval<B>());
+                template <class A, class B> static auto apply(const A& a, const B& b) { return a - b; }
+            };
+            struct Multiplies {
+                template <class A, class B> using element_type = decltype(std::declval<A>() * std::declval<B>());
+                template <class A, class B> static auto apply(const A& a, const B& b) { return a * b; }
+            };
+            struct Divides {
+                template <class A, class B> using element_type = decltype(std::declval<A>() / std::declval<B>());
+                template <class A, class B> static auto apply(const A& a, const B& b) { return a / b; }
+            };
+
+            struct Negate {
+                template <class A> using element_type = A;
+                template <class A> static auto apply(const A& a) { return -a; }
+            };
+            struct Conj {
+                template <class A> using element_type = A;
+                template <class A> static auto apply(const A& a) { return Gadgetron::conj(a); }
+            };
+            struct Abs {
+                template <class A> using element_type = realType_t<A>;
+                template <class A> static auto apply(const A& a) {
+                    using std::abs;
+                    using Gadgetron::abs;
+                    return abs(a);
+                }
+            };
+            struct Norm {
+                template <class A> using element_type = realType_t<A>;
+                template <class A> static auto apply(const A& a) { return Gadgetron::norm(a); }
+            };
+            struct Real {
+                template <class A> using element_type = realType_t<A>;
+                template <class A> static auto apply(const A& a) { return Gadgetron::real(a); }
+            };
+            struct Imag {
+                template <class A> using element_type = realType_t<A>;
+                template <class A> static auto apply(const A& a) { return Gadgetron::imag(a); }
+            };
+            struct Sqrt {
+                template <class A> using element_type = A;
+                template <class A> static auto apply(const A& a) {
+                    using std::sqrt;
+                    using Gadgetron::sqrt;
+                    return sqrt(a);
+                }
+            };
+            struct Exp {
+                template <class A> using element_type = A;
+                template <class A> static auto apply(const A& a) {
+                    using std::exp;
+                    using Gadgetron::exp;
+                    return exp(a);
+                }
+            };
+
+            template <class T> auto as_node(const hoNDExpression<T>& expression) { return expression.node(); }
+            template <class T> auto as_node(const hoNDArray<T>& array) { return ArrayNode<T>(array); }
+            template <class T, class = std::enable_if_t<is_scalar<T>::value>> auto as_node(const T& value) {
+                return ScalarNode<T>(value);
+            }
+
+            template <class Op, class A, class B> auto make_binary(const A& a, const B& b) {
+                using Node = BinaryNode<Op, decltype(as_node(a)), decltype(as_node(b))>;
+                return hoNDExpression<Node>(Node(as_node(a), as_node(b)));
+            }
+
+            template <class Op, class Node> auto make_unary(const hoNDExpression<Node>& e) {
+                using Result = UnaryNode<Op, Node>;
+                return hoNDExpression<Result>(Result(e.node()));
+            }
+
+            template <class A, class B>
+            using enable_if_operands = std::enable_if_t<(is_expression<A>::value || is_expression<B>::value)
+                                                        && is_operand<A> && is_operand<B>>;
+
+            // Writes the expression to out, which must hold node.size() elements
+            template <class Node, class T> void evaluate(const Node& node, T* out) {
+                using V          = internal_type_t<T>;
+                auto destination = reinterpret_cast<V*>(out);
+                long long size   = node.size();
+#pragma omp parallel for if (size > elements_use_threading)
+                for (long long i = 0; i < size; i++)
+                    destination[i] = V(node[i]);
+            }
+
+            // Sums the expression over all elements
+            template <class Node> typename Node::value_type reduce(const Node& node) {
+                using V       = typename Node::value_type;
+                size_t size   = node.size();
+                long long blocks = (size + reduction_block_size - 1) / reduction_block_size;
+
+                std::vector<V> partial(blocks, V(0));
+#pragma omp parallel for if ((long long)size > elements_use_threading)
+                for (long long block = 0; block < blocks; block++) {
+                    size_t end = std::min<size_t>(size, (block + 1) * reduction_block_size);
+                    V sum(0);
+                    for (size_t i = block * reduction_block_size; i < end; i++)
+                        sum += node[i];
+                    partial[block] = sum;
+                }
+
+                V total(0);
+                for (auto& sum : partial)
+                    total += sum;
+                return total;
+            }
+        }
+
+        /**
+         * An unevaluated element-wise expression over hoNDArrays. Created from lazy() and the operators below.
+         */
+        template <class Node> class hoNDExpression {
+        public:
+            using element_type = typename Node::element_type;
+
+            explicit hoNDExpression(Node node) : node_{ std::move(node) } {}
+
+            size_t get_number_of_elements() const { return node_.size(); }
+
+            /// Dimensions of the first array in the expression
+            const std::vector<size_t>& dimensions() const { return *node_.shape(); }
+
+            /// Evaluates element i
+            element_type operator[](size_t i) const { return detail::to_element<element_type>(node_[i]); }
+
+            /// Materializes the expression into a new array
+            template <class T> operator hoNDArray<T>() const {
+                hoNDArray<T> result(dimensions());
+                detail::evaluate(node_, result.get_data_ptr());
+                return result;
+            }
+
+            const Node& node() const { return node_; }
+
+        private:
+            Node node_;
+        };
+
+        /// Starts an expression. The array must outlive the expression.
+        template <class T> hoNDExpression<detail::ArrayNode<T>> lazy(const hoNDArray<T>& array) {
+            return hoNDExpression<detail::ArrayNode<T>>(detail::ArrayNode<T>(array));
+        }
+        template <class T> void lazy(const hoNDArray<T>&& array) = delete;
+
+        /// Materializes the expression into a new array
+        template <class Node> hoNDArray<typename hoNDExpression<Node>::element_type> evaluate(const hoNDExpression<Node>& e) {
+            return e;
+        }
+
+        /// Evaluates the expression into out, reusing the memory of out if it has the right number of elements.
+        template <class T, class Node> hoNDArray<T>& assign(hoNDArray<T>& out, const hoNDExpression<Node>& e) {
+            if (out.get_number_of_elements() != e.get_number_of_elements()) {
+                // Keep the input alive if out is one of the operands
+                hoNDArray<T> result = e;
+                out = std::move(result);
+                return out;
+            }
+            detail::evaluate(e.node(), out.get_data_ptr());
+            return out;
+        }
+
+        // The overloads taking complext are needed to take precedence over the mixed complext operators in complext.h
+#define GADGETRON_EXPRESSION_OPERATOR(op, Op)                                                                          \
+    template <class A, class B, class = detail::enable_if_operands<A, B>> auto operator op(const A& a, const B& b) {   \
+        return detail::make_binary<detail::Op>(a, b);                                                                  \
+    }                                                                                                                  \
+    template <class Node, class T> auto operator op(const hoNDExpression<Node>& a, const complext<T>& b) {             \
+        return detail::make_binary<detail::Op>(a, b);                                                                  \
+    }                                                                                                                  \
+    template <class T, class Node> auto operator op(const complext<T>& a, const hoNDExpression<Node>& b) {             \
+        return detail::make_binary<detail::Op>(a, b);                                                                  \
+    }
+
+        GADGETRON_EXPRESSION_OPERATOR(+, Plus)
+        GADGETRON_EXPRESSION_OPERATOR(-, Minus)
+        GADGETRON_EXPRESSION_OPERATOR(*, Multiplies)
+        GADGETRON_EXPRESSION_OPERATOR(/, Divides)
+
+#undef GADGETRON_EXPRESSION_OPERATOR
+
+        template <class Node> auto operator-(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Negate>(e); }
+        template <class Node> auto conj(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Conj>(e); }
+        template <class Node> auto abs(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Abs>(e); }
+        /// Squared magnitude
+        template <class Node> auto norm(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Norm>(e); }
+        template <class Node> auto real(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Real>(e); }
+        template <class Node> auto imag(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Imag>(e); }
+        template <class Node> auto sqrt(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Sqrt>(e); }
+        template <class Node> auto exp(const hoNDExpression<Node>& e) { return detail::make_unary<detail::Exp>(e); }
+
+        template <class T, class Node> hoNDArray<T>& operator+=(hoNDArray<T>& x, const hoNDExpression<Node>& e) {
+            return assign(x, lazy(x) + e);
+        }
+        template <class T, class Node> hoNDArray<T>& operator-=(hoNDArray<T>& x, const hoNDExpression<Node>& e) {
+            return assign(x, lazy(x) - e);
+        }
+        template <class T, class Node> hoNDArray<T>& operator*=(hoNDArray<T>& x, const hoNDExpression<Node>& e) {
+            return assign(x, lazy(x) * e);
+        }
+        template <class T, class Node> hoNDArray<T>& operator/=(hoNDArray<T>& x, const hoNDExpression<Node>& e) {
+            return assign(x, lazy(x) / e);
+        }
+
+        /// Sum of all elements, evaluated in a single pass
+        template <class Node> auto sum(const hoNDExpression<Node>& e) {
+            using T = typename hoNDExpression<Node>::element_type;
+            return detail::to_element<T>(detail::reduce(e.node()));
+        }
+
+        /// Dot product, conjugating x (if cc is true) as Gadgetron::dot does
+        template <class L, class R> auto dot(const hoNDExpression<L>& x, const hoNDExpression<R>& y, bool cc = true) {
+            return cc ? sum(conj(x) * y) : sum(x * y);
+        }
+
+        /// Euclidean norm
+        template <class Node> auto nrm2(const hoNDExpression<Node>& e) {
+            using std::sqrt;
+            return sqrt(sum(norm(e)));
+        }
+    }
+
+    template <class T>
+    template <class Node>
+    hoNDArray<T>& hoNDArray<T>::operator=(const expressions::hoNDExpression<Node>& expression) {
+        return expressions::assign(*this, expression);
+    }
+}
@@ -436,27 +436,10 @@ template void invert(hoNDArray< std::complex<double> >& A);
 /// ------------------------------------------------------------------------------------
 
 template<typename T>
-void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>& x, double lamda)
+void SolveNormalEquations_Tikhonov(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda)
 {
-    GADGET_CHECK_THROW(b.get_size(0)==A.get_size(0));
-
-    hoNDArray<T> AHA(A.get_size(1), A.get_size(1));
-    Gadgetron::clear(AHA);
-
-    // hoNDArray<T> ACopy(A);
-    // GADGET_CHECK_THROW(gemm(AHA, ACopy, true, A, false));
-
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - A = " << Gadgetron::norm2(A));
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - b = " << Gadgetron::norm2(b));
-
-    char uplo = 'L';
-    bool isAHA = true;
-    herk(AHA, A, uplo, isAHA);
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - AHA = " << Gadgetron::norm2(AHA));
-
-    x.create(A.get_size(1), b.get_size(1));
-    gemm(x, A, true, b, false);
-    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - x = " << Gadgetron::norm2(x));
+    GADGET_CHECK_THROW(AHA.get_size(0)==AHA.get_size(1));
+    GADGET_CHECK_THROW(x.get_size(0)==AHA.get_size(0));
 
     // apply the Tikhonov regularization
     // Ideally, we shall apply the regularization is lamda*maxEigenValue
@@ -491,6 +474,10 @@ void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>&
         Gadgetron::scal( scalingFactor, x);
     }
 
+    // posv overwrites both with the factorization and the solution
+    hoNDArray<T> AHACopy(AHA);
+    hoNDArray<T> rhs(x);
+
     try
     {
         posv(AHA, x);
@@ -499,14 +486,12 @@ void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>&
     catch(...)
     {
         GERROR_STREAM("posv failed in SolveLinearSystem_Tikhonov(... ) ... ");
-        GDEBUG_STREAM("A = " << Gadgetron::nrm2(A));
-        GDEBUG_STREAM("b = " << Gadgetron::nrm2(b));
-        GDEBUG_STREAM("AHA = " << Gadgetron::nrm2(AHA));
+        GDEBUG_STREAM("AHA = " << Gadgetron::nrm2(AHACopy));
         GDEBUG_STREAM("trA = " << trA);
-        GDEBUG_STREAM("x = " << Gadgetron::nrm2(x));
+        GDEBUG_STREAM("x = " << Gadgetron::nrm2(rhs));
 
-        gemm(x, A, true, b, false);
-        GDEBUG_STREAM("SolveLinearSystem_Tikhonov - x = " << Gadgetron::nrm2(x));
+        AHA = AHACopy;
+        x = rhs;
 
         try
         {
@@ -516,8 +501,8 @@ void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>&
         {
             GERROR_STREAM("hesv failed in SolveLinearSystem_Tikhonov(... ) ... ");
 
-            gemm(x, A, true, b, false);
-            GDEBUG_STREAM("SolveLinearSystem_Tikhonov - x = " << Gadgetron::nrm2(x));
+            AHA = AHACopy;
+            x = rhs;
 
             try
             {
@@ -532,6 +517,37 @@ void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>&
     }
 }
 
+template void SolveNormalEquations_Tikhonov(hoNDArray<float>& AHA, hoNDArray<float>& x, double lamda);
+template void SolveNormalEquations_Tikhonov(hoNDArray<double>& AHA, hoNDArray<double>& x, double lamda);
+template void SolveNormalEquations_Tikhonov(hoNDArray< std::complex<float> >& AHA, hoNDArray< std::complex<float> >& x, double lamda);
+template void SolveNormalEquations_Tikhonov(hoNDArray< std::complex<double> >& AHA, hoNDArray< std::complex<double> >& x, double lamda);
+
+template<typename T>
+void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>& x, double lamda)
+{
+    GADGET_CHECK_THROW(b.get_size(0)==A.get_size(0));
+
+    hoNDArray<T> AHA(A.get_size(1), A.get_size(1));
+    Gadgetron::clear(AHA);
+
+    // hoNDArray<T> ACopy(A);
+    // GADGET_CHECK_THROW(gemm(AHA, ACopy, true, A, false));
+
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - A = " << Gadgetron::norm2(A));
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - b = " << Gadgetron::norm2(b));
+
+    char uplo = 'L';
+    bool isAHA = true;
+    herk(AHA, A, uplo, isAHA);
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - AHA = " << Gadgetron::norm2(AHA));
+
+    x.create(A.get_size(1), b.get_size(1));
+    gemm(x, A, true, b, false);
+    //GDEBUG_STREAM("SolveLinearSystem_Tikhonov - x = " << Gadgetron::norm2(x));
+
+    SolveNormalEquations_Tikhonov(AHA, x, lamda);
+}
+
 template void SolveLinearSystem_Tikhonov(hoNDArray<float>& A, hoNDArray<float>& b, hoNDArray<float>& x, double lamda);
 template void SolveLinearSystem_Tikhonov(hoNDArray<double>& A, hoNDArray<double>& b, hoNDArray<double>& x, double lamda);
 template void SolveLinearSystem_Tikhonov(hoNDArray< std::complex<float> >& A, hoNDArray< std::complex<float> >& b, hoNDArray< std::complex<float> >& x, double lamda);
@@ -77,6 +77,11 @@ void gesv(hoNDArray<T>& A, hoNDArray<T>& b);
 template<typename T> 
 void SolveLinearSystem_Tikhonov(hoNDArray<T>& A, hoNDArray<T>& b, hoNDArray<T>& x, double lamda);
 
+/// solve the normal equations AHA*x = AHb with Tikhonov regularization, for AHA and AHb already formed
+/// only the lower triangle of AHA is used; AHA is overwritten, x holds AHb on input and the solution on output
+template<typename T> 
+void SolveNormalEquations_Tikhonov(hoNDArray<T>& AHA, hoNDArray<T>& x, double lamda);
+
 /// Computes the LU factorization of a general m-by-n matrix
 /// this function is called by general matrix inversion
 template<typename T>  
@@ -881,8 +881,8 @@ bool BSplineFFD4D<T, CoordType, DOut>::refine()
 
         for ( d=0; d<DOut; d++ )
         {
-            this->ctrl_pt_[d].create(dim, spacing, origin, axis, new_ctrl_pt[d].begin(), true);
-            new_ctrl_pt[d].delete_data_on_destruct(false);
+            // copy rather than hand over the buffer, it belongs to the allocator of new_ctrl_pt[d]
+            this->ctrl_pt_[d] = new_ctrl_pt[d];
         }
     }
     catch(...)
@@ -2,15 +2,26 @@
 // Include for Visual studio, 'cos reasons.
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <array>
+#include <atomic>
+#include <map>
 #include <numeric>
 #include <set>
+#include <tuple>
 #include <omp.h>
 
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "hoMatrix.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
 #include "hoNDFFT.h"
 #include <boost/container/flat_set.hpp>
+#include <boost/filesystem.hpp>
 
 namespace Gadgetron {
 
@@ -27,51 +38,120 @@ namespace Gadgetron {
         template <class T> struct fftw_types {};
 
         template <> struct fftw_types<float> {
-            using complex                      = fftwf_complex;
-            using plan                         = fftwf_plan_s;
-            static constexpr auto plan_guru    = fftwf_plan_guru64_dft;
-            static constexpr auto plan_dft     = fftwf_plan_dft;
-            static constexpr auto execute_dft  = fftwf_execute_dft;
-            static constexpr auto destroy_plan = fftwf_destroy_plan;
+            using complex                          = fftwf_complex;
+            using plan                             = fftwf_plan_s;
+            static constexpr auto plan_guru        = fftwf_plan_guru64_dft;
+            static constexpr auto plan_dft         = fftwf_plan_dft;
+            static constexpr auto execute_dft      = fftwf_execute_dft;
+            static constexpr auto destroy_plan     = fftwf_destroy_plan;
+            static constexpr auto alignment_of     = fftwf_alignment_of;
+            static constexpr auto malloc           = fftwf_malloc;
+            static constexpr auto free             = fftwf_free;
+            static constexpr auto import_wisdom    = fftwf_import_wisdom_from_filename;
+            static constexpr auto export_wisdom    = fftwf_export_wisdom_to_filename;
+            static constexpr const char* wisdom_file = "fftwf_wisdom";
         };
 
         template <> struct fftw_types<double> {
-            using complex                      = fftw_complex;
-            using plan                         = fftw_plan_s;
-            static constexpr auto plan_guru    = fftw_plan_guru64_dft;
-            static constexpr auto plan_dft     = fftw_plan_dft;
-            static constexpr auto execute_dft  = fftw_execute_dft;
-            static constexpr auto destroy_plan = fftw_destroy_plan;
+            using complex                          = fftw_complex;
+            using plan                             = fftw_plan_s;
+            static constexpr auto plan_guru        = fftw_plan_guru64_dft;
+            static constexpr auto plan_dft         = fftw_plan_dft;
+            static constexpr auto execute_dft      = fftw_execute_dft;
+            static constexpr auto destroy_plan     = fftw_destroy_plan;
+            static constexpr auto alignment_of     = fftw_alignment_of;
+            static constexpr auto malloc           = fftw_malloc;
+            static constexpr auto free             = fftw_free;
+            static constexpr auto import_wisdom    = fftw_import_wisdom_from_filename;
+            static constexpr auto export_wisdom    = fftw_export_wisdom_to_filename;
+            static constexpr const char* wisdom_file = "fftw_wisdom";
         };
+
+        // The FFTW planner (and wisdom) is not thread safe, so all planning goes through this lock.
         class FFTLock {
         protected:
             static std::mutex lock;
         };
         std::mutex FFTLock::lock;
-        template <class T> class SingleFFTPlan : FFTLock {
+
+        struct WisdomLock : FFTLock {
+            static std::mutex& mutex() { return lock; }
+        };
+
+        std::atomic<FFT::PlanningRigor> rigor{ FFT::PlanningRigor::estimate };
+        std::atomic<bool> wisdom_changed{ false };
+
+        unsigned int planner_flags(FFT::PlanningRigor rigor) {
+            switch (rigor) {
+            case FFT::PlanningRigor::measure: return FFTW_MEASURE;
+            case FFT::PlanningRigor::patient: return FFTW_PATIENT;
+            default: return FFTW_ESTIMATE;
+            }
+        }
+
+        /**
+         * Everything FFTW needs to know about a transform for a plan to be reusable: the strided dimensions, direction,
+         * whether the transform is in-place, and whether every array the plan will be executed on is SIMD aligned.
+         */
+        struct PlanKey {
+            std::vector<std::array<ptrdiff_t, 3>> dimensions;
+            bool forward;
+            bool in_place;
+            bool aligned;
+            FFT::PlanningRigor rigor;
+
+            bool operator<(const PlanKey& other) const {
+                return std::tie(dimensions, forward, in_place, aligned, rigor)
+                       < std::tie(other.dimensions, other.forward, other.in_place, other.aligned, other.rigor);
+            }
+        };
+
+        template <class T> class FFTPlan : FFTLock {
         public:
             using FFTWComplex = typename fftw_types<T>::complex;
 
-            SingleFFTPlan(int dimension, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output,
-                bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
+            FFTPlan(const PlanKey& key, const std::complex<T>* input, std::complex<T>* output) {
+                auto fftw_dimensions = std::vector<fftw_iodim64>();
+                for (auto& d : key.dimensions)
+                    fftw_dimensions.push_back(fftw_iodim64{ d[0], d[1], d[2] });
 
-                const auto& dimensions = input.dimensions();
-                size_t stride
-                    = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
+                auto flags = planner_flags(key.rigor) | (key.aligned ? 0u : unsigned(FFTW_UNALIGNED));
 
-                auto fftw_dimensions = fftw_iodim64{ static_cast<ptrdiff_t>(dimensions[dimension]), static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) };
+                std::lock_guard<std::mutex> guard(lock);
+                if (key.rigor == FFT::PlanningRigor::estimate) {
+                    // Estimating does not touch the arrays, so the caller's arrays can be used directly.
+                    plan = fftw_types<T>::plan_guru(int(fftw_dimensions.size()), fftw_dimensions.data(), 0, nullptr,
+                        (FFTWComplex*)input, (FFTWComplex*)output, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+                } else {
+                    // Measuring overwrites the arrays, so plan on scratch arrays of the same extent.
+                    size_t extent = 1;
+                    for (auto& d : key.dimensions)
+                        extent += (d[0] - 1) * std::max(d[1], d[2]);
+
+                    auto scratch_in  = (FFTWComplex*)fftw_types<T>::malloc(extent * sizeof(FFTWComplex));
+                    auto scratch_out = key.in_place
+                                           ? scratch_in
+                                           : (FFTWComplex*)fftw_types<T>::malloc(extent * sizeof(FFTWComplex));
+                    plan = fftw_types<T>::plan_guru(int(fftw_dimensions.size()), fftw_dimensions.data(), 0, nullptr,
+                        scratch_in, scratch_out, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+                    if (scratch_out != scratch_in)
+                        fftw_types<T>::free(scratch_out);
+                    fftw_types<T>::free(scratch_in);
+                    wisdom_changed = true;
+                }
 
-                plan = fftw_types<T>::plan_guru(1, &fftw_dimensions, 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
             }
 
-            ~SingleFFTPlan() {
+            ~FFTPlan() {
                 std::lock_guard<std::mutex> guard(lock);
                 fftw_types<T>::destroy_plan(plan);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
+            FFTPlan(const FFTPlan&) = delete;
+            FFTPlan& operator=(const FFTPlan&) = delete;
+
+            void execute(const std::complex<T>* input, std::complex<T>* output) const {
                 fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
             }
 
@@ -79,43 +159,93 @@ namespace Gadgetron {
             typename fftw_types<T>::plan* plan;
         };
 
-        template <class T> class ContigousFFTPlan : FFTLock {
+        /**
+         * Plans are cached for the lifetime of the process, so repeated transforms of the same size (slices,
+         * repetitions, ...) only pay for planning once. Plans are shared, so evicting a plan in use is safe.
+         */
+        template <class T> class PlanCache {
         public:
-            using FFTWComplex = typename fftw_types<T>::complex;
-            ContigousFFTPlan(
-                int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
-
-                const auto& dimensions = input.dimensions();
-
-                auto strides = std::vector<size_t>(rank + 1, 1);
-                std::partial_sum(
-                    dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
-
-                auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+            static PlanCache& instance() {
+                static PlanCache cache;
+                return cache;
+            }
 
-                for (int i = 0; i < rank; i++) {
-                    fftw_dimensions[i] = { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] };
+            std::shared_ptr<const FFTPlan<T>> get(
+                const PlanKey& key, const std::complex<T>* input, std::complex<T>* output) {
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    auto it = plans.find(key);
+                    if (it != plans.end())
+                        return it->second;
                 }
-                std::reverse(fftw_dimensions.begin(),fftw_dimensions.end());
-                plan = fftw_types<T>::plan_guru(rank, fftw_dimensions.data(), 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
 
-                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
-            }
-            ~ContigousFFTPlan() {
-                std::lock_guard<std::mutex> guard(lock);
-                fftw_types<T>::destroy_plan(plan);
-            }
+                // Planning can take a while with measure/patient; the cache stays available in the meantime.
+                auto plan = std::make_shared<const FFTPlan<T>>(key, input, output);
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
-                fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
+                std::lock_guard<std::mutex> guard(mutex);
+                if (plans.size() >= max_plans)
+                    plans.clear();
+                return plans.emplace(key, std::move(plan)).first->second;
             }
 
         private:
-            typename fftw_types<T>::plan* plan;
+            static constexpr size_t max_plans = 512;
+
+            std::mutex mutex;
+            std::map<PlanKey, std::shared_ptr<const FFTPlan<T>>> plans;
         };
 
+        // FFTW only cares about alignment modulo the SIMD width, so checking the first two of a set of equally spaced
+        // arrays is enough.
+        template <class T>
+        bool is_aligned(const std::complex<T>* base, std::initializer_list<size_t> offsets) {
+            auto alignment_of = [](const std::complex<T>* ptr) {
+                return fftw_types<T>::alignment_of(const_cast<T*>(reinterpret_cast<const T*>(ptr)));
+            };
+            if (alignment_of(base) != 0)
+                return false;
+            return std::all_of(
+                offsets.begin(), offsets.end(), [&](size_t offset) { return alignment_of(base + offset) == 0; });
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> get_plan(std::vector<std::array<ptrdiff_t, 3>> dimensions, bool forward,
+            const std::complex<T>* input, std::complex<T>* output, std::initializer_list<size_t> offsets) {
+            auto key = PlanKey{ std::move(dimensions), forward, input == output,
+                is_aligned<T>(input, offsets) && is_aligned<T>(output, offsets), rigor.load() };
+            return PlanCache<T>::instance().get(key, input, output);
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> single_fft_plan(int dimension, const hoNDArray<std::complex<T>>& input,
+            hoNDArray<std::complex<T>>& output, bool forward) {
+            const auto& dimensions = input.dimensions();
+            size_t stride = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, size_t(1), std::multiplies<>());
+            size_t outer_stride = stride * dimensions[dimension];
+
+            return get_plan<T>({ { ptrdiff_t(dimensions[dimension]), ptrdiff_t(stride), ptrdiff_t(stride) } }, forward,
+                input.data(), output.data(),
+                { stride > 1 ? size_t(1) : size_t(0), input.size() > outer_stride ? outer_stride : size_t(0) });
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> contigous_fft_plan(int rank, const hoNDArray<std::complex<T>>& input,
+            hoNDArray<std::complex<T>>& output, bool forward) {
+            const auto& dimensions = input.dimensions();
+
+            auto strides = std::vector<size_t>(rank + 1, 1);
+            std::partial_sum(dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+
+            auto fftw_dimensions = std::vector<std::array<ptrdiff_t, 3>>(rank);
+            for (int i = 0; i < rank; i++) {
+                fftw_dimensions[i] = { ptrdiff_t(dimensions[i]), ptrdiff_t(strides[i]), ptrdiff_t(strides[i]) };
+            }
+            std::reverse(fftw_dimensions.begin(), fftw_dimensions.end());
+
+            auto batch_size = strides[rank];
+            return get_plan<T>(std::move(fftw_dimensions), forward, input.data(), output.data(),
+                { input.size() > batch_size ? batch_size : size_t(0) });
+        }
 
         int contigous_rank(const boost::container::flat_set<int>& dimensions) {
             if (!dimensions.count(0))
@@ -131,7 +261,7 @@ namespace Gadgetron {
         static void contigous_fftn(const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, int rank,
             bool forward, bool normalize) {
 
-            auto plan = ContigousFFTPlan<T>(rank, input, output, forward);
+            auto plan = contigous_fft_plan(rank, input, output, forward);
             size_t batch_size
                 = std::accumulate(input.dimensions().begin(), input.dimensions().begin() + rank, 1, std::multiplies<>());
             size_t batches = input.size() / batch_size;
@@ -139,7 +269,7 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan,  input, output, batches, batch_size)
             for (long long i = 0; i < batches; i++) {
 
-                plan.execute(input.data() + i * batch_size, output.data() + i * batch_size);
+                plan->execute(input.data() + i * batch_size, output.data() + i * batch_size);
             }
 
             if (normalize)
@@ -150,7 +280,7 @@ namespace Gadgetron {
         static void single_fft(int dimension, const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r,
             bool forward, bool normalize) {
             assert(dimension >= 0);
-            auto plan              = SingleFFTPlan<T>(dimension, a, r, forward);
+            auto plan              = single_fft_plan(dimension, a, r, forward);
             const auto& dimensions = a.dimensions();
             size_t inner_batches
                 = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
@@ -161,7 +291,7 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan, a, r , outer_batches, inner_batches, outer_batchsize ) collapse(2)
             for (long long outer = 0; outer < outer_batches; outer++) {
                 for (long long inner = 0; inner < inner_batches; inner++) {
-                    plan.execute(
+                    plan->execute(
                         a.data() + inner + outer * outer_batchsize, r.data() + inner + outer * outer_batchsize);
                 }
             }
@@ -813,6 +943,69 @@ namespace Gadgetron {
     }
 
 
+    namespace {
+        template <class T> bool import_wisdom_file(const boost::filesystem::path& directory) {
+            auto file = directory / fftw_types<T>::wisdom_file;
+            boost::system::error_code ec;
+            if (!boost::filesystem::exists(file, ec))
+                return false;
+            return fftw_types<T>::import_wisdom(file.string().c_str()) != 0;
+        }
+
+        template <class T> bool export_wisdom_file(const boost::filesystem::path& directory) {
+            auto file = directory / fftw_types<T>::wisdom_file;
+            auto temporary = file;
+#ifdef _WIN32
+            temporary += "." + std::to_string(_getpid());
+#else
+            temporary += "." + std::to_string(getpid());
+#endif
+
+            // Merge with whatever other processes have written since we last read the file.
+            import_wisdom_file<T>(directory);
+            if (!fftw_types<T>::export_wisdom(temporary.string().c_str()))
+                return false;
+
+            boost::system::error_code ec;
+            boost::filesystem::rename(temporary, file, ec);
+            return !ec;
+        }
+    }
+
+    void FFT::set_planning_rigor(PlanningRigor planning_rigor) {
+        rigor = planning_rigor;
+    }
+
+    FFT::PlanningRigor FFT::planning_rigor() {
+        return rigor;
+    }
+
+    FFT::PlanningRigor FFT::planning_rigor_from_string(const std::string& name) {
+        if (name == "estimate") return PlanningRigor::estimate;
+        if (name == "measure") return PlanningRigor::measure;
+        if (name == "patient") return PlanningRigor::patient;
+        throw std::invalid_argument("Unknown FFT planning rigor: " + name);
+    }
+
+    bool FFT::import_wisdom(const boost::filesystem::path& directory) {
+        std::lock_guard<std::mutex> guard(WisdomLock::mutex());
+        auto imported_float  = import_wisdom_file<float>(directory);
+        auto imported_double = import_wisdom_file<double>(directory);
+        return imported_float || imported_double;
+    }
+
+    bool FFT::export_wisdom(const boost::filesystem::path& directory) {
+        std::lock_guard<std::mutex> guard(WisdomLock::mutex());
+        if (!wisdom_changed.exchange(false))
+            return true;
+
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(directory, ec);
+        if (ec)
+            return false;
+        return export_wisdom_file<float>(directory) && export_wisdom_file<double>(directory);
+    }
+
     template <class ComplexType, class ENABLER>
     void FFT::fft(hoNDArray<ComplexType>& data, std::vector<size_t> dimensions) {
         std::sort(dimensions.begin(), dimensions.end());
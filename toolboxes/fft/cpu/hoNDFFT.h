@@ -9,6 +9,7 @@
 #include "hoNDArray.h"
 
 #include "complext.h"
+#include <boost/filesystem/path.hpp>
 #include <complex>
 #include <fftw3.h>
 #include <iostream>
@@ -107,6 +108,33 @@ template <class ComplexType,
           class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
 hoNDArray<ComplexType> ifft3c(const hoNDArray<ComplexType> &data);
 
+/**
+ * How much effort FFTW spends finding a fast plan. Plans are cached per transform size, so the planning cost of
+ * measure and patient is only paid the first time a size is seen (or never, if the wisdom already covers it).
+ */
+enum class PlanningRigor { estimate, measure, patient };
+
+EXPORTCPUFFT void set_planning_rigor(PlanningRigor rigor);
+EXPORTCPUFFT PlanningRigor planning_rigor();
+
+/**
+ * Parses "estimate", "measure" or "patient".
+ */
+EXPORTCPUFFT PlanningRigor planning_rigor_from_string(const std::string& name);
+
+/**
+ * Loads FFTW wisdom (for both single and double precision) from the directory.
+ * @return True if any wisdom was loaded
+ */
+EXPORTCPUFFT bool import_wisdom(const boost::filesystem::path& directory);
+
+/**
+ * Saves the accumulated FFTW wisdom to the directory, merged with the wisdom already there. Does nothing if no new
+ * plans have been measured since the last export.
+ * @return False if the wisdom could not be written
+ */
+EXPORTCPUFFT bool export_wisdom(const boost::filesystem::path& directory);
+
 }
 
 
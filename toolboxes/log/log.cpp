@@ -6,22 +6,495 @@
 #include <time.h>
 #include <cstring>
 #include <chrono>
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <unordered_map>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace
+{
+  using Clock = std::chrono::system_clock;
+
+  struct LogRecord
+  {
+    Gadgetron::GadgetronLogLevel level;
+    std::string filename;
+    int lineno;
+    Clock::time_point time;
+    unsigned int thread;
+    std::string message;
+  };
+
+  // The messages logged by one thread and not yet written. The thread adds records at the head, and the drain
+  // removes them at the tail; neither takes a lock. Records are reused, so their strings keep their capacity.
+  class LogRing
+  {
+  public:
+    static constexpr size_t capacity = 512;
+
+    bool full() const { return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) >= capacity; }
+    LogRecord& next() { return records[head.load(std::memory_order_relaxed) % capacity]; }
+    void publish() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    size_t begin() const { return tail.load(std::memory_order_relaxed); }
+    size_t end() const { return head.load(std::memory_order_acquire); }
+    LogRecord& at(size_t index) { return records[index % capacity]; }
+    void release(size_t end) { tail.store(end, std::memory_order_release); }
+
+    void discard() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Set when the thread is done with the ring; it is dropped once drained.
+    std::atomic<bool> abandoned{false};
+
+    // The thread logging to the ring
+    const std::thread::id owner = std::this_thread::get_id();
+
+  private:
+    LogRecord records[capacity];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+  };
+
+  unsigned int thread_number()
+  {
+    static std::atomic<unsigned int> threads{0};
+    thread_local unsigned int number = threads++;
+    return number;
+  }
+
+  void format_message(std::string& out, const char* cformatting, va_list args)
+  {
+    char buffer[512];
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(buffer, sizeof(buffer), cformatting, copy);
+    va_end(copy);
+
+    if (length < 0) {
+      out.clear();
+    } else if (size_t(length) < sizeof(buffer)) {
+      out.assign(buffer, length);
+    } else {
+      out.resize(length);
+      vsnprintf(&out[0], length + 1, cformatting, args);
+    }
+  }
+
+  const char* level_name(Gadgetron::GadgetronLogLevel LEVEL)
+  {
+    switch (LEVEL) {
+    case Gadgetron::GADGETRON_LOG_LEVEL_DEBUG:
+      return "DEBUG";
+    case Gadgetron::GADGETRON_LOG_LEVEL_INFO:
+      return "INFO";
+    case Gadgetron::GADGETRON_LOG_LEVEL_WARNING:
+      return "WARNING";
+    case Gadgetron::GADGETRON_LOG_LEVEL_ERROR:
+      return "ERROR";
+    case Gadgetron::GADGETRON_LOG_LEVEL_VERBOSE:
+      return "VERBOSE";
+    default:
+      return "";
+    }
+  }
+
+  const char* base_name(const std::string& filename)
+  {
+    const char* base_start = strrchr(filename.c_str(),'/');
+    if (!base_start) {
+      base_start = strrchr(filename.c_str(),'\\'); //Maybe using backslashes
+    }
+    return base_start ? base_start + 1 : filename.c_str();
+  }
+
+  void append_json_string(std::string& out, const char* begin, const char* end)
+  {
+    out += '"';
+    for (const char* c = begin; c != end; c++) {
+      switch (*c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+          out += escaped;
+        } else {
+          out += *c;
+        }
+      }
+    }
+    out += '"';
+  }
+}
 
 namespace Gadgetron
 {
+  struct GadgetronLogger::Backend
+  {
+    explicit Backend(const GadgetronLogger& logger) : logger(logger)
+    {
+      static std::atomic<uint64_t> loggers{0};
+      id = ++loggers;
+    }
+
+    // Called with the drain mutex held, by whoever writes: the logging thread, the writer thread, or flush.
+    void emit(const LogRecord& record)
+    {
+      auto limit = rate_limit.load(std::memory_order_relaxed);
+      if (limit) {
+        site_key = record.filename;
+        site_key += ':';
+        site_key += std::to_string(record.lineno);
+
+        auto found = sites.find(site_key);
+        if (found == sites.end()) {
+          found = sites.emplace(site_key, Site{record.filename, record.lineno, record.level, record.time, 0, 0}).first;
+        }
+
+        auto& site = found->second;
+        if (record.time - site.window >= std::chrono::seconds(1)) {
+          report_suppressed(site, record.time, record.thread);
+          site.window = record.time;
+          site.count = 0;
+        }
+
+        if (site.count >= limit) {
+          site.suppressed++;
+          return;
+        }
+        site.count++;
+      }
+
+      write(record.level, record.filename, record.lineno, record.time, record.thread, record.message, 0);
+    }
+
+    // Reports sites that have stopped logging since messages from them were suppressed.
+    void sweep(Clock::time_point now)
+    {
+      if (sites.empty() || now - last_sweep < std::chrono::seconds(1)) return;
+      last_sweep = now;
+
+      for (auto& entry : sites) {
+        auto& site = entry.second;
+        if (site.suppressed && now - site.window >= std::chrono::seconds(1)) {
+          report_suppressed(site, now, thread_number());
+          site.window = now;
+          site.count = 0;
+        }
+      }
+    }
+
+    // Writes out everything the threads have logged, in the order it was logged.
+    void drain()
+    {
+      {
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        draining = rings;
+      }
+
+      pending.clear();
+      ends.resize(draining.size());
+      for (size_t i = 0; i < draining.size(); i++) {
+        auto& ring = *draining[i];
+        ends[i] = ring.end();
+        for (size_t index = ring.begin(); index < ends[i]; index++) {
+          pending.push_back(&ring.at(index));
+        }
+      }
+
+      std::stable_sort(pending.begin(), pending.end(),
+                       [](const LogRecord* a, const LogRecord* b) { return a->time < b->time; });
+      for (auto record : pending) emit(*record);
+
+      for (size_t i = 0; i < draining.size(); i++) {
+        draining[i]->release(ends[i]);
+      }
+
+      sweep(Clock::now());
+      fflush(output.load());
+
+      std::lock_guard<std::mutex> guard(registry_mutex);
+      rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<LogRing>& ring) {
+        return ring->abandoned.load() && ring->begin() == ring->end();
+      }), rings.end());
+      draining.clear();
+    }
+
+    LogRing& thread_ring()
+    {
+      struct ThreadRing
+      {
+        uint64_t logger = 0;
+        std::shared_ptr<LogRing> ring;
+        ~ThreadRing() { if (ring) ring->abandoned = true; }
+      };
+      thread_local ThreadRing local;
+
+      if (local.logger != id) {
+        if (local.ring) local.ring->abandoned = true;
+        local.ring = std::make_shared<LogRing>();
+        local.logger = id;
+
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        rings.push_back(local.ring);
+      }
+      return *local.ring;
+    }
+
+    void ensure_writer()
+    {
+      if (writer_running.load(std::memory_order_acquire)) return;
+
+      std::lock_guard<std::mutex> guard(registry_mutex);
+      if (writer_running.load()) return;
+
+      stopping = false;
+      writer = std::make_unique<std::thread>([this]() {
+        while (!stopping.load()) {
+          {
+            std::lock_guard<std::mutex> guard(drain_mutex);
+            drain();
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+      });
+      writer_running = true;
+    }
+
+    void stop_writer()
+    {
+      std::unique_ptr<std::thread> stopped;
+      {
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        stopping = true;
+        stopped = std::move(writer);
+        writer_running = false;
+      }
+      if (stopped && stopped->joinable()) stopped->join();
+    }
+
+    // After a fork, only the forking thread exists in the child. Messages logged before the fork are written by
+    // the parent; the child starts its own writer when it next logs. The rings of the other threads will never be
+    // written to again, so they are dropped.
+    void forked()
+    {
+      auto self = std::this_thread::get_id();
+      rings.erase(std::remove_if(rings.begin(), rings.end(), [self](const std::shared_ptr<LogRing>& ring) {
+        return ring->owner != self;
+      }), rings.end());
+      for (auto& ring : rings) ring->discard();
+      writer.release();
+      writer_running = false;
+    }
+
+    // Every live backend, so they can be flushed at exit and made safe across fork.
+    static std::mutex& all_mutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    static std::set<Backend*>& all()
+    {
+      static std::set<Backend*> backends;
+      return backends;
+    }
+
+    static void flush_all()
+    {
+      std::lock_guard<std::mutex> guard(all_mutex());
+      for (auto backend : all()) {
+        std::lock_guard<std::mutex> drain_guard(backend->drain_mutex);
+        backend->drain();
+      }
+    }
+
+#ifndef _WIN32
+    static void prepare_fork()
+    {
+      all_mutex().lock();
+      for (auto backend : all()) {
+        backend->drain_mutex.lock();
+        backend->registry_mutex.lock();
+      }
+    }
+
+    static void after_fork_in_parent()
+    {
+      for (auto backend : all()) {
+        backend->registry_mutex.unlock();
+        backend->drain_mutex.unlock();
+      }
+      all_mutex().unlock();
+    }
+
+    static void after_fork_in_child()
+    {
+      for (auto backend : all()) {
+        backend->forked();
+        backend->registry_mutex.unlock();
+        backend->drain_mutex.unlock();
+      }
+      all_mutex().unlock();
+    }
+#endif
+
+    static void add(Backend* backend)
+    {
+      // Constructed before the exit handlers are registered, so they are still there when the handlers run.
+      all_mutex();
+      all();
+
+      static std::once_flag handlers;
+      std::call_once(handlers, []() {
+        std::atexit(flush_all);
+        std::at_quick_exit(flush_all);
+#ifndef _WIN32
+        pthread_atfork(prepare_fork, after_fork_in_parent, after_fork_in_child);
+#endif
+      });
+
+      std::lock_guard<std::mutex> guard(all_mutex());
+      all().insert(backend);
+    }
+
+    static void remove(Backend* backend)
+    {
+      std::lock_guard<std::mutex> guard(all_mutex());
+      all().erase(backend);
+    }
+
+    const GadgetronLogger& logger;
+    uint64_t id;
+
+    std::atomic<bool> async{false};
+    std::atomic<int> format{GADGETRON_LOG_FORMAT_TEXT};
+    std::atomic<unsigned int> rate_limit{0};
+    std::atomic<FILE*> output{stderr};
+
+    std::mutex registry_mutex; // Taken after the drain mutex, if both are needed
+    std::vector<std::shared_ptr<LogRing>> rings;
+    std::unique_ptr<std::thread> writer;
+    std::atomic<bool> writer_running{false};
+    std::atomic<bool> stopping{false};
+
+    std::mutex drain_mutex;
+
+  private:
+    struct Site
+    {
+      std::string filename;
+      int lineno;
+      GadgetronLogLevel level;
+      Clock::time_point window;
+      unsigned int count;
+      unsigned long suppressed;
+    };
+
+    void report_suppressed(Site& site, Clock::time_point time, unsigned int thread)
+    {
+      if (!site.suppressed) return;
+      notice = "Suppressed " + std::to_string(site.suppressed) + " messages logged here within a second\n";
+      write(site.level, site.filename, site.lineno, time, thread, notice, site.suppressed);
+      site.suppressed = 0;
+    }
+
+    void write(GadgetronLogLevel LEVEL, const std::string& filename, int lineno, Clock::time_point time,
+               unsigned int thread, const std::string& message, unsigned long suppressed)
+    {
+      time_t rawtime = Clock::to_time_t(time);
+      struct tm timeinfo;
+#ifdef _WIN32
+      localtime_s(&timeinfo, &rawtime);
+#else
+      localtime_r(&rawtime, &timeinfo);
+#endif
+      auto micros = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count() % 1000000;
+
+      const char* file = logger.isOutputOptionEnabled(GADGETRON_LOG_PRINT_FOLDER) ? filename.c_str() : base_name(filename);
+
+      line.clear();
+      if (format.load() == GADGETRON_LOG_FORMAT_JSON) {
+        char timestr[64];
+        snprintf(timestr, sizeof(timestr), "%04d-%02d-%02dT%02d:%02d:%02d.%06d",
+                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+                 timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec, int(micros));
+
+        auto end = message.c_str() + message.size();
+        while (end != message.c_str() && (end[-1] == '\n' || end[-1] == '\r')) end--;
+
+        line += "{\"time\":\"";
+        line += timestr;
+        line += "\",\"level\":\"";
+        line += level_name(LEVEL);
+        line += "\",\"file\":";
+        append_json_string(line, file, file + strlen(file));
+        line += ",\"line\":" + std::to_string(lineno);
+        line += ",\"thread\":" + std::to_string(thread);
+        line += ",\"message\":";
+        append_json_string(line, message.c_str(), end);
+        if (suppressed) line += ",\"suppressed\":" + std::to_string(suppressed);
+        line += "}\n";
+      } else {
+        if (logger.isOutputOptionEnabled(GADGETRON_LOG_PRINT_DATETIME)) {
+          //Time the format MM-DD HH:MM:SS.uuu
+          char timestr[66];snprintf(timestr, 66, "%02d-%02d %02d:%02d:%02d.%03d ",
+                                    timeinfo.tm_mon+1, timeinfo.tm_mday,
+                                    timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec, int(micros/1000));
+          line += timestr;
+        }
+
+        if (logger.isOutputOptionEnabled(GADGETRON_LOG_PRINT_LEVEL) && LEVEL != GADGETRON_LOG_LEVEL_VERBOSE) {
+          line += level_name(LEVEL);
+          line += ' ';
+        }
+
+        if (logger.isOutputOptionEnabled(GADGETRON_LOG_PRINT_FILELOC)) {
+          line += '[';
+          line += file;
+          line += ':' + std::to_string(lineno) + "] ";
+        }
+
+        line += message;
+      }
+
+      fwrite(line.data(), 1, line.size(), output.load());
+    }
+
+    std::string line;
+    std::string notice;
+    std::string site_key;
+    std::unordered_map<std::string, Site> sites;
+    Clock::time_point last_sweep;
+
+    std::vector<std::shared_ptr<LogRing>> draining;
+    std::vector<size_t> ends;
+    std::vector<LogRecord*> pending;
+  };
+
   GadgetronLogger* GadgetronLogger::instance()
   {
-    if (!instance_) instance_ = new GadgetronLogger();
-    return instance_;
+    static GadgetronLogger* logger = instance_ = new GadgetronLogger();
+    return logger;
   }
 
   GadgetronLogger* GadgetronLogger::instance_ = NULL;
 
   GadgetronLogger::GadgetronLogger()
-    : level_mask_(GADGETRON_LOG_LEVEL_MAX,false)
-    , print_mask_(GADGETRON_LOG_PRINT_MAX, false)
+    : level_mask_(0)
+    , print_mask_(0)
+    , backend_(std::make_unique<Backend>(*this))
   {
+    Backend::add(backend_.get());
+
     char* log_mask = getenv(GADGETRON_LOG_MASK_ENVIRONMENT);
     if ( log_mask != NULL) {
 
@@ -31,8 +504,7 @@ namespace Gadgetron
       if (log_mask_str.find("ALL") != std::string::npos) {
 	enableAllOutputOptions();
 	enableAllLogLevels();
-	return;
-      }
+      } else {
 
       if (log_mask_str.find("LEVEL_DEBUG") != std::string::npos)
 	enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
@@ -54,6 +526,7 @@ namespace Gadgetron
 
       if (log_mask_str.find("PRINT_DATETIME") != std::string::npos)
 	enableOutputOption(GADGETRON_LOG_PRINT_DATETIME);
+      }
     } else {
       enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
       enableLogLevel(GADGETRON_LOG_LEVEL_INFO);
@@ -74,6 +547,28 @@ namespace Gadgetron
          fflush(stderr);
        }
     }
+
+    char* log_format = getenv(GADGETRON_LOG_FORMAT_ENVIRONMENT);
+    if (log_format != NULL && std::string(log_format) == "json") {
+      setFormat(GADGETRON_LOG_FORMAT_JSON);
+    }
+
+    char* rate_limit = getenv(GADGETRON_LOG_RATE_LIMIT_ENVIRONMENT);
+    if (rate_limit != NULL) {
+      setRateLimit(static_cast<unsigned int>(strtoul(rate_limit, NULL, 10)));
+    }
+
+    char* log_mode = getenv(GADGETRON_LOG_MODE_ENVIRONMENT);
+    if (log_mode != NULL && std::string(log_mode) == "async") {
+      enableAsync();
+    }
+  }
+
+  GadgetronLogger::~GadgetronLogger()
+  {
+    backend_->stop_writer();
+    flush();
+    Backend::remove(backend_.get());
   }
 
 
@@ -82,143 +577,142 @@ namespace Gadgetron
     //Check if we should log this message
     if (!isLevelEnabled(LEVEL)) return;
 
-    std::unique_lock<std::mutex> lock(m);
-    const char* fmt = cformatting;
-    std::string fmt_str;
-    bool append_cformatting_needed = false; //Will be set to true if we add any additional labels
-
-    if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_DATETIME)) {
-      time_t rawtime;
-      struct tm * timeinfo;
-
-      auto curtime= std::chrono::system_clock::now();
-      rawtime = std::chrono::system_clock::to_time_t(curtime);
-      timeinfo = localtime ( &rawtime );
-
-      auto duration = curtime.time_since_epoch();
-      int micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count() % 1000000;
-
-      //Time the format MM-DD HH:MM:SS.uuu
-      char timestr[66];snprintf(timestr, 66, "%02d-%02d %02d:%02d:%02d.%03d ",
-                                timeinfo->tm_mon+1, timeinfo->tm_mday,
-                                timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, micros/1000);
-
-      fmt_str += std::string(timestr);
-      append_cformatting_needed = true;
-    }
-
-    if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_LEVEL)) {
-      switch (LEVEL) {
-      case GADGETRON_LOG_LEVEL_DEBUG:
-	fmt_str += "DEBUG ";
-	break;
-      case GADGETRON_LOG_LEVEL_INFO:
-	fmt_str += "INFO ";
-	break;
-      case GADGETRON_LOG_LEVEL_WARNING:
-	fmt_str += "WARNING ";
-	break;
-      case GADGETRON_LOG_LEVEL_ERROR:
-	fmt_str += "ERROR ";
-	break;
-      default:
-	;
-      }
-      append_cformatting_needed = true;
-    }
-
-    if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_FILELOC)) {
-      if (!isOutputOptionEnabled(GADGETRON_LOG_PRINT_FOLDER)) {
-	const char* base_start = strrchr(filename,'/');
-	if (!base_start) {
-	  base_start = strrchr(filename,'\\'); //Maybe using backslashes
-	}
-	if (base_start) {
-	  base_start++;
-	  fmt_str += std::string("[") + std::string(base_start);
-	} else {
-	  fmt_str += std::string("[") + std::string(filename);
-	}
-      } else {
-	fmt_str += std::string("[") + std::string(filename);
+    va_list args;
+    va_start (args, cformatting);
+
+    if (backend_->async.load(std::memory_order_relaxed)) {
+      auto& ring = backend_->thread_ring();
+      while (ring.full()) {
+        backend_->ensure_writer();
+        std::this_thread::yield();
       }
-      char linenostr[8];snprintf(linenostr, 8, "%d", lineno);
-      fmt_str += std::string(":") + std::string(linenostr);
-      fmt_str += std::string("] ");
-      append_cformatting_needed = true;
-    }
 
-    if (append_cformatting_needed) {
-      fmt_str += std::string(cformatting);
-      fmt = fmt_str.c_str();
+      auto& record = ring.next();
+      record.level = LEVEL;
+      record.filename.assign(filename);
+      record.lineno = lineno;
+      record.time = Clock::now();
+      record.thread = thread_number();
+      format_message(record.message, cformatting, args);
+      ring.publish();
+
+      backend_->ensure_writer();
+    } else {
+      thread_local LogRecord record;
+      record.level = LEVEL;
+      record.filename.assign(filename);
+      record.lineno = lineno;
+      record.time = Clock::now();
+      record.thread = thread_number();
+      format_message(record.message, cformatting, args);
+
+      std::lock_guard<std::mutex> guard(backend_->drain_mutex);
+      backend_->emit(record);
+      backend_->sweep(record.time);
+      fflush(backend_->output.load());
     }
 
-    va_list args;
-    va_start (args, cformatting);
-    vfprintf(stderr, fmt, args);
     va_end (args);
-    fflush(stderr);
   }
 
-  void GadgetronLogger::enableLogLevel(GadgetronLogLevel LEVEL)
+  void GadgetronLogger::enableAsync()
   {
-    if (LEVEL < level_mask_.size()) {
-      level_mask_[LEVEL] = true;
-    }
+    backend_->async = true;
+    backend_->ensure_writer();
   }
 
-  void GadgetronLogger::disableLogLevel(GadgetronLogLevel LEVEL)
+  void GadgetronLogger::disableAsync()
+  {
+    backend_->async = false;
+    backend_->stop_writer();
+    flush();
+  }
+
+  bool GadgetronLogger::isAsync() const
   {
-    if (LEVEL < level_mask_.size()) {
-      level_mask_[LEVEL] = false;
+    return backend_->async.load();
+  }
+
+  void GadgetronLogger::setFormat(GadgetronLogFormat FORMAT)
+  {
+    backend_->format = FORMAT;
+  }
+
+  GadgetronLogFormat GadgetronLogger::format() const
+  {
+    return static_cast<GadgetronLogFormat>(backend_->format.load());
+  }
+
+  void GadgetronLogger::setRateLimit(unsigned int messages_per_second)
+  {
+    backend_->rate_limit = messages_per_second;
+  }
+
+  void GadgetronLogger::flush()
+  {
+    std::lock_guard<std::mutex> guard(backend_->drain_mutex);
+    backend_->drain();
+  }
+
+  void GadgetronLogger::setOutput(FILE* output)
+  {
+    flush();
+    backend_->output = output;
+  }
+
+  void GadgetronLogger::enableLogLevel(GadgetronLogLevel LEVEL)
+  {
+    if (LEVEL < GADGETRON_LOG_LEVEL_MAX) {
+      level_mask_ |= (1u << LEVEL);
     }
   }
 
-  bool GadgetronLogger::isLevelEnabled(GadgetronLogLevel LEVEL)
+  void GadgetronLogger::disableLogLevel(GadgetronLogLevel LEVEL)
   {
-    if (LEVEL >= level_mask_.size()) return false;
-    return level_mask_[LEVEL];
+    if (LEVEL < GADGETRON_LOG_LEVEL_MAX) {
+      level_mask_ &= ~(1u << LEVEL);
+    }
   }
 
   void GadgetronLogger::enableAllLogLevels()
   {
-    level_mask_.assign(GADGETRON_LOG_LEVEL_MAX,true);
+    level_mask_ = (1u << GADGETRON_LOG_LEVEL_MAX) - 1;
   }
 
   void GadgetronLogger::disableAllLogLevels()
   {
-    level_mask_.assign(GADGETRON_LOG_LEVEL_MAX,false);
+    level_mask_ = 0;
   }
 
   void GadgetronLogger::enableOutputOption(GadgetronLogOutput OUTPUT)
   {
-    if (OUTPUT < print_mask_.size()) {
-      print_mask_[OUTPUT] = true;
+    if (OUTPUT < GADGETRON_LOG_PRINT_MAX) {
+      print_mask_ |= (1u << OUTPUT);
     }
   }
 
   void GadgetronLogger::disableOutputOption(GadgetronLogOutput OUTPUT)
   {
-    if (OUTPUT < print_mask_.size()) {
-      print_mask_[OUTPUT] = false;
+    if (OUTPUT < GADGETRON_LOG_PRINT_MAX) {
+      print_mask_ &= ~(1u << OUTPUT);
     }
   }
 
-  bool GadgetronLogger::isOutputOptionEnabled(GadgetronLogOutput OUTPUT)
+  bool GadgetronLogger::isOutputOptionEnabled(GadgetronLogOutput OUTPUT) const
   {
-    if (OUTPUT < print_mask_.size()) {
-      return print_mask_[OUTPUT];
+    if (OUTPUT < GADGETRON_LOG_PRINT_MAX) {
+      return (print_mask_.load(std::memory_order_relaxed) >> OUTPUT) & 1u;
     }
     return false;
   }
 
   void GadgetronLogger::enableAllOutputOptions()
   {
-    print_mask_.assign(GADGETRON_LOG_PRINT_MAX, true);
+    print_mask_ = (1u << GADGETRON_LOG_PRINT_MAX) - 1;
   }
 
   void GadgetronLogger::disableAllOutputOptions()
   {
-    print_mask_.assign(GADGETRON_LOG_PRINT_MAX, false);
+    print_mask_ = 0;
   }
 }
@@ -3,13 +3,20 @@
 
 #include "log_export.h"
 
-#include <vector> //For mask fields
+#include <vector>
 
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
 #include <sstream>
 #include <mutex>
 
 #define GADGETRON_LOG_MASK_ENVIRONMENT "GADGETRON_LOG_MASK"
 #define GADGETRON_LOG_FILE_ENVIRONMENT "GADGETRON_LOG_FILE"
+#define GADGETRON_LOG_MODE_ENVIRONMENT "GADGETRON_LOG_MODE"
+#define GADGETRON_LOG_FORMAT_ENVIRONMENT "GADGETRON_LOG_FORMAT"
+#define GADGETRON_LOG_RATE_LIMIT_ENVIRONMENT "GADGETRON_LOG_RATE_LIMIT"
 
 namespace Gadgetron
 {
@@ -39,6 +46,15 @@ namespace Gadgetron
     GADGETRON_LOG_PRINT_MAX           //!< All print options must have lower values than this
   };
 
+  /**
+     Gadgetron log formats.
+   */
+  enum GadgetronLogFormat
+  {
+    GADGETRON_LOG_FORMAT_TEXT = 0,    //!< One line per message, prefixed as chosen by the output options
+    GADGETRON_LOG_FORMAT_JSON         //!< One JSON object per line, with time, level, file, line, thread and message
+  };
+
   /**
      Main logging utility class for the Gadgetron and associated toolboxes. 
 
@@ -86,6 +102,18 @@ namespace Gadgetron
      
      Any (or no) seperator is allowed between the levels and ourput options.
 
+     By default, messages are written to stderr by the thread logging them, one at a time. With 
+     GADGETRON_LOG_MODE=async, each thread puts its messages in a buffer of its own, without taking a lock, 
+     and a background thread writes them out in batches. Messages are written in the order they were logged, 
+     a few milliseconds later; call @flush to write out everything logged so far.
+
+     GADGETRON_LOG_FORMAT=json writes each message as a JSON object on a line of its own.
+
+     GADGETRON_LOG_RATE_LIMIT=N writes at most N messages per second from each place in the code, and logs 
+     how many were left out.
+
+     Levels are checked before a message is formatted, so disabled levels cost little more than a branch.
+
    */
   class EXPORTGADGETRONLOG GadgetronLogger
   {
@@ -98,22 +126,46 @@ namespace Gadgetron
 
     void enableLogLevel(GadgetronLogLevel LEVEL);
     void disableLogLevel(GadgetronLogLevel LEVEL);
-    bool isLevelEnabled(GadgetronLogLevel LEVEL);
+    bool isLevelEnabled(GadgetronLogLevel LEVEL) const
+    {
+      return LEVEL < GADGETRON_LOG_LEVEL_MAX && ((level_mask_.load(std::memory_order_relaxed) >> LEVEL) & 1u);
+    }
     void enableAllLogLevels();
     void disableAllLogLevels();
 
     void enableOutputOption(GadgetronLogOutput OUTPUT);
     void disableOutputOption(GadgetronLogOutput OUTPUT);
-    bool isOutputOptionEnabled(GadgetronLogOutput OUTPUT);
+    bool isOutputOptionEnabled(GadgetronLogOutput OUTPUT) const;
     void enableAllOutputOptions();
     void disableAllOutputOptions();
 
+    ///Write messages from a background thread rather than from the thread logging them
+    void enableAsync();
+    void disableAsync();
+    bool isAsync() const;
+
+    void setFormat(GadgetronLogFormat FORMAT);
+    GadgetronLogFormat format() const;
+
+    ///Write at most this many messages per second from each place in the code. 0 means no limit.
+    void setRateLimit(unsigned int messages_per_second);
+
+    ///Write out all messages logged so far
+    void flush();
+
+    ///Write messages to this file rather than to stderr
+    void setOutput(FILE* output);
+
+    virtual ~GadgetronLogger();
+
   protected:
     GadgetronLogger();
     static GadgetronLogger* instance_;
-    std::vector<bool> level_mask_;
-    std::vector<bool> print_mask_;
-    std::mutex m;
+    std::atomic<uint32_t> level_mask_;
+    std::atomic<uint32_t> print_mask_;
+
+    struct Backend;
+    std::unique_ptr<Backend> backend_;
   };
 }
 
@@ -131,43 +183,28 @@ namespace Gadgetron
     GDEBUG(gdb.c_str());		  \
  }
 
-//Stream syntax log level functions
-#define GINFO_STREAM(message)				\
-  {							\
-    std::stringstream gadget_msg_dep_str;		\
-    gadget_msg_dep_str  << message << std::endl;	\
-    GINFO(gadget_msg_dep_str.str().c_str());		\
+//Stream syntax log level functions. The message is only formatted if the level is enabled.
+#define GADGETRON_LOG_STREAM(LEVEL, message)						\
+  {											\
+    if (Gadgetron::GadgetronLogger::instance()->isLevelEnabled(LEVEL)) {		\
+      std::stringstream gadget_msg_dep_str;						\
+      gadget_msg_dep_str  << message << std::endl;					\
+      Gadgetron::GadgetronLogger::instance()->log(LEVEL, __FILE__, __LINE__, "%s",	\
+                                                  gadget_msg_dep_str.str().c_str());	\
+    }											\
   }
 
-#define GVERBOSE_STREAM(message)					\
-  {								\
-    std::stringstream gadget_msg_dep_str;			\
-    gadget_msg_dep_str  << message << std::endl;		\
-    GVERBOSE(gadget_msg_dep_str.str().c_str());			\
-  }
+#define GINFO_STREAM(message) GADGETRON_LOG_STREAM(Gadgetron::GADGETRON_LOG_LEVEL_INFO, message)
+
+#define GVERBOSE_STREAM(message) GADGETRON_LOG_STREAM(Gadgetron::GADGETRON_LOG_LEVEL_VERBOSE, message)
 
 #ifndef MATLAB_MEX_COMPILE
 
-#define GDEBUG_STREAM(message)				\
-{							\
-    std::stringstream gadget_msg_dep_str;		\
-    gadget_msg_dep_str  << message << std::endl;	\
-    GDEBUG(gadget_msg_dep_str.str().c_str());		\
-}
+#define GDEBUG_STREAM(message) GADGETRON_LOG_STREAM(Gadgetron::GADGETRON_LOG_LEVEL_DEBUG, message)
 
-#define GWARN_STREAM(message)					\
-  {								\
-    std::stringstream gadget_msg_dep_str;			\
-    gadget_msg_dep_str  << message << std::endl;		\
-    GWARN(gadget_msg_dep_str.str().c_str());			\
-  }
+#define GWARN_STREAM(message) GADGETRON_LOG_STREAM(Gadgetron::GADGETRON_LOG_LEVEL_WARNING, message)
 
-#define GERROR_STREAM(message)					\
-  {								\
-    std::stringstream gadget_msg_dep_str;			\
-    gadget_msg_dep_str  << message << std::endl;		\
-    GERROR(gadget_msg_dep_str.str().c_str());			\
-  }
+#define GERROR_STREAM(message) GADGETRON_LOG_STREAM(Gadgetron::GADGETRON_LOG_LEVEL_ERROR, message)
 
 #else
     #pragma message ("Use matlab definition for GDEBUG stream ... ")
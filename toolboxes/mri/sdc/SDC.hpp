@@ -17,6 +17,16 @@ template <template <class> class ARRAY, class REAL, unsigned int D> struct valid
     vector_td<size_t, D> operator()(const vector_td<size_t, D>& size);
 };
 
+// Looks up weights estimated before for the same inputs, or calls compute. Array types without a cache compute.
+template <template <class> class ARRAY, class REAL, unsigned int D> struct caches {
+    template <class F>
+    std::shared_ptr<ARRAY<REAL>> operator()(const ARRAY<vector_td<REAL, D>>& traj, const ARRAY<REAL>& initial_dcw,
+                                            const vector_td<size_t, D>& matrix_size, REAL os_factor,
+                                            unsigned int num_iterations, REAL kernelWidth, F compute) {
+        return compute();
+    }
+};
+
 template <template <class> class ARRAY, class REAL, unsigned int D>
 std::shared_ptr<ARRAY<REAL>> estimate_dcw(const ARRAY<vector_td<REAL, D>>& traj,
                                           const vector_td<size_t, D>& matrix_size, REAL os_factor,
@@ -33,50 +43,54 @@ template <template <class> class ARRAY, class REAL, unsigned int D>
 std::shared_ptr<ARRAY<REAL>> estimate_dcw(const ARRAY<vector_td<REAL, D>>& traj, const ARRAY<REAL>& initial_dcw,
                                           const vector_td<size_t, D>& matrix_size, REAL os_factor,
                                           unsigned int num_iterations, REAL kernelWidth) {
-    // Specialized functors.
-    auto update_weights = updates<ARRAY, REAL>();
-    auto validate_size = validates<ARRAY, REAL, D>();
+    auto compute = [&]() {
+        // Specialized functors.
+        auto update_weights = updates<ARRAY, REAL>();
+        auto validate_size = validates<ARRAY, REAL, D>();
 
-    // Matrix size with oversampling.
-    auto matrix_size_os = vector_td<size_t, D>(vector_td<REAL, D>(matrix_size) * os_factor);
+        // Matrix size with oversampling.
+        auto matrix_size_os = vector_td<size_t, D>(vector_td<REAL, D>(matrix_size) * os_factor);
 
-    // Validate matrix size.
-    auto valid_matrix_size = validate_size(matrix_size);
-    auto valid_matrix_size_os = validate_size(matrix_size_os);
+        // Validate matrix size.
+        auto valid_matrix_size = validate_size(matrix_size);
+        auto valid_matrix_size_os = validate_size(matrix_size_os);
 
-    // Convolution kernel.
-    auto kernel = JincKernel<REAL, D>(kernelWidth);
+        // Convolution kernel.
+        auto kernel = JincKernel<REAL, D>(kernelWidth);
 
-    // Prepare gridding convolution.
-    auto conv = GriddingConvolution<ARRAY, REAL, D, JincKernel>::make(valid_matrix_size, valid_matrix_size_os, kernel);
+        // Prepare gridding convolution.
+        auto conv = GriddingConvolution<ARRAY, REAL, D, JincKernel>::make(valid_matrix_size, valid_matrix_size_os, kernel);
 
-    // cudaPointerAttributes attributes;
-    // cudaPointerGetAttributes(&attributes,traj.get_data_ptr());
+        // cudaPointerAttributes attributes;
+        // cudaPointerGetAttributes(&attributes,traj.get_data_ptr());
 
 
-    // if(attributes.devicePointer != NULL)
-    //     //conv->initialize(ConvolutionType::ATOMIC);
+        // if(attributes.devicePointer != NULL)
+        //     //conv->initialize(ConvolutionType::ATOMIC);
 
-    conv->preprocess(traj);
+        conv->preprocess(traj);
 
-    // Working arrays.
-    ARRAY<REAL> dcw(initial_dcw);
-    ARRAY<REAL> grid(to_std_vector(conv->get_matrix_size_os()));
-    ARRAY<REAL> tmp(dcw.get_dimensions());
+        // Working arrays.
+        ARRAY<REAL> dcw(initial_dcw);
+        ARRAY<REAL> grid(to_std_vector(conv->get_matrix_size_os()));
+        ARRAY<REAL> tmp(dcw.get_dimensions());
 
-    // Iteration loop.
-    for (size_t i = 0; i < num_iterations; i++) {
-        // To intermediate grid.
-        conv->compute(dcw, grid, GriddingConvolutionMode::NC2C);
+        // Iteration loop.
+        for (size_t i = 0; i < num_iterations; i++) {
+            // To intermediate grid.
+            conv->compute(dcw, grid, GriddingConvolutionMode::NC2C);
 
-        // To original trajectory.
-        conv->compute(grid, tmp, GriddingConvolutionMode::C2NC);
+            // To original trajectory.
+            conv->compute(grid, tmp, GriddingConvolutionMode::C2NC);
 
-        // Update weights.
-        update_weights(tmp, dcw);
-    }
+            // Update weights.
+            update_weights(tmp, dcw);
+        }
+
+        return std::make_shared<ARRAY<REAL>>(dcw);
+    };
 
-    return std::make_shared<ARRAY<REAL>>(dcw);
+    return caches<ARRAY, REAL, D>()(traj, initial_dcw, matrix_size, os_factor, num_iterations, kernelWidth, compute);
 }
 
 
@@ -1,6 +1,7 @@
 
 #include "hoSDC.h"
 
+#include "hoGriddingCache.h"
 #include "hoGriddingConvolution.h"
 #include "hoNDArray_elemwise.h"
 
@@ -29,6 +30,44 @@ namespace Gadgetron
             return size;
         }
     };
+
+    template<class REAL, unsigned int D>
+    struct caches<hoNDArray, REAL, D>
+    {
+        template<class F>
+        std::shared_ptr<hoNDArray<REAL>> operator()(const hoNDArray<vector_td<REAL, D>>& traj,
+                                                    const hoNDArray<REAL>& initial_dcw,
+                                                    const vector_td<size_t, D>& matrix_size,
+                                                    REAL os_factor,
+                                                    unsigned int num_iterations,
+                                                    REAL kernelWidth,
+                                                    F compute)
+        {
+            auto& cache = hoGriddingCache::instance();
+            if (!cache.enabled())
+                return compute();
+
+            auto key = hoGriddingCacheKey()
+                .add(std::string("estimate_dcw"))
+                .add(uint32_t(sizeof(REAL)))
+                .add(matrix_size)
+                .add(os_factor)
+                .add(num_iterations)
+                .add(kernelWidth)
+                .add(traj)
+                .add(initial_dcw);
+
+            std::shared_ptr<const hoNDArray<REAL>> dcw = cache.find<hoNDArray<REAL>>(key);
+            if (!dcw)
+            {
+                dcw = compute();
+                cache.insert(key, dcw);
+            }
+
+            // Callers are free to modify the weights they get.
+            return std::make_shared<hoNDArray<REAL>>(*dcw);
+        }
+    };
 }
 
 
@@ -26,6 +26,7 @@
 #include "mri_core_utility.h"
 #include "hoMatrix.h"
 #include "hoNDArray_linalg.h"
+#include "cpp_blas.h"
 #include "hoNDFFT.h"
 #include "hoNDArray_utils.h"
 #include "hoNDArray_elemwise.h"
@@ -90,6 +91,111 @@ void grappa2d_kerPattern(std::vector<int>& kE1, std::vector<int>& oE1, size_t& c
 
 // ------------------------------------------------------------------------
 
+/// accumulate A'*A and A'*B of the calibration equation A*ker = B over blocks of calibration points
+/// A and B are never formed for all points, only for blockSize of them at a time
+/// acsSrc : [RO E1 E2 srcCHA], acsDst : [RO E1 E2 dstCHA]
+/// [sRO eRO], [sE1 eE1], [sE2 eE2]: the calibration points, i.e. the centers of the kernels
+/// the columns of A and B are in the order of grappa2d_prepare_calib and grappa3d_calib
+/// AHA : [colA colA], only the lower triangle is filled
+/// AHB : [colA colB]
+template <typename T>
+static void grappa_accumulate_calib_normal_equations(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t kRO,
+                                                    const std::vector<int>& kE1, const std::vector<int>& oE1,
+                                                    const std::vector<int>& kE2, const std::vector<int>& oE2,
+                                                    size_t sRO, size_t eRO, size_t sE1, size_t eE1, size_t sE2, size_t eE2,
+                                                    size_t blockSize, hoNDArray<T>& AHA, hoNDArray<T>& AHB)
+{
+    typedef typename realType<T>::Type value_type;
+
+    size_t RO = acsSrc.get_size(0);
+    size_t E1 = acsSrc.get_size(1);
+    size_t E2 = acsSrc.get_size(2);
+    size_t srcCHA = acsSrc.get_size(3);
+    size_t dstCHA = acsDst.get_size(3);
+
+    long long kROhalf = (long long)kRO / 2;
+
+    size_t kNE1 = kE1.size();
+    size_t oNE1 = oE1.size();
+    size_t kNE2 = kE2.size();
+    size_t oNE2 = oE2.size();
+
+    size_t lenRO = eRO - sRO + 1;
+    size_t lenE1 = eE1 - sE1 + 1;
+    size_t lenE2 = eE2 - sE2 + 1;
+
+    size_t rowA = lenRO*lenE1*lenE2;
+    size_t colA = kRO*kNE1*kNE2*srcCHA;
+    size_t colB = dstCHA*oNE1*oNE2;
+
+    AHA.create(colA, colA);
+    Gadgetron::clear(AHA);
+    AHB.create(colA, colB);
+    Gadgetron::clear(AHB);
+
+    blockSize = std::min(blockSize, rowA);
+
+    hoNDArray<T> A(blockSize, colA);
+    hoNDArray<T> B(blockSize, colB);
+    T* pA = A.begin();
+    T* pB = B.begin();
+
+    const T* pSrc = acsSrc.begin();
+    const T* pDst = acsDst.begin();
+
+    for (size_t start = 0; start < rowA; start += blockSize)
+    {
+        size_t rows = std::min(blockSize, rowA - start);
+
+        long long r;
+#pragma omp parallel for private(r)
+        for (r = 0; r < (long long)rows; r++)
+        {
+            size_t ind = start + r;
+            long long ro = (long long)(sRO + ind % lenRO);
+            long long e1 = (long long)(sE1 + (ind / lenRO) % lenE1);
+            long long e2 = (long long)(sE2 + ind / (lenRO*lenE1));
+
+            // fill the row of A
+            size_t col = 0;
+            for (size_t src = 0; src < srcCHA; src++)
+            {
+                for (size_t ke2 = 0; ke2 < kNE2; ke2++)
+                {
+                    for (size_t ke1 = 0; ke1 < kNE1; ke1++)
+                    {
+                        const T* pKer = pSrc + src*RO*E1*E2 + (e2 + kE2[ke2])*RO*E1 + (e1 + kE1[ke1])*RO + ro;
+                        for (long long kro = -kROhalf; kro <= kROhalf; kro++)
+                        {
+                            pA[r + col*blockSize] = pKer[kro];
+                            col++;
+                        }
+                    }
+                }
+            }
+
+            // fill the row of B
+            col = 0;
+            for (size_t oe2 = 0; oe2 < oNE2; oe2++)
+            {
+                for (size_t oe1 = 0; oe1 < oNE1; oe1++)
+                {
+                    for (size_t dst = 0; dst < dstCHA; dst++)
+                    {
+                        pB[r + col*blockSize] = pDst[dst*RO*E1*E2 + (e2 + oE2[oe2])*RO*E1 + (e1 + oE1[oe1])*RO + ro];
+                        col++;
+                    }
+                }
+            }
+        }
+
+        BLAS::herk(false, true, colA, rows, value_type(1), pA, blockSize, value_type(1), AHA.begin(), colA);
+        BLAS::gemm(true, false, colA, colB, rows, T(1), pA, blockSize, pB, blockSize, T(1), AHB.begin(), colA);
+    }
+}
+
+// ------------------------------------------------------------------------
+
 template <typename T> EXPORTMRICORE void grappa2d_prepare_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& A_mem, hoNDArray<T>& B_mem)
 {
     try
@@ -244,7 +350,7 @@ template EXPORTMRICORE void grappa2d_perform_calib(const hoNDArray< std::complex
 // ------------------------------------------------------------------------
 
 template <typename T> 
-void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker)
+void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker, size_t calibBlockSize)
 {
     try
     {
@@ -252,9 +358,45 @@ void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, doub
         GADGET_CHECK_THROW(acsSrc.get_size(1)==acsDst.get_size(1));
         GADGET_CHECK_THROW(acsSrc.get_size(2)>=acsDst.get_size(2));
 
-        hoNDArray<T> A, B;
-        Gadgetron::grappa2d_prepare_calib(acsSrc, acsDst, kRO, kE1, oE1, startRO, endRO, startE1, endE1, A, B);
-        Gadgetron::grappa2d_perform_calib(A, B, kRO, kE1, oE1, thres, ker);
+        if (calibBlockSize == 0)
+        {
+            hoNDArray<T> A, B;
+            Gadgetron::grappa2d_prepare_calib(acsSrc, acsDst, kRO, kE1, oE1, startRO, endRO, startE1, endE1, A, B);
+            Gadgetron::grappa2d_perform_calib(A, B, kRO, kE1, oE1, thres, ker);
+            return;
+        }
+
+        size_t RO = acsSrc.get_size(0);
+        size_t E1 = acsSrc.get_size(1);
+        size_t srcCHA = acsSrc.get_size(2);
+        size_t dstCHA = acsDst.get_size(2);
+
+        long long kROhalf = kRO / 2;
+        if (2 * kROhalf == kRO)
+        {
+            GWARN_STREAM("grappa2d_calib(...) - 2*kROhalf == kRO " << kRO);
+        }
+        kRO = 2 * kROhalf + 1;
+
+        size_t kNE1 = kE1.size();
+        size_t oNE1 = oE1.size();
+
+        // same calibration region as grappa2d_prepare_calib
+        size_t sRO = startRO + kROhalf;
+        size_t eRO = endRO - kROhalf;
+        size_t sE1 = std::abs(kE1[0]) + startE1;
+        size_t eE1 = endE1 - kE1[kNE1 - 1];
+
+        hoNDArray<T> src(RO, E1, 1, srcCHA, const_cast<T*>(acsSrc.begin()));
+        hoNDArray<T> dst(RO, E1, 1, dstCHA, const_cast<T*>(acsDst.begin()));
+        std::vector<int> kE2(1, 0), oE2(1, 0);
+
+        hoNDArray<T> AHA, x;
+        grappa_accumulate_calib_normal_equations(src, dst, kRO, kE1, oE1, kE2, oE2, sRO, eRO, sE1, eE1, 0, 0, calibBlockSize, AHA, x);
+        SolveNormalEquations_Tikhonov(AHA, x, thres);
+
+        ker.create(kRO, kNE1, srcCHA, dstCHA, oNE1);
+        memcpy(ker.begin(), x.begin(), ker.get_number_of_bytes());
     }
     catch(...)
     {
@@ -262,8 +404,8 @@ void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, doub
     }
 }
 
-template EXPORTMRICORE void grappa2d_calib(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<float> >& ker);
-template EXPORTMRICORE void grappa2d_calib(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<double> >& ker);
+template EXPORTMRICORE void grappa2d_calib(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<float> >& ker, size_t calibBlockSize);
+template EXPORTMRICORE void grappa2d_calib(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<double> >& ker, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
@@ -574,7 +716,7 @@ template EXPORTMRICORE void grappa2d_convert_to_convolution_kernel(const hoNDArr
 // ------------------------------------------------------------------------
 
 template <typename T>
-void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& convKer)
+void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& convKer, size_t calibBlockSize)
 {
         std::vector<int> kE1, oE1;
 
@@ -586,35 +728,35 @@ void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
         grappa2d_kerPattern(kE1, oE1, convkRO, convkE1, accelFactor, kRO, kNE1, fitItself);
 
         hoNDArray<T> ker;
-        grappa2d_calib(acsSrc, acsDst, thres, kRO, kE1, oE1, startRO, endRO, startE1, endE1, ker);
+        grappa2d_calib(acsSrc, acsDst, thres, kRO, kE1, oE1, startRO, endRO, startE1, endE1, ker, calibBlockSize);
 
         grappa2d_convert_to_convolution_kernel(ker, kRO, kE1, oE1, convKer);
 }
 
-template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<float> >& convKer);
-template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<double> >& convKer);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<float> >& convKer, size_t calibBlockSize);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray< std::complex<double> >& convKer, size_t calibBlockSize);
 
 
 // ------------------------------------------------------------------------
 
 template <typename T>
-void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer)
+void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer, size_t calibBlockSize)
 {
     size_t startRO = 0;
     size_t endRO = acsSrc.get_size(0) - 1;
     size_t startE1 = 0;
     size_t endE1 = acsSrc.get_size(1) - 1;
 
-    grappa2d_calib_convolution_kernel(acsSrc, acsDst, accelFactor, thres, kRO, kNE1, startRO, endRO, startE1, endE1, convKer);
+    grappa2d_calib_convolution_kernel(acsSrc, acsDst, accelFactor, thres, kRO, kNE1, startRO, endRO, startE1, endE1, convKer, calibBlockSize);
 }
 
-template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<float> >& convKer);
-template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<double> >& convKer);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<float> >& convKer, size_t calibBlockSize);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<double> >& convKer, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
 template <typename T> 
-void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer)
+void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer, size_t calibBlockSize)
 {
     try
     {
@@ -652,7 +794,7 @@ void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDAr
         GADGET_CHECK_THROW(endRO>startRO);
         GADGET_CHECK_THROW(endE1>startE1 + accelFactor);
 
-        GADGET_CATCH_THROW(grappa2d_calib_convolution_kernel(dataSrc, dataDst, accelFactor, thres, kRO, kNE1, startRO, endRO, startE1, endE1, convKer));
+        GADGET_CATCH_THROW(grappa2d_calib_convolution_kernel(dataSrc, dataDst, accelFactor, thres, kRO, kNE1, startRO, endRO, startE1, endE1, convKer, calibBlockSize));
     }
     catch (...)
     {
@@ -660,8 +802,8 @@ void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDAr
     }
 }
 
-template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& dataSrc, const hoNDArray< std::complex<float> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<float> >& convKer);
-template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& dataSrc, const hoNDArray< std::complex<double> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<double> >& convKer);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& dataSrc, const hoNDArray< std::complex<float> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<float> >& convKer, size_t calibBlockSize);
+template EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& dataSrc, const hoNDArray< std::complex<double> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray< std::complex<double> >& convKer, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
@@ -945,7 +1087,7 @@ void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst,
                 double thres, double overDetermineRatio, size_t kRO,
                 const std::vector<int>& kE1, const std::vector<int>& oE1,
                 const std::vector<int>& kE2, const std::vector<int>& oE2,
-                hoNDArray<T>& ker)
+                hoNDArray<T>& ker, size_t calibBlockSize)
 {
     try
     {
@@ -1055,6 +1197,15 @@ void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst,
             }
         }
 
+        if (calibBlockSize > 0)
+        {
+            hoNDArray<T> AHA, x;
+            grappa_accumulate_calib_normal_equations(acsSrc, acsDst, kRO, kE1, oE1, kE2, oE2, sRO, eRO, sE1, eE1, sE2, eE2, calibBlockSize, AHA, x);
+            SolveNormalEquations_Tikhonov(AHA, x, thres);
+            memcpy(ker.begin(), x.begin(), ker.get_number_of_bytes());
+            return;
+        }
+
         size_t rowA = lenRO*lenE1*lenE2;
 
         hoMatrix<T> A, B, x(colA, colB);
@@ -1137,8 +1288,8 @@ void grappa3d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst,
     return;
 }
 
-template EXPORTMRICORE void grappa3d_calib(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, double thres, double overDetermineRatio, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, const std::vector<int>& kE2, const std::vector<int>& oE2, hoNDArray< std::complex<float> >& ker);
-template EXPORTMRICORE void grappa3d_calib(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, double thres, double overDetermineRatio, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, const std::vector<int>& kE2, const std::vector<int>& oE2, hoNDArray< std::complex<double> >& ker);
+template EXPORTMRICORE void grappa3d_calib(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, double thres, double overDetermineRatio, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, const std::vector<int>& kE2, const std::vector<int>& oE2, hoNDArray< std::complex<float> >& ker, size_t calibBlockSize);
+template EXPORTMRICORE void grappa3d_calib(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, double thres, double overDetermineRatio, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, const std::vector<int>& kE2, const std::vector<int>& oE2, hoNDArray< std::complex<double> >& ker, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
@@ -1253,7 +1404,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
                                 double thres, double overDetermineRatio,
                                 size_t kRO, size_t kNE1, size_t kNE2,
                                 size_t startRO, size_t endRO, size_t startE1, size_t endE1, size_t startE2, size_t endE2,
-                                hoNDArray<T>& convKer)
+                                hoNDArray<T>& convKer, size_t calibBlockSize)
 {
     try
     {
@@ -1265,7 +1416,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
 
         if (startRO == 0 && endRO == RO - 1 && startE1 == 0 && endE1 == E1 - 1 && startE2 == 0 && endE2 == E2 - 1)
         {
-            grappa3d_calib_convolution_kernel(acsSrc, acsDst, accelFactorE1, accelFactorE2, thres, overDetermineRatio, kRO, kNE1, kNE2, convKer);
+            grappa3d_calib_convolution_kernel(acsSrc, acsDst, accelFactorE1, accelFactorE2, thres, overDetermineRatio, kRO, kNE1, kNE2, convKer, calibBlockSize);
         }
         else
         {
@@ -1287,7 +1438,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
             cropSize[3] = dstCHA;
             Gadgetron::crop(cropOffset, cropSize, acsDst, acsDstFullSampled);
 
-            grappa3d_calib_convolution_kernel(acsSrcFullSampled, acsDstFullSampled, accelFactorE1, accelFactorE2, thres, overDetermineRatio, kRO, kNE1, kNE2, convKer);
+            grappa3d_calib_convolution_kernel(acsSrcFullSampled, acsDstFullSampled, accelFactorE1, accelFactorE2, thres, overDetermineRatio, kRO, kNE1, kNE2, convKer, calibBlockSize);
         }
     }
     catch (...)
@@ -1298,8 +1449,8 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
     return;
 }
 
-template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, size_t startRO, size_t endRO, size_t startE1, size_t endE1, size_t startE2, size_t endE2, hoNDArray< std::complex<float> >& convKer);
-template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, size_t startRO, size_t endRO, size_t startE1, size_t endE1, size_t startE2, size_t endE2, hoNDArray< std::complex<double> >& convKer);
+template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, size_t startRO, size_t endRO, size_t startE1, size_t endE1, size_t startE2, size_t endE2, hoNDArray< std::complex<float> >& convKer, size_t calibBlockSize);
+template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, size_t startRO, size_t endRO, size_t startE1, size_t endE1, size_t startE2, size_t endE2, hoNDArray< std::complex<double> >& convKer, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
@@ -1308,7 +1459,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
                                 size_t accelFactorE1, size_t accelFactorE2,
                                 double thres, double overDetermineRatio,
                                 size_t kRO, size_t kNE1, size_t kNE2,
-                                hoNDArray<T>& convKer)
+                                hoNDArray<T>& convKer, size_t calibBlockSize)
 {
     try
     {
@@ -1322,7 +1473,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
         grappa3d_kerPattern(kE1, oE1, kE2, oE2, convkRO, convkE1, convkE2, accelFactorE1, accelFactorE2, kRO, kNE1, kNE2, fitItself);
 
         hoNDArray<T> ker;
-        grappa3d_calib(acsSrc, acsDst, thres, overDetermineRatio, kRO, kE1, oE1, kE2, oE2, ker);
+        grappa3d_calib(acsSrc, acsDst, thres, overDetermineRatio, kRO, kE1, oE1, kE2, oE2, ker, calibBlockSize);
 
         grappa3d_convert_to_convolution_kernel(ker, kRO, kE1, oE1, kE2, oE2, convKer);
 
@@ -1335,8 +1486,8 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArr
     return;
 }
 
-template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<float> >& convKer);
-template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<double> >& convKer);
+template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<float> >& convKer, size_t calibBlockSize);
+template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<double> >& convKer, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
@@ -1345,7 +1496,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDAr
                                 size_t accelFactorE1, size_t accelFactorE2,
                                 double thres, double overDetermineRatio,
                                 size_t kRO, size_t kNE1, size_t kNE2,
-                                hoNDArray<T>& convKer)
+                                hoNDArray<T>& convKer, size_t calibBlockSize)
 {
     try
     {
@@ -1388,7 +1539,7 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDAr
         GADGET_CHECK_THROW(endE1>startE1 + accelFactorE1);
         GADGET_CHECK_THROW(endE2>startE2 + accelFactorE2);
 
-        grappa3d_calib_convolution_kernel(dataSrc, dataDst, accelFactorE1, accelFactorE2, thres, overDetermineRatio, kRO, kNE1, kNE2, startRO, endRO, startE1, endE1, startE2, endE2, convKer);
+        grappa3d_calib_convolution_kernel(dataSrc, dataDst, accelFactorE1, accelFactorE2, thres, overDetermineRatio, kRO, kNE1, kNE2, startRO, endRO, startE1, endE1, startE2, endE2, convKer, calibBlockSize);
     }
     catch (...)
     {
@@ -1398,8 +1549,8 @@ void grappa3d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDAr
     return;
 }
 
-template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& dataSrc, const hoNDArray< std::complex<float> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<float> >& convKer);
-template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& dataSrc, const hoNDArray< std::complex<double> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<double> >& convKer);
+template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<float> >& dataSrc, const hoNDArray< std::complex<float> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<float> >& convKer, size_t calibBlockSize);
+template EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray< std::complex<double> >& dataSrc, const hoNDArray< std::complex<double> >& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactorE1, size_t accelFactorE2, double thres, double overDetermineRatio, size_t kRO, size_t kNE1, size_t kNE2, hoNDArray< std::complex<double> >& convKer, size_t calibBlockSize);
 
 // ------------------------------------------------------------------------
 
@@ -23,11 +23,13 @@ namespace Gadgetron {
     /// kRO: kernel size along RO
     /// kNE1: kernel size along E1
     /// convKer: computed grappa convolution kernel
-    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& convKer);
+    /// calibBlockSize: if 0, the calibration matrix is assembled for all calibration points before solving;
+    /// otherwise its normal equations are accumulated over blocks of calibBlockSize points, without storing the whole matrix
+    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& convKer, size_t calibBlockSize = 0);
     /// entire data in acsSrc and acsDst is used
-    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer);
+    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer, size_t calibBlockSize = 0);
     /// dataMask : [RO E1] array, marking fully rectangular sampled region with 1
-    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer);
+    template <typename T> EXPORTMRICORE void grappa2d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, size_t accelFactor, double thres, size_t kRO, size_t kNE1, hoNDArray<T>& convKer, size_t calibBlockSize = 0);
 
     /// compute image domain kernel from 2d grappd convolution kernel
     /// RO, E1: the size of image domain kernel
@@ -85,7 +87,7 @@ namespace Gadgetron {
     /// solve for ker
     template <typename T> EXPORTMRICORE void grappa2d_perform_calib(const hoNDArray<T>& A, const hoNDArray<T>& B, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, double thres, hoNDArray<T>& ker);
 
-    template <typename T> EXPORTMRICORE void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker);
+    template <typename T> EXPORTMRICORE void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker, size_t calibBlockSize = 0);
 
     /// convert the grappa multiplication kernel computed from grappa2d_calib to convolution kernel
     /// convKer : [convRO convE1 srcCHA dstCHA]
@@ -123,26 +125,27 @@ namespace Gadgetron {
     /// kNE1: kernel size along E1
     /// kNE2: kernel size along E2
     /// convKer: computed grappa convolution kernel [convKRO convKE1 convKE2 srcCHA dstCHA]
+    /// calibBlockSize: as for grappa2d_calib_convolution_kernel
     template <typename T> EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, 
                                                                             size_t accelFactorE1, size_t accelFactorE2, 
                                                                             double thres, double overDetermineRatio,
                                                                             size_t kRO, size_t kNE1, size_t kNE2, 
                                                                             size_t startRO, size_t endRO, size_t startE1, size_t endE1, size_t startE2, size_t endE2, 
-                                                                            hoNDArray<T>& convKer);
+                                                                            hoNDArray<T>& convKer, size_t calibBlockSize = 0);
 
     /// entire data in acsSrc and acsDst is used
     template <typename T> EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, 
                                                                             size_t accelFactorE1, size_t accelFactorE2,
                                                                             double thres, double overDetermineRatio,
                                                                             size_t kRO, size_t kNE1, size_t kNE2, 
-                                                                            hoNDArray<T>& convKer);
+                                                                            hoNDArray<T>& convKer, size_t calibBlockSize = 0);
 
     /// dataMask : [RO E1 E2] array, marking fully rectangular sampled region with 1
     template <typename T> EXPORTMRICORE void grappa3d_calib_convolution_kernel(const hoNDArray<T>& dataSrc, const hoNDArray<T>& dataDst, hoNDArray<unsigned short>& dataMask, 
                                                                             size_t accelFactorE1, size_t accelFactorE2, 
                                                                             double thres, double overDetermineRatio, 
                                                                             size_t kRO, size_t kNE1, size_t kNE2, 
-                                                                            hoNDArray<T>& convKer);
+                                                                            hoNDArray<T>& convKer, size_t calibBlockSize = 0);
 
     /// compute image domain kernel from 3d grappd convolution kernel
     /// RO, E1, E2: the size of image domain kernel
@@ -216,7 +219,7 @@ namespace Gadgetron {
                                                     double thres, double overDetermineRatio, size_t kRO, 
                                                     const std::vector<int>& kE1, const std::vector<int>& oE1, 
                                                     const std::vector<int>& kE2, const std::vector<int>& oE2, 
-                                                    hoNDArray<T>& ker);
+                                                    hoNDArray<T>& ker, size_t calibBlockSize = 0);
 
     /// convert the grappa multiplication kernel computed from grappa3d_calib to convolution kernel
     /// convKer : [convRO convE1 convE2 srcCHA dstCHA]
@@ -4,13 +4,15 @@
 #include "ConvolutionMatrix.h"
 
 #include <GadgetronTimer.h>
+#include <algorithm>
 #include <numeric>
+#include "complext.h"
 #include "vector_td_utilities.h"
-#include <boost/range/irange.hpp>
 
 namespace
 {
     using namespace Gadgetron;
+    using index_type = ConvInternal::ConvolutionMatrix<float>::index_type;
 
     template<int N>
     struct iteration_counter { };
@@ -19,30 +21,30 @@ namespace
     void iterate_body(
         const vector_td<REAL, D> &point,
         const vector_td<size_t, D> &matrix_size,
-        std::vector<size_t> &indices,
-        std::vector<REAL> &weights,
+        index_type *&indices,
+        REAL *&weights,
         vector_td<REAL, D> &image_point,
         size_t index,
         const ConvolutionKernel<REAL, D, K>& kernel,
         iteration_counter<-1>)
     {
         auto delta = abs(image_point - point);
-        indices.push_back(index);
-        weights.push_back(kernel.get(delta));
+        *indices++ = index_type(index);
+        *weights++ = kernel.get(delta);
     }
 
     template<class REAL, unsigned int D, template<class, unsigned int> class K, int N>
     void iterate_body(
         const vector_td<REAL, D> &point,
         const vector_td<size_t, D> &matrix_size,
-        std::vector<size_t> &indices,
-        std::vector<REAL> &weights,
+        index_type *&indices,
+        REAL *&weights,
         vector_td<REAL, D> &image_point,
         size_t index,
         const ConvolutionKernel<REAL, D, K>& kernel,
         iteration_counter<N>)
     {
-        size_t frame_offset = std::accumulate(&matrix_size[0], &matrix_size[N], 1, std::multiplies<size_t>());
+        size_t frame_offset = std::accumulate(&matrix_size[0], &matrix_size[N], size_t(1), std::multiplies<size_t>());
 
         for (int i = std::ceil(point[N] - kernel.get_radius());
              i <= std::floor(point[N] + kernel.get_radius());
@@ -56,25 +58,40 @@ namespace
         }
     }
 
+    /**
+     * \brief Number of grid points within the kernel radius of a point.
+     */
     template<class REAL, unsigned int D, template<class, unsigned int> class K>
-    std::tuple<std::vector<size_t>, std::vector<REAL>> get_indices(
+    size_t count_indices(
         const vector_td<REAL, D> &point,
-        const vector_td<size_t, D> &matrix_size,
         const ConvolutionKernel<REAL, D, K>& kernel)
     {
-        std::vector<size_t> indices;
-        indices.reserve(size_t(std::pow(std::ceil(kernel.get_width()), D)));
-
-        std::vector<REAL> weights;
-        weights.reserve(size_t(std::pow(std::ceil(kernel.get_width()), D)));
+        size_t count = 1;
+        for (unsigned int d = 0; d < D; d++)
+        {
+            int first = std::ceil(point[d] - kernel.get_radius());
+            int last = std::floor(point[d] + kernel.get_radius());
+            count *= last >= first ? size_t(last - first + 1) : 0;
+        }
+        return count;
+    }
 
+    template<class REAL, unsigned int D, template<class, unsigned int> class K>
+    void get_indices(
+        const vector_td<REAL, D> &point,
+        const vector_td<size_t, D> &matrix_size,
+        const ConvolutionKernel<REAL, D, K>& kernel,
+        index_type *indices,
+        REAL *weights)
+    {
         vector_td<REAL, D> image_point;
         size_t index = 0;
         iterate_body(point, matrix_size, indices, weights, image_point, index,
                      kernel, iteration_counter<D - 1>());
-
-        return std::make_tuple(std::move(indices), std::move(weights));
     }
+
+    // Below this many multiply-adds, threading costs more than it saves.
+    constexpr size_t multiply_adds_use_threading = 64 * 1024;
 }
 
 
@@ -87,12 +104,25 @@ Gadgetron::ConvInternal::make_conv_matrix(
 {
     ConvolutionMatrix<REAL> matrix(trajectory.get_number_of_elements(),
                                    prod(matrix_size));
-    
+
+    // Count the entries of every output first, so all of them can be
+    // written in place into one contiguous allocation.
+    #pragma omp parallel for 
+    for (long long i = 0; i < (long long)matrix.n_cols; i++)
+    {
+        matrix.offsets[i + 1] = count_indices(trajectory[i], kernel);
+    }
+
+    std::partial_sum(matrix.offsets.begin(), matrix.offsets.end(), matrix.offsets.begin());
+    matrix.indices.resize(matrix.non_zeros());
+    matrix.weights.resize(matrix.non_zeros());
+
     #pragma omp parallel for 
-    for (int i = 0; i < (int)trajectory.get_number_of_elements(); i++)
+    for (long long i = 0; i < (long long)matrix.n_cols; i++)
     {
-        std::tie(matrix.indices[i], matrix.weights[i]) = get_indices(
-            trajectory[i], matrix_size, kernel);
+        get_indices(trajectory[i], matrix_size, kernel,
+                    matrix.indices.data() + matrix.offsets[i],
+                    matrix.weights.data() + matrix.offsets[i]);
     }
 
     return matrix;
@@ -103,37 +133,72 @@ template<class REAL>
 Gadgetron::ConvInternal::ConvolutionMatrix<REAL>
 Gadgetron::ConvInternal::transpose(const Gadgetron::ConvInternal::ConvolutionMatrix<REAL> &matrix) {
 
-    auto work_index = boost::irange(size_t(0),matrix.n_cols);
-
     ConvolutionMatrix<REAL> transposed(matrix.n_rows, matrix.n_cols);
 
-    std::vector<int> counts(matrix.n_rows, 0);
+    for (auto row : matrix.indices)
+        transposed.offsets[row + 1]++;
 
-    for (size_t i : work_index)
-    {
-        auto &rows = matrix.indices[i];
-        for (auto &row : rows)
-            counts[row]++;
-    }
+    std::partial_sum(transposed.offsets.begin(), transposed.offsets.end(), transposed.offsets.begin());
+    transposed.indices.resize(transposed.non_zeros());
+    transposed.weights.resize(transposed.non_zeros());
 
-    for (size_t i = 0; i < counts.size(); i++)
+    // Entries are filled in order of the original outputs, so every
+    // transposed output sums its inputs in a deterministic order.
+    std::vector<size_t> positions(transposed.offsets.begin(), transposed.offsets.end() - 1);
+    for (size_t i = 0; i < matrix.n_cols; i++)
     {
-        transposed.indices[i].reserve(counts[i]);
-        transposed.weights[i].reserve(counts[i]);
+        for (size_t n = matrix.offsets[i]; n < matrix.offsets[i + 1]; n++)
+        {
+            auto position = positions[matrix.indices[n]]++;
+            transposed.indices[position] = index_type(i);
+            transposed.weights[position] = matrix.weights[n];
+        }
     }
 
-    for (size_t i : work_index )
+    return transposed;
+}
+
+
+template<class REAL, class T>
+void Gadgetron::ConvInternal::multiply(
+    const Gadgetron::ConvInternal::ConvolutionMatrix<REAL> &matrix,
+    const T* const* vectors,
+    T* const* results,
+    size_t count,
+    bool accumulate)
+{
+    // Vectors are handled in blocks, so the partial sums stay in registers.
+    constexpr size_t block = 8;
+
+    const size_t* offsets = matrix.offsets.data();
+    const index_type* indices = matrix.indices.data();
+    const REAL* weights = matrix.weights.data();
+
+    // The number of entries per output varies with the sampling density, so
+    // outputs are handed out dynamically.
+    #pragma omp parallel for schedule(dynamic, 256) if (matrix.non_zeros() * count > multiply_adds_use_threading)
+    for (long long i = 0; i < (long long)matrix.n_cols; i++)
     {
-        auto &rows = matrix.indices[i];
-        auto &weights = matrix.weights[i];
-        for (size_t n = 0; n < rows.size(); n++)
+        for (size_t k0 = 0; k0 < count; k0 += block)
         {
-            transposed.indices[rows[n]].push_back(i);
-            transposed.weights[rows[n]].push_back(weights[n]);
+            const size_t kn = std::min(block, count - k0);
+
+            T sums[block];
+            for (size_t k = 0; k < kn; k++)
+                sums[k] = T(0);
+
+            for (size_t n = offsets[i]; n < offsets[i + 1]; n++)
+            {
+                const auto index = indices[n];
+                const auto weight = weights[n];
+                for (size_t k = 0; k < kn; k++)
+                    sums[k] += vectors[k0 + k][index] * weight;
+            }
+
+            for (size_t k = 0; k < kn; k++)
+                results[k0 + k][i] = accumulate ? results[k0 + k][i] + sums[k] : sums[k];
         }
     }
-
-    return transposed;
 }
 
 
@@ -241,3 +306,20 @@ template Gadgetron::ConvInternal::ConvolutionMatrix<double>
 Gadgetron::ConvInternal::transpose(
         const Gadgetron::ConvInternal::ConvolutionMatrix<double> &matrix);
 
+template void Gadgetron::ConvInternal::multiply(
+    const Gadgetron::ConvInternal::ConvolutionMatrix<float> &matrix,
+    const float* const* vectors, float* const* results, size_t count, bool accumulate);
+
+template void Gadgetron::ConvInternal::multiply(
+    const Gadgetron::ConvInternal::ConvolutionMatrix<double> &matrix,
+    const double* const* vectors, double* const* results, size_t count, bool accumulate);
+
+template void Gadgetron::ConvInternal::multiply(
+    const Gadgetron::ConvInternal::ConvolutionMatrix<float> &matrix,
+    const Gadgetron::complext<float>* const* vectors, Gadgetron::complext<float>* const* results,
+    size_t count, bool accumulate);
+
+template void Gadgetron::ConvInternal::multiply(
+    const Gadgetron::ConvInternal::ConvolutionMatrix<double> &matrix,
+    const Gadgetron::complext<double>* const* vectors, Gadgetron::complext<double>* const* results,
+    size_t count, bool accumulate);
@@ -6,30 +6,69 @@
 
 #include "ConvolutionKernel.h"
 
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
 namespace Gadgetron
 {
     namespace ConvInternal
     {
+        /**
+         * \brief Sparse gridding matrix in compressed sparse row (CSR) form.
+         *
+         * Output i (0 <= i < n_cols) is the weighted sum of the entries
+         * indices[offsets[i]] ... indices[offsets[i+1] - 1] of an input
+         * with n_rows elements. Indices are 32-bit and all entries are
+         * stored contiguously, which halves the index traffic and avoids
+         * an allocation per output.
+         */
         template<class REAL>
         struct ConvolutionMatrix
         {
+            typedef uint32_t index_type;
+
             ConvolutionMatrix()
+              : n_cols(0), n_rows(0)
             {
                 
             }
 
             ConvolutionMatrix(size_t cols, size_t rows)
-              : n_cols(cols),n_rows(rows)
+              : n_cols(cols), n_rows(rows)
+            {
+                if (rows > std::numeric_limits<index_type>::max())
+                    throw std::runtime_error("ConvolutionMatrix: matrix too large for 32-bit indices");
+                offsets = std::vector<size_t>(n_cols + 1, 0);
+            }
+
+            size_t non_zeros() const
             {
-                weights = std::vector<std::vector<REAL>>(n_cols);
-                indices = std::vector<std::vector<size_t>>(n_cols);
+                return offsets.empty() ? 0 : offsets.back();
             }
 
-            std::vector<std::vector<REAL>> weights;
-            std::vector<std::vector<size_t>> indices;
+            std::vector<size_t> offsets;
+            std::vector<index_type> indices;
+            std::vector<REAL> weights;
             size_t n_cols, n_rows;
         };
 
+        /**
+         * \brief Multiplies the matrix with several vectors in one pass.
+         *
+         * Computes results[k] (+)= matrix * vectors[k] for k < count, reading
+         * each entry of the matrix once for all vectors. Outputs are
+         * distributed over threads, so a single vector is parallelized too.
+         *
+         * \param[in] accumulate If true, add to results, otherwise overwrite.
+         */
+        template<class REAL, class T>
+        void multiply(const ConvolutionMatrix<REAL>& matrix,
+                      const T* const* vectors,
+                      T* const* results,
+                      size_t count,
+                      bool accumulate);
 
         template<class REAL> ConvolutionMatrix<REAL> transpose(
             const ConvolutionMatrix<REAL>& matrix);
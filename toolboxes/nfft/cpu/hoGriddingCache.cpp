@@ -0,0 +1,458 @@
+#include "hoGriddingCache.h"
+
+#include "log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include "sfndam.h"
+
+namespace Gadgetron
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        uint64_t rotate(uint64_t value, int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        uint64_t hash_round(uint64_t state, uint64_t word)
+        {
+            return rotate(state + word * 0xc2b2ae3d27d4eb4full, 31) * 0x9e3779b97f4a7c15ull;
+        }
+
+        uint64_t finalize(uint64_t value)
+        {
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ull;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+
+        uint64_t load_word(const unsigned char* data)
+        {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            return word;
+        }
+
+        size_t default_memory_budget()
+        {
+            if (auto limit = std::getenv("GADGETRON_GRIDDING_CACHE_LIMIT_MB"))
+                return size_t(std::strtoull(limit, nullptr, 10)) << 20;
+            return size_t(512) << 20;
+        }
+
+        std::string default_directory()
+        {
+            if (auto directory = std::getenv("GADGETRON_GRIDDING_CACHE_DIR"))
+                return directory;
+            return std::string();
+        }
+
+        std::string key_string(uint64_t key)
+        {
+            std::ostringstream stream;
+            stream << std::hex << std::setw(16) << std::setfill('0') << key;
+            return stream.str();
+        }
+
+        std::filesystem::path file_path(const std::string& directory, uint64_t key)
+        {
+            return std::filesystem::path(directory) / ("gridding_" + key_string(key) + ".sfndam");
+        }
+
+        json key_meta(const hoGriddingCacheKey& key)
+        {
+            return { { "key", key_string(key.value()) }, { "parameters", key.parameters() } };
+        }
+
+        void check_key(const json& meta, const hoGriddingCacheKey& key)
+        {
+            if (meta.at("key").get<std::string>() != key_string(key.value()) ||
+                meta.at("parameters").get<std::string>() != key.parameters())
+                throw std::runtime_error("hoGriddingCache: file does not match key");
+        }
+
+        template<class T>
+        sfndam::sfndam<T> make_record(std::vector<uint64_t> dimensions, std::vector<T> data, json meta = json::object())
+        {
+            // sfndam cannot store empty arrays.
+            if (data.empty())
+                throw std::runtime_error("hoGriddingCache: cannot store empty array");
+            sfndam::sfndam<T> record;
+            record.array_dimensions = std::move(dimensions);
+            record.data = std::move(data);
+            record.meta = meta.dump();
+            return record;
+        }
+
+        template<class REAL>
+        size_t value_size(const hoGriddingPlan<REAL>& plan)
+        {
+            return plan.size_in_bytes();
+        }
+
+        template<class REAL>
+        size_t value_size(const hoNDArray<REAL>& weights)
+        {
+            return weights.get_number_of_bytes();
+        }
+
+        /**
+         * A plan is stored as three records per matrix: the number of
+         * entries of each output (uint32), the input indices and the
+         * weights. The first record of each matrix carries its shape.
+         */
+        template<class REAL>
+        void write_value(std::ostream& stream, const hoGriddingCacheKey& key, const hoGriddingPlan<REAL>& plan)
+        {
+            auto write_matrix = [&](const ConvInternal::ConvolutionMatrix<REAL>& matrix, bool transposed)
+            {
+                std::vector<uint32_t> counts(matrix.n_cols);
+                for (size_t i = 0; i < matrix.n_cols; i++)
+                    counts[i] = uint32_t(matrix.offsets[i + 1] - matrix.offsets[i]);
+
+                json meta = key_meta(key);
+                meta["matrices"] = plan.conv_matrix.size() + plan.conv_matrix_T.size();
+                meta["transposed"] = transposed;
+                meta["n_rows"] = matrix.n_rows;
+                meta["n_cols"] = matrix.n_cols;
+
+                sfndam::serialize(make_record({ matrix.n_cols }, std::move(counts), meta), stream);
+                sfndam::serialize(make_record({ matrix.non_zeros() }, matrix.indices), stream);
+                sfndam::serialize(make_record({ matrix.non_zeros() }, matrix.weights), stream);
+            };
+
+            if (!plan.conv_matrix_T.empty() && plan.conv_matrix_T.size() != plan.conv_matrix.size())
+                throw std::runtime_error("hoGriddingCache: inconsistent plan");
+
+            for (auto& matrix : plan.conv_matrix)
+                write_matrix(matrix, false);
+            for (auto& matrix : plan.conv_matrix_T)
+                write_matrix(matrix, true);
+        }
+
+        template<class REAL>
+        void read_value(std::istream& stream, const hoGriddingCacheKey& key, hoGriddingPlan<REAL>& plan)
+        {
+            size_t matrices = 1;
+            for (size_t m = 0; m < matrices; m++)
+            {
+                auto counts = sfndam::deserialize<uint32_t>(stream);
+                auto meta = json::parse(counts.meta);
+                check_key(meta, key);
+                matrices = meta.at("matrices").get<size_t>();
+
+                ConvInternal::ConvolutionMatrix<REAL> matrix(
+                    meta.at("n_cols").get<size_t>(), meta.at("n_rows").get<size_t>());
+                if (counts.data.size() != matrix.n_cols)
+                    throw std::runtime_error("hoGriddingCache: corrupt plan");
+                for (size_t i = 0; i < matrix.n_cols; i++)
+                    matrix.offsets[i + 1] = matrix.offsets[i] + counts.data[i];
+
+                matrix.indices = sfndam::deserialize<uint32_t>(stream).data;
+                matrix.weights = sfndam::deserialize<REAL>(stream).data;
+                if (matrix.indices.size() != matrix.non_zeros() || matrix.weights.size() != matrix.non_zeros())
+                    throw std::runtime_error("hoGriddingCache: corrupt plan");
+
+                if (meta.at("transposed").get<bool>())
+                    plan.conv_matrix_T.push_back(std::move(matrix));
+                else
+                    plan.conv_matrix.push_back(std::move(matrix));
+            }
+
+            if (!plan.conv_matrix_T.empty() && plan.conv_matrix_T.size() != plan.conv_matrix.size())
+                throw std::runtime_error("hoGriddingCache: corrupt plan");
+        }
+
+        template<class REAL>
+        void write_value(std::ostream& stream, const hoGriddingCacheKey& key, const hoNDArray<REAL>& weights)
+        {
+            // sfndam dimensions are slowest varying first.
+            auto dimensions = weights.get_dimensions();
+            std::vector<uint64_t> reversed(dimensions.rbegin(), dimensions.rend());
+            sfndam::serialize(make_record(std::move(reversed), std::vector<REAL>(weights.begin(), weights.end()),
+                                          key_meta(key)),
+                              stream);
+        }
+
+        template<class REAL>
+        void read_value(std::istream& stream, const hoGriddingCacheKey& key, hoNDArray<REAL>& weights)
+        {
+            auto record = sfndam::deserialize<REAL>(stream);
+            check_key(json::parse(record.meta), key);
+
+            std::vector<size_t> dimensions(record.array_dimensions.rbegin(), record.array_dimensions.rend());
+            weights.create(dimensions);
+            std::copy(record.data.begin(), record.data.end(), weights.begin());
+        }
+    }
+
+
+    template<class REAL>
+    size_t hoGriddingPlan<REAL>::size_in_bytes() const
+    {
+        size_t bytes = sizeof(*this);
+        for (auto* matrices : { &conv_matrix, &conv_matrix_T })
+        {
+            for (auto& matrix : *matrices)
+            {
+                bytes += sizeof(matrix) + matrix.offsets.size() * sizeof(size_t) +
+                         matrix.indices.size() * sizeof(uint32_t) + matrix.weights.size() * sizeof(REAL);
+            }
+        }
+        return bytes;
+    }
+
+
+    hoGriddingCacheKey& hoGriddingCacheKey::add(const void* data, size_t bytes)
+    {
+        // Empty arrays may have no data pointer at all.
+        if (bytes == 0)
+            return *this;
+
+        auto bytes_ptr = static_cast<const unsigned char*>(data);
+
+        // Four independent lanes, so long trajectories hash at memory speed.
+        uint64_t lanes[4] = { state_ + 0x9e3779b97f4a7c15ull, state_ + 0xc2b2ae3d27d4eb4full, state_,
+                              state_ - 0x9e3779b97f4a7c15ull };
+        size_t i = 0;
+        for (; i + 32 <= bytes; i += 32)
+        {
+            for (int l = 0; l < 4; l++)
+                lanes[l] = hash_round(lanes[l], load_word(bytes_ptr + i + 8 * l));
+        }
+
+        uint64_t state = rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18);
+        for (; i + 8 <= bytes; i += 8)
+            state = hash_round(state, load_word(bytes_ptr + i));
+
+        uint64_t tail = 0;
+        std::memcpy(&tail, bytes_ptr + i, bytes - i);
+        state = hash_round(state, tail);
+
+        state_ = finalize(state ^ uint64_t(bytes));
+        return *this;
+    }
+
+
+    void hoGriddingCacheKey::describe(const void* data, size_t bytes)
+    {
+        static const char digits[] = "0123456789abcdef";
+        auto bytes_ptr = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++)
+        {
+            parameters_ += digits[bytes_ptr[i] >> 4];
+            parameters_ += digits[bytes_ptr[i] & 15];
+        }
+        parameters_ += ';';
+    }
+
+
+    hoGriddingCache& hoGriddingCache::instance()
+    {
+        static hoGriddingCache cache(default_memory_budget(), default_directory());
+        return cache;
+    }
+
+
+    hoGriddingCache::hoGriddingCache(size_t memory_budget, std::string directory)
+      : memory_budget_(memory_budget)
+      , directory_(std::move(directory))
+    {
+
+    }
+
+
+    template<class VALUE>
+    std::shared_ptr<const VALUE> hoGriddingCache::find(const hoGriddingCacheKey& key)
+    {
+        if (auto value = find_in_memory(key, typeid(VALUE)))
+            return std::static_pointer_cast<const VALUE>(value);
+
+        auto directory = get_directory();
+        if (!directory.empty())
+        {
+            auto path = file_path(directory, key.value());
+            std::error_code error;
+            if (std::filesystem::exists(path, error))
+            {
+                try
+                {
+                    std::ifstream stream(path, std::ios::binary);
+                    auto value = std::make_shared<VALUE>();
+                    read_value(stream, key, *value);
+                    GDEBUG_STREAM("hoGriddingCache: loaded " << path.string());
+
+                    insert_in_memory(key, typeid(VALUE), value, value_size(*value));
+                    std::lock_guard<std::mutex> guard(mutex_);
+                    disk_hits_++;
+                    return value;
+                }
+                catch (const std::exception& e)
+                {
+                    GWARN_STREAM("hoGriddingCache: failed to read " << path.string() << ": " << e.what());
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(mutex_);
+        misses_++;
+        return nullptr;
+    }
+
+
+    template<class VALUE>
+    void hoGriddingCache::insert(const hoGriddingCacheKey& key, std::shared_ptr<const VALUE> value)
+    {
+        auto directory = get_directory();
+        if (!directory.empty())
+        {
+            auto path = file_path(directory, key.value());
+            try
+            {
+                // Written under a unique name and renamed over any previous file, so other processes never see a
+                // partial file.
+                std::filesystem::create_directories(directory);
+                auto temporary = path;
+                temporary += ".tmp" + std::to_string(std::random_device()());
+                {
+                    std::ofstream stream(temporary, std::ios::binary);
+                    write_value(stream, key, *value);
+                }
+                std::filesystem::rename(temporary, path);
+                GDEBUG_STREAM("hoGriddingCache: stored " << path.string());
+            }
+            catch (const std::exception& e)
+            {
+                GWARN_STREAM("hoGriddingCache: failed to write " << path.string() << ": " << e.what());
+            }
+        }
+
+        auto bytes = value_size(*value);
+        insert_in_memory(key, typeid(VALUE), std::move(value), bytes);
+    }
+
+
+    std::shared_ptr<const void> hoGriddingCache::find_in_memory(const hoGriddingCacheKey& key, std::type_index type)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto it = index_.find(key.value());
+        if (it == index_.end() || it->second->type != type || it->second->parameters != key.parameters())
+            return nullptr;
+
+        entries_.splice(entries_.begin(), entries_, it->second);
+        hits_++;
+        return it->second->value;
+    }
+
+
+    void hoGriddingCache::insert_in_memory(const hoGriddingCacheKey& key, std::type_index type,
+                                           std::shared_ptr<const void> value, size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto it = index_.find(key.value());
+        if (it != index_.end())
+        {
+            bytes_ -= it->second->bytes;
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+
+        if (bytes > memory_budget_)
+            return;
+
+        entries_.push_front(Entry{ key.value(), key.parameters(), type, std::move(value), bytes });
+        index_[key.value()] = entries_.begin();
+        bytes_ += bytes;
+        evict();
+    }
+
+
+    void hoGriddingCache::evict()
+    {
+        while (bytes_ > memory_budget_ && !entries_.empty())
+        {
+            bytes_ -= entries_.back().bytes;
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+            evictions_++;
+        }
+    }
+
+
+    bool hoGriddingCache::enabled() const
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return memory_budget_ > 0 || !directory_.empty();
+    }
+
+
+    void hoGriddingCache::set_memory_budget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        memory_budget_ = bytes;
+        evict();
+    }
+
+
+    size_t hoGriddingCache::get_memory_budget() const
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return memory_budget_;
+    }
+
+
+    void hoGriddingCache::set_directory(const std::string& directory)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        directory_ = directory;
+    }
+
+
+    std::string hoGriddingCache::get_directory() const
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return directory_;
+    }
+
+
+    void hoGriddingCache::clear()
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        entries_.clear();
+        index_.clear();
+        bytes_ = 0;
+    }
+
+
+    hoGriddingCache::Statistics hoGriddingCache::statistics() const
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return { hits_, disk_hits_, misses_, evictions_, entries_.size(), bytes_ };
+    }
+}
+
+template struct Gadgetron::hoGriddingPlan<float>;
+template struct Gadgetron::hoGriddingPlan<double>;
+
+template std::shared_ptr<const Gadgetron::hoGriddingPlan<float>> Gadgetron::hoGriddingCache::find(const Gadgetron::hoGriddingCacheKey&);
+template std::shared_ptr<const Gadgetron::hoGriddingPlan<double>> Gadgetron::hoGriddingCache::find(const Gadgetron::hoGriddingCacheKey&);
+template std::shared_ptr<const Gadgetron::hoNDArray<float>> Gadgetron::hoGriddingCache::find(const Gadgetron::hoGriddingCacheKey&);
+template std::shared_ptr<const Gadgetron::hoNDArray<double>> Gadgetron::hoGriddingCache::find(const Gadgetron::hoGriddingCacheKey&);
+
+template void Gadgetron::hoGriddingCache::insert(const Gadgetron::hoGriddingCacheKey&, std::shared_ptr<const Gadgetron::hoGriddingPlan<float>>);
+template void Gadgetron::hoGriddingCache::insert(const Gadgetron::hoGriddingCacheKey&, std::shared_ptr<const Gadgetron::hoGriddingPlan<double>>);
+template void Gadgetron::hoGriddingCache::insert(const Gadgetron::hoGriddingCacheKey&, std::shared_ptr<const Gadgetron::hoNDArray<float>>);
+template void Gadgetron::hoGriddingCache::insert(const Gadgetron::hoGriddingCacheKey&, std::shared_ptr<const Gadgetron::hoNDArray<double>>);
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "hoNDArray.h"
+
+#include "ConvolutionMatrix.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+
+namespace Gadgetron
+{
+    /**
+     * \brief Preprocessed gridding convolution for one trajectory.
+     *
+     * One convolution matrix per frame. The transposed matrices are only
+     * present if the plan was prepared for non-Cartesian to Cartesian
+     * convolution.
+     */
+    template<class REAL>
+    struct hoGriddingPlan
+    {
+        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix;
+        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_T;
+
+        size_t size_in_bytes() const;
+    };
+
+
+    /**
+     * \brief Content hash identifying an entry of the gridding cache.
+     *
+     * Everything the cached result depends on (trajectory samples, matrix
+     * sizes, kernel, precision) must be added to the key. Strings, plain
+     * values and array dimensions are also kept verbatim as parameters,
+     * which are stored with the entry and compared on lookup, so a hash
+     * collision between different setups is a miss.
+     */
+    class hoGriddingCacheKey
+    {
+    public:
+
+        /**
+         * \brief Hashes raw data, without keeping it as a parameter.
+         */
+        hoGriddingCacheKey& add(const void* data, size_t bytes);
+
+        hoGriddingCacheKey& add(const std::string& value)
+        {
+            parameters_ += value + ";";
+            return add(value.data(), value.size());
+        }
+
+        template<class T>
+        hoGriddingCacheKey& add(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed");
+            describe(&value, sizeof(T));
+            return add(&value, sizeof(T));
+        }
+
+        template<class T>
+        hoGriddingCacheKey& add(const hoNDArray<T>& array)
+        {
+            for (auto d : array.get_dimensions())
+                add(uint64_t(d));
+            return add(array.get_data_ptr(), array.get_number_of_bytes());
+        }
+
+        uint64_t value() const { return state_; }
+
+        const std::string& parameters() const { return parameters_; }
+
+    private:
+
+        void describe(const void* data, size_t bytes);
+
+        uint64_t state_ = 0x6a09e667f3bcc908ull;
+        std::string parameters_;
+    };
+
+
+    /**
+     * \brief Process-wide LRU cache of gridding preprocessing results.
+     *
+     * Scanners reuse the same few trajectories for many acquisitions, so
+     * convolution matrices and density compensation weights are kept
+     * across plans, gadgets and connections. Entries are evicted least
+     * recently used first once the memory budget is exceeded.
+     *
+     * If a directory is set, entries are also written there as sfndam files
+     * and read back on a miss, so they survive restarts of the process.
+     *
+     * The shared instance takes its budget from GADGETRON_GRIDDING_CACHE_LIMIT_MB
+     * (default 512 MiB, 0 disables the cache) and its directory from
+     * GADGETRON_GRIDDING_CACHE_DIR (default none).
+     *
+     * Supported values are hoGriddingPlan<float>, hoGriddingPlan<double>,
+     * hoNDArray<float> and hoNDArray<double>.
+     */
+    class hoGriddingCache
+    {
+    public:
+
+        struct Statistics
+        {
+            size_t hits;
+            size_t disk_hits;
+            size_t misses;
+            size_t evictions;
+            size_t entries;
+            size_t bytes;
+        };
+
+        static hoGriddingCache& instance();
+
+        explicit hoGriddingCache(size_t memory_budget, std::string directory = std::string());
+
+        /**
+         * \brief Looks up a value, in memory first and then on disk.
+         * \return The cached value, or nullptr on a miss.
+         */
+        template<class VALUE>
+        std::shared_ptr<const VALUE> find(const hoGriddingCacheKey& key);
+
+        /**
+         * \brief Adds a value, replacing any previous value with the same key, in memory and on disk.
+         */
+        template<class VALUE>
+        void insert(const hoGriddingCacheKey& key, std::shared_ptr<const VALUE> value);
+
+        /**
+         * \brief True if values are kept in memory or on disk.
+         */
+        bool enabled() const;
+
+        void set_memory_budget(size_t bytes);
+        size_t get_memory_budget() const;
+
+        void set_directory(const std::string& directory);
+        std::string get_directory() const;
+
+        /**
+         * \brief Drops all entries held in memory. Files on disk are kept.
+         */
+        void clear();
+
+        Statistics statistics() const;
+
+    private:
+
+        struct Entry
+        {
+            uint64_t key;
+            std::string parameters;
+            std::type_index type;
+            std::shared_ptr<const void> value;
+            size_t bytes;
+        };
+
+        std::shared_ptr<const void> find_in_memory(const hoGriddingCacheKey& key, std::type_index type);
+        void insert_in_memory(const hoGriddingCacheKey& key, std::type_index type, std::shared_ptr<const void> value,
+                              size_t bytes);
+        void evict();
+
+        mutable std::mutex mutex_;
+        size_t memory_budget_;
+        std::string directory_;
+
+        // Most recently used first.
+        std::list<Entry> entries_;
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+
+        size_t bytes_ = 0;
+        size_t hits_ = 0;
+        size_t disk_hits_ = 0;
+        size_t misses_ = 0;
+        size_t evictions_ = 0;
+    };
+}
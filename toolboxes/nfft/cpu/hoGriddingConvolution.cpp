@@ -47,60 +47,120 @@ namespace Gadgetron
         GriddingConvolutionBase<hoNDArray, T, D, K>::preprocess(
             trajectory, prep_mode);
 
-        auto scaled_trajectory = trajectory;
-        auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os_);
-        std::transform(scaled_trajectory.begin(),
-                       scaled_trajectory.end(),
-                       scaled_trajectory.begin(),
-                       [matrix_size_os_real](auto point)
-                       { return (point + REAL(0.5)) * matrix_size_os_real; });
-
-        conv_matrix_.reserve(this->num_frames_);
-        conv_matrix_T_.reserve(this->num_frames_);
-
-        for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(
-                            scaled_trajectory, 0))
+        bool transpose = prep_mode == GriddingConvolutionPrepMode::NC2C ||
+                         prep_mode == GriddingConvolutionPrepMode::ALL;
+
+        auto& cache = hoGriddingCache::instance();
+        if (!cache.enabled())
+        {
+            plan_ = make_plan(trajectory, nullptr, transpose);
+            return;
+        }
+
+        // The matrices depend on the kernel, which is fully determined by its
+        // type, width and the matrix sizes. Values of T sharing a precision
+        // share the plan.
+        auto key = hoGriddingCacheKey()
+            .add(std::string("hoGriddingConvolution"))
+            .add(std::string(typeid(K<REAL, D>).name()))
+            .add(uint32_t(sizeof(REAL)))
+            .add(this->matrix_size_)
+            .add(this->matrix_size_os_)
+            .add(this->kernel_.get_width())
+            .add(trajectory);
+
+        auto plan = cache.template find<hoGriddingPlan<REAL>>(key);
+        if (!plan || (transpose && plan->conv_matrix_T.empty()))
         {
-            conv_matrix_.push_back(ConvInternal::make_conv_matrix(
-                traj, this->matrix_size_os_, this->kernel_));
+            plan = make_plan(trajectory, plan.get(), transpose);
+            cache.insert(key, plan);
+        }
+        plan_ = plan;
+    }
 
-            if (prep_mode == GriddingConvolutionPrepMode::NC2C ||
-                prep_mode == GriddingConvolutionPrepMode::ALL)
+
+    template<class T, unsigned int D, template<class, unsigned int> class K>
+    std::shared_ptr<const hoGriddingPlan<realType_t<T>>> hoGriddingConvolution<T, D, K>::make_plan(
+        const hoNDArray<vector_td<REAL, D>>& trajectory,
+        const hoGriddingPlan<REAL>* previous,
+        bool transpose) const
+    {
+        auto plan = std::make_shared<hoGriddingPlan<REAL>>();
+
+        // A cached plan without transposes only needs them added.
+        if (previous)
+        {
+            plan->conv_matrix = previous->conv_matrix;
+        }
+        else
+        {
+            auto scaled_trajectory = trajectory;
+            auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os_);
+            std::transform(scaled_trajectory.begin(),
+                           scaled_trajectory.end(),
+                           scaled_trajectory.begin(),
+                           [matrix_size_os_real](auto point)
+                           { return (point + REAL(0.5)) * matrix_size_os_real; });
+
+            plan->conv_matrix.reserve(this->num_frames_);
+            for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(
+                                scaled_trajectory, 0))
             {
-                conv_matrix_T_.push_back(ConvInternal::transpose(conv_matrix_.back()));
+                plan->conv_matrix.push_back(ConvInternal::make_conv_matrix(
+                    traj, this->matrix_size_os_, this->kernel_));
             }
         }
+
+        if (transpose)
+        {
+            plan->conv_matrix_T.reserve(plan->conv_matrix.size());
+            for (auto& matrix : plan->conv_matrix)
+                plan->conv_matrix_T.push_back(ConvInternal::transpose(matrix));
+        }
+
+        return plan;
     }
 
 
     namespace
     {   
         /**
-         * \brief Matrix-vector multiplication.
+         * \brief Applies the convolution matrices to all batches.
+         * 
+         * Batch b uses matrix b % matrices.size(). All batches sharing a
+         * matrix (typically the coils of a frame) are multiplied in one
+         * pass over that matrix.
          * 
          * \tparam T Value type. Can be real or complex.
-         * \param[in] matrix Convolution matrix.
-         * \param[in] vector Vector.
-         * \param[out] result Operation result.
+         * \param[in] matrices Convolution matrices.
+         * \param[in] input Input, batches of matrix.n_rows elements.
+         * \param[out] output Output, batches of matrix.n_cols elements.
+         * \param[in] accumulate If true, accumulate to the output array.
          */
         template<class T>
-        void mvm(
-            const ConvInternal::ConvolutionMatrix<realType_t<T>>& matrix,
-            const T* vector,
-            T* result)
+        void multiply_batches(
+            const std::vector<ConvInternal::ConvolutionMatrix<realType_t<T>>>& matrices,
+            const hoNDArray<T>& input,
+            hoNDArray<T>& output,
+            bool accumulate)
         {
-            for (size_t i = 0; i < matrix.n_cols; i++)
-            {
-                auto &row_indices = matrix.indices[i];
-                auto &weights = matrix.weights[i];
+            const size_t input_size = matrices.front().n_rows;
+            const size_t output_size = matrices.front().n_cols;
+            const size_t nbatches = input.get_number_of_elements() / input_size;
+            assert(nbatches == output.get_number_of_elements() / output_size);
 
-                #ifndef WIN32
-                    #pragma omp simd
-                #endif // WIN32
-                for (size_t n = 0; n < row_indices.size(); n++)
+            for (size_t m = 0; m < matrices.size(); m++)
+            {
+                std::vector<const T*> vectors;
+                std::vector<T*> results;
+                for (size_t b = m; b < nbatches; b += matrices.size())
                 {
-                    result[i] += vector[row_indices[n]] * weights[n];
+                    vectors.push_back(input.get_data_ptr() + b * input_size);
+                    results.push_back(output.get_data_ptr() + b * output_size);
                 }
+
+                ConvInternal::multiply(matrices[m], vectors.data(), results.data(),
+                                       vectors.size(), accumulate);
             }
         }
     }
@@ -112,19 +172,7 @@ namespace Gadgetron
         hoNDArray<T> &samples,
         bool accumulate)
     {
-        size_t nbatches = image.get_number_of_elements() / conv_matrix_.front().n_rows;
-        assert(nbatches == samples.get_number_of_elements() / conv_matrix_.front().n_cols);
-
-        if (!accumulate) clear(&samples);
-
-        #pragma omp parallel for
-        for (int b = 0; b < (int)nbatches; b++)
-        {
-            const T* image_view = image.get_data_ptr() + b * conv_matrix_.front().n_rows;
-            T* samples_view = samples.get_data_ptr() + b * conv_matrix_.front().n_cols;
-            size_t matrix_index = b % conv_matrix_.size();
-            mvm(conv_matrix_[matrix_index], image_view, samples_view);
-        }
+        multiply_batches(plan_->conv_matrix, image, samples, accumulate);
     }
 
 
@@ -134,19 +182,7 @@ namespace Gadgetron
         hoNDArray<T> &image,
         bool accumulate)
     {
-        size_t nbatches = image.get_number_of_elements() / conv_matrix_.front().n_rows;
-        assert(nbatches == samples.get_number_of_elements() / conv_matrix_.front().n_cols);
-
-        if (!accumulate) clear(&image);
-
-        #pragma omp parallel for
-        for (int b = 0; b < (int)nbatches; b++)
-        {
-            T* image_view = image.get_data_ptr() + b * conv_matrix_.front().n_rows;
-            const T* samples_view = samples.get_data_ptr() + b * conv_matrix_.front().n_cols;
-            size_t matrix_index = b % conv_matrix_.size();
-            mvm(conv_matrix_T_[matrix_index], samples_view, image_view);
-        }
+        multiply_batches(plan_->conv_matrix_T, samples, image, accumulate);
     }
 }
 
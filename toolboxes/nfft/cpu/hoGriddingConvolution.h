@@ -5,6 +5,7 @@
 #include "hoNDArray.h"
 
 #include "ConvolutionMatrix.h"
+#include "hoGriddingCache.h"
 
 namespace Gadgetron
 {
@@ -49,6 +50,9 @@ namespace Gadgetron
         /**
          * \brief Prepare gridding convolution.
          * 
+         * The convolution matrices are shared through hoGriddingCache, so
+         * preparing for a trajectory seen before is a lookup.
+         * 
          * \param trajectory Trajectory, normalized to [-0.5, 0.5].
          * \param prep_mode Preparation mode.
          */
@@ -82,8 +86,15 @@ namespace Gadgetron
                            hoNDArray<T> &image,
                            bool accumulate) override;
 
-        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_;
-        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_T_;
+        /**
+         * \brief Compute the convolution matrices for a trajectory.
+         */
+        std::shared_ptr<const hoGriddingPlan<REAL>> make_plan(
+            const hoNDArray<vector_td<REAL, D>>& trajectory,
+            const hoGriddingPlan<REAL>* previous,
+            bool transpose) const;
+
+        std::shared_ptr<const hoGriddingPlan<REAL>> plan_;
     };
 
     /**
@@ -240,8 +240,8 @@ namespace Gadgetron {
             hoNDArray<ComplexType> &out,
             const hoNDArray<REAL>* dcw
     ) {
-        std::vector<size_t> dims = {this->number_of_samples,this->number_of_frames};
-        auto batches = in.get_number_of_elements()/(prod(this->matrix_size_)*this->number_of_frames);
+        std::vector<size_t> dims = {this->conv_->get_num_samples(),this->conv_->get_num_frames()};
+        auto batches = in.get_number_of_elements()/(prod(this->matrix_size_)*this->conv_->get_num_frames());
         dims.push_back(batches);
 
         hoNDArray<ComplexType> tmp(dims);
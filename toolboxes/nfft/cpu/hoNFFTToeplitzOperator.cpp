@@ -0,0 +1,206 @@
+#include "hoNFFTToeplitzOperator.h"
+
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_utils.h"
+#include "hoNDFFT.h"
+#include "hoNFFT.h"
+#include "vector_td_operators.h"
+#include "vector_td_utilities.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace Gadgetron {
+
+    namespace {
+
+        // Unitary, non-centered FFT over the first D dimensions.
+        template<class REAL, unsigned int D>
+        void fftD(hoNDArray<std::complex<REAL>>& data, bool forward)
+        {
+            auto fft = hoNDFFT<REAL>::instance();
+            if constexpr (D == 1) {
+                forward ? fft->fft1(data) : fft->ifft1(data);
+            } else if constexpr (D == 2) {
+                forward ? fft->fft2(data) : fft->ifft2(data);
+            } else {
+                forward ? fft->fft3(data) : fft->ifft3(data);
+            }
+        }
+
+        template<class T>
+        hoNDArray<std::complex<realType_t<T>>>& as_std_complex(hoNDArray<T>& array)
+        {
+            return reinterpret_cast<hoNDArray<std::complex<realType_t<T>>>&>(array);
+        }
+
+        // Linear index of the multi-index, for column major arrays of the given size.
+        template<unsigned int D>
+        size_t linear_index(const vector_td<size_t, D>& index, const vector_td<size_t, D>& size)
+        {
+            size_t result = 0;
+            for (int d = D - 1; d >= 0; d--)
+                result = result * size[d] + index[d];
+            return result;
+        }
+
+        template<unsigned int D>
+        vector_td<size_t, D> multi_index(size_t index, const vector_td<size_t, D>& size)
+        {
+            vector_td<size_t, D> result;
+            for (unsigned int d = 0; d < D; d++) {
+                result[d] = index % size[d];
+                index /= size[d];
+            }
+            return result;
+        }
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFTToeplitzOperator<REAL, D>::set_dcw(boost::shared_ptr<hoNDArray<REAL>> dcw)
+    {
+        NFFTOperator<hoNDArray, REAL, D>::set_dcw(dcw);
+        if (!trajectory_.empty())
+            compute_kernel();
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFTToeplitzOperator<REAL, D>::preprocess(const hoNDArray<typename reald<REAL, D>::Type>& trajectory)
+    {
+        NFFTOperator<hoNDArray, REAL, D>::preprocess(trajectory);
+        trajectory_ = trajectory;
+        compute_kernel();
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFTToeplitzOperator<REAL, D>::compute_kernel()
+    {
+        if (!this->plan_)
+            throw std::runtime_error("hoNFFTToeplitzOperator::compute_kernel : setup must be called before preprocess");
+
+        const auto matrix_size = this->plan_->get_matrix_size();
+        const auto matrix_size_os = this->plan_->get_matrix_size_os();
+        const vector_td<size_t, D> kernel_size = matrix_size * size_t(2);
+        const size_t samples = trajectory_.get_size(0);
+        const size_t frames = trajectory_.get_number_of_elements() / samples;
+
+        // The point spread function W^2 sampled by the adjoint NFFT, on a grid large enough to hold every
+        // difference between two pixels of the image.
+        auto psf_plan = NFFT<hoNDArray, REAL, D>::make_plan(kernel_size, matrix_size_os * size_t(2), this->plan_->get_W());
+        psf_plan->preprocess(trajectory_, NFFT_prep_mode::NC2C);
+
+        hoNDArray<complext<REAL>> weights(samples, frames);
+        weights.fill(complext<REAL>(1));
+        if (this->dcw_) {
+            weights *= *this->dcw_;
+            weights *= *this->dcw_;
+        }
+
+        auto kernel_dims = to_std_vector(kernel_size);
+        kernel_dims.push_back(frames);
+        hoNDArray<complext<REAL>> psf(kernel_dims);
+        psf_plan->compute(weights, psf, nullptr, NFFT_comp_mode::BACKWARDS_NC2C);
+
+        // The scaling of the gridding normal operator depends on how its plan was made, so it is measured:
+        // applied to an impulse in the center, it returns the point spread function shifted to the center.
+        auto image_dims = to_std_vector(matrix_size);
+        image_dims.push_back(frames);
+        hoNDArray<complext<REAL>> impulse(image_dims);
+        impulse.fill(complext<REAL>(0));
+        const vector_td<size_t, D> center = matrix_size / size_t(2);
+        const size_t image_elements = prod(matrix_size);
+        const size_t kernel_elements = prod(kernel_size);
+        for (size_t f = 0; f < frames; f++)
+            impulse[f * image_elements + linear_index(center, matrix_size)] = complext<REAL>(1);
+
+        hoNDArray<complext<REAL>> response(image_dims);
+        this->plan_->mult_MH_M(impulse, response, this->dcw_.get());
+
+        complext<double> correlation(0);
+        double energy = 0;
+        for (size_t f = 0; f < frames; f++) {
+            for (size_t i = 0; i < image_elements; i++) {
+                // Pixel r of the response is the point spread function at r - center.
+                auto index = multi_index(i, matrix_size) + matrix_size - center;
+                auto p = psf[f * kernel_elements + linear_index(index, kernel_size)];
+                auto r = response[f * image_elements + i];
+                correlation += complext<double>(conj(p) * r);
+                energy += double(norm(p));
+            }
+        }
+        if (energy == 0)
+            throw std::runtime_error("hoNFFTToeplitzOperator::compute_kernel : trajectory has no weight");
+        const auto scale = complext<REAL>(correlation / energy);
+
+        // Circulant embedding: the point spread function at offset d goes to d modulo the kernel size. With
+        // unitary FFTs, a circular convolution is sqrt(N) times the pointwise product of the transforms.
+        kernel_.create(kernel_dims);
+        const REAL normalization = std::sqrt(REAL(kernel_elements));
+        for (size_t f = 0; f < frames; f++) {
+            for (size_t i = 0; i < kernel_elements; i++) {
+                auto index = multi_index(i, kernel_size);
+                for (unsigned int d = 0; d < D; d++)
+                    index[d] = (index[d] + matrix_size[d]) % kernel_size[d];
+                auto value = scale * psf[f * kernel_elements + linear_index(index, kernel_size)] * normalization;
+                kernel_[f * kernel_elements + i] = std::complex<REAL>(real(value), imag(value));
+            }
+        }
+        fftD<REAL, D>(kernel_, true);
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFTToeplitzOperator<REAL, D>::mult_MH_M(hoNDArray<complext<REAL>>* in, hoNDArray<complext<REAL>>* out,
+                                                    bool accumulate)
+    {
+        if (!in || !out) {
+            throw std::runtime_error("hoNFFTToeplitzOperator::mult_MH_M : 0x0 input/output not accepted");
+        }
+        if (kernel_.empty()) {
+            throw std::runtime_error("hoNFFTToeplitzOperator::mult_MH_M : preprocess must be called first");
+        }
+
+        const auto matrix_size = this->plan_->get_matrix_size();
+        const vector_td<size_t, D> kernel_size = matrix_size * size_t(2);
+        const size_t kernel_elements = prod(kernel_size);
+        const size_t frames = kernel_.get_number_of_elements() / kernel_elements;
+
+        hoNDArray<complext<REAL>> padded;
+        pad<complext<REAL>, D>(kernel_size, *in, padded);
+
+        auto& data = as_std_complex(padded);
+        fftD<REAL, D>(data, true);
+
+        const size_t batches = data.get_number_of_elements() / kernel_elements;
+#pragma omp parallel for
+        for (long long b = 0; b < (long long)batches; b++) {
+            auto batch = data.get_data_ptr() + b * kernel_elements;
+            auto kernel = kernel_.get_data_ptr() + (b % frames) * kernel_elements;
+            for (size_t i = 0; i < kernel_elements; i++)
+                batch[i] *= kernel[i];
+        }
+
+        fftD<REAL, D>(data, false);
+
+        // Same offset as pad used.
+        const vector_td<size_t, D> offset = kernel_size / size_t(2) - matrix_size / size_t(2);
+        if (accumulate) {
+            hoNDArray<complext<REAL>> result;
+            crop<complext<REAL>, D>(offset, matrix_size, padded, result);
+            *out += result;
+        } else {
+            crop<complext<REAL>, D>(offset, matrix_size, padded, *out);
+        }
+    }
+}
+
+template class Gadgetron::hoNFFTToeplitzOperator<float, 1>;
+template class Gadgetron::hoNFFTToeplitzOperator<float, 2>;
+template class Gadgetron::hoNFFTToeplitzOperator<float, 3>;
+
+template class Gadgetron::hoNFFTToeplitzOperator<double, 1>;
+template class Gadgetron::hoNFFTToeplitzOperator<double, 2>;
+template class Gadgetron::hoNFFTToeplitzOperator<double, 3>;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "NFFTOperator.h"
+#include "hoNDArray.h"
+
+#include <complex>
+
+namespace Gadgetron{
+
+  /**
+     \brief NFFT encoding operator with a Toeplitz embedded normal operator (CPU).
+
+     mult_M and mult_MH grid, as NFFTOperator does. mult_MH_M instead uses that E^H W^2 E is a convolution
+     on the image, with the point spread function of the trajectory as kernel. The kernel is computed once
+     per trajectory on a grid of twice the matrix size, so that it is circulant; each application of the
+     normal operator is then a zero-padded FFT, a pointwise multiplication and an inverse FFT, without any
+     gridding.
+
+     The kernel depends on the density compensation weights; setting them recomputes it.
+  */
+  template<class REAL, unsigned int D>
+  class hoNFFTToeplitzOperator : public NFFTOperator<hoNDArray, REAL, D>
+  {
+  public:
+
+    hoNFFTToeplitzOperator() = default;
+    virtual ~hoNFFTToeplitzOperator() {}
+
+    virtual void set_dcw( boost::shared_ptr< hoNDArray<REAL> > dcw ) override;
+    virtual void preprocess( const hoNDArray<typename reald<REAL,D>::Type>& trajectory ) override;
+
+    virtual void mult_MH_M( hoNDArray< complext<REAL> > *in, hoNDArray< complext<REAL> > *out, bool accumulate = false ) override;
+
+  protected:
+
+    void compute_kernel();
+
+    hoNDArray<typename reald<REAL,D>::Type> trajectory_;
+
+    // Fourier transform of the circulant embedded kernel, one per frame.
+    hoNDArray< std::complex<REAL> > kernel_;
+  };
+}
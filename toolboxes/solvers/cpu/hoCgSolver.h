@@ -10,6 +10,7 @@
 
 #include "cgSolver.h"
 #include "hoNDArray_math.h"
+#include "hoNDArray_expressions.h"
 
 namespace Gadgetron{
 
@@ -24,5 +25,45 @@ namespace Gadgetron{
   public:
     hoCgSolver() : cgSolver<hoNDArray<T> >() {}
     virtual ~hoCgSolver() {}
+
+  protected:
+    typedef typename cgSolver<hoNDArray<T> >::REAL REAL;
+
+    // Same iteration as cgSolver::iterate, but with the vector updates fused into single passes over memory
+    //
+    virtual void iterate( unsigned int iteration, REAL *tc_metric, bool *tc_terminate )
+    {
+      using namespace expressions;
+
+      hoNDArray<T>& x = *this->x_;
+      hoNDArray<T>& p = *this->p_;
+      hoNDArray<T>& r = *this->r_;
+      hoNDArray<T> q(x.dimensions());
+
+      this->mult_MH_M( &p, &q );
+
+      this->alpha_ = this->rq_/dot( lazy(p), lazy(q) );
+      const T alpha = this->alpha_;
+      x += alpha*lazy(p);
+      r -= alpha*lazy(q);
+
+      if( this->precond_.get() ){
+        this->precond_->apply( &r, &q );
+        this->precond_->apply( &q, &q );
+
+        REAL tmp_rq = real(dot( lazy(r), lazy(q) ));
+        p = lazy(q) + T(tmp_rq/this->rq_)*lazy(p);
+        this->rq_ = tmp_rq;
+      }
+      else{
+        REAL tmp_rq = real(sum( norm(lazy(r)) ));
+        p = lazy(r) + T(tmp_rq/this->rq_)*lazy(p);
+        this->rq_ = tmp_rq;
+      }
+
+      if( !this->cb_->iterate( iteration, tc_metric, tc_terminate ) ){
+        throw std::runtime_error( "Error: hoCgSolver::iterate : termination callback iteration failed" );
+      }
+    }
   };
 }